@@ -0,0 +1,124 @@
+#include "AllocationCounter.h"
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// --------------- Basic usage -----------------
+//
+// Counts heap allocations, to prove a piece of code
+// doesn't make any:
+//
+//   unsigned long long before = AllocationCounter::GetCount();
+//   /* a frame */
+//   unsigned long long allocations = AllocationCounter::GetCount() - before;
+//
+// This file replaces the global operator new and delete
+// (the plain, array and nothrow forms), so every C++
+// allocation in the program is counted: containers,
+// std::string, std::function, make_shared and so on.
+// Over-aligned new, and code that calls malloc directly,
+// isn't.  ImGui allocates with malloc, so it's routed
+// through MemoryTracker::ImGuiAlloc(), which uses new.
+//
+// Each allocation carries a small header with its size
+// and MemoryTracker tag, so frees can be charged back to
+// the right tag.
+//
+// GetCount() includes every thread (job workers, the log
+// writer...), and GetThreadCount() only the calling one.
+// Counting is a few relaxed atomic adds per allocation.
+// ---------------------------------------------
+
+namespace AllocationCounter
+{
+	// Annonymous namespace to hold variables/helpers only accessible in this file
+	namespace
+	{
+		std::atomic<unsigned long long> count{ 0 };
+		std::atomic<unsigned long long> bytes{ 0 };
+		thread_local unsigned long long threadCount = 0;
+
+		// In front of every allocation.  Keeps what follows it as
+		// aligned as malloc's own result
+		struct alignas(16) Header
+		{
+			size_t size;
+			MemoryTracker::Tag tag;
+		};
+
+		void* CountedAlloc(size_t size)
+		{
+			Header* header = (Header*)std::malloc(sizeof(Header) + size);
+			if (!header)
+				return 0;
+
+			count.fetch_add(1, std::memory_order_relaxed);
+			bytes.fetch_add(size, std::memory_order_relaxed);
+			threadCount++;
+
+			header->size = size;
+			header->tag = MemoryTracker::GetThreadTag();
+			MemoryTracker::RecordAllocation(header->tag, size);
+			return header + 1;
+		}
+
+		void CountedFree(void* pointer)
+		{
+			if (!pointer)
+				return;
+
+			Header* header = (Header*)pointer - 1;
+			MemoryTracker::RecordFree(header->tag, header->size);
+			std::free(header);
+		}
+
+		// operator new has to keep trying (through the new handler) or throw
+		void* CountedNew(size_t size)
+		{
+			while (true)
+			{
+				void* pointer = CountedAlloc(size);
+				if (pointer)
+					return pointer;
+
+				std::new_handler handler = std::get_new_handler();
+				if (!handler)
+					throw std::bad_alloc();
+				handler();
+			}
+		}
+	}
+}
+
+// Getters
+unsigned long long AllocationCounter::GetCount() { return count.load(std::memory_order_relaxed); }
+unsigned long long AllocationCounter::GetBytes() { return bytes.load(std::memory_order_relaxed); }
+unsigned long long AllocationCounter::GetThreadCount() { return threadCount; }
+
+
+// --------------------------------------------------------
+// Global replacements, all counted the same way
+// --------------------------------------------------------
+void* operator new(size_t size) { return AllocationCounter::CountedNew(size); }
+void* operator new[](size_t size) { return AllocationCounter::CountedNew(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try { return AllocationCounter::CountedNew(size); }
+	catch (...) { return 0; }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	try { return AllocationCounter::CountedNew(size); }
+	catch (...) { return 0; }
+}
+
+void operator delete(void* pointer) noexcept { AllocationCounter::CountedFree(pointer); }
+void operator delete[](void* pointer) noexcept { AllocationCounter::CountedFree(pointer); }
+void operator delete(void* pointer, size_t) noexcept { AllocationCounter::CountedFree(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { AllocationCounter::CountedFree(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { AllocationCounter::CountedFree(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { AllocationCounter::CountedFree(pointer); }
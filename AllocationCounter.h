@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// See AllocationCounter.cpp for usage details
+
+namespace AllocationCounter
+{
+	// Since startup, from every thread
+	unsigned long long GetCount();
+	unsigned long long GetBytes();
+
+	// Just the calling thread's
+	unsigned long long GetThreadCount();
+}
@@ -0,0 +1,457 @@
+#include "AssetStreamer.h"
+#include "IORing.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MemoryTracker.h"
+
+#include <algorithm>
+#include <fstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --------------- Basic usage -----------------
+//
+// Loads files in the background, nearest first, so
+// startup and camera moves don't wait on the disk:
+//
+//   AssetStreamer streamer(4 * 1024 * 1024);	// Upload bytes per frame
+//   streamer.Request(FixPath("Rock.mesh"), position,
+//       [](AssetStreamer::Buffer& data) { /* parse, on a worker */ return true; },
+//       [&](unsigned int asset, AssetStreamer::Buffer& data, bool succeeded) { /* create buffers */ });
+//
+// Then once per frame, on the main thread:
+//
+//   streamer.SetViewPosition(cameraPosition);
+//   streamer.Update();
+//
+// Each request goes through three stages:
+//  - A dedicated IO thread reads the whole file, in big
+//    chunk-sized reads straight into the asset's buffer.
+//    It always picks the queued request nearest to the
+//    view position, so moving the camera reorders what's
+//    left.
+//  - The decode function runs as a JobSystem job, so
+//    parsing and decompression spread over the workers
+//    while the IO thread moves on to the next file.
+//  - Update() hands decoded assets (nearest first) to
+//    their upload function, but only up to the upload
+//    budget each frame, so a burst of finished assets
+//    doesn't become a long frame.  At least one asset is
+//    uploaded per frame, however big.
+//
+// Reading stops while more than pMaxBufferedBytes are
+// waiting for upload, so a slow upload budget can't fill
+// memory with everything on disk.  The view position is
+// what gets read next when it resumes.
+//
+// On Linux the IO thread reads through io_uring (see
+// IORing.cpp): a file's chunks are all queued at once, up
+// to the ring's depth, so the device works on several
+// while the thread sleeps.  Files are opened with
+// O_DIRECT, reading whole sectors into the sector-aligned
+// Buffer and skipping the OS cache, which only keeps a
+// second copy of data that's about to be decoded anyway.
+// File systems that refuse O_DIRECT (tmpfs, for one) get
+// the same ring with cached reads.  Everywhere else, or
+// with pUseIORing off, it's an unbuffered std::ifstream
+// reading the same chunks one after another.  The
+// destructor drops whatever hasn't been read yet and
+// waits for decodes in flight.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Reads one file keeps in flight at once
+	const unsigned int RingDepth = 8;
+
+	size_t AlignUp(size_t bytes, size_t alignment)
+	{
+		return (bytes + alignment - 1) / alignment * alignment;
+	}
+}
+
+AssetStreamer::AssetStreamer(size_t pUploadBytesPerFrame, size_t pMaxBufferedBytes, size_t pChunkSize, bool pUseIORing) :
+	chunkSize(pChunkSize > 0 ? pChunkSize : 1),
+	uploadBytesPerFrame(pUploadBytesPerFrame),
+	maxBufferedBytes(pMaxBufferedBytes),
+	nextId(0),
+	viewPosition{ 0, 0, 0 },
+	quitting(false),
+	inFlight(0),
+	decoding(0),
+	bytesRead(0),
+	bufferedBytes(0),
+	unbufferedReads(0),
+	completed(0),
+	failed(0),
+	uploadedLastFrame(0)
+{
+	if (pUseIORing)
+	{
+		ring = std::make_shared<IORing>(RingDepth);
+		if (!ring->IsAvailable())
+			ring.reset();
+	}
+	ioThread = std::thread(&AssetStreamer::IOLoop, this);
+}
+
+AssetStreamer::~AssetStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		quitting = true;
+	}
+	queueChanged.notify_all();
+	ioThread.join();
+
+	// Decode jobs point back here
+	while (decoding.load(std::memory_order_acquire) > 0)
+		std::this_thread::yield();
+}
+
+
+// --------------------------------------------------------
+// Queues a file.  Its position decides how soon it's
+// read.  Returns the id its upload function will get
+// --------------------------------------------------------
+unsigned int AssetStreamer::Request(const std::string& pPath, const float pPosition[3], const DecodeFunction& pDecode, const UploadFunction& pUpload)
+{
+	std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+	asset->id = nextId++;
+	asset->path = pPath;
+	asset->decode = pDecode;
+	asset->upload = pUpload;
+	asset->readBytes = 0;
+	asset->succeeded = false;
+	for (int i = 0; i < 3; i++)
+		asset->position[i] = pPosition[i];
+
+	inFlight++;
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		asset->distance = DistanceFromView(pPosition);
+		queue.push_back(asset);
+		std::push_heap(queue.begin(), queue.end(), IsFurther);
+	}
+	queueChanged.notify_one();
+	return asset->id;
+}
+
+
+// --------------------------------------------------------
+// Moves the point requests are prioritized around, and
+// reorders everything still waiting to be read
+// --------------------------------------------------------
+void AssetStreamer::SetViewPosition(const float pPosition[3])
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	if (pPosition[0] == viewPosition[0] && pPosition[1] == viewPosition[1] && pPosition[2] == viewPosition[2])
+		return;
+
+	for (int i = 0; i < 3; i++)
+		viewPosition[i] = pPosition[i];
+	for (std::shared_ptr<Asset>& asset : queue)
+		asset->distance = DistanceFromView(asset->position);
+	std::make_heap(queue.begin(), queue.end(), IsFurther);
+}
+
+
+// --------------------------------------------------------
+// Uploads decoded assets, nearest first, until this
+// frame's budget is spent.  Call once per frame on the
+// main thread
+// --------------------------------------------------------
+void AssetStreamer::Update()
+{
+	std::vector<std::shared_ptr<Asset>> uploads;
+	size_t uploaded = 0;
+	size_t released = 0;
+	{
+		std::lock_guard<std::mutex> lock(readyMutex);
+		if (ready.empty())
+		{
+			uploadedLastFrame = 0;
+			return;
+		}
+
+		// Furthest first, so the nearest come off the back
+		for (std::shared_ptr<Asset>& asset : ready)
+			asset->distance = DistanceFromView(asset->position);
+		std::sort(ready.begin(), ready.end(), IsFurther);
+
+		while (!ready.empty())
+		{
+			size_t size = ready.back()->data.size();
+			if (!uploads.empty() && uploaded + size > uploadBytesPerFrame)
+				break;
+			uploaded += size;
+			uploads.push_back(ready.back());
+			ready.pop_back();
+		}
+	}
+
+	// Outside the lock, since uploads can take a while
+	for (std::shared_ptr<Asset>& asset : uploads)
+	{
+		if (asset->succeeded)
+			completed++;
+		else
+			failed++;
+		asset->upload(asset->id, asset->data, asset->succeeded);
+		released += asset->readBytes;
+	}
+	uploadedLastFrame = uploaded;
+
+	// Room to read again
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		bufferedBytes -= released;
+	}
+	queueChanged.notify_one();
+}
+
+
+// --------------------------------------------------------
+// Blocks until every request has been read and decoded.
+// They still need Update() to be uploaded.  Mostly for
+// tests
+// --------------------------------------------------------
+void AssetStreamer::WaitIdle()
+{
+	while (inFlight.load(std::memory_order_acquire) > 0)
+		std::this_thread::yield();
+}
+
+
+// --------------------------------------------------------
+// The IO thread: reads the nearest queued file, hands it
+// to a decode job and moves on
+// --------------------------------------------------------
+void AssetStreamer::IOLoop()
+{
+	while (true)
+	{
+		std::shared_ptr<Asset> asset;
+		{
+			std::unique_lock<std::mutex> lock(queueMutex);
+			queueChanged.wait(lock, [this]()
+				{
+					return quitting || (!queue.empty() && bufferedBytes.load(std::memory_order_relaxed) < maxBufferedBytes);
+				});
+			if (quitting)
+				return;
+
+			std::pop_heap(queue.begin(), queue.end(), IsFurther);
+			asset = queue.back();
+			queue.pop_back();
+		}
+
+		asset->succeeded = ring ? ReadFileWithRing(asset->path, asset->data) : ReadFile(asset->path, asset->data);
+		asset->readBytes = asset->data.size();
+		bufferedBytes += asset->readBytes;
+		if (!asset->succeeded)
+			Log::Write(Log::Severity::Warning, Log::Category::Assets, "Couldn't read %s", asset->path.c_str());
+
+		decoding++;
+		JobSystem::Submit([this, asset]() { Decode(asset); });
+	}
+}
+
+
+// --------------------------------------------------------
+// Reads a whole file in chunk-sized pieces, straight into
+// the asset's buffer (the stream's own buffering is off,
+// so nothing is copied twice)
+// --------------------------------------------------------
+bool AssetStreamer::ReadFile(const std::string& pPath, Buffer& pData)
+{
+	MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+	std::ifstream file;
+	file.rdbuf()->pubsetbuf(0, 0);
+	file.open(pPath, std::ios::binary | std::ios::ate);
+	if (!file)
+		return false;
+
+	std::streamoff size = file.tellg();
+	if (size < 0)
+		return false;
+	file.seekg(0);
+
+	pData.resize((size_t)size);
+	for (size_t offset = 0; offset < pData.size(); offset += chunkSize)
+	{
+		size_t length = std::min(chunkSize, pData.size() - offset);
+		file.read((char*)pData.data() + offset, length);
+		if ((size_t)file.gcount() != length)
+		{
+			pData.clear();
+			return false;
+		}
+	}
+	bytesRead += pData.size();
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Reads a whole file through the ring, every chunk queued
+// at once.  Unbuffered reads can only move whole sectors,
+// so the buffer is read up to the next sector and trimmed
+// afterwards
+// --------------------------------------------------------
+bool AssetStreamer::ReadFileWithRing(const std::string& pPath, Buffer& pData)
+{
+#ifdef _WIN32
+	return ReadFile(pPath, pData);
+#else
+	MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+	bool unbuffered = true;
+	int file = open(pPath.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+	if (file < 0 && errno == EINVAL)
+	{
+		unbuffered = false;
+		file = open(pPath.c_str(), O_RDONLY | O_CLOEXEC);
+	}
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0)
+	{
+		close(file);
+		return false;
+	}
+	size_t size = (size_t)info.st_size;
+	pData.resize(AlignUp(size, Buffer::allocator_type::SectorSize));
+
+	// Every chunk starts on a sector, so a read that comes back
+	// short carries on to the end of its own chunk
+	const size_t chunk = AlignUp(std::min(chunkSize, (size_t)1 << 30), Buffer::allocator_type::SectorSize);
+	auto chunkEnd = [&](size_t offset) { return std::min((offset / chunk + 1) * chunk, pData.size()); };
+	size_t nextOffset = 0;
+	unsigned int pending = 0;
+	bool succeeded = true;
+	while (pending > 0 || (succeeded && nextOffset < pData.size()))
+	{
+		while (succeeded && nextOffset < pData.size() &&
+			ring->Read(file, pData.data() + nextOffset, (unsigned int)(chunkEnd(nextOffset) - nextOffset), nextOffset, nextOffset))
+		{
+			nextOffset = chunkEnd(nextOffset);
+			pending++;
+		}
+
+		// The kernel may still be writing into the buffer, so
+		// nothing leaves before every read has come back
+		unsigned long long offset;
+		int result;
+		if (!ring->Wait(offset, result))
+		{
+			// Only a broken ring gets here.  Its reads may still land,
+			// so their memory is handed to nobody rather than freed
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "io_uring stopped answering while reading %s", pPath.c_str());
+			new Buffer(std::move(pData));
+			pData = Buffer();
+			close(file);
+			return false;
+		}
+		pending--;
+
+		size_t end = (size_t)offset + (result > 0 ? (size_t)result : 0);
+		if (result < 0 || (result == 0 && end < size))
+			succeeded = false;
+		else if (succeeded && end < size && end < chunkEnd((size_t)offset))
+		{
+			ring->Read(file, pData.data() + end, (unsigned int)(chunkEnd((size_t)offset) - end), end, end);
+			pending++;
+		}
+	}
+	close(file);
+
+	if (!succeeded)
+	{
+		pData.clear();
+		return false;
+	}
+	pData.resize(size);
+	bytesRead += size;
+	if (unbuffered)
+		unbufferedReads++;
+	return true;
+#endif
+}
+
+
+// --------------------------------------------------------
+// A decode job: runs the asset's decode function, then
+// queues it for uploading
+// --------------------------------------------------------
+void AssetStreamer::Decode(std::shared_ptr<Asset> pAsset)
+{
+	if (pAsset->succeeded)
+	{
+		MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+		pAsset->succeeded = pAsset->decode(pAsset->data);
+		if (!pAsset->succeeded)
+			Log::Write(Log::Severity::Warning, Log::Category::Assets, "Couldn't decode %s", pAsset->path.c_str());
+	}
+	if (!pAsset->succeeded)
+		pAsset->data.clear();
+
+	{
+		std::lock_guard<std::mutex> lock(readyMutex);
+		ready.push_back(pAsset);
+	}
+	inFlight--;
+	decoding--;
+}
+
+
+// --------------------------------------------------------
+// Squared, which sorts the same
+// --------------------------------------------------------
+float AssetStreamer::DistanceFromView(const float pPosition[3])
+{
+	float distance = 0;
+	for (int i = 0; i < 3; i++)
+		distance += (pPosition[i] - viewPosition[i]) * (pPosition[i] - viewPosition[i]);
+	return distance;
+}
+
+// Heap and sort order: nearest last
+bool AssetStreamer::IsFurther(const std::shared_ptr<Asset>& pA, const std::shared_ptr<Asset>& pB)
+{
+	return pA->distance > pB->distance;
+}
+
+// Getters
+AssetStreamer::Stats AssetStreamer::GetStats()
+{
+	Stats stats = {};
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		stats.queued = (unsigned int)queue.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(readyMutex);
+		stats.ready = (unsigned int)ready.size();
+	}
+	stats.decoding = decoding.load(std::memory_order_relaxed);
+	stats.completed = completed;
+	stats.failed = failed;
+	stats.bytesRead = bytesRead.load(std::memory_order_relaxed);
+	stats.uploadedLastFrame = uploadedLastFrame;
+	stats.uploadBytesPerFrame = uploadBytesPerFrame;
+	stats.bufferedBytes = bufferedBytes.load(std::memory_order_relaxed);
+	stats.ioRing = ring != nullptr;
+	stats.unbufferedReads = unbufferedReads.load(std::memory_order_relaxed);
+	return stats;
+}
+
+// Setters
+void AssetStreamer::SetUploadBytesPerFrame(size_t pBytes) { uploadBytesPerFrame = pBytes; }
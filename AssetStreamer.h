@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// See AssetStreamer.cpp for usage details
+
+class IORing;
+
+// --------------------------------------------------------
+// Sector-aligned memory, which unbuffered reads need.
+// Over-allocates through plain new, so it's still counted
+// and tracked, and keeps that pointer just before the
+// aligned block
+// --------------------------------------------------------
+template<class T>
+class SectorAllocator
+{
+public:
+	using value_type = T;
+	static const size_t SectorSize = 4096;
+
+	SectorAllocator() {}
+	template<class U> SectorAllocator(const SectorAllocator<U>&) {}
+
+	T* allocate(size_t pCount)
+	{
+		unsigned char* block = (unsigned char*)::operator new(pCount * sizeof(T) + SectorSize);
+		unsigned char* aligned = block + SectorSize - (size_t)block % SectorSize;
+		((void**)aligned)[-1] = block;
+		return (T*)aligned;
+	}
+	void deallocate(T* pPointer, size_t) { ::operator delete(((void**)pPointer)[-1]); }
+
+	template<class U> bool operator==(const SectorAllocator<U>&) const { return true; }
+	template<class U> bool operator!=(const SectorAllocator<U>&) const { return false; }
+};
+
+class AssetStreamer
+{
+public:
+	// What files are read into
+	using Buffer = std::vector<unsigned char, SectorAllocator<unsigned char>>;
+
+	// Turns the file's bytes into whatever the upload needs, in
+	// place.  Runs as a JobSystem job.  Returning false fails
+	// the asset
+	using DecodeFunction = std::function<bool(Buffer& data)>;
+
+	// Hands a decoded asset over, on the main thread.  The data
+	// is empty if it couldn't be read or decoded
+	using UploadFunction = std::function<void(unsigned int asset, Buffer& data, bool succeeded)>;
+
+	// Right now, and totals since the streamer was created
+	struct Stats
+	{
+		unsigned int queued;			// Waiting for the IO thread
+		unsigned int decoding;
+		unsigned int ready;				// Waiting for an upload slot
+		unsigned int completed;
+		unsigned int failed;
+		unsigned long long bytesRead;
+		size_t uploadedLastFrame;		// Bytes
+		size_t uploadBytesPerFrame;
+		size_t bufferedBytes;			// Read but not uploaded yet
+		bool ioRing;					// Reading through io_uring
+		unsigned int unbufferedReads;	// Files read past the OS cache
+	};
+
+	AssetStreamer(size_t pUploadBytesPerFrame, size_t pMaxBufferedBytes = 256 * 1024 * 1024, size_t pChunkSize = 1024 * 1024, bool pUseIORing = true);
+	~AssetStreamer();
+
+	unsigned int Request(const std::string& pPath, const float pPosition[3], const DecodeFunction& pDecode, const UploadFunction& pUpload);
+	void SetViewPosition(const float pPosition[3]);
+	void Update();
+	void WaitIdle();
+
+	// Getters
+	Stats GetStats();
+
+	// Setters
+	void SetUploadBytesPerFrame(size_t pBytes);
+
+private:
+	struct Asset
+	{
+		unsigned int id;
+		std::string path;
+		float position[3];
+		float distance;					// From the view, squared
+		DecodeFunction decode;
+		UploadFunction upload;
+		Buffer data;
+		size_t readBytes;				// Before decoding, which may resize data
+		bool succeeded;
+	};
+
+	void IOLoop();
+	bool ReadFile(const std::string& pPath, Buffer& pData);
+	bool ReadFileWithRing(const std::string& pPath, Buffer& pData);
+	void Decode(std::shared_ptr<Asset> pAsset);
+	float DistanceFromView(const float pPosition[3]);
+	static bool IsFurther(const std::shared_ptr<Asset>& pA, const std::shared_ptr<Asset>& pB);
+
+	size_t chunkSize;
+	size_t uploadBytesPerFrame;
+	size_t maxBufferedBytes;
+	unsigned int nextId;
+
+	// Only used on the IO thread.  Null where io_uring isn't
+	std::shared_ptr<IORing> ring;
+
+	// Requests waiting to be read, a heap with the nearest on top
+	std::vector<std::shared_ptr<Asset>> queue;
+	float viewPosition[3];
+	std::mutex queueMutex;
+	std::condition_variable queueChanged;
+	bool quitting;
+	std::thread ioThread;
+
+	// Decoded and waiting for the main thread
+	std::vector<std::shared_ptr<Asset>> ready;
+	std::mutex readyMutex;
+
+	// Read but not yet in ready, so WaitIdle() knows what's left
+	std::atomic<unsigned int> inFlight;
+	std::atomic<unsigned int> decoding;
+	std::atomic<unsigned long long> bytesRead;
+	std::atomic<size_t> bufferedBytes;
+	std::atomic<unsigned int> unbufferedReads;
+	unsigned int completed;
+	unsigned int failed;
+	size_t uploadedLastFrame;
+};
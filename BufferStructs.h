@@ -2,10 +2,17 @@
 
 #include <DirectXMath.h>
 
+// Copied straight into cbuffer ExternalData (VertexShader.hlsl), so the
+// offsets have to match; shader reflection checks them on load
 struct VertexShaderData
 {
-	DirectX::XMFLOAT4 ColorTint;
+	DirectX::XMFLOAT4X4 ViewProjectionMatrix;	// Camera's cached view * proj, once per view
+};
+
+// One per object, all of them uploaded once per frame and read as
+// per-instance vertex data (the WORLD and TINT inputs)
+struct InstanceData
+{
 	DirectX::XMFLOAT4X4 WorldMatrix;
-	DirectX::XMFLOAT4X4 ViewMatrix;
-	DirectX::XMFLOAT4X4 ProjectionMatrix;
+	DirectX::XMFLOAT4 ColorTint;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Camera.h"
 #include "Input.h"
 #include <algorithm>	// For clamp method
+#include <cmath>
 
 using namespace DirectX;	// for overload operators
 
@@ -12,14 +13,18 @@ Camera::Camera(float xPos, float yPos, float zPos,
 {
 	// Initialize variables
 	transform = Transform(xPos, yPos, zPos);
+	aspectRatio = pAspectRatio;
 	fovAngle = pFovAngle;
+	orthographicWidth = 10.0f;
 	nearClipDist = pNearClip;
 	farClipDist = pFarClip;
 	movementSpeed = pMoveSpeed;
 	mouseLookSpeed = pLookSpeed;
 	isPerspective = pIsPerspective;
+	isReversedZ = false;
 
-	// Matrix creation
+	// Matrix creation (the view matrix update also reads the projection)
+	XMStoreFloat4x4(&projMatrix, XMMatrixIdentity());
 	UpdateViewMatrix();
 	UpdateProjectionMatrix(pAspectRatio);
 }
@@ -43,22 +48,61 @@ void Camera::UpdateViewMatrix()
 
 	// Back to storage
 	XMStoreFloat4x4(&viewMatrix, viewMat);
+	UpdateViewProjectionMatrix();
+	tracker.ViewUpdated(GetPose());
 }
 
 void Camera::UpdateProjectionMatrix(float pAspectRatio)
 {
-	if (isPerspective)
+	aspectRatio = pAspectRatio;
+
+	XMMATRIX projMat;
+	if (isPerspective && isReversedZ)
+	{
+		// Reversed infinite far plane: depth = near / z, so 1 at the near
+		// plane and approaching 0 at infinity, which spreads float depth
+		// precision evenly instead of bunching it up near the camera
+		float yScale = 1.0f / tanf(fovAngle * 0.5f);
+		projMat = XMMatrixSet(
+			yScale / aspectRatio, 0.0f, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f,
+			0.0f, 0.0f, nearClipDist, 0.0f);
+	}
+	else if (isPerspective)
 	{
 		// Create new projection matrix
-		XMMATRIX projMat = XMMatrixPerspectiveFovLH(fovAngle, pAspectRatio, nearClipDist, farClipDist);
-
-		// Store the new matrix
-		XMStoreFloat4x4(&projMatrix, projMat);
+		projMat = XMMatrixPerspectiveFovLH(fovAngle, aspectRatio, nearClipDist, farClipDist);
 	}
 	else
 	{
-		// Orthographic view not yet implemented
+		// Orthographic, with the near and far planes swapped for reversed Z
+		float height = orthographicWidth / aspectRatio;
+		if (isReversedZ)
+			projMat = XMMatrixOrthographicLH(orthographicWidth, height, farClipDist, nearClipDist);
+		else
+			projMat = XMMatrixOrthographicLH(orthographicWidth, height, nearClipDist, farClipDist);
 	}
+
+	// Store the new matrix
+	XMStoreFloat4x4(&projMatrix, projMat);
+	UpdateViewProjectionMatrix();
+}
+
+// Caches the combined matrix (and its inverse), so draws only need world * viewProj
+void Camera::UpdateViewProjectionMatrix()
+{
+	XMMATRIX viewProjMat = XMMatrixMultiply(XMLoadFloat4x4(&viewMatrix), XMLoadFloat4x4(&projMatrix));
+	XMStoreFloat4x4(&viewProjMatrix, viewProjMat);
+	XMStoreFloat4x4(&invViewProjMatrix, XMMatrixInverse(0, viewProjMat));
+	tracker.MatricesChanged();
+}
+
+CameraTracker::Pose Camera::GetPose()
+{
+	XMFLOAT3 position = transform.GetPosition();
+	XMFLOAT3 rotation = transform.GetPitchYawRoll();
+	return { { position.x, position.y, position.z }, { rotation.x, rotation.y, rotation.z } };
 }
 
 void Camera::Update(float deltaTime)
@@ -87,8 +131,9 @@ void Camera::Update(float deltaTime)
 		transform.SetRotation(rotation);
 	}
 
-	// Update view matrix
-	UpdateViewMatrix();
+	// Update view matrix, only if something changed
+	if (tracker.NeedsViewUpdate(GetPose()))
+		UpdateViewMatrix();
 }
 
 DirectX::XMFLOAT4X4 Camera::GetViewMatrix()
@@ -99,11 +144,86 @@ DirectX::XMFLOAT4X4 Camera::GetProjectionMatrix()
 {
 	return projMatrix;
 }
+DirectX::XMFLOAT4X4 Camera::GetViewProjectionMatrix()
+{
+	return viewProjMatrix;
+}
+DirectX::XMFLOAT4X4 Camera::GetInverseViewProjectionMatrix()
+{
+	return invViewProjMatrix;
+}
 DirectX::XMFLOAT3 Camera::GetPosition()
 {
 	return transform.GetPosition();
 }
+DirectX::XMFLOAT3 Camera::GetRotation()
+{
+	return transform.GetPitchYawRoll();
+}
 float Camera::GetFov()
 {
 	return fovAngle;
+}
+float Camera::GetNearClip()
+{
+	return nearClipDist;
+}
+float Camera::GetFarClip()
+{
+	return farClipDist;
+}
+float Camera::GetMovementSpeed()
+{
+	return movementSpeed;
+}
+float Camera::GetLookSpeed()
+{
+	return mouseLookSpeed;
+}
+float Camera::GetOrthographicWidth()
+{
+	return orthographicWidth;
+}
+bool Camera::IsPerspective()
+{
+	return isPerspective;
+}
+bool Camera::IsReversedZ()
+{
+	return isReversedZ;
+}
+unsigned long long Camera::GetVersion()
+{
+	return tracker.GetVersion();
+}
+unsigned int Camera::GetViewUpdateCount()
+{
+	return tracker.GetViewUpdateCount();
+}
+
+void Camera::SetPosition(DirectX::XMFLOAT3 pPosition)
+{
+	// Picked up by the next Update()
+	transform.SetPosition(pPosition);
+	tracker.MarkViewDirty();
+}
+void Camera::SetRotation(DirectX::XMFLOAT3 pPitchYawRoll)
+{
+	transform.SetRotation(pPitchYawRoll);
+	tracker.MarkViewDirty();
+}
+void Camera::SetPerspective(bool pIsPerspective)
+{
+	isPerspective = pIsPerspective;
+	UpdateProjectionMatrix(aspectRatio);
+}
+void Camera::SetOrthographicWidth(float pOrthographicWidth)
+{
+	orthographicWidth = pOrthographicWidth;
+	UpdateProjectionMatrix(aspectRatio);
+}
+void Camera::SetReversedZ(bool pIsReversedZ)
+{
+	isReversedZ = pIsReversedZ;
+	UpdateProjectionMatrix(aspectRatio);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <DirectXMath.h>
 #include "Transform.h"
+#include "CameraTracker.h"
 
 class Camera
 {
@@ -20,17 +21,48 @@ public:
 	// Getters
 	DirectX::XMFLOAT4X4 GetViewMatrix();
 	DirectX::XMFLOAT4X4 GetProjectionMatrix();
+	DirectX::XMFLOAT4X4 GetViewProjectionMatrix();
+	DirectX::XMFLOAT4X4 GetInverseViewProjectionMatrix();
 	DirectX::XMFLOAT3 GetPosition();
+	DirectX::XMFLOAT3 GetRotation();
 	float GetFov();
+	float GetNearClip();
+	float GetFarClip();
+	float GetMovementSpeed();
+	float GetLookSpeed();
+	float GetOrthographicWidth();
+	bool IsPerspective();
+	bool IsReversedZ();
+	unsigned long long GetVersion();
+	unsigned int GetViewUpdateCount();
+
+	// Setters
+	void SetPosition(DirectX::XMFLOAT3 pPosition);
+	void SetRotation(DirectX::XMFLOAT3 pPitchYawRoll);
+	void SetPerspective(bool pIsPerspective);
+	void SetOrthographicWidth(float pOrthographicWidth);
+	void SetReversedZ(bool pIsReversedZ);
 
 private:
+	void UpdateViewProjectionMatrix();
+	CameraTracker::Pose GetPose();
+
 	DirectX::XMFLOAT4X4 viewMatrix;
 	DirectX::XMFLOAT4X4 projMatrix;
+	DirectX::XMFLOAT4X4 viewProjMatrix;		// view * proj, updated with either
+	DirectX::XMFLOAT4X4 invViewProjMatrix;	// For picking: NDC back to world space
 	Transform transform;
+	float aspectRatio;
 	float fovAngle;	// radians
+	float orthographicWidth;	// World units across the view
 	float nearClipDist;
 	float farClipDist;
 	float movementSpeed;
 	float mouseLookSpeed;
 	bool isPerspective;
+	bool isReversedZ;	// Depth 1 at the near plane, 0 at the far plane (or infinity)
+
+	// The view matrix is only rebuilt when the camera actually moved,
+	// and the version goes up whenever either matrix changes
+	CameraTracker tracker;
 };
\ No newline at end of file
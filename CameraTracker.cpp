@@ -0,0 +1,82 @@
+#include "CameraTracker.h"
+
+// --------------- Basic usage -----------------
+//
+// Camera keeps one of these so that frames where it
+// doesn't move cost nothing.  Each update, after input
+// has moved the transform:
+//
+//   if (tracker.NeedsViewUpdate(pose))
+//   {
+//       // Rebuild the view matrix from the pose
+//       tracker.ViewUpdated(pose);
+//   }
+//
+// and MatricesChanged() whenever the view or projection
+// matrix actually changes.  The version only ever goes
+// up, so anything derived from the camera (constant
+// buffers, frustum planes, culling results) can keep the
+// version it was built with and skip its work while it
+// still matches.
+//
+// The view is rebuilt when the pose differs from the one
+// it was last built from, or after MarkViewDirty().
+// Nothing here depends on DirectXMath or Input, which
+// keeps it testable anywhere.
+// ---------------------------------------------
+
+CameraTracker::CameraTracker() :
+	viewPose(),
+	viewDirty(true),
+	version(0),
+	viewUpdateCount(0)
+{
+}
+
+
+// --------------------------------------------------------
+// Whether the view matrix is out of date for this pose
+// --------------------------------------------------------
+bool CameraTracker::NeedsViewUpdate(const Pose& pPose) const
+{
+	return viewDirty || !(pPose == viewPose);
+}
+
+
+// --------------------------------------------------------
+// Records that the view matrix was just built from pPose
+// --------------------------------------------------------
+void CameraTracker::ViewUpdated(const Pose& pPose)
+{
+	viewPose = pPose;
+	viewDirty = false;
+	viewUpdateCount++;
+}
+
+
+void CameraTracker::MatricesChanged()
+{
+	version++;
+}
+
+
+// --------------------------------------------------------
+// Forces a rebuild on the next update, even if the pose
+// ends up where it was
+// --------------------------------------------------------
+void CameraTracker::MarkViewDirty()
+{
+	viewDirty = true;
+}
+
+
+unsigned long long CameraTracker::GetVersion() const
+{
+	return version;
+}
+
+
+unsigned int CameraTracker::GetViewUpdateCount() const
+{
+	return viewUpdateCount;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// See CameraTracker.cpp for usage details
+
+// Decides when a camera's view matrix needs rebuilding, and
+// versions its matrices, without needing DirectXMath
+class CameraTracker
+{
+public:
+	// Where the camera is and which way it faces
+	struct Pose
+	{
+		float position[3];
+		float pitchYawRoll[3];
+
+		bool operator==(const Pose& pOther) const = default;
+	};
+
+	CameraTracker();
+
+	bool NeedsViewUpdate(const Pose& pPose) const;
+	void ViewUpdated(const Pose& pPose);
+	void MatricesChanged();
+	void MarkViewDirty();
+
+	// Getters
+	unsigned long long GetVersion() const;
+	unsigned int GetViewUpdateCount() const;
+
+private:
+	Pose viewPose;		// Where the view matrix was last built from
+	bool viewDirty;
+	unsigned long long version;
+	unsigned int viewUpdateCount;
+};
@@ -0,0 +1,322 @@
+#include "D3D11Backend.h"
+#include "Graphics.h"
+#include "JobSystem.h"
+
+#include <cstring>
+
+// --------------- Basic usage -----------------
+//
+// Executes command lists on Graphics::Context.
+// Register resources once, with the ids the
+// recording code will use:
+//
+//   backend.RegisterShaders(0, vertexShader, pixelShader, inputLayout);
+//   backend.RegisterMesh(handle.GetIndex(), mesh->GetVertexBuffer(), mesh->GetIndexBuffer(), sizeof(Vertex));
+//   backend.RegisterConstantBuffer(0, constBuffer);
+//
+// Mesh ids are MeshManager slot indices, which stay small
+// and are reused, so the table never grows past the
+// manager's capacity.  When the manager destroys a mesh,
+// unregister its slot so its buffers aren't kept alive:
+//
+//   if (meshManager->Release(handle))
+//       backend.UnregisterMesh(handle.GetIndex());
+//
+// A DynamicMesh draws from a different copy in its buffer
+// after each upload, so it's registered again every frame
+// with that copy's offset, in a slot the manager doesn't use:
+//
+//   backend.RegisterMesh(slot, dynamic->GetVertexBuffer(), dynamic->GetIndexBuffer(), sizeof(Vertex), dynamic->GetVertexOffset());
+//
+// Then every frame:
+//
+//   backend.Execute(commands);
+//
+// Or, for lists recorded in parallel (see ParallelRecorder):
+//
+//   backend.ExecuteParallel(lists);
+//
+// which translates each list on its own deferred context
+// on the JobSystem, then runs them in order on the
+// immediate context.
+//
+// ClearTargets clears the back buffer and depth buffer.
+// UpdateConstants maps the buffer registered for that
+// slot with WRITE_DISCARD and copies the data in; binding
+// the buffer to the pipeline is still up to the caller.
+// UpdateInstances copies into a dynamic vertex buffer
+// the backend owns and binds it to input slot 1, so input
+// layouts read it there as per-instance data (see Game's
+// InstanceFormat).  Record it in the list executed first:
+// parallel lists get the buffer bound like the constant
+// buffers, and read whatever it held when they ran.
+// Commands referring to unregistered ids are skipped.
+// ---------------------------------------------
+
+D3D11Backend::D3D11Backend() :
+	instanceCapacity(0),
+	instanceStride(0)
+{
+}
+
+D3D11Backend::~D3D11Backend()
+{
+}
+
+
+// --------------------------------------------------------
+// Resource registration
+// --------------------------------------------------------
+void D3D11Backend::RegisterShaders(unsigned int pShader,
+	Microsoft::WRL::ComPtr<ID3D11VertexShader> pVertexShader,
+	Microsoft::WRL::ComPtr<ID3D11PixelShader> pPixelShader,
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout)
+{
+	if (pShader >= shaders.size())
+		shaders.resize(pShader + 1);
+	shaders[pShader] = { pVertexShader, pPixelShader, pInputLayout };
+}
+
+void D3D11Backend::RegisterMesh(unsigned int pMesh,
+	Microsoft::WRL::ComPtr<ID3D11Buffer> pVertexBuffer,
+	Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer,
+	unsigned int pVertexStride,
+	unsigned int pVertexOffset)
+{
+	if (pMesh >= meshes.size())
+		meshes.resize(pMesh + 1);
+	meshes[pMesh] = { pVertexBuffer, pIndexBuffer, pVertexStride, pVertexOffset };
+}
+
+void D3D11Backend::UnregisterMesh(unsigned int pMesh)
+{
+	if (pMesh < meshes.size())
+		meshes[pMesh] = {};
+}
+
+void D3D11Backend::RegisterConstantBuffer(unsigned int pSlot, Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer)
+{
+	if (pSlot >= constantBuffers.size())
+		constantBuffers.resize(pSlot + 1);
+
+	D3D11_BUFFER_DESC desc = {};
+	pBuffer->GetDesc(&desc);
+	constantBuffers[pSlot] = { pBuffer, desc.ByteWidth };
+}
+
+
+// --------------------------------------------------------
+// Translates each command into immediate context calls
+// --------------------------------------------------------
+void D3D11Backend::Execute(const CommandList& pCommands)
+{
+	ExecuteOn(Graphics::Context.Get(), pCommands);
+}
+
+
+// --------------------------------------------------------
+// Translates each list on its own deferred context, in
+// parallel on the JobSystem, then plays the resulting
+// D3D11 command lists back in order on the immediate context
+// --------------------------------------------------------
+void D3D11Backend::ExecuteParallel(const std::vector<CommandList>& pLists)
+{
+	// Not worth the overhead for a single list
+	if (pLists.size() <= 1)
+	{
+		for (const CommandList& commands : pLists)
+			Execute(commands);
+		return;
+	}
+
+	while (deferredContexts.size() < pLists.size())
+	{
+		Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+		if (FAILED(Graphics::Device->CreateDeferredContext(0, context.GetAddressOf())))
+		{
+			for (const CommandList& commands : pLists)
+				Execute(commands);
+			return;
+		}
+		deferredContexts.push_back(context);
+	}
+	recordedLists.resize(pLists.size());
+
+	// Deferred contexts start with default state, so give each
+	// the frame state the immediate context already has
+	// (targets, viewport, depth test, constant buffers and
+	// instances)
+	UINT viewportCount = 1;
+	D3D11_VIEWPORT viewport = {};
+	Graphics::Context->RSGetViewports(&viewportCount, &viewport);
+	ID3D11RenderTargetView* renderTarget = Graphics::BackBufferRTV.Get();
+	ID3D11DepthStencilView* depthBuffer = Graphics::DepthBufferDSV.Get();
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthState;
+	UINT stencilRef = 0;
+	Graphics::Context->OMGetDepthStencilState(depthState.GetAddressOf(), &stencilRef);
+
+	JobSystem::ParallelFor((unsigned int)pLists.size(), [&](unsigned int i)
+		{
+			ID3D11DeviceContext* context = deferredContexts[i].Get();
+			context->OMSetRenderTargets(1, &renderTarget, depthBuffer);
+			context->OMSetDepthStencilState(depthState.Get(), stencilRef);
+			context->RSSetViewports(viewportCount, &viewport);
+			context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+			for (unsigned int slot = 0; slot < constantBuffers.size(); slot++)
+				if (constantBuffers[slot].buffer)
+					context->VSSetConstantBuffers(slot, 1, constantBuffers[slot].buffer.GetAddressOf());
+			if (instanceBuffer)
+			{
+				UINT instanceOffset = 0;
+				context->IASetVertexBuffers(1, 1, instanceBuffer.GetAddressOf(), &instanceStride, &instanceOffset);
+			}
+
+			ExecuteOn(context, pLists[i]);
+			context->FinishCommandList(FALSE, recordedLists[i].ReleaseAndGetAddressOf());
+		});
+
+	// Keep the immediate context's state for ImGui and the next frame
+	for (Microsoft::WRL::ComPtr<ID3D11CommandList>& recorded : recordedLists)
+	{
+		if (recorded)
+			Graphics::Context->ExecuteCommandList(recorded.Get(), TRUE);
+		recorded.Reset();
+	}
+}
+
+
+// --------------------------------------------------------
+// Translates each command into calls on the given context
+// --------------------------------------------------------
+void D3D11Backend::ExecuteOn(ID3D11DeviceContext* pContext, const CommandList& pCommands)
+{
+	size_t offset = 0;
+	CommandList::Header header;
+	const unsigned char* payload = 0;
+	while (pCommands.Next(offset, header, payload))
+	{
+		switch (header.type)
+		{
+		case RenderCommandType::ClearTargets:
+		{
+			CommandList::ClearTargetsCommand command;
+			memcpy(&command, payload, sizeof(command));
+			pContext->ClearRenderTargetView(Graphics::BackBufferRTV.Get(), command.color);
+			pContext->ClearDepthStencilView(Graphics::DepthBufferDSV.Get(), D3D11_CLEAR_DEPTH, command.depth, 0);
+			break;
+		}
+
+		case RenderCommandType::BindShaders:
+		{
+			CommandList::BindShadersCommand command;
+			memcpy(&command, payload, sizeof(command));
+			if (command.shader >= shaders.size())
+				break;
+
+			const ShaderSet& set = shaders[command.shader];
+			pContext->IASetInputLayout(set.inputLayout.Get());
+			pContext->VSSetShader(set.vertexShader.Get(), 0, 0);
+			pContext->PSSetShader(set.pixelShader.Get(), 0, 0);
+			break;
+		}
+
+		case RenderCommandType::BindMesh:
+		{
+			CommandList::BindMeshCommand command;
+			memcpy(&command, payload, sizeof(command));
+			if (command.mesh >= meshes.size() || !meshes[command.mesh].vertexBuffer)
+				break;
+
+			const MeshBuffers& mesh = meshes[command.mesh];
+			UINT stride = mesh.vertexStride;
+			UINT vertexOffset = mesh.vertexOffset;
+			pContext->IASetVertexBuffers(0, 1, mesh.vertexBuffer.GetAddressOf(), &stride, &vertexOffset);
+			pContext->IASetIndexBuffer(mesh.indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+			break;
+		}
+
+		case RenderCommandType::UpdateConstants:
+		{
+			CommandList::UpdateConstantsCommand command;
+			memcpy(&command, payload, sizeof(command));
+			if (command.slot >= constantBuffers.size() || !constantBuffers[command.slot].buffer)
+				break;
+
+			// Copy to the resource (map (lock) -> copy -> unmap (unlock))
+			ConstantBuffer& target = constantBuffers[command.slot];
+			D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
+			if (FAILED(pContext->Map(target.buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer)))
+				break;
+			memcpy(mappedBuffer.pData, payload + sizeof(command), command.size < target.size ? command.size : target.size);
+			pContext->Unmap(target.buffer.Get(), 0);
+			break;
+		}
+
+		case RenderCommandType::Draw:
+		{
+			CommandList::DrawCommand command;
+			memcpy(&command, payload, sizeof(command));
+			pContext->DrawIndexed(command.indexCount, command.startIndex, command.baseVertex);
+			break;
+		}
+
+		case RenderCommandType::DrawInstanced:
+		{
+			CommandList::DrawInstancedCommand command;
+			memcpy(&command, payload, sizeof(command));
+			pContext->DrawIndexedInstanced(command.indexCount, command.instanceCount,
+				command.startIndex, command.baseVertex, command.startInstance);
+			break;
+		}
+
+		case RenderCommandType::SetViewport:
+		{
+			CommandList::SetViewportCommand command;
+			memcpy(&command, payload, sizeof(command));
+			D3D11_VIEWPORT viewport = { command.x, command.y, command.width, command.height, 0.0f, 1.0f };
+			pContext->RSSetViewports(1, &viewport);
+			break;
+		}
+
+		case RenderCommandType::UpdateInstances:
+		{
+			CommandList::UpdateInstancesCommand command;
+			memcpy(&command, payload, sizeof(command));
+			unsigned int size = command.stride * command.count;
+			if (size == 0)
+				break;
+
+			// Grow by half again, so a slowly growing scene doesn't
+			// recreate the buffer every frame
+			if (size > instanceCapacity)
+			{
+				D3D11_BUFFER_DESC desc = {};
+				desc.ByteWidth = size + size / 2;
+				desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+				desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+				desc.Usage = D3D11_USAGE_DYNAMIC;
+				if (FAILED(Graphics::Device->CreateBuffer(&desc, 0, instanceBuffer.ReleaseAndGetAddressOf())))
+				{
+					instanceCapacity = 0;
+					break;
+				}
+				instanceCapacity = desc.ByteWidth;
+			}
+
+			D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
+			if (FAILED(pContext->Map(instanceBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer)))
+				break;
+			memcpy(mappedBuffer.pData, payload + sizeof(command), size);
+			pContext->Unmap(instanceBuffer.Get(), 0);
+
+			instanceStride = command.stride;
+			UINT instanceOffset = 0;
+			pContext->IASetVertexBuffers(1, 1, instanceBuffer.GetAddressOf(), &instanceStride, &instanceOffset);
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+}
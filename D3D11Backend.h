@@ -0,0 +1,71 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+#include "RenderCommands.h"
+
+// See D3D11Backend.cpp for usage details
+
+class D3D11Backend : public RenderBackend
+{
+public:
+	D3D11Backend();
+	~D3D11Backend();
+
+	// Resources that commands refer to by id
+	void RegisterShaders(unsigned int pShader,
+		Microsoft::WRL::ComPtr<ID3D11VertexShader> pVertexShader,
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> pPixelShader,
+		Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout);
+	void RegisterMesh(unsigned int pMesh,
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pVertexBuffer,
+		Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer,
+		unsigned int pVertexStride,
+		unsigned int pVertexOffset = 0);	// Bytes, for buffers holding several copies
+	void UnregisterMesh(unsigned int pMesh);
+	void RegisterConstantBuffer(unsigned int pSlot, Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer);
+
+	void Execute(const CommandList& pCommands) override;
+	void ExecuteParallel(const std::vector<CommandList>& pLists);
+
+private:
+	void ExecuteOn(ID3D11DeviceContext* pContext, const CommandList& pCommands);
+
+	struct ShaderSet
+	{
+		Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader;
+		Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
+		Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
+	};
+
+	struct MeshBuffers
+	{
+		Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+		Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+		unsigned int vertexStride;
+		unsigned int vertexOffset;
+	};
+
+	struct ConstantBuffer
+	{
+		Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+		unsigned int size;
+	};
+
+	// Indexed by id, so ids should be small and reused (mesh
+	// ids are MeshManager slots)
+	std::vector<ShaderSet> shaders;
+	std::vector<MeshBuffers> meshes;
+	std::vector<ConstantBuffer> constantBuffers;
+
+	// UpdateInstances' vertex buffer, bound to input slot 1 and
+	// grown (never shrunk) to fit the largest update so far
+	Microsoft::WRL::ComPtr<ID3D11Buffer> instanceBuffer;
+	unsigned int instanceCapacity;
+	unsigned int instanceStride;
+
+	// One deferred context per parallel list, reused every frame
+	std::vector<Microsoft::WRL::ComPtr<ID3D11DeviceContext>> deferredContexts;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11CommandList>> recordedLists;
+};
@@ -0,0 +1,151 @@
+#include "D3DShaderCompiler.h"
+
+#include <d3dcompiler.h>
+#include <d3d11shader.h>
+#include <wrl/client.h>
+
+#pragma comment(lib, "d3dcompiler.lib")
+
+// --------------- Basic usage -----------------
+//
+// The ShaderManager's compiler on Windows, a thin wrapper
+// around D3DCompile():
+//
+//   ShaderManager shaders(std::make_shared<D3DShaderCompiler>(), FixPath("ShaderCache"));
+//
+// Debug builds compile with debug info and without
+// optimizations (like the project's FxCompile settings),
+// release builds at optimization level 3.  Both are part
+// of GetId(), along with the compiler version, so the
+// two never share cached bytecode.  #includes are
+// resolved relative to the source file.
+//
+// Reflect() reads the vertex inputs (skipping system
+// values like SV_VertexID) and constant buffers with
+// D3DReflect().
+// ---------------------------------------------
+
+D3DShaderCompiler::D3DShaderCompiler()
+{
+#if defined(DEBUG) || defined(_DEBUG)
+	flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+	flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+}
+
+D3DShaderCompiler::~D3DShaderCompiler()
+{
+}
+
+
+// --------------------------------------------------------
+// Compiles HLSL source, returning the bytecode or the
+// compiler's messages.  Safe to call from worker threads
+// --------------------------------------------------------
+bool D3DShaderCompiler::Compile(const std::string& pSource, const std::string& pSourceName, const ShaderCache::Defines& pDefines,
+	const std::string& pEntryPoint, const std::string& pTarget,
+	std::vector<unsigned char>& pBytecode, std::string& pErrors)
+{
+	// Null terminated list of macros
+	std::vector<D3D_SHADER_MACRO> macros;
+	for (const std::pair<std::string, std::string>& define : pDefines)
+		macros.push_back({ define.first.c_str(), define.second.c_str() });
+	macros.push_back({ 0, 0 });
+
+	Microsoft::WRL::ComPtr<ID3DBlob> code;
+	Microsoft::WRL::ComPtr<ID3DBlob> errors;
+	HRESULT result = D3DCompile(pSource.data(), pSource.size(), pSourceName.c_str(), macros.data(),
+		D3D_COMPILE_STANDARD_FILE_INCLUDE, pEntryPoint.c_str(), pTarget.c_str(), flags, 0,
+		code.GetAddressOf(), errors.GetAddressOf());
+
+	pErrors.clear();
+	if (errors)
+	{
+		pErrors.assign((const char*)errors->GetBufferPointer(), errors->GetBufferSize());
+		while (!pErrors.empty() && (pErrors.back() == '\0' || pErrors.back() == '\n'))
+			pErrors.pop_back();
+	}
+	if (FAILED(result) || !code)
+	{
+		if (pErrors.empty())
+			pErrors = "D3DCompile failed";
+		pBytecode.clear();
+		return false;
+	}
+
+	const unsigned char* bytes = (const unsigned char*)code->GetBufferPointer();
+	pBytecode.assign(bytes, bytes + code->GetBufferSize());
+	return true;
+}
+
+
+
+// --------------------------------------------------------
+// Reads a shader's inputs and constant buffers.  Safe to
+// call from worker threads
+// --------------------------------------------------------
+bool D3DShaderCompiler::Reflect(const std::vector<unsigned char>& pBytecode, ShaderReflection& pReflection)
+{
+	pReflection.Clear();
+
+	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflector;
+	D3D11_SHADER_DESC shaderDesc = {};
+	if (FAILED(D3DReflect(pBytecode.data(), pBytecode.size(), IID_PPV_ARGS(reflector.GetAddressOf()))) ||
+		FAILED(reflector->GetDesc(&shaderDesc)))
+		return false;
+
+	// Inputs, with the component count from the mask (xyz is 0b0111)
+	for (unsigned int i = 0; i < shaderDesc.InputParameters; i++)
+	{
+		D3D11_SIGNATURE_PARAMETER_DESC parameter = {};
+		if (FAILED(reflector->GetInputParameterDesc(i, &parameter)))
+			return false;
+		if (parameter.SystemValueType != D3D_NAME_UNDEFINED)
+			continue;
+
+		ShaderReflection::InputElement input = {};
+		input.semanticName = parameter.SemanticName;
+		input.semanticIndex = parameter.SemanticIndex;
+		switch (parameter.ComponentType)
+		{
+		case D3D_REGISTER_COMPONENT_UINT32: input.type = ShaderReflection::ComponentType::UInt; break;
+		case D3D_REGISTER_COMPONENT_SINT32: input.type = ShaderReflection::ComponentType::SInt; break;
+		default: input.type = ShaderReflection::ComponentType::Float; break;
+		}
+		for (unsigned int mask = parameter.Mask; mask != 0; mask >>= 1)
+			input.componentCount++;
+		pReflection.AddInput(input);
+	}
+
+	// Constant buffers (not texture buffers), with the register they're bound to
+	for (unsigned int i = 0; i < shaderDesc.ConstantBuffers; i++)
+	{
+		ID3D11ShaderReflectionConstantBuffer* constantBuffer = reflector->GetConstantBufferByIndex(i);
+		D3D11_SHADER_BUFFER_DESC bufferDesc = {};
+		D3D11_SHADER_INPUT_BIND_DESC bindDesc = {};
+		if (FAILED(constantBuffer->GetDesc(&bufferDesc)))
+			return false;
+		if (bufferDesc.Type != D3D_CT_CBUFFER || FAILED(reflector->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc)))
+			continue;
+
+		ShaderReflection::ConstantBuffer buffer = {};
+		buffer.name = bufferDesc.Name;
+		buffer.slot = bindDesc.BindPoint;
+		buffer.size = bufferDesc.Size;
+		for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+		{
+			D3D11_SHADER_VARIABLE_DESC variableDesc = {};
+			if (FAILED(constantBuffer->GetVariableByIndex(v)->GetDesc(&variableDesc)))
+				return false;
+			buffer.variables.push_back({ variableDesc.Name, variableDesc.StartOffset, variableDesc.Size });
+		}
+		pReflection.AddConstantBuffer(buffer);
+	}
+	return true;
+}
+
+std::string D3DShaderCompiler::GetId()
+{
+	return "D3DCompile " + std::to_string(D3D_COMPILER_VERSION) + " flags " + std::to_string(flags);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "ShaderManager.h"
+
+// See D3DShaderCompiler.cpp for usage details
+
+class D3DShaderCompiler : public ShaderCompiler
+{
+public:
+	D3DShaderCompiler();
+	~D3DShaderCompiler();
+
+	bool Compile(const std::string& pSource, const std::string& pSourceName, const ShaderCache::Defines& pDefines,
+		const std::string& pEntryPoint, const std::string& pTarget,
+		std::vector<unsigned char>& pBytecode, std::string& pErrors) override;
+	bool Reflect(const std::vector<unsigned char>& pBytecode, ShaderReflection& pReflection) override;
+	std::string GetId() override;
+
+private:
+	unsigned int flags;
+};
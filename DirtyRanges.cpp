@@ -0,0 +1,131 @@
+#include "DirtyRanges.h"
+
+#include <algorithm>
+
+// --------------- Basic usage -----------------
+//
+// Tracks which parts of an array changed, as a few ranges
+// instead of a flag per element, so only those parts need
+// copying somewhere else (to a GPU buffer, say):
+//
+//   DirtyRanges dirty(16, 256);	// Merge across gaps of up to 16, keep 256 ranges at most
+//   dirty.Add(100, 20);			// Elements 100 to 119 changed
+//   dirty.Add(110, 30);			// Merges into 100 to 139
+//
+//   for (const DirtyRanges::Range& range : dirty.GetRanges())
+//       memcpy(destination + range.first, source + range.first, range.count * sizeof(Element));
+//   dirty.Clear();
+//
+// Ranges are kept sorted and merged as they're added:
+// overlapping or touching ranges always become one, and
+// so do ranges with at most the merge gap between them,
+// since copying a few unchanged elements is cheaper than
+// another separate copy.  Adding finds its place with a
+// binary search, so many small adds stay cheap.
+//
+// With a limit on the number of ranges, going over it
+// merges the two closest ranges, so scattered changes
+// cost a bounded number of copies (and a bounded insert)
+// at the price of copying some unchanged elements.
+//
+// Nothing here locks; see DynamicMesh for marking ranges
+// from several threads.
+// ---------------------------------------------
+
+DirtyRanges::DirtyRanges(unsigned int pMergeGap, unsigned int pMaxRanges) :
+	mergeGap(pMergeGap),
+	maxRanges(pMaxRanges)
+{
+}
+
+
+// --------------------------------------------------------
+// Marks pCount elements from pFirst, merging with any
+// range it overlaps, touches or comes within the merge
+// gap of
+// --------------------------------------------------------
+void DirtyRanges::Add(unsigned int pFirst, unsigned int pCount)
+{
+	if (pCount == 0)
+		return;
+
+	// 64 bits, so ranges near the top of the index space and
+	// a large gap can't wrap around
+	unsigned long long first = pFirst;
+	unsigned long long end = first + pCount;
+
+	// The first range that ends close enough to merge with this one
+	std::vector<Range>::iterator at = std::lower_bound(ranges.begin(), ranges.end(), first,
+		[this](const Range& range, unsigned long long value) { return (unsigned long long)range.first + range.count + mergeGap < value; });
+
+	// Swallow every range that starts close enough to its end
+	std::vector<Range>::iterator last = at;
+	while (last != ranges.end() && last->first <= end + mergeGap)
+	{
+		first = std::min(first, (unsigned long long)last->first);
+		end = std::max(end, (unsigned long long)last->first + last->count);
+		++last;
+	}
+
+	Range merged = { (unsigned int)first, (unsigned int)(end - first) };
+	if (at == last)
+		ranges.insert(at, merged);
+	else
+	{
+		*at = merged;
+		ranges.erase(at + 1, last);
+	}
+
+	if (maxRanges > 0 && ranges.size() > maxRanges)
+		MergeClosest();
+}
+
+
+// --------------------------------------------------------
+// Marks everything another set has marked
+// --------------------------------------------------------
+void DirtyRanges::Add(const DirtyRanges& pOther)
+{
+	for (const Range& range : pOther.ranges)
+		Add(range.first, range.count);
+}
+
+void DirtyRanges::Clear()
+{
+	ranges.clear();
+}
+
+
+// --------------------------------------------------------
+// Joins the two neighbouring ranges with the fewest
+// unmarked elements between them
+// --------------------------------------------------------
+void DirtyRanges::MergeClosest()
+{
+	size_t closest = 0;
+	unsigned int closestGap = ~0u;
+	for (size_t i = 0; i + 1 < ranges.size(); i++)
+	{
+		unsigned int gap = ranges[i + 1].first - (ranges[i].first + ranges[i].count);
+		if (gap < closestGap)
+		{
+			closest = i;
+			closestGap = gap;
+		}
+	}
+
+	ranges[closest].count = ranges[closest + 1].first + ranges[closest + 1].count - ranges[closest].first;
+	ranges.erase(ranges.begin() + closest + 1);
+}
+
+// Getters
+const std::vector<DirtyRanges::Range>& DirtyRanges::GetRanges() const { return ranges; }
+bool DirtyRanges::IsEmpty() const { return ranges.empty(); }
+
+unsigned int DirtyRanges::GetDirtyCount() const
+{
+	unsigned int count = 0;
+	for (const Range& range : ranges)
+		count += range.count;
+	return count;
+}
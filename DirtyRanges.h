@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+
+// See DirtyRanges.cpp for usage details
+
+// Sorted, non-overlapping ranges of elements that changed
+class DirtyRanges
+{
+public:
+	struct Range
+	{
+		unsigned int first;
+		unsigned int count;
+	};
+
+	DirtyRanges(unsigned int pMergeGap = 0, unsigned int pMaxRanges = 0);	// Zero for no limit
+
+	void Add(unsigned int pFirst, unsigned int pCount);
+	void Add(const DirtyRanges& pOther);
+	void Clear();
+
+	// Getters
+	const std::vector<Range>& GetRanges() const;
+	unsigned int GetDirtyCount() const;		// Elements covered, including merged gaps
+	bool IsEmpty() const;
+
+private:
+	void MergeClosest();
+
+	std::vector<Range> ranges;
+	unsigned int mergeGap;
+	unsigned int maxRanges;
+};
@@ -0,0 +1,232 @@
+#include "DynamicMesh.h"
+#include "MemoryTracker.h"
+
+#include <cstdint>
+#include <cstring>
+
+// --------------- Basic usage -----------------
+//
+// A mesh whose vertices can change every frame, for
+// anything procedural or deforming.  The indices (the
+// triangles) stay the same:
+//
+//   DynamicMesh wave(vertices, vertexCount, indices, indexCount, "Wave");
+//
+//   // Any thread, each writing its own vertices
+//   Vertex* vertices = wave.GetVertices();
+//   for (unsigned int i = first; i < first + count; i++)
+//       vertices[i].Position.y = height;
+//   wave.MarkDirty(first, count);
+//
+//   // Render thread, once those writes are done
+//   wave.Upload();
+//   wave.BindBuffers();		// Or register GetVertexOffset() with the backend
+//   wave.DrawIndexed();
+//
+// Vertices are written to a cache line aligned copy on
+// the CPU, and only the ranges marked dirty are copied to
+// the GPU.  Writers can work in parallel on separate
+// ranges (a job per band of a grid, say); marking takes a
+// short lock, so mark whole ranges rather than single
+// vertices.  Upload() must not overlap with writing.
+//
+// The GPU buffer is DYNAMIC and holds a copy of the
+// vertices for every frame that can be in flight, plus
+// one.  Each upload moves on to the next copy, which the
+// GPU finished with frames ago, and maps it with
+// NO_OVERWRITE, so nothing waits and the driver doesn't
+// rename the buffer (which would lose what's already in
+// it).  That copy is brought up to date by writing every
+// range that changed since it was last used, so a
+// change reaches each copy in turn.  With nothing marked,
+// Upload() keeps drawing from the current copy and
+// copies nothing.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const size_t StagingAlignment = 64;
+
+	// DXGI's own default for how many frames can be queued
+	const unsigned int DefaultFrameLatency = 3;
+
+	// Ranges with fewer unchanged vertices than this between
+	// them are uploaded as one, and there are never more
+	// copies than the limit
+	const unsigned int UploadMergeGap = 64;
+	const unsigned int MaxUploadRanges = 256;
+}
+
+
+DynamicMesh::DynamicMesh(Vertex pVertices[], size_t pVertexCount, unsigned int pIndices[], size_t pIndexCount, std::string pMeshName) :
+	vertexCount(pVertexCount),
+	indexCount(pIndexCount),
+	meshName(pMeshName),
+	staging(0),
+	dirty(UploadMergeGap, MaxUploadRanges),
+	currentCopy(0),
+	stats()
+{
+	// Enough copies that the next one is never still in use
+	// by the GPU: one more than can be queued, which is
+	// three by default (and less in latency mode)
+	unsigned int latency = Graphics::GetMaximumFrameLatency();
+	stats.copies = (latency > DefaultFrameLatency ? latency : DefaultFrameLatency) + 1;
+	stale.resize(stats.copies, DirtyRanges(UploadMergeGap, MaxUploadRanges));
+
+	// The CPU copy, aligned by hand so it's still counted by
+	// the memory tracker
+	size_t vertexBytes = sizeof(Vertex) * vertexCount;
+	{
+		MemoryTracker::Scope scope(MemoryTracker::Tag::Meshes);
+		stagingMemory.reset(new unsigned char[vertexBytes + StagingAlignment]);
+	}
+	uintptr_t aligned = ((uintptr_t)stagingMemory.get() + StagingAlignment - 1) & ~(uintptr_t)(StagingAlignment - 1);
+	staging = (Vertex*)aligned;
+	if (vertexCount > 0)
+		memcpy(staging, pVertices, vertexBytes);
+
+	// Every copy of the vertices, which the CPU can write
+	{
+		D3D11_BUFFER_DESC vbd = {};
+		vbd.Usage = D3D11_USAGE_DYNAMIC;
+		vbd.ByteWidth = static_cast<UINT>(vertexBytes * stats.copies);
+		vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		vbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		Graphics::Device->CreateBuffer(&vbd, 0, vertexBuffer.GetAddressOf());
+
+		// The first map discards, and fills them all
+		D3D11_MAPPED_SUBRESOURCE mapped = {};
+		if (vertexBuffer && SUCCEEDED(Graphics::Context->Map(vertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		{
+			for (unsigned int copy = 0; copy < stats.copies; copy++)
+				memcpy((unsigned char*)mapped.pData + vertexBytes * copy, staging, vertexBytes);
+			Graphics::Context->Unmap(vertexBuffer.Get(), 0);
+		}
+	}
+
+	// Indices never change, so they're immutable like Mesh's
+	{
+		D3D11_BUFFER_DESC ibd = {};
+		ibd.Usage = D3D11_USAGE_IMMUTABLE;
+		ibd.ByteWidth = static_cast<UINT>(sizeof(unsigned int) * indexCount);
+		ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+		D3D11_SUBRESOURCE_DATA initialIndexData = {};
+		initialIndexData.pSysMem = pIndices;
+		Graphics::Device->CreateBuffer(&ibd, &initialIndexData, indexBuffer.GetAddressOf());
+	}
+}
+
+DynamicMesh::~DynamicMesh()
+{
+}
+
+
+// --------------------------------------------------------
+// The CPU copy of the vertices, to write directly.  Mark
+// what's written with MarkDirty()
+// --------------------------------------------------------
+Vertex* DynamicMesh::GetVertices()
+{
+	return staging;
+}
+
+
+// --------------------------------------------------------
+// Marks vertices for the next Upload().  Safe from any
+// thread
+// --------------------------------------------------------
+void DynamicMesh::MarkDirty(unsigned int pFirst, unsigned int pCount)
+{
+	if (pFirst >= vertexCount)
+		return;
+	if (pCount > vertexCount - pFirst)
+		pCount = (unsigned int)(vertexCount - pFirst);
+
+	std::lock_guard<std::mutex> lock(dirtyLock);
+	dirty.Add(pFirst, pCount);
+}
+
+
+// --------------------------------------------------------
+// Copies vertices in and marks them
+// --------------------------------------------------------
+void DynamicMesh::WriteVertices(unsigned int pFirst, const Vertex pVertices[], unsigned int pCount)
+{
+	if (pFirst >= vertexCount)
+		return;
+	if (pCount > vertexCount - pFirst)
+		pCount = (unsigned int)(vertexCount - pFirst);
+
+	memcpy(staging + pFirst, pVertices, sizeof(Vertex) * pCount);
+	MarkDirty(pFirst, pCount);
+}
+
+
+// --------------------------------------------------------
+// Moves on to the next copy in the GPU buffer and brings
+// it up to date, copying only the ranges that changed
+// since it was last used
+// --------------------------------------------------------
+void DynamicMesh::Upload()
+{
+	DirtyRanges changed(UploadMergeGap, MaxUploadRanges);
+	{
+		std::lock_guard<std::mutex> lock(dirtyLock);
+		std::swap(changed, dirty);
+	}
+
+	stats.lastRanges = 0;
+	stats.lastVertices = 0;
+	if (changed.IsEmpty() || !vertexBuffer)
+		return;
+
+	// Every copy is now behind on these
+	for (DirtyRanges& copyStale : stale)
+		copyStale.Add(changed);
+
+	currentCopy = (currentCopy + 1) % stats.copies;
+	DirtyRanges& copyStale = stale[currentCopy];
+
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(Graphics::Context->Map(vertexBuffer.Get(), 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped)))
+		return;
+
+	Vertex* copy = (Vertex*)((unsigned char*)mapped.pData + GetVertexOffset());
+	for (const DirtyRanges::Range& range : copyStale.GetRanges())
+		memcpy(copy + range.first, staging + range.first, sizeof(Vertex) * range.count);
+	Graphics::Context->Unmap(vertexBuffer.Get(), 0);
+
+	stats.lastRanges = (unsigned int)copyStale.GetRanges().size();
+	stats.lastVertices = copyStale.GetDirtyCount();
+	stats.uploads++;
+	stats.uploadedBytes += sizeof(Vertex) * stats.lastVertices;
+	copyStale.Clear();
+}
+
+
+// Set buffers in the input assembler (IA) stage, at this frame's copy
+void DynamicMesh::BindBuffers()
+{
+	UINT stride = sizeof(Vertex);
+	UINT offset = GetVertexOffset();
+	Graphics::Context->IASetVertexBuffers(0, 1, vertexBuffer.GetAddressOf(), &stride, &offset);
+	Graphics::Context->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+}
+
+// Draw with whatever buffers are currently bound
+void DynamicMesh::DrawIndexed()
+{
+	Graphics::Context->DrawIndexed(static_cast<UINT>(indexCount), 0, 0);
+}
+
+// Getters
+Microsoft::WRL::ComPtr<ID3D11Buffer> DynamicMesh::GetVertexBuffer() { return vertexBuffer; }
+Microsoft::WRL::ComPtr<ID3D11Buffer> DynamicMesh::GetIndexBuffer() { return indexBuffer; }
+unsigned int DynamicMesh::GetVertexOffset() { return (unsigned int)(sizeof(Vertex) * vertexCount * currentCopy); }
+size_t DynamicMesh::GetVertexCount() { return vertexCount; }
+size_t DynamicMesh::GetIndexCount() { return indexCount; }
+const std::string& DynamicMesh::GetName() { return meshName; }
+DynamicMesh::Stats DynamicMesh::GetStats() { return stats; }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DirtyRanges.h"
+#include "Graphics.h"
+#include "Vertex.h"
+
+// See DynamicMesh.cpp for usage details
+
+class DynamicMesh
+{
+public:
+	// The last upload, and totals since the mesh was created
+	struct Stats
+	{
+		unsigned int copies;				// Of the vertices in the GPU buffer
+		unsigned int lastRanges;
+		unsigned int lastVertices;
+		unsigned long long uploads;			// Upload() calls that copied anything
+		unsigned long long uploadedBytes;
+	};
+
+	DynamicMesh(Vertex pVertices[], size_t pVertexCount, unsigned int pIndices[], size_t pIndexCount, std::string pMeshName);
+	~DynamicMesh();
+
+	DynamicMesh(const DynamicMesh&) = delete;
+	DynamicMesh& operator=(const DynamicMesh&) = delete;
+
+	// Any thread, for vertices no other thread is writing
+	Vertex* GetVertices();
+	void MarkDirty(unsigned int pFirst, unsigned int pCount);
+	void WriteVertices(unsigned int pFirst, const Vertex pVertices[], unsigned int pCount);
+
+	// Render thread, once a frame, after writing
+	void Upload();
+
+	Microsoft::WRL::ComPtr<ID3D11Buffer> GetVertexBuffer();
+	Microsoft::WRL::ComPtr<ID3D11Buffer> GetIndexBuffer();
+	unsigned int GetVertexOffset();		// Bytes, to this frame's copy
+
+	size_t GetVertexCount();
+	size_t GetIndexCount();
+	const std::string& GetName();
+	Stats GetStats();
+
+	void BindBuffers();
+	void DrawIndexed();
+
+private:
+	// Every vertex once per copy, and the indices, which don't change
+	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
+
+	size_t vertexCount;
+	size_t indexCount;
+	std::string meshName;
+
+	// Where vertices are written, cache line aligned
+	// within a tracked allocation
+	std::unique_ptr<unsigned char[]> stagingMemory;
+	Vertex* staging;
+
+	// Marked since the last upload, by any thread
+	std::mutex dirtyLock;
+	DirtyRanges dirty;
+
+	// Per copy, what changed since that copy was last written
+	std::vector<DirtyRanges> stale;
+	unsigned int currentCopy;
+
+	Stats stats;
+};
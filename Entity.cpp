@@ -1,26 +1,40 @@
 #include "Entity.h"
 
-Entity::Entity(std::shared_ptr<Mesh> pMesh)
+Entity::Entity(MeshHandle pMesh)
 {
-	meshPtr = pMesh;
+	mesh = pMesh;
+	isOccluder = false;
 }
 
-Entity::~Entity()
+Entity::Entity(MeshHandle pMesh, const std::shared_ptr<TransformPool>& pTransforms, unsigned int pTransformIndex, bool pIsOccluder) :
+	transform(pTransforms, pTransformIndex),
+	mesh(pMesh),
+	isOccluder(pIsOccluder)
 {
 }
 
-void Entity::Draw(float deltaTime, float totalTime)
+Entity::~Entity()
 {
-	meshPtr->Draw(deltaTime, totalTime);
 }
 
 // Getters
-std::shared_ptr<Mesh> Entity::GetMesh()
+MeshHandle Entity::GetMesh()
 {
-	return meshPtr;
+	return mesh;
 }
 
 Transform& Entity::GetTransform()
 {
 	return transform;
 }
+
+bool Entity::IsOccluder()
+{
+	return isOccluder;
+}
+
+// Setters
+void Entity::SetOccluder(bool pIsOccluder)
+{
+	isOccluder = pIsOccluder;
+}
@@ -1,21 +1,24 @@
 #pragma once
 
-#include <memory>
-#include "Mesh.h"
+#include "MeshManager.h"
 #include "Transform.h"
 
 class Entity
 {
 public:
-	Entity(std::shared_ptr<Mesh> pMesh);
+	Entity(MeshHandle pMesh);
+	Entity(MeshHandle pMesh, const std::shared_ptr<TransformPool>& pTransforms, unsigned int pTransformIndex, bool pIsOccluder);
 	~Entity();
 
-	void Draw(float deltaTime, float totalTime);
-
 	// Getters
 	Transform& GetTransform();
-	std::shared_ptr<Mesh> GetMesh();
+	MeshHandle GetMesh();
+	bool IsOccluder();
+
+	// Setters
+	void SetOccluder(bool pIsOccluder);
 private:
 	Transform transform;
-	std::shared_ptr<Mesh> meshPtr;
+	MeshHandle mesh;	// Owned by the MeshManager, which Game releases it from
+	bool isOccluder;	// Rasterized by the occlusion culler instead of tested
 };
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "FileWatcher.h"
+
+// --------------- Basic usage -----------------
+//
+// Notices when files change on disk, by polling:
+//
+//   watcher.Watch("VertexShader.hlsl");
+//
+// Then every so often (a few times a second is plenty):
+//
+//   for (const std::string& path : watcher.Poll())
+//       /* reload path */
+//
+// Poll() compares each file's last write time and size
+// against what it saw last time, and returns the paths
+// that differ.  Files that appear or disappear count as
+// changes too.  A file saved several times between polls
+// is only reported once.
+//
+// Polling is a stat per file, which is cheap for the
+// handful of files a shader folder holds, and works the
+// same on every platform (no ReadDirectoryChangesW or
+// inotify handles to manage).  Polls that find nothing
+// don't allocate.
+// ---------------------------------------------
+
+FileWatcher::FileWatcher()
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+
+// --------------------------------------------------------
+// Starts watching a file, from its current state
+// --------------------------------------------------------
+void FileWatcher::Watch(const std::string& pPath)
+{
+	for (const WatchedFile& file : files)
+	{
+		if (file.path == pPath)
+			return;
+	}
+	WatchedFile file = { pPath, std::filesystem::path(pPath), false, 0, 0 };
+	Stamp(file);
+	files.push_back(file);
+}
+
+void FileWatcher::Unwatch(const std::string& pPath)
+{
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		if (files[i].path == pPath)
+		{
+			files.erase(files.begin() + i);
+			return;
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Returns every watched file that changed since last time
+// --------------------------------------------------------
+std::vector<std::string> FileWatcher::Poll()
+{
+	std::vector<std::string> changed;
+	for (WatchedFile& file : files)
+	{
+		bool exists = file.exists;
+		long long writeTime = file.writeTime;
+		unsigned long long size = file.size;
+		Stamp(file);
+		if (file.exists != exists || file.writeTime != writeTime || file.size != size)
+			changed.push_back(file.path);
+	}
+	return changed;
+}
+
+
+// --------------------------------------------------------
+// Reads a file's write time and size, without throwing
+// --------------------------------------------------------
+void FileWatcher::Stamp(WatchedFile& pFile)
+{
+	pFile.exists = false;
+	pFile.writeTime = 0;
+	pFile.size = 0;
+
+	std::error_code error;
+	std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(pFile.nativePath, error);
+	if (error)
+		return;
+	unsigned long long size = (unsigned long long)std::filesystem::file_size(pFile.nativePath, error);
+	if (error)
+		return;
+
+	pFile.exists = true;
+	pFile.writeTime = (long long)writeTime.time_since_epoch().count();
+	pFile.size = size;
+}
+
+// Getters
+size_t FileWatcher::GetWatchCount() { return files.size(); }
+
+bool FileWatcher::Exists(const std::string& pPath)
+{
+	std::error_code error;
+	return std::filesystem::is_regular_file(pPath, error);
+}
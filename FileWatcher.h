@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// See FileWatcher.cpp for usage details
+
+class FileWatcher
+{
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	void Watch(const std::string& pPath);
+	void Unwatch(const std::string& pPath);
+	std::vector<std::string> Poll();
+
+	// Getters
+	size_t GetWatchCount();
+	static bool Exists(const std::string& pPath);
+
+private:
+	// What a file looked like the last time it was checked
+	struct WatchedFile
+	{
+		std::string path;
+		std::filesystem::path nativePath;	// Converted once, so polling doesn't allocate
+		bool exists;
+		long long writeTime;
+		unsigned long long size;
+	};
+
+	static void Stamp(WatchedFile& pFile);
+
+	std::vector<WatchedFile> files;
+};
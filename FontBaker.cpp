@@ -0,0 +1,554 @@
+#include "FontBaker.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ImGui/imgui.h"
+#include "ImGui/imgui_internal.h"
+
+// Private copy of stb_truetype for this file.  ImGui's own copy
+// is static to imgui_draw.cpp and allocates through ImGui's
+// allocator, which we can't call from worker threads.  Like
+// imgui_draw.cpp's IMGUI_STB_NAMESPACE, it lives in a namespace
+// so its stand-in rect packer types don't clash with the ones
+// imgui_internal.h declares (no packing happens here).
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+namespace FontBakerStb
+{
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "ImGui/imstb_truetype.h"
+}
+using namespace FontBakerStb;
+
+// --------------- Basic usage -----------------
+//
+// Replaces ImGui's stb_truetype font loader with one
+// that rasterizes glyphs on the JobSystem's worker
+// threads instead of stalling the frame:
+//
+//   FontBaker::Initialize(ImGui::GetIO().Fonts, FixPath("FontCache.bin"));
+//
+// Then, once per frame before ImGui::NewFrame():
+//
+//   FontBaker::Update();
+//
+// And before ImGui::DestroyContext():
+//
+//   FontBaker::ShutDown();
+//
+// When ImGui first needs a glyph, its metrics and atlas
+// rectangle are set up right away so text layout is
+// final, but the rectangle is filled with a faint
+// placeholder and the actual bitmap is queued to a
+// worker.  Update() copies finished bitmaps into the
+// atlas; ImGui then sends all of a frame's changes to
+// the renderer together.
+//
+// A few glyphs per frame are still rasterized on the
+// main thread, so the handful of glyphs needed at
+// startup don't flash as placeholders.
+//
+// Finished bitmaps are also saved to a cache file,
+// keyed by a hash of the font data and the raster size,
+// each time Update() commits the last queued glyph and
+// again on shutdown.  On the next run, cached glyphs are
+// copied into the atlas without being rasterized.
+// ---------------------------------------------
+
+namespace FontBaker
+{
+	// Annonymous namespace to hold variables
+	// only accessible in this file
+	namespace
+	{
+		const unsigned int CacheFileMagic = 0x43594C47;	// "GLYC"
+		const unsigned int CacheFileVersion = 1;
+		const size_t CacheByteLimit = 32 * 1024 * 1024;
+		const ImU32 PlaceholderColor = IM_COL32(255, 255, 255, 48);
+
+		// One for each ImFontConfig, same as ImGui's stb_truetype loader
+		struct FontSrcData
+		{
+			stbtt_fontinfo fontInfo;
+			float scaleFactor;
+			unsigned int fontHash;
+		};
+
+		// Everything that affects the rasterized bitmap of a glyph
+		struct CacheKey
+		{
+			unsigned int fontHash;
+			unsigned int fontDataSize;
+			int glyphIndex;
+			float scaleX;
+			float scaleY;
+			int oversampleH;
+			int oversampleV;
+
+			bool operator==(const CacheKey& other) const
+			{
+				return fontHash == other.fontHash && fontDataSize == other.fontDataSize && glyphIndex == other.glyphIndex &&
+					scaleX == other.scaleX && scaleY == other.scaleY && oversampleH == other.oversampleH && oversampleV == other.oversampleV;
+			}
+		};
+
+		struct CacheKeyHasher
+		{
+			size_t operator()(const CacheKey& key) const { return ImHashData(&key, sizeof(CacheKey), 0); }
+		};
+
+		struct CachedGlyph
+		{
+			int width;
+			int height;
+			std::vector<unsigned char> pixels;
+		};
+
+		// A glyph waiting on a worker thread.  The worker only
+		// reads the font and writes pixels; everything else is
+		// used on the main thread when the glyph is committed.
+		struct GlyphJob
+		{
+			const FontSrcData* fontData;
+			CacheKey key;
+			int width;
+			int height;
+			ImGuiID bakedId;
+			ImWchar codepoint;
+			ImFontAtlasRectId packId;
+			std::vector<unsigned char> pixels;
+			std::atomic<bool> cancelled{ false };
+			std::atomic<bool> done{ false };
+		};
+
+		ImFontAtlas* fontAtlas = nullptr;
+		ImFontLoader loader;
+		std::string cachePath;
+		int syncGlyphBudget = 0;
+		int syncGlyphsThisFrame = 0;
+
+		std::vector<std::shared_ptr<GlyphJob>> jobs;
+		std::unordered_map<CacheKey, CachedGlyph, CacheKeyHasher> glyphCache;
+		size_t cacheBytes = 0;
+		bool cacheDirty = false;
+		Stats stats = {};
+
+		// Shared by the main thread and the workers
+		void RasterizeGlyph(const FontSrcData* fontData, const CacheKey& key, int width, int height, unsigned char* pixels)
+		{
+			// (stb asserts if pixels are not cleared)
+			memset(pixels, 0, (size_t)width * height);
+			float subX, subY;
+			stbtt_MakeGlyphBitmapSubpixelPrefilter(&fontData->fontInfo, pixels, width, height, width,
+				key.scaleX, key.scaleY, 0, 0, key.oversampleH, key.oversampleV, &subX, &subY, key.glyphIndex);
+		}
+
+		void AddToCache(const CacheKey& key, int width, int height, const unsigned char* pixels)
+		{
+			size_t size = (size_t)width * height;
+			if (cacheBytes + size > CacheByteLimit || glyphCache.count(key) > 0)
+				return;
+
+			CachedGlyph& cached = glyphCache[key];
+			cached.width = width;
+			cached.height = height;
+			cached.pixels.assign(pixels, pixels + size);
+			cacheBytes += size;
+			cacheDirty = true;
+		}
+
+		// Cancels matching jobs. When waiting, blocks until workers are done with them,
+		// which is needed before the font data they read is freed.
+		template<typename Predicate>
+		void CancelJobs(Predicate matches, bool wait)
+		{
+			for (size_t i = 0; i < jobs.size();)
+			{
+				std::shared_ptr<GlyphJob>& job = jobs[i];
+				if (!matches(*job))
+				{
+					i++;
+					continue;
+				}
+
+				job->cancelled = true;
+				while (wait && !job->done.load(std::memory_order_acquire))
+					std::this_thread::yield();
+
+				jobs[i] = jobs.back();
+				jobs.pop_back();
+			}
+		}
+
+		// Copies a finished bitmap into the atlas, as long as the glyph it was
+		// rasterized for still exists (fonts may be discarded or rebuilt meanwhile)
+		void CommitGlyph(GlyphJob& job)
+		{
+			AddToCache(job.key, job.width, job.height, job.pixels.data());
+			stats.asyncGlyphs++;
+
+			ImFontAtlasBuilder* builder = fontAtlas->Builder;
+			if (builder == nullptr)
+				return;
+			ImFontBaked* baked = (ImFontBaked*)builder->BakedMap.GetVoidPtr(job.bakedId);
+			ImTextureRect* r = ImFontAtlasPackGetRectSafe(fontAtlas, job.packId);
+			if (baked == nullptr || r == nullptr || r->w != job.width || r->h != job.height)
+				return;
+
+			// (out of range when unused or not found, both are above Glyphs.Size)
+			if (job.codepoint >= baked->IndexLookup.Size || baked->IndexLookup[job.codepoint] >= baked->Glyphs.Size)
+				return;
+			ImFontGlyph* glyph = &baked->Glyphs[baked->IndexLookup[job.codepoint]];
+			if (glyph->PackId != job.packId)
+				return;
+
+			ImFontConfig* src = baked->OwnerFont->Sources[glyph->SourceIdx];
+			ImFontAtlasBakedSetFontGlyphBitmap(fontAtlas, baked, src, glyph, r, job.pixels.data(), ImTextureFormat_Alpha8, job.width);
+		}
+
+		void LoadCache()
+		{
+			MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+			std::ifstream file(cachePath, std::ios::binary);
+			if (!file)
+				return;
+
+			unsigned int header[3] = {};
+			file.read((char*)header, sizeof(header));
+			if (!file || header[0] != CacheFileMagic || header[1] != CacheFileVersion)
+				return;
+
+			for (unsigned int i = 0; i < header[2]; i++)
+			{
+				CacheKey key;
+				unsigned short size[2];
+				file.read((char*)&key, sizeof(CacheKey));
+				file.read((char*)size, sizeof(size));
+				if (!file || size[0] == 0 || size[1] == 0)
+					break;
+
+				CachedGlyph cached;
+				cached.width = size[0];
+				cached.height = size[1];
+				cached.pixels.resize((size_t)size[0] * size[1]);
+				file.read((char*)cached.pixels.data(), cached.pixels.size());
+				if (!file || cacheBytes + cached.pixels.size() > CacheByteLimit)
+					break;
+
+				cacheBytes += cached.pixels.size();
+				glyphCache[key] = std::move(cached);
+			}
+		}
+
+		void SaveCache()
+		{
+			if (!cacheDirty || cachePath.empty())
+				return;
+
+			std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return;
+
+			unsigned int header[3] = { CacheFileMagic, CacheFileVersion, (unsigned int)glyphCache.size() };
+			file.write((const char*)header, sizeof(header));
+			for (auto& [key, cached] : glyphCache)
+			{
+				unsigned short size[2] = { (unsigned short)cached.width, (unsigned short)cached.height };
+				file.write((const char*)&key, sizeof(CacheKey));
+				file.write((const char*)size, sizeof(size));
+				file.write((const char*)cached.pixels.data(), cached.pixels.size());
+			}
+			cacheDirty = false;
+		}
+
+		// --- ImFontLoader callbacks ---
+		// Metrics match ImGui's stb_truetype loader exactly, only the rasterization is moved
+
+		void LoaderShutdown(ImFontAtlas* atlas)
+		{
+			IM_UNUSED(atlas);
+			CancelJobs([](const GlyphJob&) { return true; }, true);
+		}
+
+		bool FontSrcInit(ImFontAtlas* atlas, ImFontConfig* src)
+		{
+			IM_UNUSED(atlas);
+
+			FontSrcData* fontData = IM_NEW(FontSrcData);
+			IM_ASSERT(src->FontLoaderData == NULL);
+
+			const int fontOffset = stbtt_GetFontOffsetForIndex((const unsigned char*)src->FontData, src->FontNo);
+			if (fontOffset < 0 || !stbtt_InitFont(&fontData->fontInfo, (const unsigned char*)src->FontData, fontOffset))
+			{
+				IM_DELETE(fontData);
+				IM_ASSERT_USER_ERROR(0, "Failed to parse FontData. It is correct and complete? Check FontDataSize and FontNo.");
+				return false;
+			}
+			fontData->fontHash = ImHashData(src->FontData, (size_t)src->FontDataSize, 0);
+			src->FontLoaderData = fontData;
+
+			const float refSize = src->DstFont->Sources[0]->SizePixels;
+			if (src->MergeMode && src->SizePixels == 0.0f)
+				src->SizePixels = refSize;
+
+			fontData->scaleFactor = stbtt_ScaleForPixelHeight(&fontData->fontInfo, 1.0f);
+			if (src->MergeMode && src->SizePixels != 0.0f && refSize != 0.0f)
+				fontData->scaleFactor *= src->SizePixels / refSize;
+			fontData->scaleFactor *= src->ExtraSizeScale;
+			return true;
+		}
+
+		void FontSrcDestroy(ImFontAtlas* atlas, ImFontConfig* src)
+		{
+			IM_UNUSED(atlas);
+			FontSrcData* fontData = (FontSrcData*)src->FontLoaderData;
+			CancelJobs([fontData](const GlyphJob& job) { return job.fontData == fontData; }, true);
+			IM_DELETE(fontData);
+			src->FontLoaderData = NULL;
+		}
+
+		bool FontSrcContainsGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImWchar codepoint)
+		{
+			IM_UNUSED(atlas);
+			FontSrcData* fontData = (FontSrcData*)src->FontLoaderData;
+			IM_ASSERT(fontData != NULL);
+			return stbtt_FindGlyphIndex(&fontData->fontInfo, (int)codepoint) != 0;
+		}
+
+		bool FontBakedInit(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void*)
+		{
+			IM_UNUSED(atlas);
+			FontSrcData* fontData = (FontSrcData*)src->FontLoaderData;
+			if (src->MergeMode == false)
+			{
+				float scaleForLayout = fontData->scaleFactor * baked->Size;
+				int unscaledAscent, unscaledDescent, unscaledLineGap;
+				stbtt_GetFontVMetrics(&fontData->fontInfo, &unscaledAscent, &unscaledDescent, &unscaledLineGap);
+				baked->Ascent = ImCeil(unscaledAscent * scaleForLayout);
+				baked->Descent = ImFloor(unscaledDescent * scaleForLayout);
+			}
+			return true;
+		}
+
+		void FontBakedDestroy(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void*)
+		{
+			IM_UNUSED(atlas);
+			// No need to wait, workers never touch the baked font
+			const FontSrcData* fontData = (const FontSrcData*)src->FontLoaderData;
+			const ImGuiID bakedId = baked->BakedId;
+			CancelJobs([fontData, bakedId](const GlyphJob& job) { return job.fontData == fontData && job.bakedId == bakedId; }, false);
+		}
+
+		bool FontBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void*, ImWchar codepoint, ImFontGlyph* outGlyph, float* outAdvanceX)
+		{
+			FontSrcData* fontData = (FontSrcData*)src->FontLoaderData;
+			IM_ASSERT(fontData);
+			int glyphIndex = stbtt_FindGlyphIndex(&fontData->fontInfo, (int)codepoint);
+			if (glyphIndex == 0)
+				return false;
+
+			// Fonts unit to pixels
+			int oversampleH, oversampleV;
+			ImFontAtlasBuildGetOversampleFactors(src, baked, &oversampleH, &oversampleV);
+			const float scaleForLayout = fontData->scaleFactor * baked->Size;
+			const float rasterizerDensity = src->RasterizerDensity * baked->RasterizerDensity;
+			const float scaleForRasterX = fontData->scaleFactor * baked->Size * rasterizerDensity * oversampleH;
+			const float scaleForRasterY = fontData->scaleFactor * baked->Size * rasterizerDensity * oversampleV;
+
+			// Obtain size and advance
+			int x0, y0, x1, y1;
+			int advance, lsb;
+			stbtt_GetGlyphBitmapBoxSubpixel(&fontData->fontInfo, glyphIndex, scaleForRasterX, scaleForRasterY, 0, 0, &x0, &y0, &x1, &y1);
+			stbtt_GetGlyphHMetrics(&fontData->fontInfo, glyphIndex, &advance, &lsb);
+
+			// Load metrics only mode
+			if (outAdvanceX != NULL)
+			{
+				IM_ASSERT(outGlyph == NULL);
+				*outAdvanceX = advance * scaleForLayout;
+				return true;
+			}
+
+			outGlyph->Codepoint = codepoint;
+			outGlyph->AdvanceX = advance * scaleForLayout;
+			if (x0 == x1 || y0 == y1)
+				return true;
+
+			// Pack right away, so the glyph's UVs are final even while the bitmap is pending
+			const int w = (x1 - x0 + oversampleH - 1);
+			const int h = (y1 - y0 + oversampleV - 1);
+			ImFontAtlasRectId packId = ImFontAtlasPackAddRect(atlas, w, h);
+			if (packId == ImFontAtlasRectId_Invalid)
+			{
+				IM_ASSERT(packId != ImFontAtlasRectId_Invalid && "Out of texture memory.");
+				return false;
+			}
+			ImTextureRect* r = ImFontAtlasPackGetRect(atlas, packId);
+
+			// The prefilter's sub-pixel shift only depends on the oversampling,
+			// so the glyph can be placed without rasterizing it first
+			stbtt_GetGlyphBitmapBox(&fontData->fontInfo, glyphIndex, scaleForRasterX, scaleForRasterY, &x0, &y0, &x1, &y1);
+			const float refSize = baked->OwnerFont->Sources[0]->SizePixels;
+			const float offsetsScale = (refSize != 0.0f) ? (baked->Size / refSize) : 1.0f;
+			float fontOffX = ImFloor(src->GlyphOffset.x * offsetsScale + 0.5f);
+			float fontOffY = ImFloor(src->GlyphOffset.y * offsetsScale + 0.5f);
+			fontOffX += stbtt__oversample_shift(oversampleH);
+			fontOffY += stbtt__oversample_shift(oversampleV) + IM_ROUND(baked->Ascent);
+			float recipH = 1.0f / (oversampleH * rasterizerDensity);
+			float recipV = 1.0f / (oversampleV * rasterizerDensity);
+
+			outGlyph->X0 = x0 * recipH + fontOffX;
+			outGlyph->Y0 = y0 * recipV + fontOffY;
+			outGlyph->X1 = (x0 + (int)r->w) * recipH + fontOffX;
+			outGlyph->Y1 = (y0 + (int)r->h) * recipV + fontOffY;
+			outGlyph->Visible = true;
+			outGlyph->PackId = packId;
+
+			CacheKey key = { fontData->fontHash, (unsigned int)src->FontDataSize, glyphIndex, scaleForRasterX, scaleForRasterY, oversampleH, oversampleV };
+
+			// Cached from a previous run?
+			auto cached = glyphCache.find(key);
+			if (cached != glyphCache.end() && cached->second.width == w && cached->second.height == h)
+			{
+				ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, outGlyph, r, cached->second.pixels.data(), ImTextureFormat_Alpha8, w);
+				stats.cachedGlyphs++;
+				return true;
+			}
+
+			// Still within this frame's main thread budget?
+			if (syncGlyphsThisFrame < syncGlyphBudget)
+			{
+				std::vector<unsigned char> pixels((size_t)w * h);
+				RasterizeGlyph(fontData, key, w, h, pixels.data());
+				ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, outGlyph, r, pixels.data(), ImTextureFormat_Alpha8, w);
+				AddToCache(key, w, h, pixels.data());
+				syncGlyphsThisFrame++;
+				stats.syncGlyphs++;
+				return true;
+			}
+
+			// Placeholder until a worker is done
+			ImFontAtlasTextureBlockFill(atlas->TexData, r->x, r->y, r->w, r->h, PlaceholderColor);
+			ImFontAtlasTextureBlockQueueUpload(atlas, atlas->TexData, r->x, r->y, r->w, r->h);
+
+			std::shared_ptr<GlyphJob> job = std::make_shared<GlyphJob>();
+			job->fontData = fontData;
+			job->key = key;
+			job->width = w;
+			job->height = h;
+			job->bakedId = baked->BakedId;
+			job->codepoint = codepoint;
+			job->packId = packId;
+			jobs.push_back(job);
+
+			JobSystem::Submit([job]()
+				{
+					if (!job->cancelled)
+					{
+						job->pixels.resize((size_t)job->width * job->height);
+						RasterizeGlyph(job->fontData, job->key, job->width, job->height, job->pixels.data());
+					}
+					job->done.store(true, std::memory_order_release);
+				});
+			return true;
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Loads the glyph cache and swaps the atlas over to the
+// threaded loader.  Must be called before the first frame.
+// --------------------------------------------------------
+void FontBaker::Initialize(ImFontAtlas* atlas, const std::string& cacheFilePath, int syncGlyphsPerFrame)
+{
+	fontAtlas = atlas;
+	cachePath = cacheFilePath;
+	syncGlyphBudget = syncGlyphsPerFrame;
+	LoadCache();
+
+	loader.Name = "stb_truetype (threaded)";
+	loader.LoaderShutdown = LoaderShutdown;
+	loader.FontSrcInit = FontSrcInit;
+	loader.FontSrcDestroy = FontSrcDestroy;
+	loader.FontSrcContainsGlyph = FontSrcContainsGlyph;
+	loader.FontBakedInit = FontBakedInit;
+	loader.FontBakedDestroy = FontBakedDestroy;
+	loader.FontBakedLoadGlyph = FontBakedLoadGlyph;
+	atlas->SetFontLoader(&loader);
+}
+
+
+// --------------------------------------------------------
+// Waits for outstanding glyphs and writes the cache file.
+// Call before the ImGui context (and its atlas) is destroyed.
+// --------------------------------------------------------
+void FontBaker::ShutDown()
+{
+	for (std::shared_ptr<GlyphJob>& job : jobs)
+	{
+		while (!job->done.load(std::memory_order_acquire))
+			std::this_thread::yield();
+		if (!job->cancelled)
+			AddToCache(job->key, job->width, job->height, job->pixels.data());
+	}
+	jobs.clear();
+
+	SaveCache();
+	glyphCache.clear();
+	cacheBytes = 0;
+	fontAtlas = nullptr;
+}
+
+
+// --------------------------------------------------------
+// Commits glyphs that finished since last frame and resets
+// the main thread budget.  Saves the cache once nothing is
+// left to bake.  Call before ImGui::NewFrame().
+// --------------------------------------------------------
+void FontBaker::Update()
+{
+	syncGlyphsThisFrame = 0;
+	bool baking = !jobs.empty();
+
+	for (size_t i = 0; i < jobs.size();)
+	{
+		std::shared_ptr<GlyphJob> job = jobs[i];
+		if (!job->done.load(std::memory_order_acquire))
+		{
+			i++;
+			continue;
+		}
+
+		jobs[i] = jobs.back();
+		jobs.pop_back();
+		if (!job->cancelled)
+			CommitGlyph(*job);
+	}
+
+	// So a run that never shuts down cleanly still keeps them
+	if (baking && jobs.empty())
+		SaveCache();
+}
+
+
+// Getters
+FontBaker::Stats FontBaker::GetStats()
+{
+	Stats current = stats;
+	current.pendingGlyphs = (int)jobs.size();
+	current.cacheEntries = (int)glyphCache.size();
+	current.cacheBytes = cacheBytes;
+	return current;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+struct ImFontAtlas;
+
+// See FontBaker.cpp for usage details
+
+namespace FontBaker
+{
+	// Counters shown in the Inspector
+	struct Stats
+	{
+		int pendingGlyphs;			// Queued or rasterizing on a worker thread
+		int asyncGlyphs;			// Rasterized on a worker thread
+		int syncGlyphs;				// Rasterized on the main thread (per-frame budget)
+		int cachedGlyphs;			// Copied straight from the disk cache
+		int cacheEntries;
+		size_t cacheBytes;
+	};
+
+	// General functions
+	void Initialize(ImFontAtlas* atlas, const std::string& cacheFilePath, int syncGlyphsPerFrame = 32);
+	void ShutDown();
+	void Update();
+
+	// Getters
+	Stats GetStats();
+}
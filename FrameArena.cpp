@@ -0,0 +1,210 @@
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+
+// --------------- Basic usage -----------------
+//
+// A bump allocator for data that only lives for a frame
+// or two, so building it costs no heap allocations:
+//
+//   FrameArena arena(64 * 1024);	// Per thread, after JobSystem::Initialize()
+//
+// Then at the start of every frame:
+//
+//   arena.BeginFrame();
+//
+// and anywhere during it, on the main thread or a job:
+//
+//   FrameVector<unsigned int> visible{ FrameAllocator<unsigned int>(&arena) };
+//   const char* label = arena.Format("Entity %u", i);
+//
+// Allocating just moves an offset forward, and nothing is
+// freed individually: BeginFrame() rewinds everything at
+// once.  The arena is double buffered, so memory handed
+// out during one frame stays valid through the next one
+// (while a GPU upload or a job from last frame finishes
+// with it, say), and is reused the frame after.
+//
+// Every JobSystem worker (and the main thread) bumps its
+// own sub-arena, so there's no locking.  Other threads
+// share one extra sub-arena behind a lock.
+//
+// Every sub-arena gets its first block up front.  When a
+// thread runs out of room mid-frame, its sub-arena grabs
+// another block from the heap.  The next time that
+// half is rewound, its blocks are merged into one big
+// enough for the whole frame, so the heap is only touched
+// until the busiest frame has been seen.  GetStats()
+// counts those allocations.
+//
+// BeginFrame() and GetStats() must be called between
+// frames, when no job is allocating.
+// ---------------------------------------------
+
+FrameArena::FrameArena(size_t pBytesPerThread, unsigned int pThreadCount) :
+	threadCount(pThreadCount > 0 ? pThreadCount : JobSystem::ThreadCount() + 1),
+	blockSize(pBytesPerThread > 0 ? pBytesPerThread : 1),
+	subArenas(2 * (threadCount + 1)),
+	current(0),
+	peakFrameBytes(0),
+	blockAllocations(0),
+	overflows(0),
+	frame(0)
+{
+	// Every block up front, so threads that only allocate now
+	// and then don't hit the heap in the middle of a frame
+	MemoryTracker::Scope scope(MemoryTracker::Tag::FrameArena);
+	for (SubArena& subArena : subArenas)
+	{
+		subArena.blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[blockSize]), blockSize });
+		blockAllocations++;
+		Reset(subArena);
+	}
+}
+
+FrameArena::~FrameArena()
+{
+}
+
+
+// --------------------------------------------------------
+// Flips to the other half and rewinds it.  Anything
+// allocated two frames ago is gone after this
+// --------------------------------------------------------
+void FrameArena::BeginFrame()
+{
+	size_t frameBytes = GetStats().frameBytes;
+	if (frameBytes > peakFrameBytes)
+		peakFrameBytes = frameBytes;
+
+	current = 1 - current;
+	for (unsigned int i = 0; i <= threadCount; i++)
+		Reset(subArenas[current * (threadCount + 1) + i]);
+	frame++;
+}
+
+
+// --------------------------------------------------------
+// Returns uninitialized memory that lasts until the frame
+// after next.  Safe to call from any thread
+// --------------------------------------------------------
+void* FrameArena::Allocate(size_t pSize, size_t pAlignment)
+{
+	unsigned int thread = JobSystem::ThreadIndex();
+	SubArena* half = &subArenas[current * (threadCount + 1)];
+	if (thread < threadCount)
+		return AllocateFrom(half[thread], pSize, pAlignment);
+
+	std::lock_guard<std::mutex> lock(sharedMutex);
+	return AllocateFrom(half[threadCount], pSize, pAlignment);
+}
+
+
+// --------------------------------------------------------
+// printf into the arena, for labels and other short lived
+// text
+// --------------------------------------------------------
+const char* FrameArena::Format(const char* pFormat, ...)
+{
+	va_list args;
+	va_start(args, pFormat);
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	int length = vsnprintf(0, 0, pFormat, argsCopy);
+	va_end(argsCopy);
+
+	if (length < 0)
+	{
+		va_end(args);
+		return "";
+	}
+
+	char* text = (char*)Allocate((size_t)length + 1, 1);
+	vsnprintf(text, (size_t)length + 1, pFormat, args);
+	va_end(args);
+	return text;
+}
+
+
+// --------------------------------------------------------
+// Bumps a sub-arena's offset, moving on to its next block
+// (or a new one) when this one is full
+// --------------------------------------------------------
+void* FrameArena::AllocateFrom(SubArena& pSubArena, size_t pSize, size_t pAlignment)
+{
+	while (true)
+	{
+		if (pSubArena.block < pSubArena.blocks.size())
+		{
+			Block& block = pSubArena.blocks[pSubArena.block];
+			uintptr_t start = (uintptr_t)block.memory.get() + pSubArena.offset;
+			uintptr_t aligned = (start + pAlignment - 1) & ~(uintptr_t)(pAlignment - 1);
+			size_t end = (size_t)(aligned - (uintptr_t)block.memory.get()) + pSize;
+			if (end <= block.size)
+			{
+				pSubArena.bytes += end - pSubArena.offset;
+				pSubArena.offset = end;
+				return (void*)aligned;
+			}
+
+			// Full, so try the next one
+			pSubArena.block++;
+			pSubArena.offset = 0;
+			continue;
+		}
+
+		// Out of blocks
+		MemoryTracker::Scope scope(MemoryTracker::Tag::FrameArena);
+		overflows++;
+		size_t size = pSize + pAlignment > blockSize ? pSize + pAlignment : blockSize;
+		pSubArena.blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[size]), size });
+		blockAllocations++;
+	}
+}
+
+
+// --------------------------------------------------------
+// Rewinds a sub-arena, merging its blocks into one if it
+// needed more than one last time
+// --------------------------------------------------------
+void FrameArena::Reset(SubArena& pSubArena)
+{
+	if (pSubArena.blocks.size() > 1)
+	{
+		MemoryTracker::Scope scope(MemoryTracker::Tag::FrameArena);
+		size_t total = 0;
+		for (Block& block : pSubArena.blocks)
+			total += block.size;
+		pSubArena.blocks.clear();
+		pSubArena.blocks.push_back({ std::unique_ptr<unsigned char[]>(new unsigned char[total]), total });
+		blockAllocations++;
+	}
+
+	pSubArena.block = 0;
+	pSubArena.offset = 0;
+	pSubArena.bytes = 0;
+}
+
+// Getters
+unsigned int FrameArena::GetThreadCount() { return threadCount; }
+
+FrameArena::Stats FrameArena::GetStats()
+{
+	Stats stats = {};
+	for (unsigned int i = 0; i <= threadCount; i++)
+		stats.frameBytes += subArenas[current * (threadCount + 1) + i].bytes;
+	stats.peakFrameBytes = peakFrameBytes > stats.frameBytes ? peakFrameBytes : stats.frameBytes;
+	for (const SubArena& subArena : subArenas)
+	{
+		for (const Block& block : subArena.blocks)
+			stats.capacity += block.size;
+	}
+	stats.blockAllocations = blockAllocations;
+	stats.overflows = overflows;
+	stats.frame = frame;
+	return stats;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// See FrameArena.cpp for usage details
+
+class FrameArena
+{
+public:
+	// Totals for the frame being built, and since creation
+	struct Stats
+	{
+		size_t frameBytes;				// Allocated so far this frame, every thread
+		size_t peakFrameBytes;
+		size_t capacity;				// Reserved, both frames and every thread
+		unsigned int blockAllocations;	// Heap allocations made by the arena itself
+		unsigned int overflows;			// Times a thread ran out of room mid-frame
+		unsigned long long frame;
+	};
+
+	FrameArena(size_t pBytesPerThread, unsigned int pThreadCount = 0);
+	~FrameArena();
+
+	void BeginFrame();
+	void* Allocate(size_t pSize, size_t pAlignment = alignof(std::max_align_t));
+	const char* Format(const char* pFormat, ...);
+
+	// Getters
+	Stats GetStats();
+	unsigned int GetThreadCount();
+
+private:
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> memory;
+		size_t size;
+	};
+
+	// One thread's memory for one frame.  Padded so threads
+	// bumping their own offsets don't share a cache line
+	struct alignas(64) SubArena
+	{
+		std::vector<Block> blocks;
+		size_t block;		// Being allocated from
+		size_t offset;		// Into that block
+		size_t bytes;		// This frame, including alignment
+	};
+
+	void* AllocateFrom(SubArena& pSubArena, size_t pSize, size_t pAlignment);
+	void Reset(SubArena& pSubArena);
+
+	unsigned int threadCount;
+	size_t blockSize;
+
+	// Each half has one sub-arena per thread, plus one shared by
+	// threads beyond the count (behind a lock)
+	std::vector<SubArena> subArenas;
+	std::mutex sharedMutex;
+	unsigned int current;				// Which frame's half is being allocated from
+	size_t peakFrameBytes;
+	std::atomic<unsigned int> blockAllocations;	// Bumped from any thread
+	std::atomic<unsigned int> overflows;
+	unsigned long long frame;
+};
+
+// --------------------------------------------------------
+// Lets standard containers allocate from a FrameArena.
+// Nothing is freed until the arena comes back around to
+// that frame, so only use these for per-frame data
+// --------------------------------------------------------
+template<class T>
+class FrameAllocator
+{
+public:
+	using value_type = T;
+
+	FrameAllocator(FrameArena* pArena) : arena(pArena) {}
+	template<class U> FrameAllocator(const FrameAllocator<U>& pOther) : arena(pOther.GetArena()) {}
+
+	T* allocate(size_t pCount) { return (T*)arena->Allocate(pCount * sizeof(T), alignof(T)); }
+	void deallocate(T*, size_t) {}
+
+	FrameArena* GetArena() const { return arena; }
+	template<class U> bool operator==(const FrameAllocator<U>& pOther) const { return arena == pOther.GetArena(); }
+	template<class U> bool operator!=(const FrameAllocator<U>& pOther) const { return arena != pOther.GetArena(); }
+
+private:
+	FrameArena* arena;
+};
+
+template<class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
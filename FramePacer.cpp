@@ -0,0 +1,138 @@
+#include "FramePacer.h"
+
+#include <chrono>
+#include <thread>
+
+// --------------- Basic usage -----------------
+//
+// Caps the frame rate by waiting at the start of each
+// frame until it's due:
+//
+//   FramePacer pacer;
+//   pacer.SetTargetFps(144.0);		// Zero for no limit
+//
+//   // Every frame, before sampling input
+//   pacer.WaitForNextFrame();
+//
+// Frames are due a fixed interval apart, counted from
+// the previous frame's due time rather than from when it
+// actually started, so small errors don't add up and the
+// average rate is exact.  A frame that runs a whole
+// interval late starts the schedule over instead of
+// rushing the next few to catch up.
+//
+// Waiting is a sleep then a spin.  Sleeps are cheap but
+// can wake late by a millisecond or more (much more on a
+// default Windows timer), so the pacer stops sleeping a
+// margin before the frame is due and spins on the clock
+// for the rest.  The margin learns from the sleeps: it
+// grows right away when one wakes later than the margin
+// allows for, and shrinks slowly when they're on time.
+//
+// The clock and sleep can be swapped out, so the timing
+// can be tested against a fake clock.  By default they're
+// std::chrono::steady_clock (QueryPerformanceCounter on
+// Windows) and std::this_thread::sleep_for().
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Sleeping stops this early at first, and never less
+	const unsigned long long InitialSpinMargin = 2000000;	// 2 ms
+	const unsigned long long MinSpinMargin = 200000;		// 0.2 ms
+
+	unsigned long long SteadyNow()
+	{
+		return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void ThreadSleep(unsigned long long nanoseconds)
+	{
+		std::this_thread::sleep_for(std::chrono::nanoseconds(nanoseconds));
+	}
+}
+
+
+FramePacer::FramePacer(NowFunction pNow, SleepFunction pSleep) :
+	now(pNow ? pNow : SteadyNow),
+	sleep(pSleep ? pSleep : ThreadSleep),
+	interval(0),
+	nextFrame(0),
+	spinMargin(InitialSpinMargin),
+	stats()
+{
+	stats.spinMarginMs = spinMargin / 1000000.0;
+}
+
+
+// --------------------------------------------------------
+// Sleeps, then spins, until the next frame is due.
+// Returns right away with no target set, or when the
+// frame is already late
+// --------------------------------------------------------
+void FramePacer::WaitForNextFrame()
+{
+	stats.frames++;
+	stats.lastSleepMs = 0.0;
+	stats.lastSpinMs = 0.0;
+	stats.lastLateMs = 0.0;
+	if (interval == 0)
+		return;
+
+	unsigned long long start = now();
+	if (nextFrame == 0)
+		nextFrame = start;
+
+	unsigned long long time = start;
+	if (time < nextFrame)
+	{
+		// Sleep while there's more than the margin left, and
+		// learn how late sleeps wake
+		while (time < nextFrame && nextFrame - time > spinMargin)
+		{
+			unsigned long long request = nextFrame - time - spinMargin;
+			sleep(request);
+			unsigned long long woke = now();
+			unsigned long long overshoot = woke - time > request ? woke - time - request : 0;
+			if (overshoot > spinMargin)
+				spinMargin = overshoot + overshoot / 4 < interval ? overshoot + overshoot / 4 : interval;
+			else
+				spinMargin -= (spinMargin - overshoot) / 256;
+			if (spinMargin < MinSpinMargin)
+				spinMargin = MinSpinMargin;
+			time = woke;
+		}
+		unsigned long long slept = time - start;
+
+		// Spin the rest
+		while (time < nextFrame)
+			time = now();
+		stats.lastSleepMs = slept / 1000000.0;
+		stats.lastSpinMs = (time - start - slept) / 1000000.0;
+	}
+	else if (time > nextFrame)
+		stats.missedFrames++;
+
+	unsigned long long late = time - nextFrame;
+	stats.lastLateMs = late / 1000000.0;
+	if (stats.lastLateMs > stats.maxLateMs)
+		stats.maxLateMs = stats.lastLateMs;
+	stats.spinMarginMs = spinMargin / 1000000.0;
+
+	// A fixed step from this frame's due time, unless that's
+	// already come and gone
+	nextFrame = late < interval ? nextFrame + interval : time + interval;
+}
+
+// Getters
+double FramePacer::GetTargetFps() { return interval > 0 ? 1000000000.0 / interval : 0.0; }
+FramePacer::Stats FramePacer::GetStats() { return stats; }
+
+// Setters
+void FramePacer::SetTargetFps(double pFps)
+{
+	interval = pFps > 0.0 ? (unsigned long long)(1000000000.0 / pFps) : 0;
+	nextFrame = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+
+// See FramePacer.cpp for usage details
+
+class FramePacer
+{
+public:
+	// Nanoseconds on a steady clock, and a (possibly coarse) sleep
+	using NowFunction = std::function<unsigned long long()>;
+	using SleepFunction = std::function<void(unsigned long long nanoseconds)>;
+
+	// The last frame, and totals since the pacer was created
+	struct Stats
+	{
+		unsigned long long frames;
+		double lastSleepMs;
+		double lastSpinMs;
+		double lastLateMs;				// Past the frame's start time, after waiting
+		double maxLateMs;
+		double spinMarginMs;			// How early sleeping stops
+		unsigned long long missedFrames;	// Already past the start time, so no wait
+	};
+
+	FramePacer(NowFunction pNow = NowFunction(), SleepFunction pSleep = SleepFunction());
+
+	void WaitForNextFrame();
+
+	// Getters
+	double GetTargetFps();
+	Stats GetStats();
+
+	// Setters
+	void SetTargetFps(double pFps);	// Zero for no limit
+
+private:
+	NowFunction now;
+	SleepFunction sleep;
+
+	unsigned long long interval;		// Nanoseconds, zero for no limit
+	unsigned long long nextFrame;		// When the next frame should start
+	unsigned long long spinMargin;		// Nanoseconds
+	Stats stats;
+};
@@ -5,17 +5,23 @@
 #include "PathHelpers.h"
 #include "Window.h"
 #include "BufferStructs.h"
+#include "FontBaker.h"
+#include "Log.h"
+#include "D3DShaderCompiler.h"
+#include "AllocationCounter.h"
+#include "JobSystem.h"
 
 #include <DirectXMath.h>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
 
 #include "ImGui/imgui.h"
 #include "ImGui/imgui_impl_dx11.h"
 #include "ImGui/imgui_impl_win32.h"
 
-// Needed for a helper function to load pre-compiled shader files
-#pragma comment(lib, "d3dcompiler.lib")
-#include <d3dcompiler.h>
-
 // For the DirectX Math library
 using namespace DirectX;
 
@@ -26,6 +32,89 @@ static float dragVal = 0.0;
 const int listItems[5] = { 10, 20, 30, 40, 50 };
 static float vsColorTint[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
 static float vsOffset[3] = { 0.25f, 0.0f, 0.0f };
+static bool showLogConsole = true;
+
+// Annonymous namespace to hold helpers only accessible in this file
+namespace
+{
+	// The software backend spells these out in plain floats
+	static_assert(sizeof(SoftwareBackend::InputVertex) == sizeof(Vertex) &&
+		offsetof(SoftwareBackend::InputVertex, color) == offsetof(Vertex, Color), "SoftwareBackend::InputVertex doesn't match Vertex");
+	static_assert(sizeof(SoftwareBackend::Constants) == sizeof(VertexShaderData) &&
+		offsetof(SoftwareBackend::Constants, viewProjection) == offsetof(VertexShaderData, ViewProjectionMatrix), "SoftwareBackend::Constants doesn't match VertexShaderData");
+	static_assert(sizeof(SoftwareBackend::Instance) == sizeof(InstanceData) &&
+		offsetof(SoftwareBackend::Instance, colorTint) == offsetof(InstanceData, ColorTint), "SoftwareBackend::Instance doesn't match InstanceData");
+
+	// Backend mesh ids are the mesh manager's slots, then
+	// meshes it doesn't own
+	const unsigned int MeshCapacity = 256;
+	const unsigned int WaveMeshSlot = MeshCapacity;
+
+	// The wave demo's grid, and the ripple rolling across it
+	const unsigned int WaveGridSize = 256;		// Vertices along each side
+	const float WaveGridSpacing = 0.08f;
+	const float WaveGridY = -3.0f;
+	const int WaveBandRows = 12;				// Either side of the crest
+	const float WaveHeight = 0.6f;
+	const unsigned int WaveRowsPerJob = 4;
+
+	// Our Vertex, as the shaders' input layouts see it
+	const std::vector<ShaderReflection::InputElement> VertexFormat =
+	{
+		{ "POSITION", 0, ShaderReflection::ComponentType::Float, 3, offsetof(Vertex, Position) },
+		{ "COLOR", 0, ShaderReflection::ComponentType::Float, 4, offsetof(Vertex, Color) },
+	};
+
+	// InstanceData, read from input slot 1 once per instance
+	const std::vector<ShaderReflection::InputElement> InstanceFormat =
+	{
+		{ "WORLD", 0, ShaderReflection::ComponentType::Float, 4, offsetof(InstanceData, WorldMatrix) },
+		{ "WORLD", 1, ShaderReflection::ComponentType::Float, 4, offsetof(InstanceData, WorldMatrix) + 16 },
+		{ "WORLD", 2, ShaderReflection::ComponentType::Float, 4, offsetof(InstanceData, WorldMatrix) + 32 },
+		{ "WORLD", 3, ShaderReflection::ComponentType::Float, 4, offsetof(InstanceData, WorldMatrix) + 48 },
+		{ "TINT", 0, ShaderReflection::ComponentType::Float, 4, offsetof(InstanceData, ColorTint) },
+	};
+
+	bool IsInstanceElement(const ShaderReflection::InputElement& element)
+	{
+		for (const ShaderReflection::InputElement& instanceElement : InstanceFormat)
+		{
+			if (instanceElement.semanticName == element.semanticName)
+				return true;
+		}
+		return false;
+	}
+
+	// 32 bits per component
+	DXGI_FORMAT ElementFormat(const ShaderReflection::InputElement& element)
+	{
+		const DXGI_FORMAT formats[3][4] =
+		{
+			{ DXGI_FORMAT_R32_FLOAT, DXGI_FORMAT_R32G32_FLOAT, DXGI_FORMAT_R32G32B32_FLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT },
+			{ DXGI_FORMAT_R32_UINT, DXGI_FORMAT_R32G32_UINT, DXGI_FORMAT_R32G32B32_UINT, DXGI_FORMAT_R32G32B32A32_UINT },
+			{ DXGI_FORMAT_R32_SINT, DXGI_FORMAT_R32G32_SINT, DXGI_FORMAT_R32G32B32_SINT, DXGI_FORMAT_R32G32B32A32_SINT },
+		};
+		return formats[(int)element.type][element.componentCount - 1];
+	}
+
+	// The occlusion culler keeps the nearest (smallest) depth,
+	// so reversed Z is flipped back with z' = w - z
+	XMFLOAT4X4 CullingViewProjection(Camera& camera)
+	{
+		XMFLOAT4X4 viewProj = camera.GetViewProjectionMatrix();
+		if (!camera.IsReversedZ())
+			return viewProj;
+
+		XMMATRIX flipDepth = XMMatrixSet(
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, -1.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 1.0f);
+		XMFLOAT4X4 result;
+		XMStoreFloat4x4(&result, XMMatrixMultiply(XMLoadFloat4x4(&viewProj), flipDepth));
+		return result;
+	}
+}
 
 // --------------------------------------------------------
 // The constructor is called after the window and graphics API
@@ -33,6 +122,43 @@ static float vsOffset[3] = { 0.25f, 0.0f, 0.0f };
 // --------------------------------------------------------
 Game::Game()
 {
+	// Per-frame scratch memory, one sub-arena per job thread
+	frameArena = std::make_shared<FrameArena>(64 * 1024);
+	frameAllocationStart = AllocationCounter::GetCount();
+	frameThreadAllocationStart = AllocationCounter::GetThreadCount();
+	frameAllocations = 0;
+	frameThreadAllocations = 0;
+
+	// Warn (in the log) when a subsystem grows past what it should need
+	MemoryTracker::SetBudget(MemoryTracker::Tag::ImGui, 16 * 1024 * 1024);
+	MemoryTracker::SetBudget(MemoryTracker::Tag::Meshes, 64 * 1024 * 1024);
+	MemoryTracker::SetBudget(MemoryTracker::Tag::Entities, 1024 * 1024);
+	MemoryTracker::SetBudget(MemoryTracker::Tag::Assets, 32 * 1024 * 1024);
+	MemoryTracker::SetBudget(MemoryTracker::Tag::FrameArena, 16 * 1024 * 1024);
+
+	inputWaitMs = 0.0;
+	inputToPresentMs = 0.0;
+	inputToPresentAverageMs = 0.0;
+	inputToPresentPeakMs = 0.0;
+
+	// No frame cap or latency mode to start with
+	framePacer = std::make_shared<FramePacer>();
+	latencyMode = false;
+	frameCap = 0;
+	swapChainWaitMs = 0.0;
+	sampleToPresentMs = 0.0;
+	sampleToPresentAverageMs = 0.0;
+
+	// Background loading, which only holds as much read data as
+	// the Assets budget allows, and uploads 4 MB a frame at most
+	assetStreamer = std::make_shared<AssetStreamer>(4 * 1024 * 1024, 24 * 1024 * 1024);
+
+	// The wave demo is off until it's turned on
+	waveMeshEnabled = false;
+	waveFirstRow = 0;
+	waveEndRow = 0;
+	waveWriteMs = 0.0;
+
 	// Helper methods for loading shaders, creating some basic
 	// geometry to draw and some simple camera matrices.
 	//  - You'll be expanding and/or replacing these later
@@ -64,18 +190,25 @@ Game::Game()
 	{
 		// ImGui init
 		IMGUI_CHECKVERSION();
+		ImGui::SetAllocatorFunctions(MemoryTracker::ImGuiAlloc, MemoryTracker::ImGuiFree);	// So its allocations are counted and tagged too
 		ImGui::CreateContext();
 		ImGui_ImplWin32_Init(Window::Handle());
 		ImGui_ImplDX11_Init(Graphics::Device.Get(), Graphics::Context.Get());
 
+		// Rasterize glyphs on worker threads, cached on disk between runs
+		FontBaker::Initialize(ImGui::GetIO().Fonts, FixPath("FontCache.bin"));
+
 		// Pick a style
 		ImGui::StyleColorsDark();
 		//ImGui::StyleColorsLight();
 		//ImGui::StyleColorsClassic();
 	}
 
-	// Hardcoded meshes
+	// Hardcoded meshes, owned by the mesh manager
 	{
+		MemoryTracker::Scope scope(MemoryTracker::Tag::Meshes);
+		meshManager = std::make_shared<MeshManager>(MeshCapacity);
+
 		// Create points & colors for meshes
 		XMFLOAT4 red = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
 		XMFLOAT4 green = XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f);
@@ -91,7 +224,7 @@ Game::Game()
 			{ XMFLOAT3(-0.5f, -0.5f, +0.0f), green }
 		};
 		unsigned int triangleIndices[] = { 0, 1, 2 };
-		triangleMesh = std::make_shared<Mesh>(triangleVertices, std::size(triangleVertices), triangleIndices, std::size(triangleIndices), "Triangle");
+		triangleMesh = meshManager->Load(triangleVertices, std::size(triangleVertices), triangleIndices, std::size(triangleIndices), "Triangle");
 		meshVec.push_back(triangleMesh);
 
 		// Quad mesh
@@ -110,7 +243,7 @@ Game::Game()
 			{ XMFLOAT3(-0.25f, +0.25f, +0.0f), blue }
 		};
 		unsigned int quadIndices[] = { 0, 1, 2,   0, 3, 1 };
-		quadMesh = std::make_shared<Mesh>(quadVertices, std::size(quadVertices), quadIndices, std::size(quadIndices), "Quad");
+		quadMesh = meshManager->Load(quadVertices, std::size(quadVertices), quadIndices, std::size(quadIndices), "Quad");
 		meshVec.push_back(quadMesh);
 
 		// Weird mesh
@@ -139,7 +272,7 @@ Game::Game()
 			{ XMFLOAT3(-0.125f, -0.25f, +0.0f), black }
 		};
 		unsigned int weirdIndices[] = { 0, 1, 2,   0, 3, 1,   4, 6, 5,   4, 5, 7 };
-		weirdMesh = std::make_shared<Mesh>(weirdVertices, std::size(weirdVertices), weirdIndices, std::size(weirdIndices), "The weird one");
+		weirdMesh = meshManager->Load(weirdVertices, std::size(weirdVertices), weirdIndices, std::size(weirdIndices), "The weird one");
 		meshVec.push_back(weirdMesh);
 	}
 
@@ -159,46 +292,62 @@ Game::Game()
 		Graphics::Context->VSSetConstantBuffers(0, 1, constBuffer.GetAddressOf());
 	}
 
-	// Hardcoded entities
+	// Depth test for reversed Z cameras (the default state uses LESS)
 	{
-		testEntity1 = std::make_shared<Entity>(triangleMesh);
-		testEntity1->GetTransform().Scale(0.5f);
-		entityVec.push_back(testEntity1);
-
-		testEntity2 = std::make_shared<Entity>(triangleMesh);
-		testEntity2->GetTransform().Scale(0.75f);
-		entityVec.push_back(testEntity2);
-
-		testEntity3 = std::make_shared<Entity>(quadMesh);
-		entityVec.push_back(testEntity3);
-
-		testEntity4 = std::make_shared<Entity>(quadMesh);
-		entityVec.push_back(testEntity4);
+		D3D11_DEPTH_STENCIL_DESC depthDesc = {};
+		depthDesc.DepthEnable = TRUE;
+		depthDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+		depthDesc.DepthFunc = D3D11_COMPARISON_GREATER;
+		Graphics::Device->CreateDepthStencilState(&depthDesc, reversedDepthState.GetAddressOf());
+	}
 
-		testEntity5 = std::make_shared<Entity>(weirdMesh);
-		entityVec.push_back(testEntity5);
+	// Rendering backend, with the ids the frame's commands will use
+	{
+		d3d11Backend = std::make_shared<D3D11Backend>();
+		d3d11Backend->RegisterShaders(0, vertexShader, pixelShader, inputLayout);
+		for (MeshHandle handle : meshVec)
+		{
+			Mesh* mesh = meshManager->Get(handle);
+			d3d11Backend->RegisterMesh(handle.GetIndex(), mesh->GetVertexBuffer(), mesh->GetIndexBuffer(), sizeof(Vertex));
+		}
+		d3d11Backend->RegisterConstantBuffer(0, constBuffer);
+		captureFrameCommands = false;
+		parallelRecording = false;
+		recordMs = 0.0;
+		captureSoftwareFrame = false;
 	}
 
-	// Camera setup
+	// The scene: the built-in one right away, then the last one
+	// saved once it has streamed in
 	{
-		camera1 = std::make_shared<Camera>
-			(0.0f, 0.0f, -1.0f,
-				Window::AspectRatio(), 1.5708f,
-				0.01f, 500.0f,
-				1.0f, 0.01f,
-				true);
-		cameraVec.push_back(camera1);
+		sceneSaver = std::make_shared<SceneSaver>();
+		sceneReadMs = 0.0;
+		sceneInstantiateMs = 0.0;
+		reloadTestEntities = 0;
+		reloadTestSucceeded = false;
+		reloadTestReadMs = 0.0;
+		reloadTestInstantiateMs = 0.0;
+		cameraCacheUpdates = 0;
+		SceneData scene;
+		BuildDefaultScene(scene);
+		InstantiateScene(scene);
+		sceneSource = "Built in";
+		std::error_code error;
+		if (std::filesystem::exists(FixPath("Scene.bin"), error))
+			StreamScene(FixPath("Scene.bin"));
+	}
 
-		camera2 = std::make_shared<Camera>
-			(-0.2f, 0.5f, -2.0f,
-				Window::AspectRatio(), 0.4f,
-				0.01f, 500.0f,
-				1.0f, 0.01f,
-				true);
-		cameraVec.push_back(camera2);
+	// CPU occlusion culling, off until some entities are marked as occluders
+	{
+		occlusionCuller = std::make_shared<OcclusionCuller>(320, 180);
+		occlusionCullingEnabled = false;
+		occlusionCullMs = 0.0;
+	}
 
-		// Set active camera
-		activeCameraIndex = 0;
+	// Several cameras at once, off until turned on in the Inspector
+	{
+		multiViewRenderer = std::make_shared<MultiViewRenderer>(320, 180);
+		multiViewEnabled = false;
 	}
 }
 
@@ -211,7 +360,15 @@ Game::Game()
 // --------------------------------------------------------
 Game::~Game()
 {
+	// Hand back the meshes' loads, before the manager goes
+	for (MeshHandle handle : meshVec)
+	{
+		if (meshManager->Release(handle))
+			d3d11Backend->UnregisterMesh(handle.GetIndex());
+	}
+
 	// ImGui clean up
+	FontBaker::ShutDown();
 	ImGui_ImplDX11_Shutdown();
 	ImGui_ImplWin32_Shutdown();
 	ImGui::DestroyContext();
@@ -219,73 +376,389 @@ Game::~Game()
 
 
 // --------------------------------------------------------
-// Loads shaders from compiled shader object (.cso) files
-// and also created the Input Layout that describes our 
+// Loads shaders through the ShaderManager, which compiles
+// the .hlsl sources (or reuses cached bytecode) and falls
+// back to the compiled shader object (.cso) files, and
+// also creates the Input Layout that describes our 
 // vertex data to the rendering pipeline. 
-// - Input Layout creation is done here because it must 
-//    be verified against vertex shader byte code
-// - We'll have that byte code already loaded below
+// - Each shader has feature bits (see ShaderPermutations),
+//    and each combination is its own shader
+// - Input layouts are built from the vertex shader's
+//    reflection, and verified against its byte code
+// - The same functions run again whenever a source file
+//    is edited, between frames
 // --------------------------------------------------------
 void Game::LoadShaders()
 {
-	// BLOBs (or Binary Large OBjects) for reading raw data from external files
-	// - This is a simplified way of handling big chunks of external data
-	// - Literally just a big array of bytes read from a file
-	ID3DBlob* pixelShaderBlob;
-	ID3DBlob* vertexShaderBlob;
-
-	// Loading shaders
-	//  - Visual Studio will compile our shaders at build time
-	//  - They are saved as .cso (Compiled Shader Object) files
-	//  - We need to load them when the application starts
-	{
-		// Read our compiled shader code files into blobs
-		// - Essentially just "open the file and plop its contents here"
-		// - Uses the custom FixPath() helper from Helpers.h to ensure relative paths
-		// - Note the "L" before the string - this tells the compiler the string uses wide characters
-		D3DReadFileToBlob(FixPath(L"PixelShader.cso").c_str(), &pixelShaderBlob);
-		D3DReadFileToBlob(FixPath(L"VertexShader.cso").c_str(), &vertexShaderBlob);
-
-		// Create the actual Direct3D shaders on the GPU
-		Graphics::Device->CreatePixelShader(
-			pixelShaderBlob->GetBufferPointer(),	// Pointer to blob's contents
-			pixelShaderBlob->GetBufferSize(),		// How big is that data?
-			0,										// No classes in this shader
-			pixelShader.GetAddressOf());			// Address of the ID3D11PixelShader pointer
-
-		Graphics::Device->CreateVertexShader(
-			vertexShaderBlob->GetBufferPointer(),	// Get a pointer to the blob's contents
-			vertexShaderBlob->GetBufferSize(),		// How big is that data?
-			0,										// No classes in this shader
-			vertexShader.GetAddressOf());			// The address of the ID3D11VertexShader pointer
-	}
-
-	// Create an input layout 
-	//  - This describes the layout of data sent to a vertex shader
-	//  - In other words, it describes how to interpret data (numbers) in a vertex buffer
-	//  - Doing this NOW because it requires a vertex shader's byte code to verify against!
-	//  - Luckily, we already have that loaded (the vertex shader blob above)
-	{
-		D3D11_INPUT_ELEMENT_DESC inputElements[2] = {};
-
-		// Set up the first element - a position, which is 3 float values
-		inputElements[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;				// Most formats are described as color channels; really it just means "Three 32-bit floats"
-		inputElements[0].SemanticName = "POSITION";							// This is "POSITION" - needs to match the semantics in our vertex shader input!
-		inputElements[0].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;	// How far into the vertex is this?  Assume it's after the previous element
-
-		// Set up the second element - a color, which is 4 more float values
-		inputElements[1].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;			// 4x 32-bit floats
-		inputElements[1].SemanticName = "COLOR";							// Match our vertex shader input!
-		inputElements[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;	// After the previous element
-
-		// Create the input layout, verifying our description against actual shader code
-		Graphics::Device->CreateInputLayout(
-			inputElements,							// An array of descriptions
-			2,										// How many elements in that array?
-			vertexShaderBlob->GetBufferPointer(),	// Pointer to the code of a shader that uses this layout
-			vertexShaderBlob->GetBufferSize(),		// Size of the shader code that uses this layout
-			inputLayout.GetAddressOf());			// Address of the resulting ID3D11InputLayout pointer
+	// Sources are found relative to the working directory (the
+	// project folder when run from Visual Studio), so edits to
+	// them hot-reload.  Elsewhere, the .cso files next to the
+	// exe are used instead
+	shaderManager = std::make_shared<ShaderManager>(std::make_shared<D3DShaderCompiler>(), FixPath("ShaderCache"));
+	vertexFeatures = 0;
+	pixelFeatures = 0;
+	shadersChanged = false;
+
+	// Pixel shader variants
+	ShaderManager::ShaderDesc pixelDesc = { "PixelShader.hlsl", "main", "ps_5_0", {}, FixPath("PixelShader.cso") };
+	pixelPermutations = std::make_shared<ShaderPermutations>(shaderManager, pixelDesc, std::vector<std::string>{ "GRAYSCALE" },
+		[this](unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)
+		{
+			// Create the actual Direct3D shader on the GPU
+			Microsoft::WRL::ComPtr<ID3D11PixelShader> newShader;
+			if (FAILED(Graphics::Device->CreatePixelShader(
+				bytecode.data(),			// Pointer to the bytecode
+				bytecode.size(),			// How big is that data?
+				0,							// No classes in this shader
+				newShader.GetAddressOf())))	// Address of the ID3D11PixelShader pointer
+				return false;
+
+			if (shader >= pixelShaders.size())
+				pixelShaders.resize(shader + 1);
+			pixelShaders[shader] = newShader;
+			shadersChanged = true;
+			return true;
+		});
+
+	// Vertex shader variants, and the input layouts that are verified against them
+	ShaderManager::ShaderDesc vertexDesc = { "VertexShader.hlsl", "main", "vs_5_0", {}, FixPath("VertexShader.cso") };
+	vertexPermutations = std::make_shared<ShaderPermutations>(shaderManager, vertexDesc, std::vector<std::string>{ "FLAT_TINT" },
+		[this](unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)
+		{
+			// VertexShaderData is copied straight into the cbuffer, so it
+			// has to line up with the shader's idea of it
+			std::string errors;
+			if (!reflection.CheckVariable("ExternalData", "viewProjection", offsetof(VertexShaderData, ViewProjectionMatrix), sizeof(XMFLOAT4X4), errors))
+			{
+				Log::Write(Log::Severity::Error, Log::Category::Graphics, "VertexShaderData doesn't match the shader: %s", errors.c_str());
+				return false;
+			}
+
+			Microsoft::WRL::ComPtr<ID3D11VertexShader> newShader;
+			if (FAILED(Graphics::Device->CreateVertexShader(bytecode.data(), bytecode.size(), 0, newShader.GetAddressOf())))
+				return false;
+
+			// Create an input layout 
+			//  - This describes the layout of data sent to a vertex shader
+			//  - In other words, it describes how to interpret data (numbers) in a vertex buffer
+			//  - Doing this NOW because it requires a vertex shader's byte code to verify against!
+			//  - Variants that read the same inputs share one
+			Microsoft::WRL::ComPtr<ID3D11InputLayout> newLayout;
+			unsigned long long signature = reflection.GetInputSignature();
+			for (std::pair<unsigned long long, Microsoft::WRL::ComPtr<ID3D11InputLayout>>& cached : inputLayoutCache)
+			{
+				if (cached.first == signature)
+					newLayout = cached.second;
+			}
+
+			if (!newLayout)
+			{
+				// Find each of the shader's inputs in our Vertex, or in InstanceData
+				std::vector<ShaderReflection::InputElement> format = VertexFormat;
+				format.insert(format.end(), InstanceFormat.begin(), InstanceFormat.end());
+				std::vector<ShaderReflection::InputElement> layout;
+				if (!reflection.BuildInputLayout(format, layout, errors))
+				{
+					Log::Write(Log::Severity::Error, Log::Category::Graphics, "Can't build an input layout: %s", errors.c_str());
+					return false;
+				}
+
+				std::vector<D3D11_INPUT_ELEMENT_DESC> inputElements(layout.size());
+				for (size_t i = 0; i < layout.size(); i++)
+				{
+					inputElements[i].SemanticName = layout[i].semanticName.c_str();	// Needs to match the semantics in our vertex shader input!
+					inputElements[i].SemanticIndex = layout[i].semanticIndex;
+					inputElements[i].Format = ElementFormat(layout[i]);				// Most formats are described as color channels; really it just means "Three 32-bit floats"
+					inputElements[i].AlignedByteOffset = layout[i].offset;			// How far into the vertex is this?
+					inputElements[i].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+					if (IsInstanceElement(layout[i]))
+					{
+						inputElements[i].InputSlot = 1;								// The backend's instance buffer
+						inputElements[i].InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+						inputElements[i].InstanceDataStepRate = 1;
+					}
+				}
+
+				// Create the input layout, verifying our description against actual shader code
+				if (FAILED(Graphics::Device->CreateInputLayout(
+					inputElements.data(),					// An array of descriptions
+					(unsigned int)inputElements.size(),		// How many elements in that array?
+					bytecode.data(),						// Pointer to the code of a shader that uses this layout
+					bytecode.size(),						// Size of the shader code that uses this layout
+					newLayout.GetAddressOf())))				// Address of the resulting ID3D11InputLayout pointer
+					return false;
+				inputLayoutCache.push_back({ signature, newLayout });
+			}
+
+			if (shader >= vertexShaders.size())
+			{
+				vertexShaders.resize(shader + 1);
+				vertexShaderLayouts.resize(shader + 1);
+			}
+			vertexShaders[shader] = newShader;
+			vertexShaderLayouts[shader] = newLayout;
+			shadersChanged = true;
+			return true;
+		});
+
+	SelectShaders();
+}
+
+// --------------------------------------------------------
+// Points the backend (and the pipeline) at the variants
+// picked by the current feature bits, loading them first
+// if needed.  Called after any shader is swapped
+// --------------------------------------------------------
+void Game::SelectShaders()
+{
+	// A variant that never loaded keeps the previous shader
+	unsigned int vertexId = vertexPermutations->Get(vertexFeatures);
+	unsigned int pixelId = pixelPermutations->Get(pixelFeatures);
+	if (vertexId < vertexShaders.size() && vertexShaders[vertexId])
+	{
+		vertexShader = vertexShaders[vertexId];
+		inputLayout = vertexShaderLayouts[vertexId];
+	}
+	if (pixelId < pixelShaders.size() && pixelShaders[pixelId])
+		pixelShader = pixelShaders[pixelId];
+
+	if (d3d11Backend)
+		d3d11Backend->RegisterShaders(0, vertexShader, pixelShader, inputLayout);
+
+	Graphics::Context->IASetInputLayout(inputLayout.Get());
+	Graphics::Context->VSSetShader(vertexShader.Get(), 0, 0);
+	Graphics::Context->PSSetShader(pixelShader.Get(), 0, 0);
+	shadersChanged = false;
+}
+
+// --------------------------------------------------------
+// The scene this started with, before there were scene
+// files: five entities over the test meshes, two cameras
+// and one looking down on it all (mostly for multi-view)
+// --------------------------------------------------------
+void Game::BuildDefaultScene(SceneData& pScene)
+{
+	pScene.Clear();
+	pScene.meshNames = { "Triangle", "Quad", "The weird one" };
+
+	const float zero[3] = { 0.0f, 0.0f, 0.0f };
+	const float halfScale[3] = { 0.5f, 0.5f, 0.5f };
+	const float threeQuarterScale[3] = { 0.75f, 0.75f, 0.75f };
+	const float fullScale[3] = { 1.0f, 1.0f, 1.0f };
+	pScene.AddEntity(0, zero, zero, halfScale, 0);
+	pScene.AddEntity(0, zero, zero, threeQuarterScale, 0);
+	pScene.AddEntity(1, zero, zero, fullScale, 0);
+	pScene.AddEntity(1, zero, zero, fullScale, 0);
+	pScene.AddEntity(2, zero, zero, fullScale, 0);
+
+	pScene.cameras.push_back({ { 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, 0.0f }, 1.5708f, 0.01f, 500.0f, 1.0f, 0.01f, 10.0f, SceneData::CameraPerspective });
+	pScene.cameras.push_back({ { -0.2f, 0.5f, -2.0f }, { 0.0f, 0.0f, 0.0f }, 0.4f, 0.01f, 500.0f, 1.0f, 0.01f, 10.0f, SceneData::CameraPerspective });
+	pScene.cameras.push_back({ { 0.0f, 3.0f, -0.6f }, { 1.35f, 0.0f, 0.0f }, 1.2f, 0.01f, 500.0f, 1.0f, 0.01f, 10.0f, SceneData::CameraPerspective });
+	pScene.activeCamera = 0;
+}
+
+
+// --------------------------------------------------------
+// Copies the current entities and cameras into a scene,
+// so it can be saved
+// --------------------------------------------------------
+void Game::GatherScene(SceneData& pScene)
+{
+	pScene.Clear();
+	for (MeshHandle handle : meshVec)
+		pScene.meshNames.push_back(meshManager->Get(handle)->GetName());
+
+	for (std::shared_ptr<Entity>& entity : entityVec)
+	{
+		// Scenes refer to meshes by their place in meshVec
+		unsigned int mesh = 0;
+		while (mesh < meshVec.size() && meshVec[mesh] != entity->GetMesh())
+			mesh++;
+		if (mesh == meshVec.size())
+			continue;
+
+		XMFLOAT3 position = entity->GetTransform().GetPosition();
+		XMFLOAT3 rotation = entity->GetTransform().GetPitchYawRoll();
+		XMFLOAT3 scale = entity->GetTransform().GetScale();
+		pScene.AddEntity(mesh, &position.x, &rotation.x, &scale.x, entity->IsOccluder() ? SceneData::EntityOccluder : 0);
+	}
+
+	for (std::shared_ptr<Camera>& camera : cameraVec)
+	{
+		XMFLOAT3 position = camera->GetPosition();
+		XMFLOAT3 rotation = camera->GetRotation();
+		SceneData::CameraDesc desc = { { position.x, position.y, position.z }, { rotation.x, rotation.y, rotation.z },
+			camera->GetFov(), camera->GetNearClip(), camera->GetFarClip(), camera->GetMovementSpeed(), camera->GetLookSpeed(),
+			camera->GetOrthographicWidth(), 0 };
+		desc.flags = (camera->IsPerspective() ? SceneData::CameraPerspective : 0) | (camera->IsReversedZ() ? SceneData::CameraReversedZ : 0);
+		pScene.cameras.push_back(desc);
+	}
+	pScene.activeCamera = activeCameraIndex;
+}
+
+
+// --------------------------------------------------------
+// Replaces every entity and camera with the scene's.
+// Meshes are found by name among the loaded ones, and
+// entities whose mesh isn't loaded are skipped
+// --------------------------------------------------------
+void Game::InstantiateScene(const SceneData& pScene)
+{
+	std::vector<MeshHandle> meshes(pScene.meshNames.size(), MeshHandle{ 0 });
+	for (size_t i = 0; i < pScene.meshNames.size(); i++)
+	{
+		for (MeshHandle handle : meshVec)
+		{
+			if (meshManager->Get(handle)->GetName() == pScene.meshNames[i])
+				meshes[i] = handle;
+		}
+		if (!meshManager->Get(meshes[i]))
+			Log::Write(Log::Severity::Warning, Log::Category::Assets, "The scene uses mesh \"%s\", which isn't loaded", pScene.meshNames[i].c_str());
+	}
+
+	// The entities all live in one block, which each of their
+	// pointers shares, rather than an allocation apiece.  Their
+	// transforms are the scene's arrays, copied in whole
+	{
+		MemoryTracker::Scope scope(MemoryTracker::Tag::Entities);
+		std::shared_ptr<TransformPool> transforms = std::make_shared<TransformPool>(pScene.GetEntityCount(), pScene.positions.data(), pScene.rotations.data(), pScene.scales.data());
+		std::shared_ptr<std::vector<Entity>> entities = std::make_shared<std::vector<Entity>>();
+		entities->reserve(pScene.GetEntityCount());
+		entityVec.clear();
+		entityVec.reserve(pScene.GetEntityCount());
+		for (size_t i = 0; i < pScene.GetEntityCount(); i++)
+		{
+			MeshHandle mesh = meshes[pScene.meshes[i]];
+			if (!meshManager->Get(mesh))
+				continue;
+
+			entities->emplace_back(mesh, transforms, (unsigned int)i, (pScene.entityFlags[i] & SceneData::EntityOccluder) != 0);
+			entityVec.push_back(std::shared_ptr<Entity>(entities, &entities->back()));
+		}
+	}
+
+	cameraVec.clear();
+	for (const SceneData::CameraDesc& desc : pScene.cameras)
+	{
+		std::shared_ptr<Camera> camera = std::make_shared<Camera>
+			(desc.position[0], desc.position[1], desc.position[2],
+				Window::AspectRatio(), desc.fov,
+				desc.nearClip, desc.farClip,
+				desc.movementSpeed, desc.lookSpeed,
+				(desc.flags & SceneData::CameraPerspective) != 0);
+		camera->SetRotation(XMFLOAT3(desc.rotation[0], desc.rotation[1], desc.rotation[2]));
+		camera->SetOrthographicWidth(desc.orthographicWidth);
+		camera->SetReversedZ((desc.flags & SceneData::CameraReversedZ) != 0);
+		camera->UpdateViewMatrix();
+		cameraVec.push_back(camera);
+	}
+
+	// Everything else expects at least one camera
+	if (cameraVec.empty())
+		cameraVec.push_back(std::make_shared<Camera>(0.0f, 0.0f, -1.0f, Window::AspectRatio(), 1.5708f, 0.01f, 500.0f, 1.0f, 0.01f, true));
+
+	activeCameraIndex = pScene.activeCamera < cameraVec.size() ? pScene.activeCamera : 0;
+	cachedCamera = 0;
+	cachedCameraVersion = 0;
+	sceneStreaming = false;
+}
+
+
+// --------------------------------------------------------
+// Loads a scene file (binary or JSON) and instantiates it.
+// A missing or broken file leaves the current scene as is
+// --------------------------------------------------------
+bool Game::LoadScene(const std::string& pPath, bool pIsText)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	SceneData scene;
+	if (!(pIsText ? SceneFile::LoadText(pPath, scene) : SceneFile::Load(pPath, scene)))
+		return false;
+
+	std::chrono::high_resolution_clock::time_point read = std::chrono::high_resolution_clock::now();
+	InstantiateScene(scene);
+	sceneReadMs = std::chrono::duration<double, std::milli>(read - start).count();
+	sceneInstantiateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - read).count();
+	sceneSource = pPath;
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Loads a binary scene through the AssetStreamer: read
+// and parsed in the background, then instantiated on the
+// main thread when it arrives.  Any scene instantiated in
+// the meantime wins
+// --------------------------------------------------------
+void Game::StreamScene(const std::string& pPath)
+{
+	std::shared_ptr<SceneData> scene = std::make_shared<SceneData>();
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	AssetStreamer::DecodeFunction decode = [scene, pPath](AssetStreamer::Buffer& data)
+		{
+			bool parsed = SceneFile::Read(data.data(), data.size(), pPath, *scene);
+			data.clear();
+			data.shrink_to_fit();
+			return parsed;
+		};
+	AssetStreamer::UploadFunction upload = [this, scene, pPath, start](unsigned int, AssetStreamer::Buffer&, bool succeeded)
+		{
+			if (!succeeded || !sceneStreaming)
+				return;
+
+			std::chrono::high_resolution_clock::time_point read = std::chrono::high_resolution_clock::now();
+			InstantiateScene(*scene);
+			sceneReadMs = std::chrono::duration<double, std::milli>(read - start).count();
+			sceneInstantiateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - read).count();
+			sceneSource = pPath;
+		};
+
+	const float origin[3] = { 0.0f, 0.0f, 0.0f };
+	sceneStreaming = true;
+	assetStreamer->Request(pPath, origin, decode, upload);
+}
+
+
+// --------------------------------------------------------
+// Times a full reload (reading the binary file, then
+// instantiating it) of a generated scene with the given
+// number of entities, then puts the current scene back
+// --------------------------------------------------------
+void Game::TimeSceneReload(unsigned int pEntityCount)
+{
+	SceneData current;
+	GatherScene(current);
+	std::string source = sceneSource;
+	double readMs = sceneReadMs;
+	double instantiateMs = sceneInstantiateMs;
+
+	// A grid of the current scene's meshes
+	SceneData scene;
+	scene.meshNames = current.meshNames;
+	scene.cameras = current.cameras;
+	scene.activeCamera = current.activeCamera;
+	if (scene.meshNames.empty())
+		return;
+	for (unsigned int i = 0; i < pEntityCount; i++)
+	{
+		float position[3] = { (float)(i % 100), (float)(i / 100 % 100), (float)(i / 10000) };
+		float rotation[3] = { 0.0f, i * 0.01f, 0.0f };
+		float scale[3] = { 0.5f, 0.5f, 0.5f };
+		scene.AddEntity((unsigned int)(i % scene.meshNames.size()), position, rotation, scale, 0);
 	}
+
+	std::error_code error;
+	std::string path = (std::filesystem::temp_directory_path(error) / "SceneReloadTest.bin").string();
+	reloadTestEntities = pEntityCount;
+	reloadTestSucceeded = SceneFile::Save(path, scene) && LoadScene(path, false);
+	reloadTestReadMs = sceneReadMs;
+	reloadTestInstantiateMs = sceneInstantiateMs;
+	std::filesystem::remove(path, error);
+
+	InstantiateScene(current);
+	sceneSource = source;
+	sceneReadMs = readMs;
+	sceneInstantiateMs = instantiateMs;
 }
 
 // --------------------------------------------------------
@@ -301,6 +774,23 @@ void Game::OnResize()
 }
 
 
+// --------------------------------------------------------
+// Called before each frame's timing and input, to wait
+// for the swap chain to take another frame and then for
+// the frame cap, so input is sampled as late as possible
+// --------------------------------------------------------
+void Game::WaitForNextFrame()
+{
+	// Nothing is displayed while minimized, so there's nothing to wait for
+	unsigned long long start = InputQueue::Now();
+	if (!Window::IsMinimized())
+		Graphics::WaitForFrameLatency();
+	swapChainWaitMs = (InputQueue::Now() - start) / 1000000.0;
+
+	framePacer->WaitForNextFrame();
+}
+
+
 // --------------------------------------------------------
 // Update your game here - user input, move objects, AI, etc.
 // --------------------------------------------------------
@@ -310,6 +800,22 @@ void Game::Update(float deltaTime, float totalTime)
 	if (Input::KeyDown(VK_ESCAPE))
 		Window::Quit();
 
+	// A new frame: count what the last one allocated, and rewind
+	// the scratch memory from two frames ago
+	unsigned long long allocationCount = AllocationCounter::GetCount();
+	unsigned long long threadAllocationCount = AllocationCounter::GetThreadCount();
+	frameAllocations = allocationCount - frameAllocationStart;
+	frameThreadAllocations = threadAllocationCount - frameThreadAllocationStart;
+	frameAllocationStart = allocationCount;
+	frameThreadAllocationStart = threadAllocationCount;
+	frameArena->BeginFrame();
+	MemoryTracker::Update(totalTime);
+
+	// Swap in any shaders that finished recompiling (between frames)
+	shaderManager->Update();
+	if (shadersChanged)
+		SelectShaders();
+
 	// Update ImGui
 	ImGuiNewFrameUpdate(deltaTime);
 	ImGuiBuildUI();
@@ -317,12 +823,123 @@ void Game::Update(float deltaTime, float totalTime)
 	// Update Camera
 	cameraVec[activeCameraIndex]->Update(deltaTime);
 
-	// Move entities
-	//entityVec[0]->GetTransform().SetPosition((float)sin(totalTime), (float)cos(totalTime), 0.0f);
-	entityVec[1]->GetTransform().SetPosition((float)cos(totalTime), (float)sin(totalTime), 0.0f);
-	entityVec[2]->GetTransform().SetRotation(0.0f, 0.0f, totalTime * 2.0f);
-	entityVec[3]->GetTransform().SetScale((float)sin(totalTime) + 1.5f, (float)sin(totalTime) + 1.5f, 1.0f);
-	entityVec[4]->GetTransform().SetPosition(-(float)sin(totalTime), 0.5f, 0.0f);
+	// Hand over streamed assets, nearest the camera first
+	XMFLOAT3 streamingPos = cameraVec[activeCameraIndex]->GetPosition();
+	assetStreamer->SetViewPosition(&streamingPos.x);
+	assetStreamer->Update();
+
+	// Move entities (loaded scenes can have fewer)
+	if (entityVec.size() >= 5)
+	{
+		//entityVec[0]->GetTransform().SetPosition((float)sin(totalTime), (float)cos(totalTime), 0.0f);
+		entityVec[1]->GetTransform().SetPosition((float)cos(totalTime), (float)sin(totalTime), 0.0f);
+		entityVec[2]->GetTransform().SetRotation(0.0f, 0.0f, totalTime * 2.0f);
+		entityVec[3]->GetTransform().SetScale((float)sin(totalTime) + 1.5f, (float)sin(totalTime) + 1.5f, 1.0f);
+		entityVec[4]->GetTransform().SetPosition(-(float)sin(totalTime), 0.5f, 0.0f);
+	}
+
+	// Roll the ripple along, writing its rows on jobs
+	if (waveMeshEnabled)
+		UpdateWaveMesh(totalTime);
+}
+
+
+// --------------------------------------------------------
+// A flat grid below the scene for the wave demo, on the
+// XZ plane
+// --------------------------------------------------------
+void Game::CreateWaveMesh()
+{
+	float halfWidth = WaveGridSpacing * (WaveGridSize - 1) / 2.0f;
+	std::vector<Vertex> vertices(WaveGridSize * WaveGridSize);
+	for (unsigned int z = 0; z < WaveGridSize; z++)
+	{
+		for (unsigned int x = 0; x < WaveGridSize; x++)
+		{
+			Vertex& vertex = vertices[z * WaveGridSize + x];
+			vertex.Position = XMFLOAT3(WaveGridSpacing * x - halfWidth, WaveGridY, WaveGridSpacing * z - halfWidth);
+			vertex.Color = XMFLOAT4(0.2f, 0.4f, 0.8f, 1.0f);
+		}
+	}
+
+	// Two clockwise (seen from above) triangles per square
+	std::vector<unsigned int> indices;
+	indices.reserve((WaveGridSize - 1) * (WaveGridSize - 1) * 6);
+	for (unsigned int z = 0; z < WaveGridSize - 1; z++)
+	{
+		for (unsigned int x = 0; x < WaveGridSize - 1; x++)
+		{
+			unsigned int i = z * WaveGridSize + x;
+			unsigned int square[6] = { i, i + WaveGridSize, i + 1, i + 1, i + WaveGridSize, i + WaveGridSize + 1 };
+			indices.insert(indices.end(), square, square + 6);
+		}
+	}
+
+	waveMesh = std::make_shared<DynamicMesh>(vertices.data(), vertices.size(), indices.data(), indices.size(), "Wave");
+	waveFirstRow = 0;
+	waveEndRow = 0;
+}
+
+
+// --------------------------------------------------------
+// Raises the rows around the ripple's crest and flattens
+// the ones it just left.  Each job writes its own rows and
+// marks just those, so only they're uploaded
+// --------------------------------------------------------
+void Game::UpdateWaveMesh(float totalTime)
+{
+	std::chrono::high_resolution_clock::time_point writeStart = std::chrono::high_resolution_clock::now();
+
+	// The crest starts and ends off the grid, so the band slides on and off
+	int crest = (int)fmodf(totalTime * 60.0f, (float)(WaveGridSize + 2 * WaveBandRows)) - WaveBandRows;
+	int bandFirst = crest - WaveBandRows + 1;
+	int bandEnd = crest + WaveBandRows;
+	unsigned int firstRow = bandFirst < 0 ? 0 : (bandFirst > (int)WaveGridSize ? WaveGridSize : (unsigned int)bandFirst);
+	unsigned int endRow = bandEnd < 0 ? 0 : (bandEnd > (int)WaveGridSize ? WaveGridSize : (unsigned int)bandEnd);
+
+	// This frame's band, and last frame's to flatten, as one
+	// span when they overlap
+	unsigned int spans[2][2] = { { firstRow, endRow }, { waveFirstRow, waveEndRow } };
+	if (waveFirstRow <= endRow && firstRow <= waveEndRow)
+	{
+		spans[0][0] = firstRow < waveFirstRow ? firstRow : waveFirstRow;
+		spans[0][1] = endRow > waveEndRow ? endRow : waveEndRow;
+		spans[1][1] = spans[1][0];
+	}
+
+	DynamicMesh* mesh = waveMesh.get();
+	for (unsigned int span = 0; span < 2; span++)
+	{
+		unsigned int writeFirst = spans[span][0];
+		unsigned int writeEnd = spans[span][1];
+		if (writeEnd <= writeFirst)
+			continue;
+
+		unsigned int pieces = (writeEnd - writeFirst + WaveRowsPerJob - 1) / WaveRowsPerJob;
+		JobSystem::ParallelFor(pieces, [mesh, writeFirst, writeEnd, crest, totalTime](unsigned int piece)
+			{
+				unsigned int rowStart = writeFirst + piece * WaveRowsPerJob;
+				unsigned int rowEnd = rowStart + WaveRowsPerJob < writeEnd ? rowStart + WaveRowsPerJob : writeEnd;
+				Vertex* vertices = mesh->GetVertices();
+				for (unsigned int row = rowStart; row < rowEnd; row++)
+				{
+					int distance = abs((int)row - crest);
+					float height = distance < WaveBandRows ? WaveHeight * 0.5f * (1.0f + cosf(XM_PI * distance / WaveBandRows)) : 0.0f;
+					for (unsigned int x = 0; x < WaveGridSize; x++)
+					{
+						float y = height * (0.75f + 0.25f * sinf(x * 0.1f + totalTime * 3.0f));
+						Vertex& vertex = vertices[row * WaveGridSize + x];
+						vertex.Position.y = WaveGridY + y;
+						vertex.Color = XMFLOAT4(0.2f + y, 0.4f + y, 0.8f, 1.0f);
+					}
+				}
+				mesh->MarkDirty(rowStart * WaveGridSize, (rowEnd - rowStart) * WaveGridSize);
+			});
+	}
+
+	waveFirstRow = firstRow;
+	waveEndRow = endRow;
+	waveWriteMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - writeStart).count();
 }
 
 // --------------------------------------------------------
@@ -333,66 +950,146 @@ void Game::Draw(float deltaTime, float totalTime)
 	// Frame start
 	// - These things should happen ONCE PER FRAME
 	// - At the beginning of Game::Draw() before drawing *anything*
+	// - The scene is recorded into a command list, then executed by the backend
 	{
+		// Reversed Z cameras put the far plane at depth 0, so they
+		// clear to 0 and keep the greater depth instead
+		bool reversedZ = cameraVec[activeCameraIndex]->IsReversedZ();
+		Graphics::Context->OMSetDepthStencilState(reversedZ ? reversedDepthState.Get() : 0, 0);
+
 		// Clear the back buffer (erase what's on screen) and depth buffer
-		Graphics::Context->ClearRenderTargetView(Graphics::BackBufferRTV.Get(),	bgColor);
-		Graphics::Context->ClearDepthStencilView(Graphics::DepthBufferDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+		frameCommands.Clear();
+		frameCommands.ClearTargets(bgColor, reversedZ ? 0.0f : 1.0f);
+		frameCommands.SetViewport(0.0f, 0.0f, (float)Window::Width(), (float)Window::Height());
 	}
 	
-	// Draw geometry
-	//for (unsigned int i = 0; i < meshVec.size(); ++i)
+	// Camera matrices for culling and recording
+	UpdateCameraCache();
+
+	// World matrices and tints, brought up to date once here so culling
+	// and recording (on job threads, and maybe for several views) only
+	// read them, then uploaded once for every view to index into
+	XMFLOAT4 tint(vsColorTint[0], vsColorTint[1], vsColorTint[2], 1.0f);
+	frameInstances.resize(entityVec.size() + 1);
 	for (unsigned int i = 0; i < entityVec.size(); ++i)
+		frameInstances[i] = { entityVec[i]->GetTransform().GetWorldMatrix(), tint };
+	XMStoreFloat4x4(&frameInstances.back().WorldMatrix, XMMatrixIdentity());
+	frameInstances.back().ColorTint = tint;
+	frameCommands.UpdateInstances(frameInstances.data(), sizeof(InstanceData), (unsigned int)frameInstances.size());
+
+	// Lists recorded on the JobSystem, executed after frameCommands
+	const std::vector<CommandList>* jobLists = 0;
+	if (multiViewEnabled)
 	{
-		// Create vertex shader data
-		VertexShaderData vsData;
-		vsData.ColorTint = XMFLOAT4(vsColorTint[0], vsColorTint[1], vsColorTint[2], 1.0f);
-		vsData.WorldMatrix = entityVec[i]->GetTransform().GetWorldMatrix();
-		vsData.ViewMatrix = cameraVec[activeCameraIndex]->GetViewMatrix();
-		vsData.ProjectionMatrix = cameraVec[activeCameraIndex]->GetProjectionMatrix();
+		// Every camera culls, shares one sort and records on its own job
+		jobLists = &DrawMultiView();
+	}
+	else
+	{
+		// Skip entities hidden behind occluders
+		entityVisible.assign(entityVec.size(), true);
+		if (occlusionCullingEnabled)
+		{
+			std::chrono::high_resolution_clock::time_point cullStart = std::chrono::high_resolution_clock::now();
+			CullEntities(*occlusionCuller, cachedCullingViewProj, true, entityVisible);
+			occlusionCullMs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - cullStart).count() * 1000.0;
+		}
 
-		//// Translation
-		//XMMATRIX trMat = XMMatrixTranslation((float)sin(totalTime), 0, 0);
-		//
-		//// Scale
-		//float scale = (float)sin(totalTime * 3.7f) * 0.5f + 1.0f;
-		//XMMATRIX scMat = XMMatrixScaling(scale, scale, scale);
-		//
-		//// Rotation
-		//XMMATRIX rotMat = XMMatrixRotationRollPitchYaw(0, 0, totalTime * 0.1f);
-		//
-		//// Build world matrix
-		//XMMATRIX worldMat = scMat * rotMat * trMat;	// order matters here
-		//
-		//// Store result
-		//XMStoreFloat4x4(&vsData.Matrix, worldMat);
+		// Queue visible entities, sorted by shader, then mesh, then distance
+		// so consecutive draws can share bound state
+		XMFLOAT3 cameraPos = cameraVec[activeCameraIndex]->GetPosition();
+		renderQueue.Clear();
+		for (unsigned int i = 0; i < entityVec.size(); ++i)
+		{
+			if (entityVisible[i])
+				renderQueue.Push(MakeSortKey(i, cameraPos), i, entityVec[i]->GetMesh().value);
+		}
+		renderQueue.Sort();
 
-		//// DXMath demo
-		//// Create storage types
-		//XMFLOAT3 position(1, 2, 3);
-		//XMFLOAT3 offset(4, 5, 6);
-		//
-		//// Load into math types
-		//XMVECTOR posVec = XMLoadFloat3(&position);
-		//XMVECTOR offVec = XMLoadFloat3(&offset);
-		//
-		//// Do some math
-		//posVec = XMVectorAdd(posVec, offVec);
-		//posVec *= 5;
-		//
-		//// Store back in storage type
-		//XMStoreFloat3(&position, posVec);
+		// Draw geometry, either into the frame's list or split
+		// into chunks recorded in parallel on deferred contexts
+		//for (unsigned int i = 0; i < meshVec.size(); ++i)
+		std::chrono::high_resolution_clock::time_point recordStart = std::chrono::high_resolution_clock::now();
+		if (parallelRecording)
+		{
+			jobLists = &parallelRecorder.Record(renderQueue.BuildDrawCalls(),
+				[this](CommandList& commands, const RenderQueue::DrawCall& call) { RecordDraw(commands, call, cachedViewProj); });
+		}
+		else
+		{
+			for (const RenderQueue::DrawCall& call : renderQueue.BuildDrawCalls())
+				RecordDraw(frameCommands, call, cachedViewProj);
+		}
+		recordMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count();
 
-		// Copy to the resource (map (lock) -> copy -> unmap (unlock))
-		D3D11_MAPPED_SUBRESOURCE mappedBuffer = {};
-		Graphics::Context->Map(constBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedBuffer);	// map
-		memcpy(mappedBuffer.pData, &vsData, sizeof(vsData));	// copy
-		Graphics::Context->Unmap(constBuffer.Get(), 0);		// unmap
+		// The wave demo: upload the rows that changed, then draw
+		// from whichever copy in its buffer that went to
+		if (waveMeshEnabled && waveMesh)
+		{
+			waveMesh->Upload();
+			d3d11Backend->RegisterMesh(WaveMeshSlot, waveMesh->GetVertexBuffer(), waveMesh->GetIndexBuffer(), sizeof(Vertex), waveMesh->GetVertexOffset());
+
+			VertexShaderData vsData;
+			vsData.ViewProjectionMatrix = cachedViewProj;
+			frameCommands.BindShaders(0);
+			frameCommands.UpdateConstants(0, &vsData, sizeof(vsData));
+			frameCommands.BindMesh(WaveMeshSlot);
+			frameCommands.DrawInstanced(static_cast<unsigned int>(waveMesh->GetIndexCount()), 1, 0, 0, (unsigned int)entityVec.size());
+		}
+	}
 
-		// Draw mesh
-		//meshVec[i]->Draw(deltaTime, totalTime);
+	// The clears (and draws, if they weren't recorded on jobs),
+	// then the job lists in order on deferred contexts
+	d3d11Backend->Execute(frameCommands);
+	if (jobLists)
+		d3d11Backend->ExecuteParallel(*jobLists);
 
-		// Draw entity
-		entityVec[i]->Draw(deltaTime, totalTime);
+	// Save this frame's commands as text, if requested from the Inspector
+	if (captureFrameCommands)
+	{
+		NullBackend capture(true);
+		capture.Execute(frameCommands);
+		unsigned int commandCount = frameCommands.GetCommandCount();
+		if (jobLists)
+		{
+			for (const CommandList& commands : *jobLists)
+			{
+				capture.Execute(commands);
+				commandCount += commands.GetCommandCount();
+			}
+		}
+		std::ofstream file(FixPath("FrameCapture.txt"));
+		file << capture.GetTranscript();
+		Log::Write(Log::Severity::Info, Log::Category::Graphics, "Saved %u commands to FrameCapture.txt", commandCount);
+		captureFrameCommands = false;
+	}
+
+	// Render this frame's commands on the CPU and save them as a PNG
+	if (captureSoftwareFrame)
+	{
+		if (!softwareBackend || softwareBackend->GetWidth() != (int)Window::Width() || softwareBackend->GetHeight() != (int)Window::Height())
+		{
+			softwareBackend = std::make_shared<SoftwareBackend>(Window::Width(), Window::Height());
+			for (MeshHandle handle : meshVec)
+			{
+				Mesh* mesh = meshManager->Get(handle);
+				softwareBackend->RegisterMesh(handle.GetIndex(), (const SoftwareBackend::InputVertex*)mesh->GetVertices().data(), mesh->GetVertexCount(), mesh->GetIndices().data(), mesh->GetIndexCount());
+			}
+		}
+
+		softwareBackend->ResetStats();
+		softwareBackend->SetReversedDepth(cameraVec[activeCameraIndex]->IsReversedZ());
+		softwareBackend->Execute(frameCommands);
+		if (jobLists)
+			for (const CommandList& commands : *jobLists)
+				softwareBackend->Execute(commands);
+
+		SoftwareBackend::Stats softwareStats = softwareBackend->GetStats();
+		if (softwareBackend->SavePNG(FixPath("SoftwareFrame.png")))
+			Log::Write(Log::Severity::Info, Log::Category::Graphics, "Saved SoftwareFrame.png (%zu triangles, %zu pixels)", softwareStats.rasterizedTriangles, softwareStats.pixels);
+		else
+			Log::Write(Log::Severity::Error, Log::Category::Graphics, "Couldn't write SoftwareFrame.png");
+		captureSoftwareFrame = false;
 	}
 
 	// Draw ImGui
@@ -409,6 +1106,20 @@ void Game::Draw(float deltaTime, float totalTime)
 			vsync ? 1 : 0,
 			vsync ? 0 : DXGI_PRESENT_ALLOW_TEARING);
 
+		// Input latency: from sampling it, every frame, and from the
+		// oldest event, for frames that had any input
+		sampleToPresentMs = (InputQueue::Now() - Input::GetFrameSampleTime()) / 1000000.0;
+		sampleToPresentAverageMs += (sampleToPresentMs - sampleToPresentAverageMs) * 0.05;
+		unsigned long long inputTime = Input::GetOldestEventTime();
+		if (inputTime != 0)
+		{
+			inputWaitMs = (Input::GetFrameSampleTime() - inputTime) / 1000000.0;
+			inputToPresentMs = (InputQueue::Now() - inputTime) / 1000000.0;
+			inputToPresentAverageMs += (inputToPresentMs - inputToPresentAverageMs) * 0.05;
+			if (inputToPresentMs > inputToPresentPeakMs)
+				inputToPresentPeakMs = inputToPresentMs;
+		}
+
 		// Re-bind back buffer and depth buffer after presenting
 		Graphics::Context->OMSetRenderTargets(
 			1,
@@ -418,6 +1129,193 @@ void Game::Draw(float deltaTime, float totalTime)
 }
 
 
+// --------------------------------------------------------
+// Records one sorted draw from the given camera.  Runs on
+// job threads when recording in parallel or for several
+// views, so it only reads this frame's instances.  The
+// entity's world matrix and tint are already uploaded, so
+// a draw only picks its instance
+// --------------------------------------------------------
+void Game::RecordDraw(CommandList& pCommands, const RenderQueue::DrawCall& pCall, const XMFLOAT4X4& pViewProj)
+{
+	unsigned int i = pCall.index;
+
+	// Only one shader pair for now, but only bind it when it changes.
+	// Lists (and chunks of them) always start with a bind, so the
+	// view's camera goes in with it, once per list
+	if (pCall.bindShader)
+	{
+		VertexShaderData vsData;
+		vsData.ViewProjectionMatrix = pViewProj;
+		pCommands.BindShaders(0);
+		pCommands.UpdateConstants(0, &vsData, sizeof(vsData));
+	}
+
+	//// Translation
+	//XMMATRIX trMat = XMMatrixTranslation((float)sin(totalTime), 0, 0);
+	//
+	//// Scale
+	//float scale = (float)sin(totalTime * 3.7f) * 0.5f + 1.0f;
+	//XMMATRIX scMat = XMMatrixScaling(scale, scale, scale);
+	//
+	//// Rotation
+	//XMMATRIX rotMat = XMMatrixRotationRollPitchYaw(0, 0, totalTime * 0.1f);
+	//
+	//// Build world matrix
+	//XMMATRIX worldMat = scMat * rotMat * trMat;	// order matters here
+	//
+	//// Store result
+	//XMStoreFloat4x4(&vsData.Matrix, worldMat);
+
+	//// DXMath demo
+	//// Create storage types
+	//XMFLOAT3 position(1, 2, 3);
+	//XMFLOAT3 offset(4, 5, 6);
+	//
+	//// Load into math types
+	//XMVECTOR posVec = XMLoadFloat3(&position);
+	//XMVECTOR offVec = XMLoadFloat3(&offset);
+	//
+	//// Do some math
+	//posVec = XMVectorAdd(posVec, offVec);
+	//posVec *= 5;
+	//
+	//// Store back in storage type
+	//XMStoreFloat3(&position, posVec);
+
+	// Draw mesh
+	//meshVec[i]->Draw(deltaTime, totalTime);
+
+	// Draw entity, skipping the buffer binds if the previous draw used the same mesh
+	MeshHandle handle = entityVec[i]->GetMesh();
+	Mesh* mesh = meshManager->Get(handle);
+	if (pCall.bindMesh)
+		pCommands.BindMesh(handle.GetIndex());
+	pCommands.DrawInstanced(static_cast<unsigned int>(mesh->GetIndexCount()), 1, 0, 0, i);
+}
+
+// --------------------------------------------------------
+// Copies the active camera's matrices for this frame's draws,
+// but only when the camera changed since they were copied
+// --------------------------------------------------------
+void Game::UpdateCameraCache()
+{
+	Camera* camera = cameraVec[activeCameraIndex].get();
+	if (camera == cachedCamera && camera->GetVersion() == cachedCameraVersion)
+		return;
+
+	cachedCamera = camera;
+	cachedCameraVersion = camera->GetVersion();
+	cachedViewProj = camera->GetViewProjectionMatrix();
+	cachedCullingViewProj = CullingViewProjection(*camera);
+	cameraCacheUpdates++;
+}
+
+// --------------------------------------------------------
+// Rasterizes occluder entities into a CPU depth buffer and
+// tests every other entity's bounds against it, from the
+// point of view of one camera.  Without occluders, this is
+// just frustum culling.  Only reads shared state, so views
+// can cull in parallel with their own cullers
+// --------------------------------------------------------
+void Game::CullEntities(OcclusionCuller& pCuller, const XMFLOAT4X4& pCullingViewProj, bool pRenderOccluders, std::vector<bool>& pVisible)
+{
+	// Combined view and projection, same layout the culler expects
+	pCuller.BeginFrame(&pCullingViewProj.m[0][0]);
+
+	// Occluders first
+	for (unsigned int i = 0; i < entityVec.size() && pRenderOccluders; ++i)
+	{
+		if (!entityVec[i]->IsOccluder())
+			continue;
+
+		Mesh* mesh = meshManager->Get(entityVec[i]->GetMesh());
+		pCuller.RenderOccluder(&frameInstances[i].WorldMatrix.m[0][0],
+			&mesh->GetPositions()[0].x, sizeof(XMFLOAT3), mesh->GetPositions().size(),
+			mesh->GetIndices().data(), mesh->GetIndices().size());
+	}
+	pCuller.BuildHierarchy();
+
+	// Then test everything else
+	for (unsigned int i = 0; i < entityVec.size(); ++i)
+	{
+		if (pRenderOccluders && entityVec[i]->IsOccluder())
+		{
+			pVisible[i] = true;
+			continue;
+		}
+
+		Mesh* mesh = meshManager->Get(entityVec[i]->GetMesh());
+		XMFLOAT3 boundsMin = mesh->GetBoundsMin();
+		XMFLOAT3 boundsMax = mesh->GetBoundsMax();
+		pVisible[i] = pCuller.TestBounds(&frameInstances[i].WorldMatrix.m[0][0], &boundsMin.x, &boundsMax.x) == OcclusionCuller::Result::Visible;
+	}
+}
+
+// --------------------------------------------------------
+// Render queue key for an entity: one shader for now, then
+// its mesh's slot in the mesh manager (small, and never
+// shared by two live meshes), then its distance from the
+// camera
+// --------------------------------------------------------
+unsigned long long Game::MakeSortKey(unsigned int pEntity, const XMFLOAT3& pCameraPos)
+{
+	XMFLOAT3 entityPos = entityVec[pEntity]->GetTransform().GetPosition();
+	XMVECTOR offset = XMVectorSubtract(XMLoadFloat3(&entityPos), XMLoadFloat3(&pCameraPos));
+	float distance = XMVectorGetX(XMVector3Length(offset));
+	return RenderQueue::MakeKey(0, 0, entityVec[pEntity]->GetMesh().GetIndex(), distance);
+}
+
+// --------------------------------------------------------
+// Culls, sorts and records every camera that can share the
+// frame's depth test (the active camera's), each into its
+// own split-screen viewport.  Returns the views' lists
+// --------------------------------------------------------
+const std::vector<CommandList>& Game::DrawMultiView()
+{
+	// Active camera first, so the shared sort is by its distance
+	bool reversedZ = cameraVec[activeCameraIndex]->IsReversedZ();
+	viewCameras.assign(1, activeCameraIndex);
+	for (unsigned int i = 0; i < cameraVec.size(); ++i)
+	{
+		if (i != activeCameraIndex && cameraVec[i]->IsReversedZ() == reversedZ)
+			viewCameras.push_back(i);
+	}
+
+	// The active camera's matrices are already cached
+	viewProjections.resize(viewCameras.size());
+	viewCullingProjections.resize(viewCameras.size());
+	viewProjections[0] = cachedViewProj;
+	viewCullingProjections[0] = cachedCullingViewProj;
+	for (size_t view = 1; view < viewCameras.size(); ++view)
+	{
+		Camera& camera = *cameraVec[viewCameras[view]];
+		viewProjections[view] = camera.GetViewProjectionMatrix();
+		viewCullingProjections[view] = CullingViewProjection(camera);
+	}
+
+	multiViewRenderer->SetViewports(MultiViewRenderer::SplitScreen((unsigned int)viewCameras.size(), (float)Window::Width(), (float)Window::Height()));
+	XMFLOAT3 cameraPos = cameraVec[activeCameraIndex]->GetPosition();
+	const std::vector<CommandList>& lists = multiViewRenderer->Render((unsigned int)entityVec.size(),
+		[this](unsigned int view, OcclusionCuller& culler, std::vector<bool>& visible)
+		{
+			CullEntities(culler, viewCullingProjections[view], occlusionCullingEnabled, visible);
+		},
+		[this, &cameraPos](unsigned int entity) { return MakeSortKey(entity, cameraPos); },
+		[this](unsigned int entity) { return entityVec[entity]->GetMesh().value; },
+		[this](CommandList& commands, unsigned int view, const RenderQueue::DrawCall& call)
+		{
+			RecordDraw(commands, call, viewProjections[view]);
+		});
+
+	// Summed over the views, so it compares with a single view's recording
+	recordMs = 0.0;
+	for (unsigned int view = 0; view < multiViewRenderer->GetViewCount(); ++view)
+		recordMs += multiViewRenderer->GetViewStats(view).recordMs;
+	return lists;
+}
+
+
 // Pass ImGui new frame information at the start of update
 void Game::ImGuiNewFrameUpdate(float deltaTime)
 {
@@ -427,6 +1325,9 @@ void Game::ImGuiNewFrameUpdate(float deltaTime)
 	io.DisplaySize.x = (float)Window::Width();
 	io.DisplaySize.y = (float)Window::Height();
 
+	// Commit any glyphs finished by the font baker since last frame
+	FontBaker::Update();
+
 	//Reset the frame
 	ImGui_ImplDX11_NewFrame();
 	ImGui_ImplWin32_NewFrame();
@@ -446,6 +1347,10 @@ void Game::ImGuiBuildUI()
 	// Begin a new window
 	ImGui::Begin("Inspector");
 
+	// Tree node open states for large scenes make this window's
+	// storage big, so use the O(1) hash index instead of sorted inserts
+	ImGui::GetStateStorage()->SetUseHashIndex(true);
+
 	// App Info
 	if (ImGui::TreeNode("App Details"))
 	{
@@ -454,10 +1359,14 @@ void Game::ImGuiBuildUI()
 
 		// Show window size
 		ImGui::Text("Window Size: %dx%dpx", Window::Width(), Window::Height());
+		ImGui::Text("Resizes: %llu received, %llu applied, %llu messages dropped", Window::GetResizesReceived(), Window::GetResizesApplied(), Window::GetDroppedMessageCount());
 
 		// BG color picker
 		ImGui::ColorEdit4("BG Color", bgColor);
 
+		// Log console window
+		ImGui::Checkbox("Show log console", &showLogConsole);
+
 		ImGui::TreePop();
 	}
 
@@ -474,45 +1383,101 @@ void Game::ImGuiBuildUI()
 	{
 		for (unsigned int i = 0; i < meshVec.size(); ++i)
 		{
-			if (ImGui::TreeNode(meshVec[i]->GetName().c_str()))
+			Mesh* mesh = meshManager->Get(meshVec[i]);
+			if (ImGui::TreeNode(mesh->GetName().c_str()))
 			{
-				ImGui::Text("Triangles:"); ImGui::SameLine(); ImGui::Text(std::to_string(meshVec[i]->GetIndexCount() / 3).c_str());
-				ImGui::Text("Vertices:"); ImGui::SameLine(); ImGui::Text(std::to_string(meshVec[i]->GetVertexCount()).c_str());
-				ImGui::Text("Indices:"); ImGui::SameLine(); ImGui::Text(std::to_string(meshVec[i]->GetIndexCount()).c_str());
+				ImGui::Text("Triangles: %u", (unsigned int)(mesh->GetIndexCount() / 3));
+				ImGui::Text("Vertices: %u", (unsigned int)mesh->GetVertexCount());
+				ImGui::Text("Indices: %u", (unsigned int)mesh->GetIndexCount());
+				ImGui::Text("Handle: slot %u, generation %u, %u references", meshVec[i].GetIndex(), meshVec[i].GetGeneration(), meshManager->GetReferenceCount(meshVec[i]));
 				ImGui::TreePop();
 			}
 		}
+
+		MeshManager::Stats meshStats = meshManager->GetStats();
+		ImGui::Text("Pool: %u of %u slots, %u loads (%u deduplicated), %u unloads", meshStats.meshes, meshStats.capacity, meshStats.loads, meshStats.deduplicated, meshStats.unloads);
 		ImGui::TreePop();
 	}
 
 	// Entity controls
+	// Saving and reloading the whole scene
+	if (ImGui::TreeNode("Scene File"))
+	{
+		ImGui::Text("Loaded from: %s (%.2f ms reading, %.2f ms instantiating)", sceneSource.c_str(), sceneReadMs, sceneInstantiateMs);
+		ImGui::Text("%zu entities, %zu cameras", entityVec.size(), cameraVec.size());
+
+		// Binary to load fast, JSON to diff and edit
+		if (ImGui::Button("Save"))
+		{
+			SceneData scene;
+			GatherScene(scene);
+			sceneSaver->Save(std::move(scene), FixPath("Scene.bin"), FixPath("Scene.json"));
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Reload"))
+			LoadScene(FixPath("Scene.bin"), false);
+		ImGui::SameLine();
+		if (ImGui::Button("Reload from JSON"))
+			LoadScene(FixPath("Scene.json"), true);
+		ImGui::SameLine();
+		if (ImGui::Button("Use built-in"))
+		{
+			SceneData scene;
+			BuildDefaultScene(scene);
+			InstantiateScene(scene);
+			sceneSource = "Built in";
+			sceneReadMs = 0.0;
+			sceneInstantiateMs = 0.0;
+		}
+
+		// The whole reload should take under 100 ms for a million entities
+		if (ImGui::Button("Time a 1M entity reload"))
+			TimeSceneReload(1000000);
+		if (reloadTestEntities > 0 && !reloadTestSucceeded)
+			ImGui::Text("Reload of %u entities FAILED", reloadTestEntities);
+		else if (reloadTestEntities > 0)
+			ImGui::Text("%u entities: %.1f ms reading + %.1f ms instantiating = %.1f ms (target: under 100)", reloadTestEntities, reloadTestReadMs, reloadTestInstantiateMs, reloadTestReadMs + reloadTestInstantiateMs);
+
+		if (sceneSaver->IsBusy())
+			ImGui::Text("Saving...");
+		else if (sceneSaver->GetLastSaveMs() > 0.0)
+			ImGui::Text("Last save: %s (%.2f ms in the background)", sceneSaver->Succeeded() ? "saved" : "FAILED", sceneSaver->GetLastSaveMs());
+
+		ImGui::TreePop();
+	}
+
 	if (ImGui::TreeNode("Scene Entities"))
 	{
 		for (unsigned int i = 0; i < entityVec.size(); ++i)
 		{
-			if (ImGui::TreeNode(std::string("Entity " + std::to_string(i)).c_str()))
+			if (ImGui::TreeNode(frameArena->Format("Entity %u", i)))
 			{
 				// Name
-				ImGui::Text(entityVec[i]->GetMesh()->GetName().c_str());
+				ImGui::Text("%s", meshManager->Get(entityVec[i]->GetMesh())->GetName().c_str());
 
 				// Position
 				XMFLOAT3 position = entityVec[i]->GetTransform().GetPosition();
 				float posArray[3] = { position.x, position.y, position.z };
-				ImGui::DragFloat3(std::string("Position##" + std::to_string(i)).c_str(), posArray, 0.01f, -1.0f, 1.0f);
+				ImGui::DragFloat3(frameArena->Format("Position##%u", i), posArray, 0.01f, -1.0f, 1.0f);
 				entityVec[i]->GetTransform().SetPosition(posArray[0], posArray[1], posArray[2]);
 
 				// Rotation
 				XMFLOAT3 rotation = entityVec[i]->GetTransform().GetPitchYawRoll();
 				float rotArray[3] = { rotation.x, rotation.y, rotation.z };
-				ImGui::DragFloat3(std::string("Rotation##" + std::to_string(i)).c_str(), rotArray, 0.01f, -4.0f, 4.0f);
+				ImGui::DragFloat3(frameArena->Format("Rotation##%u", i), rotArray, 0.01f, -4.0f, 4.0f);
 				entityVec[i]->GetTransform().SetRotation(rotArray[0], rotArray[1], rotArray[2]);
 
 				// Scale
 				XMFLOAT3 scale = entityVec[i]->GetTransform().GetScale();
 				float scArray[3] = { scale.x, scale.y, scale.z };
-				ImGui::DragFloat3(std::string("Scale##" + std::to_string(i)).c_str(), scArray, 0.01f, 0.0f, 10.0f);
+				ImGui::DragFloat3(frameArena->Format("Scale##%u", i), scArray, 0.01f, 0.0f, 10.0f);
 				entityVec[i]->GetTransform().SetScale(scArray[0], scArray[1], scArray[2]);
 
+				// Occlusion culling role
+				bool isOccluder = entityVec[i]->IsOccluder();
+				if (ImGui::Checkbox(frameArena->Format("Occluder##%u", i), &isOccluder))
+					entityVec[i]->SetOccluder(isOccluder);
+
 				ImGui::TreePop();
 			}
 		}
@@ -535,7 +1500,7 @@ void Game::ImGuiBuildUI()
 
 		// Camera index label
 		ImGui::SameLine();
-		ImGui::Text(std::string("Active Camera: " + std::to_string(activeCameraIndex)).c_str());
+		ImGui::Text("Active Camera: %u", activeCameraIndex);
 
 		// Position
 		XMFLOAT3 cameraPos = cameraVec[activeCameraIndex]->GetPosition();
@@ -546,9 +1511,279 @@ void Game::ImGuiBuildUI()
 		float cameraFov = cameraVec[activeCameraIndex]->GetFov();
 		ImGui::DragFloat("FOV Angle", &cameraFov, 0.0f);
 
+		// Projection
+		std::shared_ptr<Camera> activeCamera = cameraVec[activeCameraIndex];
+		bool perspective = activeCamera->IsPerspective();
+		if (ImGui::Checkbox("Perspective", &perspective))
+			activeCamera->SetPerspective(perspective);
+		ImGui::SameLine();
+		bool reversedZ = activeCamera->IsReversedZ();
+		if (ImGui::Checkbox("Reversed Z", &reversedZ))
+			activeCamera->SetReversedZ(reversedZ);
+		if (!perspective)
+		{
+			float orthographicWidth = activeCamera->GetOrthographicWidth();
+			if (ImGui::DragFloat("Ortho Width", &orthographicWidth, 0.05f, 0.1f, 1000.0f))
+				activeCamera->SetOrthographicWidth(orthographicWidth);
+		}
+
+		// Matrices are only rebuilt (and copied) when the camera changes
+		ImGui::Text("Version: %llu", activeCamera->GetVersion());
+		ImGui::Text("View rebuilds: %u, cache refreshes: %u", activeCamera->GetViewUpdateCount(), cameraCacheUpdates);
+
+		ImGui::TreePop();
+	}
+
+	// CPU occlusion culling stats
+	if (ImGui::TreeNode("Occlusion Culling"))
+	{
+		ImGui::Checkbox("Enabled", &occlusionCullingEnabled);
+		ImGui::Text("Rasterizer: %s, %dx%d", OcclusionCuller::UsesSIMD() ? "SSE2" : "scalar", occlusionCuller->GetWidth(), occlusionCuller->GetHeight());
+
+		OcclusionCuller::Stats cullStats = occlusionCuller->GetStats();
+		int culledCount = cullStats.occludedObjects + cullStats.outsideViewObjects;
+		ImGui::Text("Occluder triangles: %d (%d rasterized)", cullStats.occluderTriangles, cullStats.rasterizedTriangles);
+		ImGui::Text("Occluded: %d / %d (%.1f%%)", cullStats.occludedObjects, cullStats.testedObjects,
+			cullStats.testedObjects > 0 ? 100.0f * cullStats.occludedObjects / cullStats.testedObjects : 0.0f);
+		ImGui::Text("Outside view: %d, total culled: %d", cullStats.outsideViewObjects, culledCount);
+		ImGui::Text("Cull time: %.3f ms", occlusionCullingEnabled ? occlusionCullMs : 0.0);
+
+		ImGui::TreePop();
+	}
+
+	// Render queue stats for the last frame
+	if (ImGui::TreeNode("Render Queue"))
+	{
+		RenderQueue::Stats queueStats = renderQueue.GetStats();
+		ImGui::Text("Draw calls: %d", queueStats.drawCalls);
+		ImGui::Text("Shader binds: %d (%d skipped)", queueStats.shaderBinds, queueStats.shaderBindsSkipped);
+		ImGui::Text("Mesh binds: %d (%d skipped)", queueStats.meshBinds, queueStats.meshBindsSkipped);
+		ImGui::Text("Commands: %u (%.1f KB)", frameCommands.GetCommandCount(), frameCommands.GetByteSize() / 1024.0f);
+		ImGui::Checkbox("Record in parallel", &parallelRecording);
+		if (parallelRecording)
+			ImGui::Text("Chunks: %d", (int)parallelRecorder.GetChunks().size());
+		ImGui::Text("Recording: %.3f ms", recordMs);
+		if (ImGui::Button("Capture frame commands"))
+			captureFrameCommands = true;
+		ImGui::SameLine();
+		if (ImGui::Button("Save software render"))
+			captureSoftwareFrame = true;
+
+		ImGui::TreePop();
+	}
+
+	// Every camera at once, each with its own cull and record cost
+	if (ImGui::TreeNode("Multi-view"))
+	{
+		ImGui::Checkbox("Draw every camera", &multiViewEnabled);
+		ImGui::TextWrapped("Cameras with a different Reversed Z setting than the active camera are left out.");
+		if (multiViewEnabled)
+		{
+			MultiViewRenderer::Stats multiViewStats = multiViewRenderer->GetStats();
+			ImGui::Text("Sorted once: %d objects (%d summed over views)", multiViewStats.sortedObjects, multiViewStats.viewObjects);
+			ImGui::Text("Sort: %.3f ms, total: %.3f ms", multiViewStats.sortMs, multiViewStats.totalMs);
+			for (unsigned int view = 0; view < multiViewRenderer->GetViewCount(); ++view)
+			{
+				MultiViewRenderer::ViewStats viewStats = multiViewRenderer->GetViewStats(view);
+				ImGui::BulletText("Camera %u: %d visible, %d draws, %d mesh binds", viewCameras[view], viewStats.visibleObjects, viewStats.drawCalls, viewStats.meshBinds);
+				ImGui::Indent();
+				ImGui::Text("Cull %.3f ms, record %.3f ms", viewStats.cullMs, viewStats.recordMs);
+				ImGui::Unindent();
+			}
+		}
+
+		ImGui::TreePop();
+	}
+
+	// Shader compiles, cache use and hot reloads
+	if (ImGui::TreeNode("Shaders"))
+	{
+		// Feature bits pick the variants in use, which load on first use
+		bool featuresChanged = false;
+		for (const std::string& feature : vertexPermutations->GetFeatures())
+			featuresChanged |= ImGui::CheckboxFlags(frameArena->Format("Vertex: %s", feature.c_str()), &vertexFeatures, vertexPermutations->GetFeatureBit(feature));
+		for (const std::string& feature : pixelPermutations->GetFeatures())
+			featuresChanged |= ImGui::CheckboxFlags(frameArena->Format("Pixel: %s", feature.c_str()), &pixelFeatures, pixelPermutations->GetFeatureBit(feature));
+		if (featuresChanged)
+			SelectShaders();
+
+		ShaderManager::Stats shaderStats = shaderManager->GetStats();
+		ImGui::Text("Variants: %d, input layouts: %d", shaderStats.shaders, (int)inputLayoutCache.size());
+		ImGui::Text("Cache hits: %u, misses: %u", shaderStats.cacheHits, shaderStats.cacheMisses);
+		ImGui::Text("Compiles: %u (%u failed), last %.1f ms", shaderStats.compiles, shaderStats.failedCompiles, shaderStats.lastCompileMs);
+		ImGui::Text("Reloads: %u, compiling: %d", shaderStats.reloads, shaderStats.pendingCompiles);
+		for (unsigned int i = 0; i < shaderManager->GetShaderCount(); ++i)
+		{
+			const ShaderManager::ShaderDesc& desc = shaderManager->GetDesc(i);
+			FrameString defines{ FrameAllocator<char>(frameArena.get()) };
+			for (const std::pair<std::string, std::string>& define : desc.defines)
+				defines.append(" ").append(define.first.c_str()).append("=").append(define.second.c_str());
+			ImGui::BulletText("%s (%s%s): version %u%s", desc.sourcePath.c_str(), desc.target.c_str(), defines.c_str(), shaderManager->GetVersion(i), shaderManager->IsLoaded(i) ? "" : ", NOT LOADED");
+			if (!shaderManager->GetErrors(i).empty())
+				ImGui::TextWrapped("%s", shaderManager->GetErrors(i).c_str());
+		}
+		if (ImGui::Button("Reload shaders"))
+		{
+			for (unsigned int i = 0; i < shaderManager->GetShaderCount(); ++i)
+				shaderManager->Reload(i);
+		}
+
+		ImGui::TreePop();
+	}
+
+	// Per-frame scratch memory, and the heap allocations that slip past it
+	if (ImGui::TreeNode("Frame Memory"))
+	{
+		FrameArena::Stats arenaStats = frameArena->GetStats();
+		ImGui::Text("Heap allocations last frame: %llu (%llu on the main thread)", frameAllocations, frameThreadAllocations);
+		ImGui::Text("Arena: %.1f KB so far this frame, peak %.1f KB", arenaStats.frameBytes / 1024.0f, arenaStats.peakFrameBytes / 1024.0f);
+		ImGui::Text("Reserved: %.1f KB for %u threads, double buffered", arenaStats.capacity / 1024.0f, frameArena->GetThreadCount());
+		ImGui::Text("Block allocations: %u (%u overflows)", arenaStats.blockAllocations, arenaStats.overflows);
+
+		ImGui::TreePop();
+	}
+
+	// Live heap memory by subsystem, against its budget
+	if (ImGui::TreeNode("Memory"))
+	{
+		if (ImGui::BeginTable("MemoryTags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Tag");
+			ImGui::TableSetupColumn("Live KB");
+			ImGui::TableSetupColumn("Peak KB");
+			ImGui::TableSetupColumn("Allocs/s");
+			ImGui::TableSetupColumn("Budget");
+			ImGui::TableHeadersRow();
+
+			for (int i = 0; i < (int)MemoryTracker::Tag::Count; i++)
+			{
+				MemoryTracker::Stats stats = MemoryTracker::GetStats((MemoryTracker::Tag)i);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", MemoryTracker::GetName((MemoryTracker::Tag)i));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f (%lld)", stats.liveBytes / 1024.0, stats.liveAllocations);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", stats.peakBytes / 1024.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.0f", stats.allocationsPerSecond);
+				ImGui::TableNextColumn();
+				if (stats.budgetBytes == 0)
+					ImGui::TextDisabled("None");
+				else if (stats.overBudget)
+					ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Over %.1f MB", stats.budgetBytes / (1024.0 * 1024.0));
+				else
+					ImGui::Text("%.0f%% of %.1f MB", stats.liveBytes * 100.0 / stats.budgetBytes, stats.budgetBytes / (1024.0 * 1024.0));
+			}
+			ImGui::EndTable();
+		}
+
+		ImGui::TreePop();
+	}
+
+	// Background loading progress
+	if (ImGui::TreeNode("Asset Streaming"))
+	{
+		AssetStreamer::Stats streamStats = assetStreamer->GetStats();
+		ImGui::Text("Queued: %u, decoding: %u, waiting for upload: %u", streamStats.queued, streamStats.decoding, streamStats.ready);
+		ImGui::Text("Completed: %u, failed: %u", streamStats.completed, streamStats.failed);
+		ImGui::Text("Read: %.1f MB, %.1f MB waiting", streamStats.bytesRead / (1024.0 * 1024.0), streamStats.bufferedBytes / (1024.0 * 1024.0));
+		ImGui::Text("Uploaded last frame: %.1f of %.1f KB", streamStats.uploadedLastFrame / 1024.0, streamStats.uploadBytesPerFrame / 1024.0);
+		ImGui::Text("Reads: %s, %u past the OS cache", streamStats.ioRing ? "io_uring" : "std::ifstream", streamStats.unbufferedReads);
+
+		ImGui::TreePop();
+	}
+
+	// Queued input and how long it takes to reach the screen
+	if (ImGui::TreeNode("Input"))
+	{
+		ImGui::Text("Events this frame: %zu, dropped: %llu", Input::GetFrameEvents().size(), Input::GetDroppedEventCount());
+		ImGui::Text("Oldest waited %.2f ms to be sampled", inputWaitMs);
+		ImGui::Text("Input to present: %.2f ms (average %.2f, peak %.2f)", inputToPresentMs, inputToPresentAverageMs, inputToPresentPeakMs);
+		ImGui::Text("(The display's scanout comes after present)");
+		if (ImGui::Button("Reset peak"))
+			inputToPresentPeakMs = 0.0;
+
+		// Rerun exactly the same frames later (also "-replay Recording.inp -exit")
+		if (Input::IsReplaying())
+		{
+			ImGui::Text("Replaying frame %u of %u", Input::GetReplayFrame(), Input::GetReplayFrameCount());
+			if (ImGui::Button("Stop replay"))
+				Input::StopReplay();
+		}
+		else if (Input::IsRecording())
+		{
+			ImGui::Text("Recording: %u frames", Input::GetRecordedFrameCount());
+			if (ImGui::Button("Stop and save"))
+				Input::StopRecording(FixPath("Recording.inp"));
+		}
+		else
+		{
+			if (ImGui::Button("Record"))
+				Input::StartRecording();
+			ImGui::SameLine();
+			if (ImGui::Button("Replay Recording.inp"))
+				Input::StartReplay(FixPath("Recording.inp"));
+		}
+
+		ImGui::TreePop();
+	}
+
+	// Frame cap and how deep frames queue
+	if (ImGui::TreeNode("Frame Pacing"))
+	{
+		if (ImGui::Checkbox("Latency mode (one frame queued)", &latencyMode))
+			Graphics::SetMaximumFrameLatency(latencyMode ? 1 : 3);
+		if (ImGui::SliderInt("Frame cap (0 for none)", &frameCap, 0, 500))
+			framePacer->SetTargetFps(frameCap);
+
+		FramePacer::Stats pacerStats = framePacer->GetStats();
+		ImGui::Text("Maximum frame latency: %u", Graphics::GetMaximumFrameLatency());
+		ImGui::Text("Waited for the swap chain: %.2f ms", swapChainWaitMs);
+		ImGui::Text("Frame cap: slept %.2f ms, spun %.2f ms (margin %.2f ms)", pacerStats.lastSleepMs, pacerStats.lastSpinMs, pacerStats.spinMarginMs);
+		ImGui::Text("Late: %.3f ms, worst %.3f ms, %llu frames missed", pacerStats.lastLateMs, pacerStats.maxLateMs, pacerStats.missedFrames);
+		ImGui::Text("Input sample to present: %.2f ms (average %.2f)", sampleToPresentMs, sampleToPresentAverageMs);
+
+		ImGui::TreePop();
+	}
+
+	// Vertices written on jobs and uploaded a few ranges at a time
+	if (ImGui::TreeNode("Dynamic Mesh"))
+	{
+		if (ImGui::Checkbox("Wave grid (single view only)", &waveMeshEnabled) && waveMeshEnabled && !waveMesh)
+			CreateWaveMesh();
+
+		if (waveMesh)
+		{
+			DynamicMesh::Stats waveStats = waveMesh->GetStats();
+			ImGui::Text("%zu vertices, %u copies in a %.1f KB buffer", waveMesh->GetVertexCount(), waveStats.copies,
+				sizeof(Vertex) * waveMesh->GetVertexCount() * waveStats.copies / 1024.0f);
+			ImGui::Text("Written on jobs in %.3f ms", waveWriteMs);
+			ImGui::Text("Last upload: %u ranges, %.1f of %.1f KB", waveStats.lastRanges,
+				sizeof(Vertex) * waveStats.lastVertices / 1024.0f, sizeof(Vertex) * waveMesh->GetVertexCount() / 1024.0f);
+			ImGui::Text("Uploaded %.1f MB over %llu uploads", waveStats.uploadedBytes / (1024.0f * 1024.0f), waveStats.uploads);
+		}
+
+		ImGui::TreePop();
+	}
+
+	// Glyph rasterization stats
+	if (ImGui::TreeNode("Font Baking"))
+	{
+		FontBaker::Stats fontStats = FontBaker::GetStats();
+		ImGui::Text("Pending glyphs: %d", fontStats.pendingGlyphs);
+		ImGui::Text("Rasterized on workers: %d", fontStats.asyncGlyphs);
+		ImGui::Text("Rasterized on main thread: %d", fontStats.syncGlyphs);
+		ImGui::Text("Loaded from cache: %d", fontStats.cachedGlyphs);
+		ImGui::Text("Cache: %d glyphs, %.1f KB", fontStats.cacheEntries, fontStats.cacheBytes / 1024.0f);
+
 		ImGui::TreePop();
 	}
 
 	// End ImGui creation
 	ImGui::End();
+
+	// Log console (its own window)
+	if (showLogConsole)
+		Log::DrawConsole("Log", &showLogConsole);
 }
\ No newline at end of file
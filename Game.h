@@ -6,7 +6,23 @@
 #include <vector>
 #include "Entity.h"
 #include "Mesh.h"
+#include "MeshManager.h"
 #include "Camera.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
+#include "RenderCommands.h"
+#include "D3D11Backend.h"
+#include "ParallelRecorder.h"
+#include "MultiViewRenderer.h"
+#include "SoftwareBackend.h"
+#include "ShaderPermutations.h"
+#include "FrameArena.h"
+#include "MemoryTracker.h"
+#include "AssetStreamer.h"
+#include "SceneFile.h"
+#include "FramePacer.h"
+#include "DynamicMesh.h"
+#include "BufferStructs.h"
 
 class Game
 {
@@ -21,6 +37,7 @@ public:
 	void Update(float deltaTime, float totalTime);
 	void Draw(float deltaTime, float totalTime);
 	void OnResize();
+	void WaitForNextFrame();
 
 private:
 
@@ -37,40 +54,156 @@ private:
 	//Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
 	//Microsoft::WRL::ComPtr<ID3D11Buffer> indexBuffer;
 
-	// Shaders and shader-related constructs
+	// Shaders and shader-related constructs (the variants in use)
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> pixelShader;
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> vertexShader;
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
 
+	// Compiles, caches and hot-reloads every variant of the shaders
+	void SelectShaders();
+	std::shared_ptr<ShaderManager> shaderManager;
+	std::shared_ptr<ShaderPermutations> vertexPermutations;
+	std::shared_ptr<ShaderPermutations> pixelPermutations;
+	unsigned int vertexFeatures;
+	unsigned int pixelFeatures;
+	bool shadersChanged;
+
+	// Every loaded variant, indexed by the manager's shader id
+	std::vector<Microsoft::WRL::ComPtr<ID3D11VertexShader>> vertexShaders;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11InputLayout>> vertexShaderLayouts;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11PixelShader>> pixelShaders;
+
+	// Layouts built from reflection, shared by variants with the same inputs
+	std::vector<std::pair<unsigned long long, Microsoft::WRL::ComPtr<ID3D11InputLayout>>> inputLayoutCache;
+
 	// ImGui update helper
 	void ImGuiNewFrameUpdate(float deltaTime);
 	void ImGuiBuildUI();
 
+	// Active camera's matrices, refreshed only when its version changes
+	void UpdateCameraCache();
+	Camera* cachedCamera;
+	unsigned long long cachedCameraVersion;
+	DirectX::XMFLOAT4X4 cachedViewProj;
+	DirectX::XMFLOAT4X4 cachedCullingViewProj;	// Forward Z, for the occlusion culler
+	unsigned int cameraCacheUpdates;
+
+	// Every entity's world matrix and tint for the current frame,
+	// updated once before anything (on any thread, for any view)
+	// reads them, then uploaded once for every view to draw from.
+	// The wave demo's instance comes after the entities
+	std::vector<InstanceData> frameInstances;
+
+	// Scratch memory for data that only lives for a frame, and
+	// the heap allocations each frame still makes
+	std::shared_ptr<FrameArena> frameArena;
+	unsigned long long frameAllocationStart;
+	unsigned long long frameThreadAllocationStart;
+	unsigned long long frameAllocations;
+	unsigned long long frameThreadAllocations;		// Main thread only
+
+	// Occlusion culling
+	void CullEntities(OcclusionCuller& pCuller, const DirectX::XMFLOAT4X4& pCullingViewProj, bool pRenderOccluders, std::vector<bool>& pVisible);
+	std::shared_ptr<OcclusionCuller> occlusionCuller;
+	std::vector<bool> entityVisible;
+	bool occlusionCullingEnabled;
+	double occlusionCullMs;
+
+	// Sorted draws for the current frame
+	unsigned long long MakeSortKey(unsigned int pEntity, const DirectX::XMFLOAT3& pCameraPos);
+	RenderQueue renderQueue;
+
+	// Recorded commands for the current frame, and what executes them
+	CommandList frameCommands;
+	std::shared_ptr<D3D11Backend> d3d11Backend;
+	bool captureFrameCommands;
+
+	// Draws split into chunks and recorded on the JobSystem
+	void RecordDraw(CommandList& pCommands, const RenderQueue::DrawCall& pCall, const DirectX::XMFLOAT4X4& pViewProj);
+	ParallelRecorder parallelRecorder;
+	bool parallelRecording;
+	double recordMs;
+
+	// Every camera with the active camera's depth convention at
+	// once, the active one first, each in a split-screen viewport
+	const std::vector<CommandList>& DrawMultiView();
+	std::shared_ptr<MultiViewRenderer> multiViewRenderer;
+	std::vector<unsigned int> viewCameras;	// Indices into cameraVec
+	std::vector<DirectX::XMFLOAT4X4> viewProjections;
+	std::vector<DirectX::XMFLOAT4X4> viewCullingProjections;
+	bool multiViewEnabled;
+
+	// CPU reference renderer, created at the window size when a frame is saved with it
+	std::shared_ptr<SoftwareBackend> softwareBackend;
+	bool captureSoftwareFrame;
+
 	// Constant buffer
 	Microsoft::WRL::ComPtr<ID3D11Buffer> constBuffer;
 
+	// GREATER depth test, for cameras with reversed Z
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> reversedDepthState;
+
+	// Loads files in the background, nearest the active camera first
+	std::shared_ptr<AssetStreamer> assetStreamer;
+
+	// How long the oldest input each frame used had been waiting
+	double inputWaitMs;				// When Input::Update() sampled it
+	double inputToPresentMs;		// When Present() returned
+	double inputToPresentAverageMs;
+	double inputToPresentPeakMs;
+
+	// Frame pacing: a frame limiter, and in latency mode only
+	// one frame queued, waited for before input is sampled
+	std::shared_ptr<FramePacer> framePacer;
+	bool latencyMode;
+	int frameCap;						// Zero for none
+	double swapChainWaitMs;
+	double sampleToPresentMs;			// Every frame, input or not
+	double sampleToPresentAverageMs;
+
+	// A grid a ripple rolls across, written by jobs a band of
+	// rows at a time and uploaded only where it changed
+	void CreateWaveMesh();
+	void UpdateWaveMesh(float totalTime);
+	std::shared_ptr<DynamicMesh> waveMesh;		// Created when first turned on
+	bool waveMeshEnabled;
+	unsigned int waveFirstRow;			// Rows the ripple covered last frame
+	unsigned int waveEndRow;
+	double waveWriteMs;
+
 	// Mesh container
-	std::vector<std::shared_ptr<Mesh>> meshVec;
+	std::shared_ptr<MeshManager> meshManager;
+	TrackedVector<MeshHandle, MemoryTracker::Tag::Meshes> meshVec;	// One Load() each
 
 	// Entity container
-	std::vector<std::shared_ptr<Entity>> entityVec;
+	TrackedVector<std::shared_ptr<Entity>, MemoryTracker::Tag::Entities> entityVec;
 
 	// Camera container
 	std::vector<std::shared_ptr<Camera>> cameraVec;
 	unsigned int activeCameraIndex;
-	std::shared_ptr<Camera> camera1;
-	std::shared_ptr<Camera> camera2;
+
+	// Entities and cameras come from scene files, or the built-in scene
+	void BuildDefaultScene(SceneData& pScene);
+	void GatherScene(SceneData& pScene);
+	void InstantiateScene(const SceneData& pScene);
+	bool LoadScene(const std::string& pPath, bool pIsText);
+	void StreamScene(const std::string& pPath);
+	void TimeSceneReload(unsigned int pEntityCount);
+	std::shared_ptr<SceneSaver> sceneSaver;
+	std::string sceneSource;
+	double sceneReadMs;
+	double sceneInstantiateMs;
+	bool sceneStreaming;			// Until the streamed scene arrives or another replaces it
+
+	// The last timed reload of a generated scene
+	unsigned int reloadTestEntities;
+	bool reloadTestSucceeded;
+	double reloadTestReadMs;
+	double reloadTestInstantiateMs;
 
 	// Test meshes
-	std::shared_ptr<Mesh> triangleMesh;
-	std::shared_ptr<Mesh> quadMesh;
-	std::shared_ptr<Mesh> weirdMesh;
-
-	// Test entities
-	std::shared_ptr<Entity> testEntity1;
-	std::shared_ptr<Entity> testEntity2;
-	std::shared_ptr<Entity> testEntity3;
-	std::shared_ptr<Entity> testEntity4;
-	std::shared_ptr<Entity> testEntity5;
+	MeshHandle triangleMesh;
+	MeshHandle quadMesh;
+	MeshHandle weirdMesh;
 };
 
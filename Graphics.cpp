@@ -1,5 +1,7 @@
 #include "Graphics.h"
+#include "Log.h"
 #include <dxgi1_6.h>
+#include <vector>
 
 // Tell the drivers to use high-performance GPU in multi-GPU systems (like laptops)
 extern "C"
@@ -16,11 +18,19 @@ namespace Graphics
 	{
 		bool apiInitialized = false;
 		bool supportsTearing = false;
+		UINT swapChainFlags = 0;
 		bool vsyncDesired = false;
 		BOOL isFullscreen = false;
 
 		D3D_FEATURE_LEVEL featureLevel{};
 
+		// Reused for every debug message, rather than allocating each one
+		std::vector<char> debugMessageBuffer;
+
+		// Signaled when the swap chain can take another frame
+		HANDLE frameLatencyWaitableObject = 0;
+		unsigned int maximumFrameLatency = 0;
+
 	}
 }
 
@@ -95,7 +105,8 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 	swapDesc.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
 	swapDesc.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
 	swapDesc.BufferUsage		= DXGI_USAGE_RENDER_TARGET_OUTPUT;
-	swapDesc.Flags				= supportsTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0;
+	swapChainFlags				= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | (supportsTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+	swapDesc.Flags				= swapChainFlags;
 	swapDesc.OutputWindow		= windowHandle;
 	swapDesc.SampleDesc.Count	= 1;
 	swapDesc.SampleDesc.Quality = 0;
@@ -148,6 +159,15 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 	// We're set up
 	apiInitialized = true;
 
+	// Frames queue up to the usual 3 deep until told otherwise.  The
+	// waitable object needs IDXGISwapChain2 (Windows 8.1 and up)
+	Microsoft::WRL::ComPtr<IDXGISwapChain2> swapChain2;
+	if (SUCCEEDED(SwapChain.As(&swapChain2)))
+	{
+		frameLatencyWaitableObject = swapChain2->GetFrameLatencyWaitableObject();
+		SetMaximumFrameLatency(3);
+	}
+
 	// Call ResizeBuffers(), which will also set up the 
 	// render target view and depth stencil view for the
 	// various buffers we need for rendering. This call 
@@ -175,6 +195,9 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 // --------------------------------------------------------
 void Graphics::ShutDown()
 {
+	if (frameLatencyWaitableObject)
+		CloseHandle(frameLatencyWaitableObject);
+	frameLatencyWaitableObject = 0;
 }
 
 
@@ -204,7 +227,7 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height)
 		width, 
 		height, 
 		DXGI_FORMAT_R8G8B8A8_UNORM, 
-		supportsTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+		swapChainFlags);
 
 	// Grab the references to the first buffer
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> backBufferTexture;
@@ -267,7 +290,39 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height)
 
 
 // --------------------------------------------------------
-// Prints graphics debug messages waiting in the queue
+// Blocks until the swap chain can take another frame,
+// which is at most the maximum frame latency behind the
+// display.  Call this at the start of a frame, before
+// sampling input, so the input isn't left waiting in a
+// queue of frames.  Gives up after 100 ms, in case
+// nothing is being displayed
+// --------------------------------------------------------
+void Graphics::WaitForFrameLatency()
+{
+	if (frameLatencyWaitableObject)
+		WaitForSingleObjectEx(frameLatencyWaitableObject, 100, true);
+}
+
+
+// --------------------------------------------------------
+// How many frames can be queued before the CPU waits for
+// the GPU and display.  One is the lowest latency, at the
+// cost of the CPU and GPU overlapping less
+// --------------------------------------------------------
+void Graphics::SetMaximumFrameLatency(unsigned int frames)
+{
+	Microsoft::WRL::ComPtr<IDXGISwapChain2> swapChain2;
+	if (frames == 0 || !SwapChain || FAILED(SwapChain.As(&swapChain2)))
+		return;
+	if (SUCCEEDED(swapChain2->SetMaximumFrameLatency(frames)))
+		maximumFrameLatency = frames;
+}
+
+unsigned int Graphics::GetMaximumFrameLatency() { return maximumFrameLatency; }
+
+
+// --------------------------------------------------------
+// Sends graphics debug messages waiting in the queue to the log
 // --------------------------------------------------------
 void Graphics::PrintDebugMessages()
 {
@@ -280,43 +335,34 @@ void Graphics::PrintDebugMessages()
 	if (messageCount == 0)
 		return;
 
-	// Loop and print messages
+	// Loop and log messages
 	for (UINT64 i = 0; i < messageCount; i++)
 	{
-		// Get the size so we can reserve space
+		// Get the size so we can make sure there's enough space
 		size_t messageSize = 0;
 		InfoQueue->GetMessage(i, 0, &messageSize);
+		if (debugMessageBuffer.size() < messageSize)
+			debugMessageBuffer.resize(messageSize);
+
+		D3D11_MESSAGE* message = (D3D11_MESSAGE*)debugMessageBuffer.data();
+		if (FAILED(InfoQueue->GetMessage(i, message, &messageSize)))
+			continue;
 
-		// Reserve space for this message
-		D3D11_MESSAGE* message = (D3D11_MESSAGE*)malloc(messageSize);
-		InfoQueue->GetMessage(i, message, &messageSize);
-		
-		// Print and clean up memory
-		if (message)
+		// Map severity to the log's
+		Log::Severity severity = Log::Severity::Info;
+		switch (message->Severity)
 		{
-			// Color code based on severity
-			switch (message->Severity)
-			{
-			case D3D11_MESSAGE_SEVERITY_CORRUPTION:
-			case D3D11_MESSAGE_SEVERITY_ERROR:
-				printf("\x1B[91m"); break; // RED
-
-			case D3D11_MESSAGE_SEVERITY_WARNING:
-				printf("\x1B[93m"); break; // YELLOW
-
-			case D3D11_MESSAGE_SEVERITY_INFO:
-			case D3D11_MESSAGE_SEVERITY_MESSAGE:
-				printf("\x1B[96m"); break; // CYAN
-			}
-
-			printf("%s\n\n", message->pDescription);
-			free(message);
-
-			// Reset color
-			printf("\x1B[0m");
+		case D3D11_MESSAGE_SEVERITY_CORRUPTION:
+		case D3D11_MESSAGE_SEVERITY_ERROR:
+			severity = Log::Severity::Error; break;
+
+		case D3D11_MESSAGE_SEVERITY_WARNING:
+			severity = Log::Severity::Warning; break;
 		}
+
+		Log::Write(severity, Log::Category::Graphics, "%s", message->pDescription);
 	}
 
-	// Clear any messages we've printed
+	// Clear any messages we've logged
 	InfoQueue->ClearStoredMessages();
 }
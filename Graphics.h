@@ -35,6 +35,11 @@ namespace Graphics
 	void ShutDown();
 	void ResizeBuffers(unsigned int width, unsigned int height);
 
+	// Frame latency
+	void WaitForFrameLatency();
+	void SetMaximumFrameLatency(unsigned int frames);
+	unsigned int GetMaximumFrameLatency();
+
 	// Debug Layer
 	void PrintDebugMessages();
 }
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "IORing.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+// The kernel's ring interface, without liburing
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IORING_SUPPORTED
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// --------------- Basic usage -----------------
+//
+// Asynchronous file reads through Linux's io_uring, for
+// the AssetStreamer's IO thread:
+//
+//   IORing ring(16);
+//   if (ring.IsAvailable())
+//   {
+//       ring.Read(file, buffer, length, offset, tag);	// Up to GetEntries() at once
+//       ring.Wait(tag, result);						// Submits, then reaps one
+//   }
+//
+// Reads are queued in the submission ring and handed to
+// the kernel in one system call by the next Wait(), which
+// then sleeps until any of them finishes.  Completions
+// come back in whatever order the device finished them,
+// tagged with the user data they were queued with.
+//
+// Talks to the kernel with raw system calls, so it needs
+// nothing but the kernel headers.  Everywhere else (and on
+// kernels without io_uring, or where it's blocked)
+// IsAvailable() is false and callers use ordinary reads.
+// One thread at a time only.
+// ---------------------------------------------
+
+IORing::IORing(unsigned int pEntries) :
+	ring(-1),
+	entries(0),
+	queued(0),
+	inFlight(0),
+	sqMemory(0),
+	cqMemory(0),
+	sqeMemory(0),
+	sqMemorySize(0),
+	cqMemorySize(0),
+	sqeMemorySize(0),
+	sqHead(0),
+	sqTail(0),
+	sqMask(0),
+	sqArray(0),
+	cqHead(0),
+	cqTail(0),
+	cqMask(0),
+	cqes(0)
+{
+#ifdef IORING_SUPPORTED
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+	int fd = (int)syscall(__NR_io_uring_setup, pEntries, &params);
+	if (fd < 0)
+		return;
+
+	// The submission and completion rings, and the submission
+	// entries, all mapped from the ring's file descriptor
+	sqMemorySize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+	cqMemorySize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	sqeMemorySize = params.sq_entries * sizeof(io_uring_sqe);
+	bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	if (singleMap)
+		sqMemorySize = cqMemorySize = sqMemorySize > cqMemorySize ? sqMemorySize : cqMemorySize;
+
+	sqMemory = mmap(0, sqMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	cqMemory = singleMap ? sqMemory : mmap(0, cqMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+	sqeMemory = mmap(0, sqeMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (sqMemory == MAP_FAILED || cqMemory == MAP_FAILED || sqeMemory == MAP_FAILED)
+	{
+		if (sqMemory != MAP_FAILED)
+			munmap(sqMemory, sqMemorySize);
+		if (!singleMap && cqMemory != MAP_FAILED)
+			munmap(cqMemory, cqMemorySize);
+		if (sqeMemory != MAP_FAILED)
+			munmap(sqeMemory, sqeMemorySize);
+		sqMemory = cqMemory = sqeMemory = 0;
+		close(fd);
+		return;
+	}
+
+	unsigned char* sq = (unsigned char*)sqMemory;
+	unsigned char* cq = (unsigned char*)cqMemory;
+	sqHead = (unsigned int*)(sq + params.sq_off.head);
+	sqTail = (unsigned int*)(sq + params.sq_off.tail);
+	sqMask = (unsigned int*)(sq + params.sq_off.ring_mask);
+	sqArray = (unsigned int*)(sq + params.sq_off.array);
+	cqHead = (unsigned int*)(cq + params.cq_off.head);
+	cqTail = (unsigned int*)(cq + params.cq_off.tail);
+	cqMask = (unsigned int*)(cq + params.cq_off.ring_mask);
+	cqes = cq + params.cq_off.cqes;
+	entries = params.sq_entries;
+	ring = fd;
+#else
+	(void)pEntries;
+#endif
+}
+
+IORing::~IORing()
+{
+#ifdef IORING_SUPPORTED
+	if (ring < 0)
+		return;
+
+	// The kernel may still be writing into buffers of reads
+	// nobody waited for, so let them land first
+	unsigned long long userData;
+	int result;
+	while ((queued > 0 || inFlight > 0) && Wait(userData, result)) {}
+
+	munmap(sqeMemory, sqeMemorySize);
+	if (cqMemory != sqMemory)
+		munmap(cqMemory, cqMemorySize);
+	munmap(sqMemory, sqMemorySize);
+	close(ring);
+#endif
+}
+
+
+// --------------------------------------------------------
+// Fills in the next submission entry.  Nothing reaches the
+// kernel until Wait()
+// --------------------------------------------------------
+bool IORing::Read(int pFile, void* pBuffer, unsigned int pLength, unsigned long long pOffset, unsigned long long pUserData)
+{
+#ifdef IORING_SUPPORTED
+	// Completions have room for every entry, so only the
+	// reads not reaped yet limit what can be queued
+	if (ring < 0 || queued + inFlight >= entries)
+		return false;
+
+	// Only this thread moves the tail; the kernel moves the head
+	unsigned int tail = *sqTail;
+	unsigned int index = tail & *sqMask;
+	io_uring_sqe* sqe = (io_uring_sqe*)sqeMemory + index;
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READ;
+	sqe->fd = pFile;
+	sqe->addr = (unsigned long long)pBuffer;
+	sqe->len = pLength;
+	sqe->off = pOffset;
+	sqe->user_data = pUserData;
+	sqArray[index] = index;
+	std::atomic_ref<unsigned int>(*sqTail).store(tail + 1, std::memory_order_release);
+	queued++;
+	return true;
+#else
+	(void)pFile;
+	(void)pBuffer;
+	(void)pLength;
+	(void)pOffset;
+	(void)pUserData;
+	return false;
+#endif
+}
+
+
+// --------------------------------------------------------
+// Hands queued reads to the kernel, then reaps the first
+// completion, sleeping in the kernel until there is one
+// --------------------------------------------------------
+bool IORing::Wait(unsigned long long& pUserData, int& pResult)
+{
+#ifdef IORING_SUPPORTED
+	if (ring < 0 || queued + inFlight == 0)
+		return false;
+
+	while (true)
+	{
+		unsigned int head = *cqHead;
+		if (head != std::atomic_ref<unsigned int>(*cqTail).load(std::memory_order_acquire))
+		{
+			const io_uring_cqe* cqe = (const io_uring_cqe*)cqes + (head & *cqMask);
+			pUserData = cqe->user_data;
+			pResult = cqe->res;
+			std::atomic_ref<unsigned int>(*cqHead).store(head + 1, std::memory_order_release);
+			inFlight--;
+			return true;
+		}
+
+		int submitted = (int)syscall(__NR_io_uring_enter, ring, queued, 1, IORING_ENTER_GETEVENTS, 0, 0);
+		if (submitted < 0)
+		{
+			if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+				continue;
+			return false;
+		}
+		queued -= (unsigned int)submitted;
+		inFlight += (unsigned int)submitted;
+	}
+#else
+	(void)pUserData;
+	(void)pResult;
+	return false;
+#endif
+}
+
+// Getters
+bool IORing::IsAvailable() { return ring >= 0; }
+unsigned int IORing::GetEntries() { return entries; }
@@ -0,0 +1,47 @@
+#pragma once
+
+// See IORing.cpp for usage details
+
+class IORing
+{
+public:
+	IORing(unsigned int pEntries);
+	~IORing();
+
+	IORing(const IORing&) = delete;
+	IORing& operator=(const IORing&) = delete;
+
+	// Queues a read of pLength bytes at pOffset.  False when the
+	// queue is full (wait for something first) or there's no ring
+	bool Read(int pFile, void* pBuffer, unsigned int pLength, unsigned long long pOffset, unsigned long long pUserData);
+
+	// Submits whatever is queued and blocks until a read finishes.
+	// pResult is the bytes read, or a negative errno
+	bool Wait(unsigned long long& pUserData, int& pResult);
+
+	// Getters
+	bool IsAvailable();
+	unsigned int GetEntries();
+
+private:
+	int ring;
+	unsigned int entries;
+	unsigned int queued;		// Not submitted yet
+	unsigned int inFlight;		// Submitted, not reaped yet
+
+	// Shared with the kernel
+	void* sqMemory;
+	void* cqMemory;
+	void* sqeMemory;
+	unsigned long long sqMemorySize;
+	unsigned long long cqMemorySize;
+	unsigned long long sqeMemorySize;
+	unsigned int* sqHead;
+	unsigned int* sqTail;
+	unsigned int* sqMask;
+	unsigned int* sqArray;
+	unsigned int* cqHead;
+	unsigned int* cqTail;
+	unsigned int* cqMask;
+	void* cqes;
+};
@@ -2780,6 +2780,7 @@ struct ImGuiStoragePair
 // Typically you don't have to worry about this since a storage is held within each Window.
 // We use it to e.g. store collapse state for a tree (Int 0/1)
 // This is optimized for efficient lookup (dichotomy into a contiguous buffer) and rare insertion (typically tied to user interactions aka max once a frame)
+// For large tables with frequent insertion (e.g. thousands of tree nodes), call SetUseHashIndex(true) to switch to an open-addressing hash index (O(1) lookup/insertion).
 // You can use it as custom user storage for temporary values. Declare your own storage if, for example:
 // - You want to manipulate the open/close state of a particular sub-tree in your interface (tree node uses Int 0/1 to store their state).
 // - You want to store custom debug data easily without adding or editing structures in your code (probably not efficient, but convenient)
@@ -2788,11 +2789,12 @@ struct ImGuiStorage
 {
     // [Internal]
     ImVector<ImGuiStoragePair>      Data;
+    ImVector<int>                   HashIndex;  // Optional open-addressing index: slot -> index into Data + 1 (0 == empty slot). Empty when not using the hash index.
 
     // - Get***() functions find pair, never add/allocate. Pairs are sorted so a query is O(log N)
     // - Set***() functions find pair, insertion on demand if missing.
     // - Sorted insertion is costly, paid once. A typical frame shouldn't need to insert any new pair.
-    void                Clear() { Data.clear(); }
+    void                Clear() { Data.clear(); if (HashIndex.Size > 0) memset(HashIndex.Data, 0, (size_t)HashIndex.size_in_bytes()); }
     IMGUI_API int       GetInt(ImGuiID key, int default_val = 0) const;
     IMGUI_API void      SetInt(ImGuiID key, int val);
     IMGUI_API bool      GetBool(ImGuiID key, bool default_val = false) const;
@@ -2813,6 +2815,11 @@ struct ImGuiStorage
 
     // Advanced: for quicker full rebuild of a storage (instead of an incremental one), you may add all your contents and then sort once.
     IMGUI_API void      BuildSortByKey();
+    // Advanced: use an open-addressing hash index for O(1) queries and insertion.
+    // - While enabled, Data is kept in insertion order instead of being sorted by key. Don't enable on storages that are searched with ImLowerBound() (e.g. ImGuiSelectionBasicStorage).
+    // - Disabling sorts Data by key again. BuildSortByKey() keeps the index valid.
+    IMGUI_API void      SetUseHashIndex(bool use_hash_index);
+    bool                IsUsingHashIndex() const { return HashIndex.Size > 0; }
     // Obsolete: use on your own storage if you know only integer are being stored (open/close all tree nodes)
     IMGUI_API void      SetAllInt(int val);
 
@@ -5480,6 +5480,38 @@ void ImTextInitClassifiers()
     ImTextClassifierSetCharClass(g_CharClassifierIsSeparator_3000_300f, 0x3000, 0x300F, ImWcharClass_Punct, 0x3002);
 }
 
+// Return the end of the run of bytes in the [c_min, 0x7E] range starting at 's', e.g. c_min = ' ' for printable ASCII.
+// Such runs contain no control characters and no UTF-8 multi-byte sequences, so text functions can process them without decoding.
+// Checks 32 (AVX2) or 16 (SSE2) bytes at a time, the scalar loop finishes the last partial block.
+static inline const char* ImTextFindAsciiRunEnd(const char* s, const char* s_end, char c_min)
+{
+#if defined(IMGUI_ENABLE_SSE) && defined(__AVX2__)
+    const __m256i lo_256 = _mm256_set1_epi8((char)(c_min - 1));
+    const __m256i hi_256 = _mm256_set1_epi8(0x7F);
+    for (; s_end - s >= 32; s += 32)
+    {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)s);
+        const __m256i in_range = _mm256_and_si256(_mm256_cmpgt_epi8(v, lo_256), _mm256_cmpgt_epi8(hi_256, v)); // Signed compares: bytes >= 0x80 are negative so out of range.
+        if ((unsigned int)_mm256_movemask_epi8(in_range) != 0xFFFFFFFF)
+            break;
+    }
+#endif
+#if defined(IMGUI_ENABLE_SSE)
+    const __m128i lo_128 = _mm_set1_epi8((char)(c_min - 1));
+    const __m128i hi_128 = _mm_set1_epi8(0x7F);
+    for (; s_end - s >= 16; s += 16)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(const void*)s);
+        const __m128i in_range = _mm_and_si128(_mm_cmpgt_epi8(v, lo_128), _mm_cmplt_epi8(v, hi_128));
+        if (_mm_movemask_epi8(in_range) != 0xFFFF)
+            break;
+    }
+#endif
+    while (s < s_end && *s >= c_min && *s < 0x7F)
+        s++;
+    return s;
+}
+
 // Simple word-wrapping for English, not full-featured. Please submit failing cases!
 // This will return the next location to wrap from. If no wrapping if necessary, this will fast-forward to e.g. text_end.
 // Refer to imgui_test_suite's "drawlist_text_wordwrap_1" for tests.
@@ -5513,23 +5545,67 @@ const char* ImFontCalcWordWrapPositionEx(ImFont* font, float size, const char* t
     const char* span_end = s;
     float span_width = 0.0f;
 
+    // Bytes in [s, ascii_run_end) are known to be printable ASCII (see fast path below)
+    const char* ascii_run_end = s;
+    ImFontBaked_BuildGrowIndex(baked, 0x100); // Flat lookups for all of Latin-1, not just ASCII.
+
     while (s < text_end)
     {
+        // Fast path: inside a word, printable ASCII which is neither blank nor punctuation only extends the current span.
+        // (not taken after a blank or punctuation, as the first character of a word may end a span)
+        if (prev_type == ImWcharClass_Other && s < ascii_run_end)
+        {
+            bool word_too_long = false;
+            for (; s < ascii_run_end; s++)
+            {
+                const unsigned int c = (unsigned int)*s;
+                if (ImTextClassifierGet(g_CharClassifierIsSeparator_0000_007f, c) != ImWcharClass_Other)
+                    break;
+                float char_width = baked->IndexAdvanceX.Data[c]; // IndexAdvanceX[] always covers Latin-1, see ImFontBaked_BuildGrowIndex() call above.
+                if (char_width < 0.0f)
+                    char_width = BuildLoadGlyphGetAdvanceOrFallback(baked, c);
+                span_width += char_width;
+                if (span_width + blank_width + line_width > wrap_width)
+                {
+                    if (span_width + blank_width > wrap_width)
+                    {
+                        word_too_long = true;
+                        break;
+                    }
+                    return span_end;
+                }
+            }
+            if (word_too_long || s >= text_end)
+                break;
+            // Fall through to handle the blank or punctuation which ended the run
+        }
+
         unsigned int c = (unsigned int)*s;
         const char* next_s;
-        if (c < 0x80)
+        if (s < ascii_run_end)
+        {
             next_s = s + 1;
+        }
         else
-            next_s = s + ImTextCharFromUtf8(&c, s, text_end);
-
-        if (c < 32)
         {
-            if (c == '\n')
-                return s; // Direct return, skip "Wrap_width is too small to fit anything" path.
-            if (c == '\r')
+            if (c < 0x80)
+                next_s = s + 1;
+            else
+                next_s = s + ImTextCharFromUtf8(&c, s, text_end);
+
+            if (c < 32)
             {
-                s = next_s; // Fast-skip
-                continue;
+                if (c == '\n')
+                    return s; // Direct return, skip "Wrap_width is too small to fit anything" path.
+                if (c == '\r')
+                {
+                    s = next_s; // Fast-skip
+                    continue;
+                }
+            }
+            else if (c < 0x7F)
+            {
+                ascii_run_end = ImTextFindAsciiRunEnd(next_s, text_end, ' ');
             }
         }
 
@@ -5620,7 +5696,11 @@ ImVec2 ImFontCalcTextSizeEx(ImFont* font, float size, float max_width, float wra
     const bool word_wrap_enabled = (wrap_width > 0.0f);
     const char* word_wrap_eol = NULL;
 
+    // Bytes in [s, ascii_run_end) are known to be printable ASCII (see fast path below)
     const char* s = text_begin;
+    const char* ascii_run_end = s;
+    ImFontBaked_BuildGrowIndex(baked, 0x100);
+
     while (s < text_end_display)
     {
         // Word-wrapping
@@ -5644,6 +5724,32 @@ ImVec2 ImFontCalcTextSizeEx(ImFont* font, float size, float max_width, float wra
             }
         }
 
+        // Fast path: printable ASCII needs no UTF-8 decoding nor newline checks, measure the whole run (up to the wrapping point) in one go.
+        if (s >= ascii_run_end && (unsigned char)(*s - ' ') < 0x7F - ' ')
+            ascii_run_end = ImTextFindAsciiRunEnd(s, text_end_display, ' ');
+        if (s < ascii_run_end)
+        {
+            const char* run_end = (word_wrap_enabled && word_wrap_eol < ascii_run_end) ? word_wrap_eol : ascii_run_end;
+            bool reached_max_width = false;
+            for (; s < run_end; s++)
+            {
+                const unsigned int c = (unsigned int)*s;
+                float char_width = baked->IndexAdvanceX.Data[c]; // IndexAdvanceX[] always covers Latin-1, see ImFontBaked_BuildGrowIndex() call above.
+                if (char_width < 0.0f)
+                    char_width = BuildLoadGlyphGetAdvanceOrFallback(baked, c);
+                char_width *= scale;
+                if (line_width + char_width >= max_width)
+                {
+                    reached_max_width = true;
+                    break;
+                }
+                line_width += char_width;
+            }
+            if (reached_max_width)
+                break;
+            continue;
+        }
+
         // Decode and advance source
         const char* prev_s = s;
         unsigned int c = (unsigned int)*s;
@@ -5754,6 +5860,7 @@ begin:
 
     const float line_height = size;
     ImFontBaked* baked = GetFontBaked(size);
+    ImFontBaked_BuildGrowIndex(baked, 0x100);
 
     const float scale = size / baked->Size;
     const float origin_x = x;
@@ -5810,6 +5917,7 @@ begin:
 
     const ImU32 col_untinted = col | ~IM_COL32_A_MASK;
     const char* word_wrap_eol = NULL;
+    const char* ascii_run_end = s; // Bytes in [s, ascii_run_end) are known to be printable ASCII
 
     while (s < text_end)
     {
@@ -5832,27 +5940,41 @@ begin:
         }
 
         // Decode and advance source
+        // (printable ASCII runs are found 16/32 bytes at a time, and skip UTF-8 decoding and control characters checks)
         unsigned int c = (unsigned int)*s;
-        if (c < 0x80)
+        if (s < ascii_run_end)
+        {
             s += 1;
+        }
         else
-            s += ImTextCharFromUtf8(&c, s, text_end);
-
-        if (c < 32)
         {
-            if (c == '\n')
+            if (c < 0x80)
+                s += 1;
+            else
+                s += ImTextCharFromUtf8(&c, s, text_end);
+
+            if (c < 32)
             {
-                x = origin_x;
-                y += line_height;
-                if (y > clip_rect.w)
-                    break; // break out of main loop
-                continue;
+                if (c == '\n')
+                {
+                    x = origin_x;
+                    y += line_height;
+                    if (y > clip_rect.w)
+                        break; // break out of main loop
+                    continue;
+                }
+                if (c == '\r')
+                    continue;
+            }
+            else if (c < 0x7F)
+            {
+                ascii_run_end = ImTextFindAsciiRunEnd(s, text_end, ' ');
             }
-            if (c == '\r')
-                continue;
         }
 
-        const ImFontGlyph* glyph = baked->FindGlyph((ImWchar)c);
+        // Optimized inline version of 'baked->FindGlyph((ImWchar)c)' for loaded glyphs (IM_FONTGLYPH_INDEX_UNUSED/NOT_FOUND are >= Glyphs.Size)
+        const unsigned int glyph_idx = (c < (unsigned int)baked->IndexLookup.Size) ? baked->IndexLookup.Data[c] : IM_FONTGLYPH_INDEX_UNUSED;
+        const ImFontGlyph* glyph = (glyph_idx < (unsigned int)baked->Glyphs.Size) ? &baked->Glyphs.Data[glyph_idx] : baked->FindGlyph((ImWchar)c);
         //if (glyph == NULL)
         //    continue;
 
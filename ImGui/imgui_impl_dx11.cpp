@@ -17,6 +17,7 @@
 
 // CHANGELOG
 // (minor and older changes stripped away, please see git history for details)
+//  2026-10-19: DirectX11: Coalesce a frame's texture updates into a single UpdateSubresource() of tex->UpdateRect when it isn't much larger than the updated regions.
 //  2026-01-19: DirectX11: Added 'SamplerNearest' in ImGui_ImplDX11_RenderState. Renamed 'SamplerDefault' to 'SamplerLinear'.
 //  2025-09-18: Call platform_io.ClearRendererHandlers() on shutdown.
 //  2025-06-11: DirectX11: Added support for ImGuiBackendFlags_RendererHasTextures, for dynamic font atlas.
@@ -410,10 +411,26 @@ void ImGui_ImplDX11_UpdateTexture(ImTextureData* tex)
         // This backend choose to use tex->Updates[] but you can use tex->UpdateRect to upload a single region.
         ImGui_ImplDX11_Texture* backend_tex = (ImGui_ImplDX11_Texture*)tex->BackendUserData;
         IM_ASSERT(backend_tex->pTextureView == (ID3D11ShaderResourceView*)(intptr_t)tex->TexID);
-        for (ImTextureRect& r : tex->Updates)
+
+        // Many small glyph uploads in one frame (e.g. asynchronously rasterized glyphs landing together) are cheaper as
+        // a single copy of their bounding rectangle, as long as it doesn't drag in too many untouched pixels.
+        int updates_surface = 0;
+        for (const ImTextureRect& r : tex->Updates)
+            updates_surface += r.w * r.h;
+        const ImTextureRect& ur = tex->UpdateRect;
+        const int max_bounds_surface = (updates_surface * 4 > 64 * 64) ? updates_surface * 4 : 64 * 64;
+        if (tex->Updates.Size > 1 && ur.w * ur.h <= max_bounds_surface)
+        {
+            D3D11_BOX box = { (UINT)ur.x, (UINT)ur.y, (UINT)0, (UINT)(ur.x + ur.w), (UINT)(ur.y + ur.h), (UINT)1 };
+            bd->pd3dDeviceContext->UpdateSubresource(backend_tex->pTexture, 0, &box, tex->GetPixelsAt(ur.x, ur.y), (UINT)tex->GetPitch(), 0);
+        }
+        else
         {
-            D3D11_BOX box = { (UINT)r.x, (UINT)r.y, (UINT)0, (UINT)(r.x + r.w), (UINT)(r.y + r .h), (UINT)1 };
-            bd->pd3dDeviceContext->UpdateSubresource(backend_tex->pTexture, 0, &box, tex->GetPixelsAt(r.x, r.y), (UINT)tex->GetPitch(), 0);
+            for (ImTextureRect& r : tex->Updates)
+            {
+                D3D11_BOX box = { (UINT)r.x, (UINT)r.y, (UINT)0, (UINT)(r.x + r.w), (UINT)(r.y + r .h), (UINT)1 };
+                bd->pd3dDeviceContext->UpdateSubresource(backend_tex->pTexture, 0, &box, tex->GetPixelsAt(r.x, r.y), (UINT)tex->GetPitch(), 0);
+            }
         }
         tex->SetStatus(ImTextureStatus_OK);
     }
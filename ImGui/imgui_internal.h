@@ -72,6 +72,15 @@ Index of this file:
 #if defined(IMGUI_ENABLE_SSE4_2) && !defined(IMGUI_USE_LEGACY_CRC32_ADLER) && !defined(__EMSCRIPTEN__)
 #define IMGUI_ENABLE_SSE4_2_CRC
 #endif
+// Enable ARMv8 CRC32 intrinsics if available (same CRC32c polynomial as the SSE 4.2 instructions, so IDs are identical across platforms)
+#if (defined(__ARM_FEATURE_CRC32) || defined(_M_ARM64)) && !defined(IMGUI_ENABLE_SSE4_2_CRC) && !defined(IMGUI_USE_LEGACY_CRC32_ADLER) && !defined(IMGUI_DISABLE_ARM_CRC)
+#define IMGUI_ENABLE_ARM_CRC
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <arm_acle.h>
+#endif
+#endif
 
 // Visual Studio warnings
 #ifdef _MSC_VER
@@ -137,6 +146,7 @@ Index of this file:
 struct ImBitVector;                 // Store 1-bit per value
 struct ImRect;                      // An axis-aligned rectangle (2 points)
 struct ImGuiTextIndex;              // Maintain a line index for a text buffer.
+struct ImGuiTextLayoutCache;        // Maintain a line index and line widths for a large static or append-only text buffer.
 
 // ImDrawList/ImFontAtlas
 struct ImDrawDataBuilder;           // Helper to build a ImDrawData instance
@@ -820,6 +830,22 @@ struct ImGuiTextIndex
     void            append(const char* base, int old_size, int new_size);
 };
 
+// Helper: Cached line layout (offsets + widths) for a large static or append-only text block, e.g. a log.
+// Update() only measures text appended since the previous call, so unchanged text isn't re-scanned and re-measured every frame.
+// The text before the previous end is assumed unchanged: call clear() after editing it. Font or size changes invalidate the cache.
+struct IMGUI_API ImGuiTextLayoutCache
+{
+    ImGuiTextIndex  Lines;
+    ImVector<float> LineWidths;
+    float           MaxLineWidth = 0.0f;
+    ImFont*         Font = NULL;
+    float           FontSize = 0.0f;
+
+    void            clear()                                 { Lines.clear(); LineWidths.clear(); MaxLineWidth = 0.0f; Font = NULL; FontSize = 0.0f; }
+    int             size()                                  { return Lines.size(); }
+    void            Update(const char* text, const char* text_end, ImFont* font, float font_size);
+};
+
 // Helper: ImGuiStorage
 IMGUI_API ImGuiStoragePair* ImLowerBound(ImGuiStoragePair* in_begin, ImGuiStoragePair* in_end, ImGuiID key);
 
@@ -3607,6 +3633,7 @@ namespace ImGui
 
     // Widgets: Text
     IMGUI_API void          TextEx(const char* text, const char* text_end = NULL, ImGuiTextFlags flags = 0);
+    IMGUI_API void          TextUnformattedCached(ImGuiTextLayoutCache* layout, const char* text, const char* text_end = NULL); // Large static/append-only text: only visible lines are touched each frame.
     IMGUI_API void          TextAligned(float align_x, float size_x, const char* fmt, ...);               // FIXME-WIP: Works but API is likely to be reworked. This is designed for 1 item on the line. (#7024)
     IMGUI_API void          TextAlignedV(float align_x, float size_x, const char* fmt, va_list args);
 
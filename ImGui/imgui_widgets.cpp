@@ -264,6 +264,39 @@ void ImGui::TextEx(const char* text, const char* text_end, ImGuiTextFlags flags)
     }
 }
 
+// Variant of TextUnformatted() for large static or append-only text (e.g. logs), without word-wrapping.
+// Line offsets and widths are kept in 'layout' across frames, so only visible lines are touched instead of scanning the whole text.
+void ImGui::TextUnformattedCached(ImGuiTextLayoutCache* layout, const char* text, const char* text_end)
+{
+    ImGuiWindow* window = GetCurrentWindow();
+    if (window->SkipItems)
+        return;
+    ImGuiContext& g = *GImGui;
+
+    if (text_end == NULL)
+        text_end = text + ImStrlen(text);
+    layout->Update(text, text_end, g.Font, g.FontSize);
+
+    const ImVec2 text_pos(window->DC.CursorPos.x, window->DC.CursorPos.y + window->DC.CurrLineTextBaseOffset);
+    const float line_height = GetTextLineHeight();
+    const int line_count = layout->size();
+    const ImVec2 text_size(layout->MaxLineWidth, ImMax(line_count, 1) * line_height);
+    ImRect bb(text_pos, text_pos + text_size);
+    ItemSize(text_size, 0.0f);
+    if (!ItemAdd(bb, 0))
+        return;
+
+    // Render visible lines only (can't skip when logging text)
+    int line_first = 0, line_last = line_count;
+    if (!g.LogEnabled)
+    {
+        line_first = ImMax((int)((window->ClipRect.Min.y - text_pos.y) / line_height), 0);
+        line_last = ImMin((int)((window->ClipRect.Max.y - text_pos.y) / line_height) + 1, line_count);
+    }
+    for (int line_n = line_first; line_n < line_last; line_n++)
+        RenderText(ImVec2(text_pos.x, text_pos.y + line_n * line_height), layout->Lines.get_line_begin(text, line_n), layout->Lines.get_line_end(text, line_n), false);
+}
+
 void ImGui::TextUnformatted(const char* text, const char* text_end)
 {
     TextEx(text, text_end, ImGuiTextFlags_NoWidthForLargeClippedText);
@@ -1,4 +1,5 @@
 #include "Input.h"
+#include "Log.h"
 #include <hidusage.h>
 
 // --------------- Basic usage -----------------
@@ -35,7 +36,9 @@
 //   if (Input::KeyReleased(' ')) { }
 // 
 // (Note that these functions will only return true on 
-// the FIRST frame that a key is pressed or released.)
+// the FIRST frame that a key is pressed or released.
+// A key tapped faster than a frame is both pressed and
+// released that frame, though never down.)
 // 
 // 
 // Checking for mouse button input is similar:
@@ -67,6 +70,39 @@
 //       int xRawDelta = Input::GetRawMouseXDelta();
 //       int yRawDelta = Input::GetRawMouseYDelta();
 //                                 ^^^
+// 
+// 
+// Keys, buttons, the wheel and raw mouse movement aren't
+// polled.  The window procedure hands every message to
+// Input::ProcessMessage(), which stamps it and pushes it
+// into a lock-free InputQueue.  Update() drains whatever
+// arrived before it was called and replays it in order,
+// so nothing between frames is lost or merged.  The
+// events themselves, with their timestamps, are there
+// for anything that cares about order within the frame:
+// 
+//   for (const InputEvent& event : Input::GetFrameEvents()) { }
+// 
+// GetOldestEventTime() is when the oldest of them
+// arrived, for measuring how long input takes to reach
+// the screen.  The cursor position is still read once
+// per frame, since only where it ends up matters.
+// 
+// 
+// A session's input can be recorded, along with each
+// frame's deltaTime and totalTime, and played back later
+// to rerun exactly the same frames (for profiling one
+// build against another, say):
+// 
+//   Input::StartRecording();
+//   Input::StopRecording(FixPath("Recording.inp"));
+// 
+//   Input::StartReplay(FixPath("Recording.inp"));
+// 
+// While replaying, Update() swaps the recorded frame in
+// for live input and time, UI capture included, and
+// returns to live input after the last one.  Replayed
+// events have no arrival time (it's zero).
 //  
 // ---------------------------------------------
 
@@ -75,9 +111,24 @@ namespace Input
 	// Annonymous namespace to hold variables only accessible in this file
 	namespace 
 	{
-		// Arrays for the current and previous key states
+		// Current key states, and which changed this frame
 		unsigned char* kbState = 0;
-		unsigned char* prevKbState = 0;
+		unsigned char* pressedThisFrame = 0;
+		unsigned char* releasedThisFrame = 0;
+
+		// Events from the window procedure, and the ones
+		// this frame used
+		std::atomic<InputQueue*> eventQueue = 0;
+		std::vector<InputEvent> frameEvents;
+		unsigned long long frameSampleTime = 0;
+
+		// This session's input as it's recorded, or an old
+		// session's played back in place of it
+		InputRecording recorded;
+		bool isRecording = false;
+		InputRecording replay;
+		unsigned int replayFrame = 0;
+		bool isReplaying = false;
 
 		// Mouse position and wheel data
 		int mouseX = 0;
@@ -97,6 +148,51 @@ namespace Input
 		// The window's handle (id) from the OS, so
 		// we can get the cursor's position
 		HWND hWnd = 0;
+
+		// Lets go of everything, for when we can't know what's held
+		void ReleaseAllKeys()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				if (kbState[i] & 0x80)
+					releasedThisFrame[i] = 1;
+				kbState[i] = 0;
+			}
+		}
+
+		// Replays one queued event onto the current state
+		void ApplyEvent(const InputEvent& event)
+		{
+			switch (event.type)
+			{
+			case InputEvent::Type::KeyDown:
+				// Auto-repeats arrive as more downs
+				if (!(kbState[event.key] & 0x80))
+					pressedThisFrame[event.key] = 1;
+				kbState[event.key] = 0x80;
+				break;
+
+			case InputEvent::Type::KeyUp:
+				if (kbState[event.key] & 0x80)
+					releasedThisFrame[event.key] = 1;
+				kbState[event.key] = 0;
+				break;
+
+			case InputEvent::Type::RawMouseMove:
+				rawMouseXDelta += event.x;
+				rawMouseYDelta += event.y;
+				break;
+
+			case InputEvent::Type::MouseWheel:
+				wheelDelta += event.wheel;
+				break;
+
+			case InputEvent::Type::FocusLost:
+				// Releases happen elsewhere now, and we won't hear about them
+				ReleaseAllKeys();
+				break;
+			}
+		}
 	}
 }
 
@@ -111,10 +207,17 @@ namespace Input
 void Input::Initialize(HWND windowHandle)
 {
 	kbState = new unsigned char[256];
-	prevKbState = new unsigned char[256];
+	pressedThisFrame = new unsigned char[256];
+	releasedThisFrame = new unsigned char[256];
 
 	memset(kbState, 0, sizeof(unsigned char) * 256);
-	memset(prevKbState, 0, sizeof(unsigned char) * 256);
+	memset(pressedThisFrame, 0, sizeof(unsigned char) * 256);
+	memset(releasedThisFrame, 0, sizeof(unsigned char) * 256);
+
+	// Plenty for a few frames of a high rate mouse
+	InputQueue* queue = new InputQueue(4096);
+	frameEvents.reserve(queue->GetCapacity());
+	frameSampleTime = 0;
 
 	wheelDelta = 0.0f;
 	mouseX = 0; mouseY = 0;
@@ -131,6 +234,10 @@ void Input::Initialize(HWND windowHandle)
 	mouse.dwFlags = RIDEV_INPUTSINK;
 	mouse.hwndTarget = windowHandle;
 	RegisterRawInputDevices(&mouse, 1, sizeof(mouse));
+
+	// The window thread may already be sending messages, so
+	// the queue only shows up once it's ready
+	eventQueue = queue;
 }
 
 // ---------------------------------------------------
@@ -139,54 +246,280 @@ void Input::Initialize(HWND windowHandle)
 // ---------------------------------------------------
 void Input::ShutDown()
 {
+	// Nothing can be queued once it's gone.  The window
+	// thread must have stopped first (see Window::ShutDown())
+	delete eventQueue.exchange(0);
+
 	delete[] kbState;
-	delete[] prevKbState;
+	delete[] pressedThisFrame;
+	delete[] releasedThisFrame;
 }
 
 // ----------------------------------------------------------
 //  Updates the input manager for this frame.  This should
 //  be called at the beginning of every Game::Update(), 
 //  before anything that might need input
+//
+//  deltaTime, totalTime - this frame's time, which is
+//                         replaced by the recorded time
+//                         while replaying
 // ----------------------------------------------------------
-void Input::Update()
+void Input::Update(float& deltaTime, float& totalTime)
 {
-	// Copy the old keys so we have last frame's data
-	memcpy(prevKbState, kbState, sizeof(unsigned char) * 256);
+	// Last frame's presses and releases are over
+	memset(pressedThisFrame, 0, sizeof(unsigned char) * 256);
+	memset(releasedThisFrame, 0, sizeof(unsigned char) * 256);
 
-	// Get the latest keys (from Windows)
-	// Note the use of (void), which denotes to the compiler
-	// that we're intentionally ignoring the return value
-	(void)GetKeyboardState(kbState);
+	// A finished replay hands back to live input
+	if (isReplaying && replayFrame >= replay.frames.size())
+		StopReplay();
 
-	// Get the current mouse position then make it relative to the window
-	POINT mousePos = {};
-	GetCursorPos(&mousePos);
-	ScreenToClient(hWnd, &mousePos);
+	// Everything that's arrived up to now, in order.
+	// Anything newer waits for the next frame
+	frameEvents.clear();
+	frameSampleTime = InputQueue::Now();
+	eventQueue.load()->Drain(frameEvents, frameSampleTime);
 
-	// Save the previous mouse position, then the current mouse 
-	// position and finally calculate the change from the previous frame
+	// Save the previous mouse position before getting the new one
 	prevMouseX = mouseX;
 	prevMouseY = mouseY;
-	mouseX = mousePos.x;
-	mouseY = mousePos.y;
+	if (isReplaying)
+	{
+		// The recorded frame stands in for live input and
+		// time, which are thrown away
+		const InputRecording::Frame& frame = replay.frames[replayFrame++];
+		frameEvents.assign(
+			replay.events.begin() + frame.firstEvent,
+			replay.events.begin() + frame.firstEvent + frame.eventCount);
+		deltaTime = frame.deltaTime;
+		totalTime = frame.totalTime;
+		mouseX = frame.mouseX;
+		mouseY = frame.mouseY;
+		keyboardCaptured = (frame.flags & InputRecording::KeyboardCaptured) != 0;
+		mouseCaptured = (frame.flags & InputRecording::MouseCaptured) != 0;
+	}
+	else
+	{
+		// Get the current mouse position then make it relative to the window
+		POINT mousePos = {};
+		GetCursorPos(&mousePos);
+		ScreenToClient(hWnd, &mousePos);
+		mouseX = mousePos.x;
+		mouseY = mousePos.y;
+	}
+
+	// Calculate the change from the previous frame
 	mouseXDelta = mouseX - prevMouseX;
 	mouseYDelta = mouseY - prevMouseY;
+
+	for (const InputEvent& event : frameEvents)
+		ApplyEvent(event);
+
+	if (isRecording)
+		recorded.AddFrame(deltaTime, totalTime, mouseX, mouseY, frameEvents);
 }
 
 // ----------------------------------------------------------
 //  Resets the mouse wheel value and raw mouse delta at the 
-//  end of the frame. This cannot occur earlier in the frame, 
-//  since these come from Win32 windowing messages, which are
-//  handled between frames.
+//  end of the frame, so the next Update() only sums the
+//  events that arrive before it.
 // ----------------------------------------------------------
 void Input::EndOfFrame()
 {
+	// Keep the capture state this frame's input was read with
+	if (isRecording && !recorded.frames.empty())
+	{
+		recorded.frames.back().flags =
+			(keyboardCaptured ? InputRecording::KeyboardCaptured : 0) |
+			(mouseCaptured ? InputRecording::MouseCaptured : 0);
+	}
+
 	// Reset wheel value
 	wheelDelta = 0;
 	rawMouseXDelta = 0;
 	rawMouseYDelta = 0;
 }
 
+// ----------------------------------------------------------
+//  Stamps and queues the window messages the input manager
+//  cares about.  Call this from the window procedure for
+//  every message; the rest are ignored.  Messages that
+//  arrive before Initialize() are dropped.
+// ----------------------------------------------------------
+void Input::ProcessMessage(UINT message, WPARAM wParam, LPARAM lParam)
+{
+	InputQueue* queue = eventQueue;
+	if (!queue)
+		return;
+
+	InputEvent event = {};
+	event.time = InputQueue::Now();
+	switch (message)
+	{
+	case WM_KEYDOWN:
+	case WM_SYSKEYDOWN:
+		event.type = InputEvent::Type::KeyDown;
+		event.key = (unsigned char)wParam;
+		break;
+
+	case WM_KEYUP:
+	case WM_SYSKEYUP:
+		event.type = InputEvent::Type::KeyUp;
+		event.key = (unsigned char)wParam;
+		break;
+
+	// Mouse buttons use the same states as keys
+	case WM_LBUTTONDOWN: event.type = InputEvent::Type::KeyDown;	event.key = VK_LBUTTON; break;
+	case WM_LBUTTONUP:	 event.type = InputEvent::Type::KeyUp;		event.key = VK_LBUTTON; break;
+	case WM_RBUTTONDOWN: event.type = InputEvent::Type::KeyDown;	event.key = VK_RBUTTON; break;
+	case WM_RBUTTONUP:	 event.type = InputEvent::Type::KeyUp;		event.key = VK_RBUTTON; break;
+	case WM_MBUTTONDOWN: event.type = InputEvent::Type::KeyDown;	event.key = VK_MBUTTON; break;
+	case WM_MBUTTONUP:	 event.type = InputEvent::Type::KeyUp;		event.key = VK_MBUTTON; break;
+
+	case WM_XBUTTONDOWN:
+	case WM_XBUTTONUP:
+		event.type = message == WM_XBUTTONDOWN ? InputEvent::Type::KeyDown : InputEvent::Type::KeyUp;
+		event.key = GET_XBUTTON_WPARAM(wParam) == XBUTTON1 ? VK_XBUTTON1 : VK_XBUTTON2;
+		break;
+
+	case WM_MOUSEWHEEL:
+		SetWheelDelta(GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA);
+		return;
+
+	case WM_INPUT:
+		ProcessRawMouseInput(lParam);
+		return;
+
+	case WM_KILLFOCUS:
+		event.type = InputEvent::Type::FocusLost;
+		break;
+
+	default:
+		return;
+	}
+
+	queue->Push(event);
+}
+
+
+// ----------------------------------------------------------
+//  The events Update() replayed this frame, oldest first,
+//  and when it drained them (InputQueue::Now() time).
+// ----------------------------------------------------------
+const std::vector<InputEvent>& Input::GetFrameEvents() { return frameEvents; }
+unsigned long long Input::GetFrameSampleTime() { return frameSampleTime; }
+
+
+// ----------------------------------------------------------
+//  When the oldest event used this frame arrived, or zero
+//  if there were none.  Compare against InputQueue::Now()
+//  to see how long input has been waiting.
+// ----------------------------------------------------------
+unsigned long long Input::GetOldestEventTime()
+{
+	return frameEvents.empty() ? 0 : frameEvents[0].time;
+}
+
+
+// ----------------------------------------------------------
+//  How many events were lost because the queue was full.
+// ----------------------------------------------------------
+unsigned long long Input::GetDroppedEventCount()
+{
+	InputQueue* queue = eventQueue;
+	return queue ? queue->GetDroppedCount() : 0;
+}
+
+
+// ----------------------------------------------------------
+//  Starts recording input and time from the next frame,
+//  dropping anything recorded before.  The keys held and
+//  the cursor position right now are where it starts.
+// ----------------------------------------------------------
+void Input::StartRecording()
+{
+	recorded.Clear();
+	for (int i = 0; i < 256; i++)
+	{
+		if (kbState[i] & 0x80)
+			recorded.heldKeys.push_back((unsigned char)i);
+	}
+	recorded.startMouseX = mouseX;
+	recorded.startMouseY = mouseY;
+	isRecording = true;
+}
+
+
+// ----------------------------------------------------------
+//  Stops recording and saves what was recorded.  Returns
+//  false if it couldn't be saved.
+// ----------------------------------------------------------
+bool Input::StopRecording(const std::string& path)
+{
+	isRecording = false;
+	if (!recorded.Save(path))
+		return false;
+
+	Log::Write(Log::Severity::Info, Log::Category::Input, "Recorded %u frames (%.1f s) to %s",
+		recorded.GetFrameCount(), recorded.GetSeconds(), path.c_str());
+	return true;
+}
+
+
+// ----------------------------------------------------------
+//  Plays a recording back from its first frame, starting
+//  with the keys and cursor position it started with.
+//  Returns false (and keeps going as before) if it can't
+//  be loaded or is empty.
+// ----------------------------------------------------------
+bool Input::StartReplay(const std::string& path)
+{
+	if (!replay.Load(path))
+		return false;
+	if (replay.frames.empty())
+	{
+		Log::Write(Log::Severity::Warning, Log::Category::Input, "%s has no frames to replay", path.c_str());
+		return false;
+	}
+
+	memset(kbState, 0, sizeof(unsigned char) * 256);
+	for (unsigned char key : replay.heldKeys)
+		kbState[key] = 0x80;
+	mouseX = replay.startMouseX;
+	mouseY = replay.startMouseY;
+	replayFrame = 0;
+	isReplaying = true;
+
+	Log::Write(Log::Severity::Info, Log::Category::Input, "Replaying %s: %u frames (%.1f s)",
+		path.c_str(), replay.GetFrameCount(), replay.GetSeconds());
+	return true;
+}
+
+
+// ----------------------------------------------------------
+//  Goes back to live input.  Keys the replay was holding
+//  are released, since nobody is really holding them.
+// ----------------------------------------------------------
+void Input::StopReplay()
+{
+	if (!isReplaying)
+		return;
+
+	isReplaying = false;
+	ReleaseAllKeys();
+}
+
+
+// ----------------------------------------------------------
+//  Recording and replay progress.
+// ----------------------------------------------------------
+bool Input::IsRecording() { return isRecording; }
+bool Input::IsReplaying() { return isReplaying; }
+unsigned int Input::GetRecordedFrameCount() { return recorded.GetFrameCount(); }
+unsigned int Input::GetReplayFrame() { return replayFrame; }
+unsigned int Input::GetReplayFrameCount() { return replay.GetFrameCount(); }
+
+
 // ----------------------------------------------------------
 //  Get the mouse's current position in pixels relative
 //  to the top left corner of the window.
@@ -206,7 +539,9 @@ int Input::GetMouseYDelta() { return mouseYDelta; }
 // ---------------------------------------------------------------
 //  Passes raw mouse input data to the input manager to be
 //  processed.  This input is the lParam of the WM_INPUT
-//  windows message, captured from (presumably) DXCore.
+//  windows message, passed along by ProcessMessage().
+//  Each movement is queued separately and summed in
+//  Update().
 // 
 //  See the following article for a discussion on different
 //  types of mouse input, not including GetCursorPos():
@@ -226,9 +561,17 @@ void Input::ProcessRawMouseInput(LPARAM lParam)
 	RAWINPUT* raw = (RAWINPUT*)rawInputBytes;
 	if (raw->header.dwType == RIM_TYPEMOUSE)
 	{
-		// This is mouse data, so grab the movement values
-		rawMouseXDelta = raw->data.mouse.lLastX;
-		rawMouseYDelta = raw->data.mouse.lLastY;
+		// This is mouse data, so queue the movement values
+		InputQueue* queue = eventQueue;
+		if (queue && (raw->data.mouse.lLastX != 0 || raw->data.mouse.lLastY != 0))
+		{
+			InputEvent event = {};
+			event.type = InputEvent::Type::RawMouseMove;
+			event.x = raw->data.mouse.lLastX;
+			event.y = raw->data.mouse.lLastY;
+			event.time = InputQueue::Now();
+			queue->Push(event);
+		}
 	}
 }
 
@@ -249,13 +592,22 @@ float Input::GetMouseWheel() { return wheelDelta; }
 
 
 // ---------------------------------------------------------------
-//  Sets the mouse wheel delta for this frame.  This is called
-//  by DXCore whenever an OS-level mouse wheel message is sent
-//  to the application.  You'll never need to call this yourself.
+//  Queues a mouse wheel movement, added to the next frame's
+//  delta.  This is called by ProcessMessage() whenever an
+//  OS-level mouse wheel message is sent to the application.
+//  You'll never need to call this yourself.
 // ---------------------------------------------------------------
 void Input::SetWheelDelta(float delta)
 {
-	wheelDelta = delta;
+	InputQueue* queue = eventQueue;
+	if (!queue)
+		return;
+
+	InputEvent event = {};
+	event.type = InputEvent::Type::MouseWheel;
+	event.wheel = delta;
+	event.time = InputQueue::Now();
+	queue->Push(event);
 }
 
 
@@ -266,7 +618,9 @@ void Input::SetWheelDelta(float delta)
 // ---------------------------------------------------------------
 void Input::SetKeyboardCapture(bool captured)
 {
-	keyboardCaptured = captured;
+	// A replay brings its own
+	if (!isReplaying)
+		keyboardCaptured = captured;
 }
 
 
@@ -277,7 +631,8 @@ void Input::SetKeyboardCapture(bool captured)
 // ---------------------------------------------------------------
 void Input::SetMouseCapture(bool captured)
 {
-	mouseCaptured = captured;
+	if (!isReplaying)
+		mouseCaptured = captured;
 }
 
 
@@ -320,10 +675,7 @@ bool Input::KeyPress(int key)
 {
 	if (key < 0 || key > 255) return false;
 
-	return
-		kbState[key] & 0x80 &&			// Down now
-		!(prevKbState[key] & 0x80) &&	// Up last frame
-		!keyboardCaptured;
+	return pressedThisFrame[key] && !keyboardCaptured;
 }
 
 // ----------------------------------------------------------
@@ -337,10 +689,7 @@ bool Input::KeyRelease(int key)
 {
 	if (key < 0 || key > 255) return false;
 
-	return
-		!(kbState[key] & 0x80) &&	// Up now
-		prevKbState[key] & 0x80 &&	// Down last frame
-		!keyboardCaptured;
+	return releasedThisFrame[key] && !keyboardCaptured;
 }
 
 
@@ -393,11 +742,11 @@ bool Input::MouseMiddleUp() { return !(kbState[VK_MBUTTON] & 0x80) && !mouseCapt
 //  Was the specific mouse button initially 
 // pressed or released this frame?
 // ----------------------------------------------------------
-bool Input::MouseLeftPress() { return kbState[VK_LBUTTON] & 0x80 && !(prevKbState[VK_LBUTTON] & 0x80) && !mouseCaptured; }
-bool Input::MouseLeftRelease() { return !(kbState[VK_LBUTTON] & 0x80) && prevKbState[VK_LBUTTON] & 0x80 && !mouseCaptured; }
+bool Input::MouseLeftPress() { return pressedThisFrame[VK_LBUTTON] && !mouseCaptured; }
+bool Input::MouseLeftRelease() { return releasedThisFrame[VK_LBUTTON] && !mouseCaptured; }
 
-bool Input::MouseRightPress() { return kbState[VK_RBUTTON] & 0x80 && !(prevKbState[VK_RBUTTON] & 0x80) && !mouseCaptured; }
-bool Input::MouseRightRelease() { return !(kbState[VK_RBUTTON] & 0x80) && prevKbState[VK_RBUTTON] & 0x80 && !mouseCaptured; }
+bool Input::MouseRightPress() { return pressedThisFrame[VK_RBUTTON] && !mouseCaptured; }
+bool Input::MouseRightRelease() { return releasedThisFrame[VK_RBUTTON] && !mouseCaptured; }
 
-bool Input::MouseMiddlePress() { return kbState[VK_MBUTTON] & 0x80 && !(prevKbState[VK_MBUTTON] & 0x80) && !mouseCaptured; }
-bool Input::MouseMiddleRelease() { return !(kbState[VK_MBUTTON] & 0x80) && prevKbState[VK_MBUTTON] & 0x80 && !mouseCaptured; }
+bool Input::MouseMiddlePress() { return pressedThisFrame[VK_MBUTTON] && !mouseCaptured; }
+bool Input::MouseMiddleRelease() { return releasedThisFrame[VK_MBUTTON] && !mouseCaptured; }
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <Windows.h>
+#include <string>
+#include <vector>
+
+#include "InputQueue.h"
+#include "InputRecording.h"
 
 // See Input.cpp for usage details
 
@@ -8,9 +13,25 @@ namespace Input
 {
 	void Initialize(HWND windowHandle);
 	void ShutDown();
-	void Update();
+	void Update(float& deltaTime, float& totalTime);
 	void EndOfFrame();
 
+	void ProcessMessage(UINT message, WPARAM wParam, LPARAM lParam);
+	const std::vector<InputEvent>& GetFrameEvents();
+	unsigned long long GetFrameSampleTime();
+	unsigned long long GetOldestEventTime();
+	unsigned long long GetDroppedEventCount();
+
+	void StartRecording();
+	bool StopRecording(const std::string& path);
+	bool StartReplay(const std::string& path);
+	void StopReplay();
+	bool IsRecording();
+	bool IsReplaying();
+	unsigned int GetRecordedFrameCount();
+	unsigned int GetReplayFrame();
+	unsigned int GetReplayFrameCount();
+
 	int GetMouseX();
 	int GetMouseY();
 	int GetMouseXDelta();
@@ -0,0 +1,95 @@
+#include "InputQueue.h"
+
+#include <chrono>
+
+// --------------- Basic usage -----------------
+//
+// Carries keyboard and mouse events from the window
+// procedure to whoever consumes input, in the order they
+// happened and stamped with when they arrived:
+//
+//   InputQueue queue(4096);
+//
+//   // In the window procedure
+//   InputEvent event = { InputEvent::Type::KeyDown, 'W', 0, 0, 0, InputQueue::Now() };
+//   queue.Push(event);
+//
+//   // Once per frame, wherever input is consumed
+//   std::vector<InputEvent> events;
+//   queue.Drain(events, InputQueue::Now());
+//
+// Drain() stops at the first event stamped after pUntil,
+// so a frame that samples input at a given time sees
+// exactly what had happened by then, and later events
+// wait for the next frame.  Nothing is merged: a key
+// pressed and released within one frame shows up as
+// both events, and every raw mouse movement is its own
+// event.
+//
+// It's an SpscQueue underneath, so there must be one
+// producer (the thread running the window procedure) and
+// one consumer, but they can be any two threads and
+// neither ever locks.  When the queue is full, new events
+// are dropped and counted rather than blocking the window
+// procedure.
+//
+// Now() is std::chrono::steady_clock, which is
+// QueryPerformanceCounter on Windows, in nanoseconds.
+// ---------------------------------------------
+
+InputQueue::InputQueue(unsigned int pCapacity) :
+	events(pCapacity),
+	pushed(0),
+	dropped(0)
+{
+}
+
+
+// --------------------------------------------------------
+// Queues an event.  Returns false, and counts it as
+// dropped, when the queue is full
+// --------------------------------------------------------
+bool InputQueue::Push(const InputEvent& pEvent)
+{
+	if (!events.Push(pEvent))
+	{
+		dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return false;
+	}
+	pushed.store(pushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Appends events that arrived up to pUntil, oldest first.
+// Returns how many were appended
+// --------------------------------------------------------
+size_t InputQueue::Drain(std::vector<InputEvent>& pEvents, unsigned long long pUntil)
+{
+	size_t count = 0;
+	InputEvent* event = events.Peek();
+	while (event && event->time <= pUntil)
+	{
+		pEvents.push_back(*event);
+		events.Pop();
+		count++;
+		event = events.Peek();
+	}
+	return count;
+}
+
+
+// --------------------------------------------------------
+// Nanoseconds on a steady clock, for stamping events
+// --------------------------------------------------------
+unsigned long long InputQueue::Now()
+{
+	return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Getters
+unsigned int InputQueue::GetCapacity() { return events.GetCapacity(); }
+unsigned long long InputQueue::GetPushedCount() { return pushed.load(std::memory_order_relaxed); }
+unsigned long long InputQueue::GetDroppedCount() { return dropped.load(std::memory_order_relaxed); }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <vector>
+
+// See InputQueue.cpp for usage details
+
+// One thing the keyboard or mouse did, when it happened
+struct InputEvent
+{
+	enum class Type : unsigned char
+	{
+		KeyDown,			// Mouse buttons too, as VK_LBUTTON etc.
+		KeyUp,
+		RawMouseMove,		// Device movement, x and y
+		MouseWheel,			// Notches, in wheel
+		FocusLost			// Everything held is released
+	};
+
+	Type type;
+	unsigned char key;		// Virtual key code
+	int x;
+	int y;
+	float wheel;
+	unsigned long long time;	// InputQueue::Now() when it arrived
+};
+
+class InputQueue
+{
+public:
+	InputQueue(unsigned int pCapacity);
+
+	// Window thread
+	bool Push(const InputEvent& pEvent);
+
+	// Consumer thread
+	size_t Drain(std::vector<InputEvent>& pEvents, unsigned long long pUntil);
+
+	// Nanoseconds on a steady clock
+	static unsigned long long Now();
+
+	// Getters
+	unsigned int GetCapacity();
+	unsigned long long GetPushedCount();
+	unsigned long long GetDroppedCount();
+
+private:
+	SpscQueue<InputEvent> events;
+
+	// Only written by the window thread
+	std::atomic<unsigned long long> pushed;
+	std::atomic<unsigned long long> dropped;
+};
@@ -0,0 +1,332 @@
+#include "InputRecording.h"
+#include "Log.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// --------------- Basic usage -----------------
+//
+// Holds each frame's deltaTime and totalTime, cursor
+// position, UI capture state and input events, which is
+// everything a frame's simulation reads, plus the keys
+// held and the cursor position before the first frame:
+//
+//   InputRecording recording;
+//   recording.heldKeys.push_back('W');
+//   recording.AddFrame(deltaTime, totalTime, mouseX, mouseY, Input::GetFrameEvents());	// Every frame
+//   recording.Save(FixPath("Recording.inp"));
+//
+//   InputRecording replay;
+//   if (replay.Load(FixPath("Recording.inp"))) { }	// False (and logged) if missing or damaged
+//
+// Normally Input does this itself; see Input.cpp for
+// recording and replaying a session.  Nothing here needs
+// a window, so a replay can drive a simulation headless.
+//
+// Events keep their order but not their arrival times,
+// which only matter for measuring latency.  The file is
+// a small header, then each frame's times as floats (so
+// they come back bit for bit), its cursor movement and
+// event count as variable-length integers, and its
+// events, mostly a byte or two each.  A frame with no
+// input and a still cursor takes 12 bytes.  Recordings
+// from another version, or damaged ones, aren't loaded.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const unsigned int RecordingMagic = 0x43455249;	// "IREC"
+	const unsigned int RecordingVersion = 1;
+
+	// Small numbers in fewer bytes: seven bits at a time, lowest first
+	void PutVarint(std::vector<unsigned char>& out, unsigned int value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((unsigned char)value);
+	}
+
+	// The sign goes in the lowest bit, so small negatives stay small
+	void PutSigned(std::vector<unsigned char>& out, int value)
+	{
+		PutVarint(out, ((unsigned int)value << 1) ^ (unsigned int)(value >> 31));
+	}
+
+	void PutBytes(std::vector<unsigned char>& out, const void* data, size_t size)
+	{
+		out.insert(out.end(), (const unsigned char*)data, (const unsigned char*)data + size);
+	}
+
+	// Reads what the Put functions wrote, failing instead of
+	// running off the end
+	class Reader
+	{
+	public:
+		Reader(const std::vector<unsigned char>& data) : at(data.data()), end(data.data() + data.size()) {}
+
+		bool GetVarint(unsigned int& value)
+		{
+			value = 0;
+			for (int shift = 0; shift < 35; shift += 7)
+			{
+				if (at == end)
+					return false;
+				unsigned char byte = *at++;
+				value |= (unsigned int)(byte & 0x7F) << shift;
+				if (!(byte & 0x80))
+					return true;
+			}
+			return false;
+		}
+
+		bool GetSigned(int& value)
+		{
+			unsigned int raw;
+			if (!GetVarint(raw))
+				return false;
+			value = (int)(raw >> 1) ^ -(int)(raw & 1);
+			return true;
+		}
+
+		bool GetBytes(void* data, size_t size)
+		{
+			if ((size_t)(end - at) < size)
+				return false;
+			memcpy(data, at, size);
+			at += size;
+			return true;
+		}
+
+		bool AtEnd() { return at == end; }
+
+	private:
+		const unsigned char* at;
+		const unsigned char* end;
+	};
+}
+
+
+// --------------------------------------------------------
+// Appends a frame.  Events are copied without their
+// arrival times
+// --------------------------------------------------------
+void InputRecording::AddFrame(float pDeltaTime, float pTotalTime, int pMouseX, int pMouseY, const std::vector<InputEvent>& pEvents)
+{
+	Frame frame = {};
+	frame.deltaTime = pDeltaTime;
+	frame.totalTime = pTotalTime;
+	frame.mouseX = pMouseX;
+	frame.mouseY = pMouseY;
+	frame.firstEvent = (unsigned int)events.size();
+	frame.eventCount = (unsigned int)pEvents.size();
+	frames.push_back(frame);
+
+	for (const InputEvent& event : pEvents)
+	{
+		events.push_back(event);
+		events.back().time = 0;
+	}
+}
+
+void InputRecording::Clear()
+{
+	heldKeys.clear();
+	startMouseX = 0;
+	startMouseY = 0;
+	frames.clear();
+	events.clear();
+}
+
+
+// --------------------------------------------------------
+// Writes the whole recording
+// --------------------------------------------------------
+bool InputRecording::Save(const std::string& pPath) const
+{
+	std::vector<unsigned char> bytes;
+	bytes.reserve(16 + frames.size() * 12 + events.size() * 3);
+	unsigned int header[4] = { RecordingMagic, RecordingVersion, (unsigned int)frames.size(), (unsigned int)events.size() };
+	PutBytes(bytes, header, sizeof(header));
+	PutVarint(bytes, (unsigned int)heldKeys.size());
+	PutBytes(bytes, heldKeys.data(), heldKeys.size());
+	PutSigned(bytes, startMouseX);
+	PutSigned(bytes, startMouseY);
+
+	int mouseX = startMouseX;
+	int mouseY = startMouseY;
+	for (const Frame& frame : frames)
+	{
+		PutBytes(bytes, &frame.deltaTime, sizeof(float));
+		PutBytes(bytes, &frame.totalTime, sizeof(float));
+		PutSigned(bytes, frame.mouseX - mouseX);
+		PutSigned(bytes, frame.mouseY - mouseY);
+		bytes.push_back(frame.flags);
+		PutVarint(bytes, frame.eventCount);
+		mouseX = frame.mouseX;
+		mouseY = frame.mouseY;
+
+		for (unsigned int i = frame.firstEvent; i < frame.firstEvent + frame.eventCount; i++)
+		{
+			const InputEvent& event = events[i];
+			bytes.push_back((unsigned char)event.type);
+			switch (event.type)
+			{
+			case InputEvent::Type::KeyDown:
+			case InputEvent::Type::KeyUp:
+				bytes.push_back(event.key);
+				break;
+
+			case InputEvent::Type::RawMouseMove:
+				PutSigned(bytes, event.x);
+				PutSigned(bytes, event.y);
+				break;
+
+			case InputEvent::Type::MouseWheel:
+				PutBytes(bytes, &event.wheel, sizeof(float));
+				break;
+
+			case InputEvent::Type::FocusLost:
+				break;
+			}
+		}
+	}
+
+	std::ofstream file(pPath, std::ios::binary | std::ios::trunc);
+	file.write((const char*)bytes.data(), bytes.size());
+	if (!file)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Input, "Couldn't write %s", pPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Reads a whole recording.  This one is only replaced if
+// the file checks out
+// --------------------------------------------------------
+bool InputRecording::Load(const std::string& pPath)
+{
+	std::ifstream file(pPath, std::ios::binary);
+	if (!file)
+	{
+		Log::Write(Log::Severity::Warning, Log::Category::Input, "Couldn't open %s", pPath.c_str());
+		return false;
+	}
+	std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	Reader reader(bytes);
+	unsigned int header[4];
+	if (!reader.GetBytes(header, sizeof(header)) || header[0] != RecordingMagic || header[1] != RecordingVersion)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Input, "%s isn't a version %u input recording", pPath.c_str(), RecordingVersion);
+		return false;
+	}
+
+	// Every frame takes at least 12 bytes, so a damaged count
+	// can't ask for much more memory than the file's size
+	std::vector<unsigned char> loadedHeldKeys;
+	std::vector<Frame> loadedFrames;
+	std::vector<InputEvent> loadedEvents;
+	unsigned int heldKeyCount = 0;
+	int loadedStartX = 0;
+	int loadedStartY = 0;
+	bool valid =
+		header[2] <= bytes.size() / 12 && header[3] <= bytes.size() &&
+		reader.GetVarint(heldKeyCount) && heldKeyCount <= 256;
+	if (valid)
+	{
+		loadedHeldKeys.resize(heldKeyCount);
+		valid = reader.GetBytes(loadedHeldKeys.data(), heldKeyCount) && reader.GetSigned(loadedStartX) && reader.GetSigned(loadedStartY);
+	}
+	if (!valid)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Input, "%s is damaged", pPath.c_str());
+		return false;
+	}
+	loadedFrames.reserve(header[2]);
+	loadedEvents.reserve(header[3]);
+
+	int mouseX = loadedStartX;
+	int mouseY = loadedStartY;
+	for (unsigned int f = 0; valid && f < header[2]; f++)
+	{
+		Frame frame = {};
+		int moveX = 0;
+		int moveY = 0;
+		valid =
+			reader.GetBytes(&frame.deltaTime, sizeof(float)) &&
+			reader.GetBytes(&frame.totalTime, sizeof(float)) &&
+			reader.GetSigned(moveX) &&
+			reader.GetSigned(moveY) &&
+			reader.GetBytes(&frame.flags, 1) &&
+			reader.GetVarint(frame.eventCount);
+		mouseX += moveX;
+		mouseY += moveY;
+		frame.mouseX = mouseX;
+		frame.mouseY = mouseY;
+		frame.firstEvent = (unsigned int)loadedEvents.size();
+
+		for (unsigned int e = 0; valid && e < frame.eventCount; e++)
+		{
+			InputEvent event = {};
+			unsigned char type = 0;
+			valid = reader.GetBytes(&type, 1);
+			event.type = (InputEvent::Type)type;
+			switch (event.type)
+			{
+			case InputEvent::Type::KeyDown:
+			case InputEvent::Type::KeyUp:
+				valid = valid && reader.GetBytes(&event.key, 1);
+				break;
+
+			case InputEvent::Type::RawMouseMove:
+				valid = valid && reader.GetSigned(event.x) && reader.GetSigned(event.y);
+				break;
+
+			case InputEvent::Type::MouseWheel:
+				valid = valid && reader.GetBytes(&event.wheel, sizeof(float));
+				break;
+
+			case InputEvent::Type::FocusLost:
+				break;
+
+			default:
+				valid = false;
+				break;
+			}
+			loadedEvents.push_back(event);
+		}
+		loadedFrames.push_back(frame);
+	}
+
+	if (!valid || !reader.AtEnd() || loadedEvents.size() != header[3])
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Input, "%s is damaged", pPath.c_str());
+		return false;
+	}
+
+	heldKeys.swap(loadedHeldKeys);
+	startMouseX = loadedStartX;
+	startMouseY = loadedStartY;
+	frames.swap(loadedFrames);
+	events.swap(loadedEvents);
+	return true;
+}
+
+// Getters
+unsigned int InputRecording::GetFrameCount() const { return (unsigned int)frames.size(); }
+
+double InputRecording::GetSeconds() const
+{
+	double seconds = 0.0;
+	for (const Frame& frame : frames)
+		seconds += frame.deltaTime;
+	return seconds;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "InputQueue.h"
+
+// See InputRecording.cpp for usage details
+
+// Every frame's time step and input, in order, so a session
+// can be played back exactly
+struct InputRecording
+{
+	enum FrameFlags
+	{
+		KeyboardCaptured = 1,		// By the UI, so Input reported no keys
+		MouseCaptured = 2
+	};
+
+	struct Frame
+	{
+		float deltaTime;
+		float totalTime;
+		int mouseX;					// Cursor, relative to the window
+		int mouseY;
+		unsigned char flags;		// FrameFlags
+		unsigned int firstEvent;	// Into events
+		unsigned int eventCount;
+	};
+
+	// Where things stood before the first frame
+	std::vector<unsigned char> heldKeys;
+	int startMouseX = 0;
+	int startMouseY = 0;
+
+	std::vector<Frame> frames;
+	std::vector<InputEvent> events;	// Without their times
+
+	void AddFrame(float pDeltaTime, float pTotalTime, int pMouseX, int pMouseY, const std::vector<InputEvent>& pEvents);
+	void Clear();
+
+	// Compact binary, a few bytes for a frame with no input
+	bool Save(const std::string& pPath) const;
+	bool Load(const std::string& pPath);
+
+	// Getters
+	unsigned int GetFrameCount() const;
+	double GetSeconds() const;		// Recorded time, adding up every frame
+};
@@ -0,0 +1,306 @@
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------- Basic usage -----------------
+//
+// A small pool of worker threads that run jobs
+// submitted from any thread, in submission order:
+//
+//   JobSystem::Initialize();	// One thread per core, minus the main thread
+//   JobSystem::Submit([]() { /* work */ });
+//   JobSystem::WaitIdle();		// Blocks until every job has finished
+//   JobSystem::ShutDown();
+//
+// ParallelFor() splits work into numbered pieces that
+// the workers and the calling thread share, and waits
+// for just those pieces (not other queued jobs):
+//
+//   JobSystem::ParallelFor(chunkCount, [&](unsigned int chunk) { /* work */ });
+//
+// Jobs must not touch D3D11 immediate context or
+// ImGui state, since both belong to the main thread.
+// Hand results back to the main thread instead.
+//
+// If the pool was never initialized (or has no
+// threads), Submit() runs the job immediately.
+//
+// ParallelFor() never allocates: batches come from a
+// fixed pool (a call that finds every one busy runs its
+// pieces on the calling thread), its helper jobs capture
+// a single pointer, and Initialize() sizes the queue so
+// it holds every helper of every batch at once.  Jobs
+// passed to Submit() that capture more than a pointer or
+// two may still allocate inside std::function, and a
+// queue that fills up grows.
+// ---------------------------------------------
+
+namespace JobSystem
+{
+	// Annonymous namespace to hold variables
+	// only accessible in this file
+	namespace
+	{
+		std::vector<std::thread> workers;
+		std::mutex queueMutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable jobsFinished;
+		unsigned int runningJobs = 0;
+		bool quitting = false;
+
+		// Ring buffer of queued jobs, only ever grown
+		std::vector<std::function<void()>> queue;
+		size_t queueHead = 0;
+		size_t queueCount = 0;
+
+		// Which worker this is (0 on any other thread)
+		thread_local unsigned int threadIndex = 0;
+
+		// ParallelFor() calls that can run at once, nested or
+		// from several threads
+		const unsigned int MaxBatches = 64;
+
+		// One ParallelFor() call, shared with its helper jobs.
+		// Helpers may start after the call returns, so a batch is
+		// only reused once every helper has left it
+		struct Batch
+		{
+			std::atomic<unsigned int> next{ 0 };
+			std::atomic<unsigned int> finished{ 0 };
+			std::atomic<unsigned int> exitedHelpers{ 0 };
+			unsigned int count = 0;
+			unsigned int helpers = 0;
+			bool inUse = false;
+			void (*run)(void*, unsigned int) = 0;
+			void* context = 0;
+		};
+		Batch batches[MaxBatches];
+		std::mutex batchMutex;
+
+		// All called with queueMutex held
+		void GrowQueue(size_t size)
+		{
+			// The queue outlives whatever tag the caller is charging
+			MemoryTracker::Scope scope(MemoryTracker::Tag::General);
+			std::vector<std::function<void()>> grown(size);
+			for (size_t i = 0; i < queueCount; i++)
+				grown[i] = std::move(queue[(queueHead + i) % queue.size()]);
+			queue.swap(grown);
+			queueHead = 0;
+		}
+
+		void PushJob(std::function<void()>&& job)
+		{
+			if (queueCount == queue.size())
+				GrowQueue(queue.size() > 0 ? queue.size() * 2 : 64);
+			queue[(queueHead + queueCount) % queue.size()] = std::move(job);
+			queueCount++;
+		}
+
+		std::function<void()> PopJob()
+		{
+			std::function<void()> job = std::move(queue[queueHead]);
+			queue[queueHead] = nullptr;
+			queueHead = (queueHead + 1) % queue.size();
+			queueCount--;
+			return job;
+		}
+
+		// Claims a free batch, or returns null if they're all busy
+		Batch* AcquireBatch()
+		{
+			std::lock_guard<std::mutex> lock(batchMutex);
+			for (Batch& batch : batches)
+			{
+				if (!batch.inUse && batch.exitedHelpers.load(std::memory_order_acquire) == batch.helpers)
+				{
+					batch.inUse = true;
+					return &batch;
+				}
+			}
+			return 0;
+		}
+
+		void ReleaseBatch(Batch* batch)
+		{
+			std::lock_guard<std::mutex> lock(batchMutex);
+			batch->inUse = false;
+		}
+
+		// Only touches the job while holding an unfinished piece,
+		// so the caller's function is still alive
+		void RunPieces(Batch& batch)
+		{
+			unsigned int piece;
+			while ((piece = batch.next.fetch_add(1)) < batch.count)
+			{
+				batch.run(batch.context, piece);
+				batch.finished.fetch_add(1, std::memory_order_release);
+			}
+		}
+
+		// Main loop of each worker thread
+		void WorkerLoop(unsigned int index)
+		{
+			threadIndex = index;
+			while (true)
+			{
+				std::function<void()> job;
+				{
+					std::unique_lock<std::mutex> lock(queueMutex);
+					jobAvailable.wait(lock, []() { return quitting || queueCount > 0; });
+					if (queueCount == 0)
+						return;
+
+					job = PopJob();
+					runningJobs++;
+				}
+
+				job();
+
+				std::lock_guard<std::mutex> lock(queueMutex);
+				runningJobs--;
+				if (runningJobs == 0 && queueCount == 0)
+					jobsFinished.notify_all();
+			}
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Starts the worker threads.  A count of zero picks one
+// thread per hardware core, leaving one for the main thread.
+// --------------------------------------------------------
+void JobSystem::Initialize(unsigned int threadCount)
+{
+	if (!workers.empty())
+		return;
+
+	if (threadCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = cores > 1 ? cores - 1 : 1;
+	}
+
+	// Every batch's helpers, plus room for other jobs
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		if (queue.size() < MaxBatches * threadCount + 64)
+			GrowQueue(MaxBatches * threadCount + 64);
+	}
+
+	quitting = false;
+	workers.reserve(threadCount);
+	for (unsigned int i = 0; i < threadCount; i++)
+		workers.emplace_back(WorkerLoop, i + 1);
+}
+
+
+// --------------------------------------------------------
+// Finishes any queued jobs and joins the worker threads
+// --------------------------------------------------------
+void JobSystem::ShutDown()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		quitting = true;
+	}
+	jobAvailable.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+
+// --------------------------------------------------------
+// Queues a job for the next free worker
+// --------------------------------------------------------
+void JobSystem::Submit(std::function<void()> job)
+{
+	if (workers.empty())
+	{
+		job();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(queueMutex);
+		PushJob(std::move(job));
+	}
+	jobAvailable.notify_one();
+}
+
+
+// --------------------------------------------------------
+// Runs run(context, 0) through run(context, count - 1) on
+// the workers and the calling thread, returning once all of
+// them have finished.  Pieces are handed out one at a time,
+// so the calling thread does everything itself if the
+// workers (or every batch) are busy.  Usually called through the template
+// in JobSystem.h, with a lambda
+// --------------------------------------------------------
+void JobSystem::ParallelFor(unsigned int count, void (*run)(void* context, unsigned int piece), void* context)
+{
+	if (count == 0)
+		return;
+
+	Batch* batch = AcquireBatch();
+	if (!batch)
+	{
+		for (unsigned int piece = 0; piece < count; piece++)
+			run(context, piece);
+		return;
+	}
+
+	batch->next.store(0, std::memory_order_relaxed);
+	batch->finished.store(0, std::memory_order_relaxed);
+	batch->exitedHelpers.store(0, std::memory_order_relaxed);
+	batch->count = count;
+	batch->helpers = count - 1 < ThreadCount() ? count - 1 : ThreadCount();
+	batch->run = run;
+	batch->context = context;
+
+	for (unsigned int i = 0; i < batch->helpers; i++)
+	{
+		Submit([batch]()
+			{
+				RunPieces(*batch);
+				batch->exitedHelpers.fetch_add(1, std::memory_order_release);
+			});
+	}
+
+	RunPieces(*batch);
+	while (batch->finished.load(std::memory_order_acquire) < count)
+		std::this_thread::yield();
+	ReleaseBatch(batch);
+}
+
+
+// --------------------------------------------------------
+// Blocks the calling thread until the queue is empty and
+// no worker is running a job.  Must not be called from
+// inside a job.
+// --------------------------------------------------------
+void JobSystem::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(queueMutex);
+	jobsFinished.wait(lock, []() { return runningJobs == 0 && queueCount == 0; });
+}
+
+
+// Getters
+unsigned int JobSystem::ThreadCount() { return (unsigned int)workers.size(); }
+unsigned int JobSystem::PendingJobCount()
+{
+	std::lock_guard<std::mutex> lock(queueMutex);
+	return (unsigned int)queueCount + runningJobs;
+}
+
+unsigned int JobSystem::ThreadIndex() { return threadIndex; }
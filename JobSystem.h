@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+
+// See JobSystem.cpp for usage details
+
+namespace JobSystem
+{
+	// General functions
+	void Initialize(unsigned int threadCount = 0);
+	void ShutDown();
+
+	// Job submission
+	void Submit(std::function<void()> job);
+	void ParallelFor(unsigned int count, void (*run)(void* context, unsigned int piece), void* context);
+	template<class Function> void ParallelFor(unsigned int count, const Function& job);
+	void WaitIdle();
+
+	// Getters
+	unsigned int ThreadCount();
+	unsigned int PendingJobCount();
+	unsigned int ThreadIndex();		// 1 to ThreadCount() on workers, 0 anywhere else
+}
+
+// Calls job(piece) through a plain function pointer, so the job
+// (and everything it captures) is never copied or allocated
+template<class Function>
+void JobSystem::ParallelFor(unsigned int count, const Function& job)
+{
+	ParallelFor(count, [](void* context, unsigned int piece) { (*(const Function*)context)(piece); }, (void*)&job);
+}
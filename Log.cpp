@@ -0,0 +1,611 @@
+#include "Log.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ImGui/imgui.h"
+#include "ImGui/imgui_internal.h"
+
+// --------------- Basic usage -----------------
+//
+// A thread-safe log with severity and category tags,
+// an optional log file and an ImGui console panel:
+//
+//   Log::Initialize(FixPath("Log.txt"));
+//   Log::Write(Log::Severity::Warning, Log::Category::Assets, "Missing %s", name);
+//
+// Then, once per frame on the main thread:
+//
+//   Log::Update();				// Moves new lines into the console
+//   Log::DrawConsole("Log");	// Between ImGui::NewFrame() and ImGui::Render()
+//
+// And at the very end of the program:
+//
+//   Log::ShutDown();
+//
+// Write() never locks or allocates: it formats the
+// message straight into a slot of a fixed-size ring
+// buffer that any number of threads can fill at once.
+// If the ring is full the message is dropped (and
+// counted) rather than stalling the caller.
+//
+// A writer thread empties the ring, appends the lines
+// to the log file, echoes them to stdout (the debug
+// console window, if there is one) and hands them to
+// the main thread for the console panel.
+//
+// The console keeps every line in one text buffer
+// with an array of line offsets, and only draws the
+// lines that are on screen.  Line widths are measured
+// once, as lines arrive, and kept in a layout cache.  Filtering builds an index
+// of matching lines a slice at a time, so even logs
+// with millions of lines stay interactive.
+// ---------------------------------------------
+
+namespace Log
+{
+	// Annonymous namespace to hold variables
+	// only accessible in this file
+	namespace
+	{
+		const size_t RingSize = 8192;					// Must be a power of two
+		const size_t SlotTextSize = 480;
+		const int ConsoleMaxLines = 2 * 1024 * 1024;	// Oldest half is trimmed past this
+		const int ConsoleMaxBytes = 256 * 1024 * 1024;
+		const int FilterLinesPerFrame = 250000;
+		const std::chrono::milliseconds WriterInterval(5);
+
+		const char* SeverityNames[] = { "Info", "Warning", "Error" };
+		const char* CategoryNames[] = { "General", "Graphics", "Input", "Assets" };
+
+		// One message in the ring.  The sequence number tells
+		// producers and the consumer who owns the slot: it is
+		// 2 * lap while free and 2 * lap + 1 once filled, so
+		// the zero-initialized ring is ready before Initialize()
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			Severity severity;
+			Category category;
+			double time;
+			char text[SlotTextSize];
+		};
+
+		// A line drained from the ring, waiting for the main thread
+		struct StagedLine
+		{
+			unsigned int length;
+			Severity severity;
+			Category category;
+		};
+
+		// A line in the console's text buffer
+		struct ConsoleLine
+		{
+			int offset;
+			int length;
+			Severity severity;
+			Category category;
+		};
+
+		// Ring buffer (many producers, one consumer)
+		Slot ring[RingSize];
+		std::atomic<size_t> writePos(0);
+		size_t readPos = 0;
+		std::atomic<unsigned long long> droppedMessages(0);
+		const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+		// Writer thread
+		std::thread writer;
+		std::mutex writerMutex;
+		std::condition_variable writerWake;
+		bool writerRunning = false;
+		bool quitting = false;
+		FILE* logFile = 0;
+
+		// Lines handed from the writer thread to the main thread.
+		// These use std containers, as ImGui's allocator belongs
+		// to the main thread
+		std::mutex stagingMutex;
+		std::string stagedText;
+		std::vector<StagedLine> stagedLines;
+
+		// Console state (main thread only)
+		ImGuiTextBuffer consoleText;
+		ImVector<ConsoleLine> consoleLines;
+		ImGuiTextLayoutCache consoleLayout;		// Line n is consoleLines[n]
+		ImGuiTextFilter filter;
+		bool severityFilter[(int)Severity::Count] = { true, true, true };
+		bool categoryFilter[(int)Category::Count] = { true, true, true, true };
+		ImVector<int> filteredLines;
+		int filterScanned = 0;
+		bool autoScroll = true;
+
+		// Takes the next filled slot from the ring, if there is one.
+		// Only one thread may call this at a time
+		bool ReadSlot(std::string& text, StagedLine& line, double& time)
+		{
+			Slot& slot = ring[readPos & (RingSize - 1)];
+			size_t filled = (readPos / RingSize) * 2 + 1;
+			if (slot.sequence.load(std::memory_order_acquire) != filled)
+				return false;
+
+			line.severity = slot.severity;
+			line.category = slot.category;
+			time = slot.time;
+			size_t length = strnlen(slot.text, SlotTextSize);
+			text.append(slot.text, length);
+			line.length = (unsigned int)length;
+
+			// The console draws one row per line
+			for (size_t i = text.size() - length; i < text.size(); i++)
+				if (text[i] == '\n' || text[i] == '\r')
+					text[i] = ' ';
+
+			// Hand the slot back to producers for the next lap
+			slot.sequence.store(filled + 1, std::memory_order_release);
+			readPos++;
+			return true;
+		}
+
+		// Empties the ring, staging lines for the console and
+		// optionally building the text for the file and stdout
+		bool DrainRing(std::string* fileText, std::string* echoText)
+		{
+			std::string text;
+			std::vector<StagedLine> lines;
+			StagedLine line = {};
+			double time = 0;
+			while (ReadSlot(text, line, time))
+			{
+				lines.push_back(line);
+
+				if (fileText || echoText)
+				{
+					char prefix[64];
+					snprintf(prefix, sizeof(prefix), "[%10.3f] [%s] [%s] ",
+						time, SeverityNames[(int)line.severity], CategoryNames[(int)line.category]);
+					const char* message = text.c_str() + text.size() - line.length;
+
+					if (fileText)
+					{
+						fileText->append(prefix);
+						fileText->append(message, line.length);
+						fileText->push_back('\n');
+					}
+
+					if (echoText)
+					{
+						// Color code based on severity
+						switch (line.severity)
+						{
+						case Severity::Error: echoText->append("\x1B[91m"); break; // RED
+						case Severity::Warning: echoText->append("\x1B[93m"); break; // YELLOW
+						default: echoText->append("\x1B[96m"); break; // CYAN
+						}
+						echoText->append(message, line.length);
+						echoText->append("\x1B[0m\n");
+					}
+				}
+			}
+
+			if (lines.empty())
+				return false;
+
+			std::lock_guard<std::mutex> lock(stagingMutex);
+			stagedText.append(text);
+			stagedLines.insert(stagedLines.end(), lines.begin(), lines.end());
+			return true;
+		}
+
+		// Main loop of the writer thread
+		void WriterLoop()
+		{
+			std::string fileText;
+			std::string echoText;
+			while (true)
+			{
+				bool quit = false;
+				{
+					std::unique_lock<std::mutex> lock(writerMutex);
+					writerWake.wait_for(lock, WriterInterval, []() { return quitting; });
+					quit = quitting;
+				}
+
+				// One write per batch, rather than one per line
+				fileText.clear();
+				echoText.clear();
+				if (DrainRing(logFile ? &fileText : 0, &echoText))
+				{
+					fwrite(echoText.data(), 1, echoText.size(), stdout);
+					if (logFile)
+					{
+						fwrite(fileText.data(), 1, fileText.size(), logFile);
+						fflush(logFile);
+					}
+				}
+
+				if (quit)
+					return;
+			}
+		}
+
+		bool PassesFilter(const ConsoleLine& line)
+		{
+			if (!severityFilter[(int)line.severity] || !categoryFilter[(int)line.category])
+				return false;
+
+			const char* start = consoleText.begin() + line.offset;
+			return filter.PassFilter(start, start + line.length);
+		}
+
+		bool FilterActive()
+		{
+			for (bool show : severityFilter) if (!show) return true;
+			for (bool show : categoryFilter) if (!show) return true;
+			return filter.IsActive();
+		}
+
+		void ResetFilterIndex()
+		{
+			filteredLines.resize(0);
+			filterScanned = 0;
+		}
+
+		// Drops the oldest half of the console once it gets too big
+		void TrimConsole()
+		{
+			if (consoleLines.Size <= ConsoleMaxLines && consoleText.size() <= ConsoleMaxBytes)
+				return;
+
+			int dropLines = consoleLines.Size / 2;
+			int dropBytes = consoleLines[dropLines].offset;
+			consoleText.Buf.erase(consoleText.Buf.begin(), consoleText.Buf.begin() + dropBytes);
+			consoleLines.erase(consoleLines.begin(), consoleLines.begin() + dropLines);
+			for (ConsoleLine& line : consoleLines)
+				line.offset -= dropBytes;
+			ResetFilterIndex();
+
+			// Drop the same lines from the layout rather than
+			// measuring everything that's left again
+			ImGuiTextIndex& layoutLines = consoleLayout.Lines;
+			if (consoleLayout.LineWidths.Size <= dropLines)
+			{
+				consoleLayout.clear();
+				return;
+			}
+			layoutLines.Offsets.erase(layoutLines.Offsets.begin(), layoutLines.Offsets.begin() + dropLines);
+			for (int& offset : layoutLines.Offsets)
+				offset -= dropBytes;
+			layoutLines.EndOffset -= dropBytes;
+			consoleLayout.LineWidths.erase(consoleLayout.LineWidths.begin(), consoleLayout.LineWidths.begin() + dropLines);
+			consoleLayout.MaxLineWidth = 0.0f;
+			for (float width : consoleLayout.LineWidths)
+				consoleLayout.MaxLineWidth = ImMax(consoleLayout.MaxLineWidth, width);
+		}
+
+		// Fills the ring from worker threads to check the
+		// producers, the writer and the console under load
+		void RunStressTest(int lineCount)
+		{
+			int jobCount = JobSystem::ThreadCount() > 0 ? (int)JobSystem::ThreadCount() : 1;
+			for (int job = 0; job < jobCount; job++)
+			{
+				int first = lineCount * job / jobCount;
+				int last = lineCount * (job + 1) / jobCount;
+				JobSystem::Submit([job, first, last]()
+					{
+						for (int i = first; i < last; i++)
+						{
+							Severity severity = (i % 97 == 0) ? Severity::Error : (i % 13 == 0) ? Severity::Warning : Severity::Info;
+							while (!Write(severity, Category::General, "Stress test line %d from job %d", i, job))
+								std::this_thread::yield();
+						}
+					});
+			}
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Opens the log file and starts the writer thread
+// --------------------------------------------------------
+void Log::Initialize(const std::string& logFilePath)
+{
+	if (writerRunning)
+		return;
+
+#ifdef _WIN32
+	if (fopen_s(&logFile, logFilePath.c_str(), "w") != 0)
+		logFile = 0;
+#else
+	logFile = fopen(logFilePath.c_str(), "w");
+#endif
+	quitting = false;
+	writerRunning = true;
+	writer = std::thread(WriterLoop);
+}
+
+
+// --------------------------------------------------------
+// Writes any remaining messages and stops the writer thread
+// --------------------------------------------------------
+void Log::ShutDown()
+{
+	if (!writerRunning)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(writerMutex);
+		quitting = true;
+	}
+	writerWake.notify_all();
+	writer.join();
+	writerRunning = false;
+
+	if (logFile)
+	{
+		fclose(logFile);
+		logFile = 0;
+	}
+}
+
+
+// --------------------------------------------------------
+// Moves lines drained by the writer thread into the console
+// and advances the filter index.  Main thread only.
+// --------------------------------------------------------
+void Log::Update()
+{
+	// Without a writer thread (before Initialize or after
+	// ShutDown), the main thread empties the ring itself
+	if (!writerRunning)
+		DrainRing(0, 0);
+
+	std::string text;
+	std::vector<StagedLine> lines;
+	{
+		std::lock_guard<std::mutex> lock(stagingMutex);
+		text.swap(stagedText);
+		lines.swap(stagedLines);
+	}
+
+	// Append to the console's text buffer, one line each
+	const char* next = text.c_str();
+	consoleLines.reserve(consoleLines.Size + (int)lines.size());
+	for (const StagedLine& staged : lines)
+	{
+		ConsoleLine line = {};
+		line.offset = consoleText.size();
+		line.length = (int)staged.length;
+		line.severity = staged.severity;
+		line.category = staged.category;
+		consoleText.append(next, next + staged.length);
+		consoleText.append("\n");
+		consoleLines.push_back(line);
+		next += staged.length;
+	}
+	TrimConsole();
+
+	// Index a slice of the lines that haven't been checked yet
+	if (FilterActive())
+	{
+		int scanEnd = filterScanned + FilterLinesPerFrame;
+		if (scanEnd > consoleLines.Size)
+			scanEnd = consoleLines.Size;
+		for (; filterScanned < scanEnd; filterScanned++)
+			if (PassesFilter(consoleLines[filterScanned]))
+				filteredLines.push_back(filterScanned);
+	}
+}
+
+
+// --------------------------------------------------------
+// Formats a message into the ring buffer.  Lock-free and
+// allocation-free, so it's safe from any thread.
+// --------------------------------------------------------
+bool Log::Write(Severity severity, Category category, const char* format, ...)
+{
+	// Claim the next slot, unless it still holds
+	// a message from the previous lap (ring is full)
+	size_t pos = writePos.load(std::memory_order_relaxed);
+	Slot* slot = 0;
+	size_t freeSequence = 0;
+	while (true)
+	{
+		slot = &ring[pos & (RingSize - 1)];
+		freeSequence = (pos / RingSize) * 2;
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		if (sequence == freeSequence)
+		{
+			if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (sequence < freeSequence)
+		{
+			droppedMessages.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			// Another thread took this slot first
+			pos = writePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->severity = severity;
+	slot->category = category;
+	slot->time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	// Long messages are cut off to fit the slot
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(slot->text, SlotTextSize, format, args);
+	va_end(args);
+	if (length < 0)
+		slot->text[0] = 0;
+	else if (length >= (int)SlotTextSize)
+		memcpy(slot->text + SlotTextSize - 4, "...", 4);
+
+	// Publish to the consumer
+	slot->sequence.store(freeSequence + 1, std::memory_order_release);
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Draws the console panel.  Only the visible lines are
+// submitted to ImGui, using the line offsets and filter index.
+// --------------------------------------------------------
+void Log::DrawConsole(const char* title, bool* open)
+{
+	if (!ImGui::Begin(title, open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	// Severity and category toggles
+	bool filterChanged = false;
+	for (int i = 0; i < (int)Severity::Count; i++)
+	{
+		filterChanged |= ImGui::Checkbox(SeverityNames[i], &severityFilter[i]);
+		ImGui::SameLine();
+	}
+	if (ImGui::Button("Categories"))
+		ImGui::OpenPopup("Categories");
+	if (ImGui::BeginPopup("Categories"))
+	{
+		for (int i = 0; i < (int)Category::Count; i++)
+			filterChanged |= ImGui::Checkbox(CategoryNames[i], &categoryFilter[i]);
+		ImGui::EndPopup();
+	}
+	ImGui::SameLine();
+	filterChanged |= filter.Draw("Filter", 200.0f);
+	if (filterChanged)
+		ResetFilterIndex();
+
+	// Actions
+	if (ImGui::Button("Clear"))
+		ClearConsole();
+	ImGui::SameLine();
+	if (ImGui::Button("Stress test (1M lines)"))
+		RunStressTest(1000000);
+	ImGui::SameLine();
+	ImGui::Checkbox("Auto-scroll", &autoScroll);
+
+	// Stats
+	bool filterActive = FilterActive();
+	ConsoleStats stats = GetConsoleStats();
+	int shownLines = stats.shownLines;
+	ImGui::Text("%d lines, %d shown, %.1f MB, %llu dropped",
+		stats.lines, shownLines, consoleText.size() / (1024.0f * 1024.0f), stats.droppedMessages);
+	if (stats.filterScanned < stats.lines)
+	{
+		ImGui::SameLine();
+		ImGui::Text("(filtering %d%%)", (int)(100.0f * stats.filterScanned / stats.lines));
+	}
+	ImGui::Separator();
+
+	// Lines, clipped to the visible region
+	if (ImGui::BeginChild("Lines", ImVec2(0, 0), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar))
+	{
+		// Only lines added since last frame are measured
+		consoleLayout.Update(consoleText.begin(), consoleText.end(), ImGui::GetFont(), ImGui::GetFontSize());
+
+		// Drawn straight into the window's draw list, sized from
+		// the layout, as ImGui::TextUnformattedCached() does
+		const float lineHeight = ImGui::GetTextLineHeight();
+		const ImU32 infoColor = ImGui::GetColorU32(ImGuiCol_Text);
+		const ImU32 warningColor = ImGui::GetColorU32(ImVec4(1.0f, 0.85f, 0.3f, 1.0f));
+		const ImU32 errorColor = ImGui::GetColorU32(ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+		ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
+		ImGuiListClipper clipper;
+		clipper.Begin(shownLines, lineHeight);
+		while (clipper.Step())
+		{
+			for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+			{
+				int index = filterActive ? filteredLines[row] : row;
+				const ConsoleLine& line = consoleLines[index];
+				const char* start = consoleText.begin() + line.offset;
+
+				ImU32 color = line.severity == Severity::Error ? errorColor : line.severity == Severity::Warning ? warningColor : infoColor;
+				drawList->AddText(ImGui::GetCursorScreenPos(), color, start, start + line.length);
+				ImGui::Dummy(ImVec2(consoleLayout.LineWidths[index], lineHeight));
+			}
+		}
+		clipper.End();
+		ImGui::PopStyleVar();
+
+		// Stay at the bottom if we already were
+		if (autoScroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY())
+			ImGui::SetScrollHereY(1.0f);
+	}
+	ImGui::EndChild();
+
+	ImGui::End();
+}
+
+
+// --------------------------------------------------------
+// Empties the console, as its Clear button does
+// --------------------------------------------------------
+void Log::ClearConsole()
+{
+	consoleText.clear();
+	consoleLines.clear();
+	consoleLayout.clear();
+	ResetFilterIndex();
+}
+
+
+// --------------------------------------------------------
+// Replaces the text filter.  The index of matching lines
+// is rebuilt a slice at a time by the following Update()s.
+// --------------------------------------------------------
+void Log::SetConsoleFilter(const char* text)
+{
+	snprintf(filter.InputBuf, sizeof(filter.InputBuf), "%s", text);
+	filter.Build();
+	ResetFilterIndex();
+}
+
+
+Log::ConsoleStats Log::GetConsoleStats()
+{
+	bool filterActive = FilterActive();
+	ConsoleStats stats = {};
+	stats.lines = consoleLines.Size;
+	stats.shownLines = filterActive ? filteredLines.Size : consoleLines.Size;
+	stats.filterScanned = filterActive ? filterScanned : consoleLines.Size;
+	stats.droppedMessages = droppedMessages.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
+// --------------------------------------------------------
+// Text of a line the console shows, counting only the
+// lines that pass the filter
+// --------------------------------------------------------
+std::string Log::GetConsoleLine(int shownRow)
+{
+	bool filterActive = FilterActive();
+	int shownLines = filterActive ? filteredLines.Size : consoleLines.Size;
+	if (shownRow < 0 || shownRow >= shownLines)
+		return std::string();
+
+	const ConsoleLine& line = consoleLines[filterActive ? filteredLines[shownRow] : shownRow];
+	return std::string(consoleText.begin() + line.offset, line.length);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+
+// See Log.cpp for usage details
+
+namespace Log
+{
+	enum class Severity
+	{
+		Info,
+		Warning,
+		Error,
+		Count
+	};
+
+	enum class Category
+	{
+		General,
+		Graphics,
+		Input,
+		Assets,
+		Count
+	};
+
+	// General functions
+	void Initialize(const std::string& logFilePath);
+	void ShutDown();
+	void Update();
+
+	// Safe to call from any thread, returns false if the message was dropped
+	bool Write(Severity severity, Category category, const char* format, ...);
+
+	// What the console holds, as of the last Update()
+	struct ConsoleStats
+	{
+		int lines;
+		int shownLines;					// Lines that pass the filter, as far as it has been indexed
+		int filterScanned;				// How far that is (every line while no filter is set)
+		unsigned long long droppedMessages;
+	};
+
+	// ImGui console panel, and the same actions without it
+	void DrawConsole(const char* title, bool* open = 0);
+	void ClearConsole();
+	void SetConsoleFilter(const char* text);	// As if typed into the filter box
+	ConsoleStats GetConsoleStats();
+	std::string GetConsoleLine(int shownRow);
+}
@@ -6,6 +6,10 @@
 #include "Graphics.h"
 #include "Game.h"
 #include "Input.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MemoryTracker.h"
+#include "PathHelpers.h"
 
 // Annonymous namespace to hold variables
 // only accessible in this file
@@ -45,9 +49,12 @@ int WINAPI WinMain(
 
 	// Do we also want a console window?  Probably only in debug mode
 	Window::CreateConsoleWindow(500, 120, 32, 120);
-	printf("Console window created successfully.  Feel free to printf() here.\n");
 #endif
 
+	// Start the log, which writes to a file and echoes to the console window (if any)
+	Log::Initialize(FixPath("Log.txt"));
+	Log::Write(Log::Severity::Info, Log::Category::General, "Log started.  Use Log::Write() instead of printf().");
+
 	// Set up app initialization details
 	unsigned int windowWidth = 1280;
 	unsigned int windowHeight = 720;
@@ -78,9 +85,31 @@ int WINAPI WinMain(
 	// Initalize the input system, which requires the window handle
 	Input::Initialize(Window::Handle());
 
+	// Start the worker threads used for background work (font baking, etc.)
+	JobSystem::Initialize();
+
 	// Now the main application object itself can be initialzied
 	game = new Game();
 
+	// "-replay Recording.inp" (next to the executable) plays a
+	// recording back from its first frame, and "-exit" quits
+	// once it's done, so the same frames can be profiled run
+	// after run
+	std::string commandLine = lpCmdLine;
+	size_t replayAt = commandLine.find("-replay ");
+	bool exitAfterReplay = false;
+	if (replayAt != std::string::npos)
+	{
+		std::string replayPath = commandLine.substr(replayAt + 8);
+		replayPath = replayPath.substr(0, replayPath.find(' '));
+		exitAfterReplay = Input::StartReplay(FixPath(replayPath)) && commandLine.find("-exit") != std::string::npos;
+	}
+
+	// Real frame times while replaying, for comparing runs
+	double replaySeconds = 0.0;
+	double slowestReplayFrame = 0.0;
+	unsigned int replayedFrames = 0;
+
 	// Time tracking
 	LARGE_INTEGER perfFreq{};
 	double perfSeconds = 0;
@@ -97,49 +126,77 @@ int WINAPI WinMain(
 	currentTime = startTime;
 	previousTime = startTime;
 
-	// Windows message loop (and our game loop)
-	MSG msg = {};
-	while (msg.message != WM_QUIT)
+	// The game loop.  Window messages are pumped on their own
+	// thread (see Window.cpp), so a flood of them, or dragging
+	// and resizing the window, never holds this up
+	while (!Window::QuitRequested())
 	{
-		// Determine if there is a message from the operating system
-		if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		// Wait for the swap chain and frame cap first, so the
+		// frame's time and input are as fresh as possible
+		game->WaitForNextFrame();
+
+		// Apply the newest window size and pass messages to the UI
+		Window::ProcessEvents();
+
+		// Calculate up-to-date timing info
+		QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
+		float deltaTime = max((float)((currentTime - previousTime) * perfSeconds), 0.0f);
+		float totalTime = (float)((currentTime - startTime) * perfSeconds);
+		previousTime = currentTime;
+
+		// Calculate basic fps
+		Window::UpdateStats(totalTime);
+
+		// Input updating, which swaps in the recorded
+		// time while replaying
+		bool wasReplaying = Input::IsReplaying();
+		Input::Update(deltaTime, totalTime);
+		if (wasReplaying && !Input::IsReplaying())
 		{
-			// Translate and dispatch the message
-			// to our custom WindowProc function
-			TranslateMessage(&msg);
-			DispatchMessage(&msg);
+			Log::Write(Log::Severity::Info, Log::Category::General, "Replayed %u frames in %.2f s: %.3f ms average, %.3f ms slowest",
+				replayedFrames, replaySeconds, replaySeconds * 1000.0 / replayedFrames, slowestReplayFrame * 1000.0);
+			replaySeconds = 0.0;
+			slowestReplayFrame = 0.0;
+			replayedFrames = 0;
+			if (exitAfterReplay)
+				Window::Quit();
 		}
-		else
-		{
-			// Calculate up-to-date timing info
-			QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
-			float deltaTime = max((float)((currentTime - previousTime) * perfSeconds), 0.0f);
-			float totalTime = (float)((currentTime - startTime) * perfSeconds);
-			previousTime = currentTime;
 
-			// Calculate basic fps
-			Window::UpdateStats(totalTime);
+		// Move new log lines into the console
+		Log::Update();
 
-			// Input updating
-			Input::Update();
+		// Update and draw
+		game->Update(deltaTime, totalTime);
+		game->Draw(deltaTime, totalTime);
 
-			// Update and draw
-			game->Update(deltaTime, totalTime);
-			game->Draw(deltaTime, totalTime);
+		// Notify Input system about end of frame
+		Input::EndOfFrame();
 
-			// Notify Input system about end of frame
-			Input::EndOfFrame();
+		// How long this replayed frame really took
+		if (Input::IsReplaying())
+		{
+			__int64 frameEndTime = 0;
+			QueryPerformanceCounter((LARGE_INTEGER*)&frameEndTime);
+			double frameSeconds = (frameEndTime - currentTime) * perfSeconds;
+			replaySeconds += frameSeconds;
+			slowestReplayFrame = max(slowestReplayFrame, frameSeconds);
+			replayedFrames++;
+		}
 
 #if defined(DEBUG) || defined(_DEBUG)
-			// Print any graphics debug messages that occurred this frame
-			Graphics::PrintDebugMessages();
+		// Print any graphics debug messages that occurred this frame
+		Graphics::PrintDebugMessages();
 #endif
-		}
 	}
 
-	// Clean up
+	// Clean up.  The window goes before input, since its
+	// thread queues input until it stops
 	delete game;
+	JobSystem::ShutDown();
+	Window::ShutDown();
 	Input::ShutDown();
 	Graphics::ShutDown();
-	return (HRESULT)msg.wParam;
+	MemoryTracker::LogLiveAllocations();	// Tagged memory that outlived the game
+	Log::ShutDown();
+	return 0;
 }
@@ -0,0 +1,229 @@
+#include "MemoryTracker.h"
+#include "Log.h"
+
+#include <atomic>
+
+// --------------- Basic usage -----------------
+//
+// Splits the heap up by who's using it.  Every
+// allocation made through the global operator new (see
+// AllocationCounter.cpp) is charged to the calling
+// thread's current tag, General unless a Scope says
+// otherwise:
+//
+//   {
+//       MemoryTracker::Scope scope(MemoryTracker::Tag::Meshes);
+//       vertices.assign(first, last);	// Charged to Meshes
+//   }
+//
+// The tag is remembered with the allocation, so freeing
+// it later (from anywhere) credits the right tag.  For
+// containers that keep growing after they're made, a
+// TrackedAllocator charges every allocation:
+//
+//   TrackedVector<std::shared_ptr<Entity>, MemoryTracker::Tag::Entities> entities;
+//
+// and ImGui is routed through here before its context is
+// created:
+//
+//   ImGui::SetAllocatorFunctions(MemoryTracker::ImGuiAlloc, MemoryTracker::ImGuiFree);
+//
+// Tags can have a budget.  Once per frame, on the main
+// thread:
+//
+//   MemoryTracker::SetBudget(MemoryTracker::Tag::Meshes, 64 * 1024 * 1024);	// Once
+//   MemoryTracker::Update(totalTime);
+//
+// works out allocation rates and logs a warning the
+// first time a tag goes over its budget (and again
+// after it has dropped back under).  At shutdown,
+// LogLiveAllocations() reports tags that should be empty
+// by then but aren't.
+//
+// Recording is a few relaxed atomic adds per allocation,
+// and works anywhere std::atomic does.
+// ---------------------------------------------
+
+namespace MemoryTracker
+{
+	// Annonymous namespace to hold variables/helpers only accessible in this file
+	namespace
+	{
+		const double RateWindowSeconds = 1.0;
+
+		const char* TagNames[] = { "General", "ImGui", "Meshes", "Entities", "Assets", "Frame arena" };
+
+		// Updated from any thread
+		struct Counters
+		{
+			std::atomic<long long> liveBytes{ 0 };
+			std::atomic<long long> peakBytes{ 0 };
+			std::atomic<long long> liveAllocations{ 0 };
+			std::atomic<unsigned long long> totalAllocations{ 0 };
+			std::atomic<unsigned long long> totalBytes{ 0 };
+		};
+		Counters counters[(int)Tag::Count];
+
+		// Only touched on the main thread
+		struct Budget
+		{
+			size_t bytes;
+			bool over;
+			unsigned long long windowAllocations;	// Totals when the rate window started
+			unsigned long long windowBytes;
+			double allocationsPerSecond;
+			double bytesPerSecond;
+		};
+		Budget budgets[(int)Tag::Count] = {};
+		double windowStart = -1.0;
+
+		thread_local Tag threadTag = Tag::General;
+	}
+}
+
+
+// --------------------------------------------------------
+// Scopes nest, each putting back the tag it replaced
+// --------------------------------------------------------
+MemoryTracker::Scope::Scope(Tag pTag)
+{
+	previous = threadTag;
+	threadTag = pTag;
+}
+
+MemoryTracker::Scope::~Scope()
+{
+	threadTag = previous;
+}
+
+
+// --------------------------------------------------------
+// Works out allocation rates, then checks budgets.  Call
+// once per frame on the main thread
+// --------------------------------------------------------
+void MemoryTracker::Update(double totalTime)
+{
+	double elapsed = totalTime - windowStart;
+	if (windowStart < 0.0 || elapsed >= RateWindowSeconds)
+	{
+		for (int i = 0; i < (int)Tag::Count; i++)
+		{
+			Budget& budget = budgets[i];
+			unsigned long long allocations = counters[i].totalAllocations.load(std::memory_order_relaxed);
+			unsigned long long bytes = counters[i].totalBytes.load(std::memory_order_relaxed);
+			if (windowStart >= 0.0)
+			{
+				budget.allocationsPerSecond = (allocations - budget.windowAllocations) / elapsed;
+				budget.bytesPerSecond = (bytes - budget.windowBytes) / elapsed;
+			}
+			budget.windowAllocations = allocations;
+			budget.windowBytes = bytes;
+		}
+		windowStart = totalTime;
+	}
+
+	CheckBudgets();
+}
+
+
+// --------------------------------------------------------
+// Logs a warning for each tag that just went over its
+// budget.  Main thread only
+// --------------------------------------------------------
+void MemoryTracker::CheckBudgets()
+{
+	for (int i = 0; i < (int)Tag::Count; i++)
+	{
+		Budget& budget = budgets[i];
+		if (budget.bytes == 0)
+			continue;
+
+		long long live = counters[i].liveBytes.load(std::memory_order_relaxed);
+		if (!budget.over && live > (long long)budget.bytes)
+		{
+			budget.over = true;
+			Log::Write(Log::Severity::Warning, Log::Category::General, "%s memory is over budget: %.2f of %.2f MB",
+				TagNames[i], live / (1024.0 * 1024.0), budget.bytes / (1024.0 * 1024.0));
+		}
+		else if (budget.over && live <= (long long)budget.bytes)
+		{
+			budget.over = false;
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Logs every tag (other than General, which holds static
+// objects until the very end) that still has memory.
+// Call after everything that owns tagged memory is gone
+// --------------------------------------------------------
+void MemoryTracker::LogLiveAllocations()
+{
+	for (int i = (int)Tag::General + 1; i < (int)Tag::Count; i++)
+	{
+		long long live = counters[i].liveBytes.load(std::memory_order_relaxed);
+		if (live != 0)
+			Log::Write(Log::Severity::Warning, Log::Category::General, "%s still has %lld bytes in %lld allocations",
+				TagNames[i], live, counters[i].liveAllocations.load(std::memory_order_relaxed));
+	}
+}
+
+
+// --------------------------------------------------------
+// Recording, from the global operator new and delete
+// --------------------------------------------------------
+MemoryTracker::Tag MemoryTracker::GetThreadTag() { return threadTag; }
+
+void MemoryTracker::RecordAllocation(Tag tag, size_t size)
+{
+	Counters& tagCounters = counters[(int)tag];
+	long long live = tagCounters.liveBytes.fetch_add((long long)size, std::memory_order_relaxed) + (long long)size;
+	tagCounters.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	tagCounters.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+	tagCounters.totalBytes.fetch_add(size, std::memory_order_relaxed);
+
+	long long peak = tagCounters.peakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !tagCounters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		;
+}
+
+void MemoryTracker::RecordFree(Tag tag, size_t size)
+{
+	counters[(int)tag].liveBytes.fetch_sub((long long)size, std::memory_order_relaxed);
+	counters[(int)tag].liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void* MemoryTracker::ImGuiAlloc(size_t size, void*)
+{
+	Scope scope(Tag::ImGui);
+	return ::operator new(size);
+}
+
+void MemoryTracker::ImGuiFree(void* pointer, void*) { ::operator delete(pointer); }
+
+// Getters
+const char* MemoryTracker::GetName(Tag tag) { return TagNames[(int)tag]; }
+
+MemoryTracker::Stats MemoryTracker::GetStats(Tag tag)
+{
+	const Counters& tagCounters = counters[(int)tag];
+	const Budget& budget = budgets[(int)tag];
+	Stats stats = {};
+	stats.liveBytes = tagCounters.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = tagCounters.peakBytes.load(std::memory_order_relaxed);
+	stats.liveAllocations = tagCounters.liveAllocations.load(std::memory_order_relaxed);
+	stats.totalAllocations = tagCounters.totalAllocations.load(std::memory_order_relaxed);
+	stats.allocationsPerSecond = budget.allocationsPerSecond;
+	stats.bytesPerSecond = budget.bytesPerSecond;
+	stats.budgetBytes = budget.bytes;
+	stats.overBudget = budget.over;
+	return stats;
+}
+
+// Setters
+void MemoryTracker::SetBudget(Tag tag, size_t bytes)
+{
+	budgets[(int)tag].bytes = bytes;
+	budgets[(int)tag].over = false;
+}
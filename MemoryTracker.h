@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// See MemoryTracker.cpp for usage details
+
+namespace MemoryTracker
+{
+	// Who an allocation is charged to
+	enum class Tag
+	{
+		General,
+		ImGui,
+		Meshes,
+		Entities,
+		Assets,
+		FrameArena,
+		Count
+	};
+
+	// Totals for one tag
+	struct Stats
+	{
+		long long liveBytes;
+		long long peakBytes;
+		long long liveAllocations;
+		unsigned long long totalAllocations;	// Since startup
+		double allocationsPerSecond;			// Over the last rate window
+		double bytesPerSecond;
+		size_t budgetBytes;						// 0 when there's no budget
+		bool overBudget;
+	};
+
+	// Charges every heap allocation the calling thread makes
+	// to a tag, until it goes out of scope
+	class Scope
+	{
+	public:
+		Scope(Tag pTag);
+		~Scope();
+
+	private:
+		Tag previous;
+	};
+
+	// General functions
+	void Update(double totalTime);		// Rates and budget warnings, once per frame
+	void CheckBudgets();				// Just the warnings
+	void LogLiveAllocations();			// Anything still alive, at shutdown
+
+	// Called by the global operator new and delete
+	Tag GetThreadTag();
+	void RecordAllocation(Tag tag, size_t size);
+	void RecordFree(Tag tag, size_t size);
+
+	// For ImGui::SetAllocatorFunctions()
+	void* ImGuiAlloc(size_t size, void* userData);
+	void ImGuiFree(void* pointer, void* userData);
+
+	// Getters
+	Stats GetStats(Tag tag);
+	const char* GetName(Tag tag);
+
+	// Setters
+	void SetBudget(Tag tag, size_t bytes);
+}
+
+// --------------------------------------------------------
+// Charges a standard container's memory to a tag, however
+// it grows later on
+// --------------------------------------------------------
+template<class T, MemoryTracker::Tag tag>
+class TrackedAllocator
+{
+public:
+	using value_type = T;
+	template<class U> struct rebind { using other = TrackedAllocator<U, tag>; };
+
+	TrackedAllocator() {}
+	template<class U> TrackedAllocator(const TrackedAllocator<U, tag>& pOther) {}
+
+	T* allocate(size_t pCount)
+	{
+		MemoryTracker::Scope scope(tag);
+		return (T*)::operator new(pCount * sizeof(T));
+	}
+	void deallocate(T* pPointer, size_t) { ::operator delete(pPointer); }
+
+	template<class U> bool operator==(const TrackedAllocator<U, tag>& pOther) const { return true; }
+	template<class U> bool operator!=(const TrackedAllocator<U, tag>& pOther) const { return false; }
+};
+
+template<class T, MemoryTracker::Tag tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, tag>>;
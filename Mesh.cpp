@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include "MemoryTracker.h"
 #include <array>
 
 Mesh::Mesh(Vertex pVertices[], size_t pVertexCount, unsigned int pIndices[], size_t pIndexCount, std::string pMeshName)
@@ -12,6 +13,25 @@ Mesh::Mesh(Vertex pVertices[], size_t pVertexCount, unsigned int pIndices[], siz
 	// Index count
 	indexCount = pIndexCount;
 
+	// Keep vertices, positions and indices on the CPU (for occlusion
+	// culling and the software backend), along with the local space bounds
+	MemoryTracker::Scope scope(MemoryTracker::Tag::Meshes);
+	vertices.assign(pVertices, pVertices + vertexCount);
+	positions.resize(vertexCount);
+	boundsMin = vertexCount > 0 ? pVertices[0].Position : DirectX::XMFLOAT3(0, 0, 0);
+	boundsMax = boundsMin;
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		positions[i] = pVertices[i].Position;
+		boundsMin.x = min(boundsMin.x, positions[i].x);
+		boundsMin.y = min(boundsMin.y, positions[i].y);
+		boundsMin.z = min(boundsMin.z, positions[i].z);
+		boundsMax.x = max(boundsMax.x, positions[i].x);
+		boundsMax.y = max(boundsMax.y, positions[i].y);
+		boundsMax.z = max(boundsMax.z, positions[i].z);
+	}
+	indices.assign(pIndices, pIndices + indexCount);
+
 	// From Game.cpp
 	// Create a VERTEX BUFFER
 	// - This holds the vertex data of triangles for a single object
@@ -78,28 +98,31 @@ void Mesh::Draw(float deltaTime, float totalTime)
 	// From Game.cpp
 	// DRAW geometry
 	// - Other Direct3D calls will also be necessary to do more complex things
-	{
-		// Set buffers in the input assembler (IA) stage
-		//  - Do this ONCE PER OBJECT, since each object may have different geometry
-		//  - For this demo, this step *could* simply be done once during Init()
-		//  - However, this needs to be done between EACH DrawIndexed() call
-		//     when drawing different geometry, so it's here as an example
-		UINT stride = sizeof(Vertex);
-		UINT offset = 0;
-		Graphics::Context->IASetVertexBuffers(0, 1, vertexBuffer.GetAddressOf(), &stride, &offset);
-		Graphics::Context->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-
-		// Tell Direct3D to draw
-		//  - Begins the rendering pipeline on the GPU
-		//  - Do this ONCE PER OBJECT you intend to draw
-		//  - This will use all currently set Direct3D resources (shaders, buffers, etc)
-		//  - DrawIndexed() uses the currently set INDEX BUFFER to look up corresponding
-		//     vertices in the currently set VERTEX BUFFER
-		Graphics::Context->DrawIndexed(
-			static_cast<UINT>(indexCount),     // The number of indices to use (we could draw a subset if we wanted)
-			0,     // Offset to the first index we want to use
-			0);    // Offset to add to each index when looking up vertices
-	}
+	BindBuffers();
+	DrawIndexed();
+}
+
+// Set buffers in the input assembler (IA) stage
+//  - Only needed when the previous draw used different geometry,
+//    so the render queue calls this separately from DrawIndexed()
+void Mesh::BindBuffers()
+{
+	UINT stride = sizeof(Vertex);
+	UINT offset = 0;
+	Graphics::Context->IASetVertexBuffers(0, 1, vertexBuffer.GetAddressOf(), &stride, &offset);
+	Graphics::Context->IASetIndexBuffer(indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+}
+
+// Tell Direct3D to draw, using whatever buffers are currently bound
+//  - Begins the rendering pipeline on the GPU
+//  - DrawIndexed() uses the currently set INDEX BUFFER to look up corresponding
+//     vertices in the currently set VERTEX BUFFER
+void Mesh::DrawIndexed()
+{
+	Graphics::Context->DrawIndexed(
+		static_cast<UINT>(indexCount),     // The number of indices to use (we could draw a subset if we wanted)
+		0,     // Offset to the first index we want to use
+		0);    // Offset to add to each index when looking up vertices
 }
 
 Microsoft::WRL::ComPtr<ID3D11Buffer> Mesh::GetVertexBuffer()
@@ -122,7 +145,32 @@ size_t Mesh::GetIndexCount()
 	return indexCount;
 }
 
-std::string Mesh::GetName()
+const std::string& Mesh::GetName()
 {
 	return meshName;
-}
\ No newline at end of file
+}
+
+const std::vector<Vertex>& Mesh::GetVertices()
+{
+	return vertices;
+}
+
+const std::vector<DirectX::XMFLOAT3>& Mesh::GetPositions()
+{
+	return positions;
+}
+
+const std::vector<unsigned int>& Mesh::GetIndices()
+{
+	return indices;
+}
+
+DirectX::XMFLOAT3 Mesh::GetBoundsMin()
+{
+	return boundsMin;
+}
+
+DirectX::XMFLOAT3 Mesh::GetBoundsMax()
+{
+	return boundsMax;
+}
@@ -2,6 +2,7 @@
 
 #include <d3d11.h>
 #include <wrl/client.h>
+#include <vector>
 #include "Graphics.h"
 #include "Vertex.h"
 
@@ -16,9 +17,18 @@ public:
 
 	size_t GetVertexCount();
 	size_t GetIndexCount();
-	std::string GetName();
+	const std::string& GetName();
+
+	// CPU-side copies for occlusion culling and software rendering
+	const std::vector<Vertex>& GetVertices();
+	const std::vector<DirectX::XMFLOAT3>& GetPositions();
+	const std::vector<unsigned int>& GetIndices();
+	DirectX::XMFLOAT3 GetBoundsMin();
+	DirectX::XMFLOAT3 GetBoundsMax();
 
 	void Draw(float deltaTime, float totalTime);
+	void BindBuffers();
+	void DrawIndexed();
 private:
 	// Buffers for geometry data
 	Microsoft::WRL::ComPtr<ID3D11Buffer> vertexBuffer;
@@ -30,4 +40,11 @@ private:
 
 	// More mesh info
 	std::string meshName;
+
+	// Vertices, positions, indices and local space bounds kept on the CPU
+	std::vector<Vertex> vertices;
+	std::vector<DirectX::XMFLOAT3> positions;
+	std::vector<unsigned int> indices;
+	DirectX::XMFLOAT3 boundsMin;
+	DirectX::XMFLOAT3 boundsMax;
 };
\ No newline at end of file
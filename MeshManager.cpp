@@ -0,0 +1,150 @@
+#include "MeshManager.h"
+#include "MemoryTracker.h"
+
+#include <cstring>
+
+// --------------- Basic usage -----------------
+//
+// Owns every mesh, in a ResourcePool, and hands out
+// handles instead of shared_ptrs:
+//
+//   MeshHandle cube = meshManager->Load(vertices, vertexCount, indices, indexCount, "Cube");
+//   Mesh* mesh = meshManager->Get(cube);	// Null if it's been unloaded
+//   meshManager->Release(cube);			// Once per Load(), true when that destroyed it
+//
+// Loading a mesh with exactly the same vertices and
+// indices as one that's already loaded (whatever its
+// name) returns the existing handle, so duplicates only
+// cost a hash of their data.  Reference counts only
+// change in Load() and Release(); the mesh is destroyed
+// when the last Load() is released.  Everything in
+// between, draws and the Inspector, just calls Get(),
+// which is an array index and a generation check with
+// no atomics.
+//
+// Main thread only, except Get(), which jobs may call as
+// long as nothing is loaded or released meanwhile.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const unsigned long long FnvOffset = 14695981039346656037ull;
+	const unsigned long long FnvPrime = 1099511628211ull;
+
+	unsigned long long HashBytes(unsigned long long hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ bytes[i]) * FnvPrime;
+		return hash;
+	}
+}
+
+
+MeshManager::MeshManager(unsigned int pCapacity) :
+	pool(pCapacity),
+	stats()
+{
+	referenceCounts.resize(pool.GetCapacity());
+	contentHashes.resize(pool.GetCapacity());
+	meshesByHash.reserve(pool.GetCapacity());
+	stats.capacity = pool.GetCapacity();
+}
+
+MeshManager::~MeshManager()
+{
+}
+
+
+// --------------------------------------------------------
+// Returns a mesh with this data, creating it only if no
+// identical one is loaded.  Returns a zeroed handle when
+// the pool is full
+// --------------------------------------------------------
+MeshHandle MeshManager::Load(Vertex pVertices[], size_t pVertexCount, unsigned int pIndices[], size_t pIndexCount, const std::string& pName)
+{
+	MemoryTracker::Scope scope(MemoryTracker::Tag::Meshes);
+	stats.loads++;
+
+	// Same hash and same bytes, so the same mesh
+	unsigned long long hash = HashContents(pVertices, pVertexCount, pIndices, pIndexCount);
+	auto range = meshesByHash.equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		Mesh* mesh = pool.Get(it->second);
+		if (mesh->GetVertexCount() == pVertexCount && mesh->GetIndexCount() == pIndexCount &&
+			memcmp(mesh->GetVertices().data(), pVertices, sizeof(Vertex) * pVertexCount) == 0 &&
+			memcmp(mesh->GetIndices().data(), pIndices, sizeof(unsigned int) * pIndexCount) == 0)
+		{
+			referenceCounts[it->second.GetIndex()]++;
+			stats.deduplicated++;
+			return it->second;
+		}
+	}
+
+	MeshHandle handle = pool.Create(pVertices, pVertexCount, pIndices, pIndexCount, pName);
+	if (!pool.Get(handle))
+		return handle;
+
+	referenceCounts[handle.GetIndex()] = 1;
+	contentHashes[handle.GetIndex()] = hash;
+	meshesByHash.insert({ hash, handle });
+	return handle;
+}
+
+
+// --------------------------------------------------------
+// Undoes one Load(), destroying the mesh after the last
+// one.  Returns true if it was destroyed, so whatever
+// keeps things per slot (a backend's buffers) can let go.
+// Stale handles are ignored
+// --------------------------------------------------------
+bool MeshManager::Release(MeshHandle pMesh)
+{
+	if (!pool.Get(pMesh) || --referenceCounts[pMesh.GetIndex()] > 0)
+		return false;
+
+	auto range = meshesByHash.equal_range(contentHashes[pMesh.GetIndex()]);
+	for (auto it = range.first; it != range.second; ++it)
+	{
+		if (it->second == pMesh)
+		{
+			meshesByHash.erase(it);
+			break;
+		}
+	}
+
+	pool.Destroy(pMesh);
+	stats.unloads++;
+	return true;
+}
+
+
+// --------------------------------------------------------
+// FNV-1a of the vertex and index data, counts included
+// --------------------------------------------------------
+unsigned long long MeshManager::HashContents(const Vertex pVertices[], size_t pVertexCount, const unsigned int pIndices[], size_t pIndexCount)
+{
+	unsigned long long hash = FnvOffset;
+	hash = HashBytes(hash, &pVertexCount, sizeof(pVertexCount));
+	hash = HashBytes(hash, pVertices, sizeof(Vertex) * pVertexCount);
+	hash = HashBytes(hash, &pIndexCount, sizeof(pIndexCount));
+	hash = HashBytes(hash, pIndices, sizeof(unsigned int) * pIndexCount);
+	return hash;
+}
+
+// Getters
+Mesh* MeshManager::Get(MeshHandle pMesh) { return pool.Get(pMesh); }
+
+unsigned int MeshManager::GetReferenceCount(MeshHandle pMesh)
+{
+	return pool.Get(pMesh) ? referenceCounts[pMesh.GetIndex()] : 0;
+}
+
+MeshManager::Stats MeshManager::GetStats()
+{
+	Stats current = stats;
+	current.meshes = pool.GetCount();
+	return current;
+}
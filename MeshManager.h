@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.h"
+#include "ResourcePool.h"
+#include "Vertex.h"
+
+// See MeshManager.cpp for usage details
+
+using MeshHandle = ResourcePool<Mesh>::Handle;
+
+class MeshManager
+{
+public:
+	// Totals since the manager was created
+	struct Stats
+	{
+		unsigned int meshes;		// Loaded right now
+		unsigned int capacity;
+		unsigned int loads;			// Every Load() call
+		unsigned int deduplicated;	// Loads that found an identical mesh
+		unsigned int unloads;		// Meshes destroyed after their last Release()
+	};
+
+	MeshManager(unsigned int pCapacity);
+	~MeshManager();
+
+	MeshHandle Load(Vertex pVertices[], size_t pVertexCount, unsigned int pIndices[], size_t pIndexCount, const std::string& pName);
+	bool Release(MeshHandle pMesh);
+	Mesh* Get(MeshHandle pMesh);
+
+	// Getters
+	Stats GetStats();
+	unsigned int GetReferenceCount(MeshHandle pMesh);
+
+private:
+	static unsigned long long HashContents(const Vertex pVertices[], size_t pVertexCount, const unsigned int pIndices[], size_t pIndexCount);
+
+	ResourcePool<Mesh> pool;
+
+	// Per pool slot, so these are plain indexing too
+	std::vector<unsigned int> referenceCounts;
+	std::vector<unsigned long long> contentHashes;
+
+	// Content hash to every mesh with it (almost always just one)
+	std::unordered_multimap<unsigned long long, MeshHandle> meshesByHash;
+
+	Stats stats;
+};
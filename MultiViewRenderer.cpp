@@ -0,0 +1,187 @@
+#include "MultiViewRenderer.h"
+#include "JobSystem.h"
+
+#include <chrono>
+#include <cmath>
+
+// --------------- Basic usage -----------------
+//
+// Draws the same objects from several cameras at once,
+// each into its own rectangle of the back buffer:
+//
+//   renderer.SetViewports(MultiViewRenderer::SplitScreen(viewCount, width, height));
+//   const std::vector<CommandList>& lists = renderer.Render(objectCount,
+//       [&](unsigned int view, OcclusionCuller& culler, std::vector<bool>& visible) { /* cull for one view */ },
+//       [&](unsigned int object) { return RenderQueue::MakeKey(...); },
+//       [&](unsigned int object) { return meshHandle.value; },
+//       [&](CommandList& commands, unsigned int view, const RenderQueue::DrawCall& call) { /* record one draw */ });
+//
+//   backend.ExecuteParallel(lists);	// After clearing the targets once
+//
+// Each frame goes through three steps:
+//  - Every view is culled on its own job, with its own
+//    OcclusionCuller, so views cost what they see
+//  - Everything visible in any view is keyed and sorted
+//    once, on the calling thread.  Views that overlap
+//    share that work instead of each sorting their own copy
+//  - Every view walks the shared order, keeping what it
+//    can see, and records its draws into its own list on
+//    its own job.  Each list starts with its SetViewport
+//    and binds its first shader and mesh, so it can run on
+//    a D3D11 deferred context like ParallelRecorder's lists
+//
+// Depth is sorted from wherever the key function measures
+// it (the first view, say), so other views get the right
+// batching but only roughly front to back order.  Every
+// view shares one depth buffer and depth test, so their
+// viewports shouldn't overlap (see SplitScreen()).
+//
+// GetViewStats() has each view's cull and record times.
+// ---------------------------------------------
+
+MultiViewRenderer::MultiViewRenderer(int pCullerWidth, int pCullerHeight) :
+	cullerWidth(pCullerWidth),
+	cullerHeight(pCullerHeight),
+	stats()
+{
+}
+
+MultiViewRenderer::~MultiViewRenderer()
+{
+}
+
+
+// --------------------------------------------------------
+// Lays views out in a grid over a pWidth x pHeight target.
+// Every viewport keeps the target's aspect ratio (so camera
+// projections don't change), centered in its grid cell
+// --------------------------------------------------------
+std::vector<MultiViewRenderer::Viewport> MultiViewRenderer::SplitScreen(unsigned int pViewCount, float pWidth, float pHeight)
+{
+	std::vector<Viewport> result;
+	if (pViewCount == 0)
+		return result;
+
+	unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)pViewCount));
+	unsigned int rows = (pViewCount + columns - 1) / columns;
+	float cellWidth = pWidth / columns;
+	float cellHeight = pHeight / rows;
+	float scale = 1.0f / (columns > rows ? columns : rows);
+
+	for (unsigned int i = 0; i < pViewCount; i++)
+	{
+		Viewport viewport;
+		viewport.width = std::floor(pWidth * scale);
+		viewport.height = std::floor(pHeight * scale);
+		viewport.x = std::floor((i % columns) * cellWidth + (cellWidth - viewport.width) * 0.5f);
+		viewport.y = std::floor((i / columns) * cellHeight + (cellHeight - viewport.height) * 0.5f);
+		result.push_back(viewport);
+	}
+	return result;
+}
+
+
+// --------------------------------------------------------
+// Culls every view in parallel, sorts what they can see
+// once, then records every view's list in parallel.
+// Returns once all of the lists are complete
+// --------------------------------------------------------
+const std::vector<CommandList>& MultiViewRenderer::Render(unsigned int pObjectCount, const CullFunction& pCull, const KeyFunction& pKey, const MeshFunction& pMesh, const RecordFunction& pRecord)
+{
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	unsigned int viewCount = (unsigned int)viewports.size();
+	stats = {};
+
+	// Cull each view on its own job
+	JobSystem::ParallelFor(viewCount, [&](unsigned int view)
+		{
+			std::chrono::high_resolution_clock::time_point cullStart = std::chrono::high_resolution_clock::now();
+			std::vector<bool>& visible = visibility[view];
+			visible.assign(pObjectCount, false);
+			pCull(view, *cullers[view], visible);
+
+			ViewStats& viewStat = viewStats[view];
+			viewStat = {};
+			for (unsigned int i = 0; i < pObjectCount; i++)
+				viewStat.visibleObjects += visible[i];
+			viewStat.cullMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - cullStart).count();
+		});
+
+	// Sort the union of what the views see, just once
+	std::chrono::high_resolution_clock::time_point sortStart = std::chrono::high_resolution_clock::now();
+	queue.Clear();
+	for (unsigned int i = 0; i < pObjectCount; i++)
+	{
+		bool visibleAnywhere = false;
+		for (unsigned int view = 0; view < viewCount && !visibleAnywhere; view++)
+			visibleAnywhere = visibility[view][i];
+		if (visibleAnywhere)
+			queue.Push(pKey(i), i, pMesh(i));
+	}
+	queue.Sort();
+	stats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - sortStart).count();
+	stats.sortedObjects = (int)queue.GetItems().size();
+
+	// Each view records its share of the sorted order
+	const std::vector<RenderQueue::Item>& items = queue.GetItems();
+	JobSystem::ParallelFor(viewCount, [&](unsigned int view)
+		{
+			std::chrono::high_resolution_clock::time_point recordStart = std::chrono::high_resolution_clock::now();
+			const std::vector<bool>& visible = visibility[view];
+			const Viewport& viewport = viewports[view];
+			ViewStats& viewStat = viewStats[view];
+			CommandList& commands = lists[view];
+			commands.Clear();
+			commands.SetViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+
+			// Same bind tracking as RenderQueue::BuildDrawCalls(),
+			// but only over the draws this view kept
+			bool first = true;
+			unsigned int shader = 0;
+			unsigned int mesh = 0;
+			for (const RenderQueue::Item& item : items)
+			{
+				if (!visible[item.index])
+					continue;
+
+				RenderQueue::DrawCall call;
+				call.index = item.index;
+				call.bindShader = first || RenderQueue::GetShader(item.key) != shader;
+				call.bindMesh = first || item.mesh != mesh;
+				shader = RenderQueue::GetShader(item.key);
+				mesh = item.mesh;
+				first = false;
+
+				viewStat.drawCalls++;
+				viewStat.shaderBinds += call.bindShader;
+				viewStat.meshBinds += call.bindMesh;
+				pRecord(commands, view, call);
+			}
+			viewStat.recordMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count();
+		});
+
+	for (unsigned int view = 0; view < viewCount; view++)
+		stats.viewObjects += viewStats[view].visibleObjects;
+	stats.totalMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	return lists;
+}
+
+// Getters
+unsigned int MultiViewRenderer::GetViewCount() { return (unsigned int)viewports.size(); }
+const std::vector<CommandList>& MultiViewRenderer::GetLists() { return lists; }
+const std::vector<bool>& MultiViewRenderer::GetVisibility(unsigned int pView) { return visibility[pView]; }
+MultiViewRenderer::ViewStats MultiViewRenderer::GetViewStats(unsigned int pView) { return viewStats[pView]; }
+MultiViewRenderer::Stats MultiViewRenderer::GetStats() { return stats; }
+
+// Setters
+void MultiViewRenderer::SetViewports(const std::vector<Viewport>& pViewports)
+{
+	viewports = pViewports;
+
+	// Cullers are only created for views that haven't had one yet
+	while (cullers.size() < viewports.size())
+		cullers.push_back(std::make_shared<OcclusionCuller>(cullerWidth, cullerHeight));
+	visibility.resize(viewports.size());
+	lists.resize(viewports.size());
+	viewStats.resize(viewports.size());
+}
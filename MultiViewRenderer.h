@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include "OcclusionCuller.h"
+#include "RenderCommands.h"
+#include "RenderQueue.h"
+
+// See MultiViewRenderer.cpp for usage details
+
+class MultiViewRenderer
+{
+public:
+	// Rectangle of the back buffer a view draws into, in pixels
+	struct Viewport
+	{
+		float x;
+		float y;
+		float width;
+		float height;
+	};
+
+	// CPU cost of one view in the last Render()
+	struct ViewStats
+	{
+		int visibleObjects;
+		int drawCalls;
+		int shaderBinds;
+		int meshBinds;
+		double cullMs;
+		double recordMs;
+	};
+
+	// Work shared by every view in the last Render()
+	struct Stats
+	{
+		int sortedObjects;		// Visible in at least one view, keyed and sorted once
+		int viewObjects;		// Summed over the views, what sorting each view would cost
+		double sortMs;
+		double totalMs;
+	};
+
+	// Marks what one view can see.  pVisible is already sized to
+	// the object count and all false.  Called from worker threads
+	// (one per view), so it must only read shared state
+	using CullFunction = std::function<void(unsigned int view, OcclusionCuller& culler, std::vector<bool>& visible)>;
+
+	// Sort key for an object visible in any view (see RenderQueue::MakeKey)
+	using KeyFunction = std::function<unsigned long long(unsigned int object)>;
+
+	// Full id of an object's mesh, which decides mesh binds (see RenderQueue::Push)
+	using MeshFunction = std::function<unsigned int(unsigned int object)>;
+
+	// Records one of a view's draws, also from worker threads
+	using RecordFunction = std::function<void(CommandList& commands, unsigned int view, const RenderQueue::DrawCall& call)>;
+
+	MultiViewRenderer(int pCullerWidth = 320, int pCullerHeight = 180);
+	~MultiViewRenderer();
+
+	static std::vector<Viewport> SplitScreen(unsigned int pViewCount, float pWidth, float pHeight);
+	const std::vector<CommandList>& Render(unsigned int pObjectCount, const CullFunction& pCull, const KeyFunction& pKey, const MeshFunction& pMesh, const RecordFunction& pRecord);
+
+	// Getters
+	unsigned int GetViewCount();
+	const std::vector<CommandList>& GetLists();
+	const std::vector<bool>& GetVisibility(unsigned int pView);
+	ViewStats GetViewStats(unsigned int pView);
+	Stats GetStats();
+
+	// Setters
+	void SetViewports(const std::vector<Viewport>& pViewports);
+
+private:
+	int cullerWidth;
+	int cullerHeight;
+
+	// Per view, kept between frames to reuse their memory
+	std::vector<Viewport> viewports;
+	std::vector<std::shared_ptr<OcclusionCuller>> cullers;
+	std::vector<std::vector<bool>> visibility;
+	std::vector<CommandList> lists;
+	std::vector<ViewStats> viewStats;
+
+	// Every visible object, sorted once for all of the views
+	RenderQueue queue;
+	Stats stats;
+};
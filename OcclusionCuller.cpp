@@ -0,0 +1,448 @@
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE2 is part of every x64 target; other targets use the scalar loop
+#if !defined(OCCLUSION_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define OCCLUSION_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// --------------- Basic usage -----------------
+//
+// A CPU occlusion culling stage.  Large occluders (walls,
+// floors, big props) are rasterized into a small depth
+// buffer, then the bounds of everything else are tested
+// against it before any draw calls are made:
+//
+//   OcclusionCuller culler(320, 180);
+//
+//   culler.BeginFrame(viewProjection);
+//   culler.RenderOccluder(world, positions, sizeof(XMFLOAT3), vertexCount, indices, indexCount);
+//   culler.BuildHierarchy();
+//
+//   if (culler.TestBounds(world, boundsMin, boundsMax) == OcclusionCuller::Result::Visible)
+//       entity->Draw(...);
+//
+// Matrices are the same row-major, row-vector layout as
+// DirectX::XMFLOAT4X4 and D3D's [0, 1] depth range is used,
+// but the class itself has no D3D or DirectXMath
+// dependencies, so it can be run and checked headless.
+//
+// Occluders are rasterized four pixels at a time (SSE2
+// when available) at pixel centers, keeping the nearest
+// depth.  Triangles are clipped against the near plane
+// and drawn double-sided.  BuildHierarchy() then builds
+// a max-depth pyramid, so a test only has to look at a
+// handful of texels from the level that best matches the
+// size of the bounds on screen.  A box is occluded if its
+// nearest point is behind the farthest depth of every
+// texel it covers.
+//
+// Like other low resolution occlusion buffers, a pixel is
+// covered if its center is, so an occludee peeking through
+// a gap much thinner than a pixel can be culled.
+// ---------------------------------------------
+
+// Annonymous namespace to hold helpers only accessible in this file
+namespace
+{
+	// result = a * b, row-major
+	void MultiplyMatrices(const float a[16], const float b[16], float result[16])
+	{
+		for (int row = 0; row < 4; row++)
+			for (int col = 0; col < 4; col++)
+				result[row * 4 + col] =
+					a[row * 4 + 0] * b[0 * 4 + col] +
+					a[row * 4 + 1] * b[1 * 4 + col] +
+					a[row * 4 + 2] * b[2 * 4 + col] +
+					a[row * 4 + 3] * b[3 * 4 + col];
+	}
+
+	// Row vector (x, y, z, 1) times a row-major matrix
+	void TransformPoint(const float m[16], float x, float y, float z, float result[4])
+	{
+		for (int col = 0; col < 4; col++)
+			result[col] = x * m[0 * 4 + col] + y * m[1 * 4 + col] + z * m[2 * 4 + col] + m[3 * 4 + col];
+	}
+
+	// Edge function a -> b, positive on the inside of a counter-clockwise
+	// (in screen space, y down) triangle: E(x, y) = A * x + B * y + C
+	struct Edge
+	{
+		float a;
+		float b;
+		float c;
+
+		Edge(const float* p0, const float* p1)
+		{
+			a = p0[1] - p1[1];
+			b = p1[0] - p0[0];
+			c = (p1[1] - p0[1]) * p0[0] - (p1[0] - p0[0]) * p0[1];
+		}
+	};
+}
+
+
+// --------------------------------------------------------
+// Sets up the depth pyramid for the given resolution
+// --------------------------------------------------------
+OcclusionCuller::OcclusionCuller(int pWidth, int pHeight) :
+	width(std::max(pWidth, 1)),
+	height(std::max(pHeight, 1)),
+	viewProjection(),
+	stats()
+{
+	stride = (width + 3) & ~3;
+
+	// Level 0 includes the row padding, which never holds
+	// anything nearer than real geometry just off screen
+	int levelWidth = stride;
+	int levelHeight = height;
+	while (true)
+	{
+		levels.push_back(std::vector<float>((size_t)levelWidth * levelHeight, 1.0f));
+		levelWidths.push_back(levelWidth);
+		levelHeights.push_back(levelHeight);
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+
+		levelWidth = (levelWidth + 1) / 2;
+		levelHeight = (levelHeight + 1) / 2;
+	}
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+
+// --------------------------------------------------------
+// Clears the depth buffer and stats, and stores the camera's
+// combined view and projection matrices for this frame
+// --------------------------------------------------------
+void OcclusionCuller::BeginFrame(const float pViewProjection[16])
+{
+	std::copy(pViewProjection, pViewProjection + 16, viewProjection);
+	std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+	stats = {};
+}
+
+
+// --------------------------------------------------------
+// Rasterizes an indexed triangle list into the depth buffer.
+// Positions are read as 3 floats every pPositionStride bytes.
+// --------------------------------------------------------
+void OcclusionCuller::RenderOccluder(const float pWorld[16],
+	const float* pPositions, size_t pPositionStride, size_t pVertexCount,
+	const unsigned int* pIndices, size_t pIndexCount)
+{
+	float worldViewProjection[16];
+	MultiplyMatrices(pWorld, viewProjection, worldViewProjection);
+
+	// Every vertex to clip space once
+	clipVertices.resize(pVertexCount * 4);
+	for (size_t i = 0; i < pVertexCount; i++)
+	{
+		const float* position = (const float*)((const char*)pPositions + i * pPositionStride);
+		TransformPoint(worldViewProjection, position[0], position[1], position[2], &clipVertices[i * 4]);
+	}
+
+	for (size_t i = 0; i + 2 < pIndexCount; i += 3)
+	{
+		stats.occluderTriangles++;
+		if (pIndices[i] >= pVertexCount || pIndices[i + 1] >= pVertexCount || pIndices[i + 2] >= pVertexCount)
+			continue;
+
+		const float* triangle[3] =
+		{
+			&clipVertices[pIndices[i] * 4],
+			&clipVertices[pIndices[i + 1] * 4],
+			&clipVertices[pIndices[i + 2] * 4]
+		};
+
+		// Skip triangles entirely outside one of the frustum planes
+		int outside[6] = {};
+		for (const float* v : triangle)
+		{
+			outside[0] += v[0] < -v[3];
+			outside[1] += v[0] > v[3];
+			outside[2] += v[1] < -v[3];
+			outside[3] += v[1] > v[3];
+			outside[4] += v[2] < 0.0f;
+			outside[5] += v[2] > v[3];
+		}
+		if (std::find(outside, outside + 6, 3) != outside + 6)
+			continue;
+
+		// Clip against the near plane (z >= 0), which
+		// turns the triangle into at most a quad
+		float polygon[4][4];
+		int polygonSize = 0;
+		for (int j = 0; j < 3; j++)
+		{
+			const float* a = triangle[j];
+			const float* b = triangle[(j + 1) % 3];
+			if (a[2] >= 0.0f)
+				std::copy(a, a + 4, polygon[polygonSize++]);
+			if ((a[2] >= 0.0f) != (b[2] >= 0.0f))
+			{
+				float t = a[2] / (a[2] - b[2]);
+				for (int k = 0; k < 4; k++)
+					polygon[polygonSize][k] = a[k] + (b[k] - a[k]) * t;
+				polygonSize++;
+			}
+		}
+
+		// Project to pixels (y down), keeping NDC depth
+		float screen[4][3];
+		bool valid = polygonSize >= 3;
+		for (int j = 0; j < polygonSize && valid; j++)
+		{
+			float w = polygon[j][3];
+			valid = w > 0.0f;
+			screen[j][0] = (polygon[j][0] / w * 0.5f + 0.5f) * width;
+			screen[j][1] = (0.5f - polygon[j][1] / w * 0.5f) * height;
+			screen[j][2] = polygon[j][2] / w;
+		}
+		if (!valid)
+			continue;
+
+		bool rasterized = RasterizeTriangle(screen[0], screen[1], screen[2]);
+		if (polygonSize == 4)
+			rasterized |= RasterizeTriangle(screen[0], screen[2], screen[3]);
+		if (rasterized)
+			stats.rasterizedTriangles++;
+	}
+}
+
+
+// --------------------------------------------------------
+// Keeps the nearest depth of a screen space triangle
+// at every covered pixel center.  Returns false if the
+// triangle was degenerate or off screen.
+// --------------------------------------------------------
+bool OcclusionCuller::RasterizeTriangle(const float* pV0, const float* pV1, const float* pV2)
+{
+	// Drawn double-sided, so wind every triangle the same way
+	float area = (pV1[0] - pV0[0]) * (pV2[1] - pV0[1]) - (pV2[0] - pV0[0]) * (pV1[1] - pV0[1]);
+	if (!(std::fabs(area) > 1e-6f))
+		return false;
+	if (area < 0.0f)
+	{
+		std::swap(pV1, pV2);
+		area = -area;
+	}
+
+	// Pixel bounds, clamped before converting to int
+	float minXf = std::max(std::min({ pV0[0], pV1[0], pV2[0] }), 0.0f);
+	float maxXf = std::min(std::max({ pV0[0], pV1[0], pV2[0] }), (float)(width - 1));
+	float minYf = std::max(std::min({ pV0[1], pV1[1], pV2[1] }), 0.0f);
+	float maxYf = std::min(std::max({ pV0[1], pV1[1], pV2[1] }), (float)(height - 1));
+	if (minXf > maxXf || minYf > maxYf)
+		return false;
+	int minX = (int)minXf & ~3;
+	int maxX = (int)maxXf;
+	int minY = (int)minYf;
+	int maxY = (int)maxYf;
+
+	// Edge functions weight the opposite vertex, and depth
+	// is linear in screen space: z = zA * x + zB * y + zC
+	Edge e0(pV1, pV2);
+	Edge e1(pV2, pV0);
+	Edge e2(pV0, pV1);
+	float dz1 = (pV1[2] - pV0[2]) / area;
+	float dz2 = (pV2[2] - pV0[2]) / area;
+	float zA = e1.a * dz1 + e2.a * dz2;
+	float zB = e1.b * dz1 + e2.b * dz2;
+	float zC = pV0[2] + e1.c * dz1 + e2.c * dz2;
+
+	float* depth = levels[0].data();
+	for (int y = minY; y <= maxY; y++)
+	{
+		float py = y + 0.5f;
+		float row0 = e0.b * py + e0.c;
+		float row1 = e1.b * py + e1.c;
+		float row2 = e2.b * py + e2.c;
+		float rowZ = zB * py + zC;
+		float* depthRow = depth + (size_t)y * stride;
+
+#ifdef OCCLUSION_USE_SSE2
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), pixelOffsets);
+			__m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.a), px), _mm_set1_ps(row0));
+			__m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1.a), px), _mm_set1_ps(row1));
+			__m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2.a), px), _mm_set1_ps(row2));
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zA), px), _mm_set1_ps(rowZ));
+			__m128 current = _mm_loadu_ps(depthRow + x);
+			__m128 nearest = _mm_min_ps(current, z);
+			_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+		}
+#else
+		for (int x = minX; x <= maxX; x += 4)
+		{
+			for (int lane = 0; lane < 4; lane++)
+			{
+				float px = (float)x + (lane + 0.5f);
+				float w0 = e0.a * px + row0;
+				float w1 = e1.a * px + row1;
+				float w2 = e2.a * px + row2;
+				if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+				{
+					float z = zA * px + rowZ;
+					if (z < depthRow[x + lane])
+						depthRow[x + lane] = z;
+				}
+			}
+		}
+#endif
+	}
+
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Builds the max-depth pyramid, call once after every
+// occluder has been rendered and before any tests
+// --------------------------------------------------------
+void OcclusionCuller::BuildHierarchy()
+{
+	for (size_t level = 1; level < levels.size(); level++)
+	{
+		const std::vector<float>& source = levels[level - 1];
+		int sourceWidth = levelWidths[level - 1];
+		int sourceHeight = levelHeights[level - 1];
+		std::vector<float>& target = levels[level];
+		int targetWidth = levelWidths[level];
+		int targetHeight = levelHeights[level];
+
+		for (int y = 0; y < targetHeight; y++)
+		{
+			// Odd sizes: the last row/column only has one child
+			const float* row0 = &source[(size_t)(y * 2) * sourceWidth];
+			const float* row1 = &source[(size_t)std::min(y * 2 + 1, sourceHeight - 1) * sourceWidth];
+			for (int x = 0; x < targetWidth; x++)
+			{
+				int x0 = x * 2;
+				int x1 = std::min(x0 + 1, sourceWidth - 1);
+				target[(size_t)y * targetWidth + x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+			}
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Tests a local space bounding box against the occluders.
+// Boxes crossing the near plane are always visible.
+// --------------------------------------------------------
+OcclusionCuller::Result OcclusionCuller::TestBounds(const float pWorld[16], const float pBoundsMin[3], const float pBoundsMax[3])
+{
+	stats.testedObjects++;
+
+	float worldViewProjection[16];
+	MultiplyMatrices(pWorld, viewProjection, worldViewProjection);
+
+	// Screen space bounds and nearest depth of the 8 corners
+	float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX;
+	float maxX = -FLT_MAX, maxY = -FLT_MAX;
+	int outside[6] = {};
+	bool crossesNear = false;
+	for (int i = 0; i < 8; i++)
+	{
+		float corner[4];
+		TransformPoint(worldViewProjection,
+			(i & 1) ? pBoundsMax[0] : pBoundsMin[0],
+			(i & 2) ? pBoundsMax[1] : pBoundsMin[1],
+			(i & 4) ? pBoundsMax[2] : pBoundsMin[2],
+			corner);
+
+		outside[0] += corner[0] < -corner[3];
+		outside[1] += corner[0] > corner[3];
+		outside[2] += corner[1] < -corner[3];
+		outside[3] += corner[1] > corner[3];
+		outside[4] += corner[2] < 0.0f;
+		outside[5] += corner[2] > corner[3];
+
+		if (corner[2] < 0.0f || corner[3] <= 0.0f)
+		{
+			crossesNear = true;
+			continue;
+		}
+
+		float x = (corner[0] / corner[3] * 0.5f + 0.5f) * width;
+		float y = (0.5f - corner[1] / corner[3] * 0.5f) * height;
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		minZ = std::min(minZ, corner[2] / corner[3]);
+	}
+
+	if (std::find(outside, outside + 6, 8) != outside + 6)
+	{
+		stats.outsideViewObjects++;
+		return Result::OutsideView;
+	}
+	if (crossesNear)
+		return Result::Visible;
+
+	// Pixels touched by the screen space bounds
+	minX = std::max(minX, 0.0f);
+	maxX = std::min(maxX, (float)(width - 1));
+	minY = std::max(minY, 0.0f);
+	maxY = std::min(maxY, (float)(height - 1));
+	if (minX > maxX || minY > maxY)
+	{
+		stats.outsideViewObjects++;
+		return Result::OutsideView;
+	}
+	int x0 = (int)minX;
+	int x1 = (int)maxX;
+	int y0 = (int)minY;
+	int y1 = (int)maxY;
+
+	// Coarsest level where the bounds cover at most 4x4 texels
+	int level = 0;
+	while (level + 1 < (int)levels.size() && ((x1 >> level) - (x0 >> level) >= 4 || (y1 >> level) - (y0 >> level) >= 4))
+		level++;
+
+	const float* depth = levels[level].data();
+	int levelWidth = levelWidths[level];
+	for (int y = y0 >> level; y <= (y1 >> level); y++)
+		for (int x = x0 >> level; x <= (x1 >> level); x++)
+			if (depth[(size_t)y * levelWidth + x] >= minZ)
+				return Result::Visible;
+
+	stats.occludedObjects++;
+	return Result::Occluded;
+}
+
+
+// Getters
+int OcclusionCuller::GetWidth() { return width; }
+int OcclusionCuller::GetHeight() { return height; }
+int OcclusionCuller::GetLevelCount() { return (int)levels.size(); }
+int OcclusionCuller::GetLevelWidth(int pLevel) { return levelWidths[pLevel]; }
+int OcclusionCuller::GetLevelHeight(int pLevel) { return levelHeights[pLevel]; }
+const float* OcclusionCuller::GetLevelDepth(int pLevel) { return levels[pLevel].data(); }
+OcclusionCuller::Stats OcclusionCuller::GetStats() { return stats; }
+
+bool OcclusionCuller::UsesSIMD()
+{
+#ifdef OCCLUSION_USE_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// See OcclusionCuller.cpp for usage details
+
+class OcclusionCuller
+{
+public:
+	enum class Result
+	{
+		Visible,
+		Occluded,
+		OutsideView
+	};
+
+	// Counters since the last BeginFrame()
+	struct Stats
+	{
+		int occluderTriangles;		// Submitted through RenderOccluder()
+		int rasterizedTriangles;	// Survived clipping and culling
+		int testedObjects;
+		int occludedObjects;
+		int outsideViewObjects;
+	};
+
+	OcclusionCuller(int pWidth, int pHeight);
+	~OcclusionCuller();
+
+	// Matrices are row-major with row vectors (same as DirectX::XMFLOAT4X4)
+	void BeginFrame(const float pViewProjection[16]);
+	void RenderOccluder(const float pWorld[16],
+		const float* pPositions, size_t pPositionStride, size_t pVertexCount,
+		const unsigned int* pIndices, size_t pIndexCount);
+	void BuildHierarchy();
+	Result TestBounds(const float pWorld[16], const float pBoundsMin[3], const float pBoundsMax[3]);
+
+	// Getters
+	int GetWidth();
+	int GetHeight();
+	int GetLevelCount();
+	int GetLevelWidth(int pLevel);
+	int GetLevelHeight(int pLevel);
+	const float* GetLevelDepth(int pLevel);
+	Stats GetStats();
+	static bool UsesSIMD();
+
+private:
+	bool RasterizeTriangle(const float* pV0, const float* pV1, const float* pV2);
+
+	// Depth buffer size, rows are padded to a multiple of 4 pixels
+	int width;
+	int height;
+	int stride;
+
+	// Level 0 is the rasterized depth, each level above
+	// holds the farthest depth of 2x2 texels below it
+	std::vector<std::vector<float>> levels;
+	std::vector<int> levelWidths;
+	std::vector<int> levelHeights;
+
+	// Per-frame state
+	float viewProjection[16];
+	std::vector<float> clipVertices;
+	Stats stats;
+};
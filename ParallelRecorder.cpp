@@ -0,0 +1,102 @@
+#include "ParallelRecorder.h"
+#include "JobSystem.h"
+
+// --------------- Basic usage -----------------
+//
+// Splits a frame's sorted draws into chunks and records
+// each chunk into its own CommandList on the JobSystem:
+//
+//   const std::vector<CommandList>& lists = recorder.Record(queue.BuildDrawCalls(),
+//       [&](CommandList& commands, const RenderQueue::DrawCall& call) { /* record one draw */ });
+//
+//   backend.ExecuteParallel(lists);	// Or Execute() each list in order
+//
+// Each chunk must be executable on its own (on a D3D11
+// deferred context, say), so its first draw always binds
+// its shader and mesh, even if the previous chunk ended
+// with the same ones.  Executing the lists in order gives
+// the same draws, constants and order as recording them
+// all into one list; only those chunk-start binds differ.
+//
+// Chunks are never smaller than the minimum (a few hundred
+// draws), and there's at most one per job thread plus the
+// calling thread.  Small frames end up in a single chunk.
+// ---------------------------------------------
+
+ParallelRecorder::ParallelRecorder(unsigned int pMinDrawsPerChunk) :
+	minDrawsPerChunk(pMinDrawsPerChunk > 0 ? pMinDrawsPerChunk : 1)
+{
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+}
+
+
+// --------------------------------------------------------
+// Splits pDrawCount draws into at most pMaxChunks nearly
+// equal ranges of at least pMinDrawsPerChunk draws each.
+// Reuses pChunks' memory
+// --------------------------------------------------------
+void ParallelRecorder::Partition(unsigned int pDrawCount, unsigned int pMinDrawsPerChunk, unsigned int pMaxChunks, std::vector<Chunk>& pChunks)
+{
+	pChunks.clear();
+	if (pDrawCount == 0)
+		return;
+
+	unsigned int chunkCount = pDrawCount / (pMinDrawsPerChunk > 0 ? pMinDrawsPerChunk : 1);
+	if (chunkCount > pMaxChunks)
+		chunkCount = pMaxChunks;
+	if (chunkCount == 0)
+		chunkCount = 1;
+
+	for (unsigned int i = 0; i < chunkCount; i++)
+	{
+		unsigned int first = (unsigned int)((unsigned long long)pDrawCount * i / chunkCount);
+		unsigned int last = (unsigned int)((unsigned long long)pDrawCount * (i + 1) / chunkCount);
+		pChunks.push_back({ first, last - first });
+	}
+}
+
+
+// --------------------------------------------------------
+// Records every chunk in parallel, returning once all of
+// the lists are complete
+// --------------------------------------------------------
+const std::vector<CommandList>& ParallelRecorder::Record(const std::vector<RenderQueue::DrawCall>& pDrawCalls, const RecordFunction& pRecord)
+{
+	Partition((unsigned int)pDrawCalls.size(), minDrawsPerChunk, JobSystem::ThreadCount() + 1, chunks);
+
+	// Lists are kept between frames to reuse their memory
+	if (lists.size() < chunks.size())
+		lists.resize(chunks.size());
+	else
+		lists.erase(lists.begin() + chunks.size(), lists.end());
+
+	JobSystem::ParallelFor((unsigned int)chunks.size(), [&](unsigned int chunkIndex)
+		{
+			const Chunk& chunk = chunks[chunkIndex];
+			CommandList& commands = lists[chunkIndex];
+			commands.Clear();
+
+			for (unsigned int i = chunk.first; i < chunk.first + chunk.count; i++)
+			{
+				RenderQueue::DrawCall call = pDrawCalls[i];
+				if (i == chunk.first)
+				{
+					call.bindShader = true;
+					call.bindMesh = true;
+				}
+				pRecord(commands, call);
+			}
+		});
+
+	return lists;
+}
+
+// Getters
+const std::vector<ParallelRecorder::Chunk>& ParallelRecorder::GetChunks() { return chunks; }
+const std::vector<CommandList>& ParallelRecorder::GetLists() { return lists; }
+
+// Setters
+void ParallelRecorder::SetMinDrawsPerChunk(unsigned int pMinDrawsPerChunk) { minDrawsPerChunk = pMinDrawsPerChunk > 0 ? pMinDrawsPerChunk : 1; }
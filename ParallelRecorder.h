@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "RenderCommands.h"
+#include "RenderQueue.h"
+
+// See ParallelRecorder.cpp for usage details
+
+class ParallelRecorder
+{
+public:
+	// A contiguous range of sorted draws, recorded into one list
+	struct Chunk
+	{
+		unsigned int first;
+		unsigned int count;
+	};
+
+	// Records one draw.  Called from worker threads, so it must
+	// only read shared state (and write to the given list)
+	using RecordFunction = std::function<void(CommandList& commands, const RenderQueue::DrawCall& call)>;
+
+	ParallelRecorder(unsigned int pMinDrawsPerChunk = 256);
+	~ParallelRecorder();
+
+	static void Partition(unsigned int pDrawCount, unsigned int pMinDrawsPerChunk, unsigned int pMaxChunks, std::vector<Chunk>& pChunks);
+	const std::vector<CommandList>& Record(const std::vector<RenderQueue::DrawCall>& pDrawCalls, const RecordFunction& pRecord);
+
+	// Getters
+	const std::vector<Chunk>& GetChunks();
+	const std::vector<CommandList>& GetLists();
+
+	// Setters
+	void SetMinDrawsPerChunk(unsigned int pMinDrawsPerChunk);
+
+private:
+	unsigned int minDrawsPerChunk;
+	std::vector<Chunk> chunks;
+	std::vector<CommandList> lists;
+};
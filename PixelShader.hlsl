@@ -30,5 +30,11 @@ float4 main(VertexToPixel input) : SV_TARGET
 	// - This color (like most values passing through the rasterizer) is 
 	//   interpolated for each pixel between the corresponding vertices 
 	//   of the triangle we're rendering
+	// - GRAYSCALE variants keep just its luminance
+#if GRAYSCALE
+	float luminance = dot(input.color.rgb, float3(0.299f, 0.587f, 0.114f));
+	return float4(luminance, luminance, luminance, input.color.a);
+#else
 	return input.color;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,313 @@
+#include "RenderCommands.h"
+
+#include <cstdio>
+#include <cstring>
+
+// --------------- Basic usage -----------------
+//
+// Rendering code records commands into a CommandList
+// instead of calling the graphics API directly, then
+// hands the list to a backend:
+//
+//   commands.Clear();
+//   commands.ClearTargets(bgColor, 1.0f);
+//   commands.UpdateInstances(instances.data(), sizeof(InstanceData), instanceCount);
+//   commands.SetViewport(0.0f, 0.0f, width, height);
+//   commands.BindShaders(shaderId);
+//   commands.UpdateConstants(0, &vsData, sizeof(vsData));
+//   commands.BindMesh(meshId);
+//   commands.DrawInstanced(indexCount, 1, 0, 0, instance);
+//
+//   backend->Execute(commands);
+//
+// Shaders and meshes are referred to by small ids; the
+// D3D11 backend maps them to its registered resources.
+// Constant data is copied into the list when recorded.
+// UpdateInstances fills the frame's per-instance buffer
+// (every object's world matrix and tint, say) in one go,
+// and draws pick their object with their first instance.
+// Backends keep the instances until the next update, so
+// lists executed after it (on deferred contexts too) all
+// read the same ones.
+// Viewports are in back buffer pixels and apply to every
+// draw after them (ClearTargets always clears everything).
+//
+// The NullBackend needs no device, so frames can be
+// recorded and "executed" headless to measure their
+// CPU cost, or compared against a golden transcript:
+//
+//   NullBackend null(true);
+//   null.Execute(commands);
+//   null.GetTranscript();	// One line per command
+// ---------------------------------------------
+
+// Annonymous namespace to hold helpers only accessible in this file
+namespace
+{
+	// FNV-1a, to summarize constant data in transcripts
+	unsigned int HashBytes(const unsigned char* bytes, size_t size)
+	{
+		unsigned int hash = 2166136261u;
+		for (size_t i = 0; i < size; i++)
+			hash = (hash ^ bytes[i]) * 16777619u;
+		return hash;
+	}
+
+	// Payload structs start 4-byte aligned in the stream,
+	// but are copied out anyway to avoid aliasing issues
+	template<typename T>
+	T ReadPayload(const unsigned char* payload)
+	{
+		T value;
+		memcpy(&value, payload, sizeof(T));
+		return value;
+	}
+}
+
+
+CommandList::CommandList() :
+	commandCount(0)
+{
+}
+
+CommandList::~CommandList()
+{
+}
+
+
+// --------------------------------------------------------
+// Empties the list, keeping its memory for the next frame
+// --------------------------------------------------------
+void CommandList::Clear()
+{
+	data.clear();
+	commandCount = 0;
+}
+
+
+// --------------------------------------------------------
+// Adds a header and room for the payload, returning
+// a pointer to the (zeroed) payload
+// --------------------------------------------------------
+void* CommandList::Append(RenderCommandType pType, unsigned int pSize)
+{
+	Header header = { pType, (pSize + 3) & ~3u };
+	size_t offset = data.size();
+	data.resize(offset + sizeof(Header) + header.size);
+	memcpy(&data[offset], &header, sizeof(Header));
+	commandCount++;
+	return &data[offset + sizeof(Header)];
+}
+
+void CommandList::ClearTargets(const float pColor[4], float pDepth)
+{
+	ClearTargetsCommand command = { { pColor[0], pColor[1], pColor[2], pColor[3] }, pDepth };
+	memcpy(Append(RenderCommandType::ClearTargets, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandList::BindShaders(unsigned int pShader)
+{
+	BindShadersCommand command = { pShader };
+	memcpy(Append(RenderCommandType::BindShaders, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandList::BindMesh(unsigned int pMesh)
+{
+	BindMeshCommand command = { pMesh };
+	memcpy(Append(RenderCommandType::BindMesh, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandList::UpdateConstants(unsigned int pSlot, const void* pData, unsigned int pSize)
+{
+	UpdateConstantsCommand command = { pSlot, pSize };
+	unsigned char* payload = (unsigned char*)Append(RenderCommandType::UpdateConstants, sizeof(command) + pSize);
+	memcpy(payload, &command, sizeof(command));
+	memcpy(payload + sizeof(command), pData, pSize);
+}
+
+void CommandList::Draw(unsigned int pIndexCount, unsigned int pStartIndex, int pBaseVertex)
+{
+	DrawCommand command = { pIndexCount, pStartIndex, pBaseVertex };
+	memcpy(Append(RenderCommandType::Draw, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandList::DrawInstanced(unsigned int pIndexCount, unsigned int pInstanceCount, unsigned int pStartIndex, int pBaseVertex, unsigned int pStartInstance)
+{
+	DrawInstancedCommand command = { pIndexCount, pInstanceCount, pStartIndex, pBaseVertex, pStartInstance };
+	memcpy(Append(RenderCommandType::DrawInstanced, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandList::SetViewport(float pX, float pY, float pWidth, float pHeight)
+{
+	SetViewportCommand command = { pX, pY, pWidth, pHeight };
+	memcpy(Append(RenderCommandType::SetViewport, sizeof(command)), &command, sizeof(command));
+}
+
+void CommandList::UpdateInstances(const void* pData, unsigned int pStride, unsigned int pCount)
+{
+	UpdateInstancesCommand command = { pStride, pCount };
+	size_t size = (size_t)pStride * pCount;
+	unsigned char* payload = (unsigned char*)Append(RenderCommandType::UpdateInstances, (unsigned int)(sizeof(command) + size));
+	memcpy(payload, &command, sizeof(command));
+	memcpy(payload + sizeof(command), pData, size);
+}
+
+
+// --------------------------------------------------------
+// Steps through the stream:
+//
+//   size_t offset = 0;
+//   CommandList::Header header;
+//   const unsigned char* payload;
+//   while (commands.Next(offset, header, payload)) { ... }
+// --------------------------------------------------------
+bool CommandList::Next(size_t& pOffset, Header& pHeader, const unsigned char*& pPayload) const
+{
+	if (pOffset + sizeof(Header) > data.size())
+		return false;
+
+	memcpy(&pHeader, &data[pOffset], sizeof(Header));
+	if (pOffset + sizeof(Header) + pHeader.size > data.size())
+		return false;
+
+	pPayload = &data[pOffset + sizeof(Header)];
+	pOffset += sizeof(Header) + pHeader.size;
+	return true;
+}
+
+// Getters
+unsigned int CommandList::GetCommandCount() const { return commandCount; }
+size_t CommandList::GetByteSize() const { return data.size(); }
+
+
+NullBackend::NullBackend(bool pKeepTranscript) :
+	keepTranscript(pKeepTranscript),
+	stats()
+{
+}
+
+NullBackend::~NullBackend()
+{
+}
+
+
+// --------------------------------------------------------
+// Decodes every command, counting it and optionally
+// appending a line to the transcript
+// --------------------------------------------------------
+void NullBackend::Execute(const CommandList& pCommands)
+{
+	size_t offset = 0;
+	CommandList::Header header;
+	const unsigned char* payload = 0;
+	char line[128];
+	while (pCommands.Next(offset, header, payload))
+	{
+		stats.commands++;
+		line[0] = 0;
+
+		switch (header.type)
+		{
+		case RenderCommandType::ClearTargets:
+		{
+			CommandList::ClearTargetsCommand command = ReadPayload<CommandList::ClearTargetsCommand>(payload);
+			stats.clears++;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "ClearTargets %.3f %.3f %.3f %.3f depth=%.3f\n",
+					command.color[0], command.color[1], command.color[2], command.color[3], command.depth);
+			break;
+		}
+
+		case RenderCommandType::BindShaders:
+		{
+			CommandList::BindShadersCommand command = ReadPayload<CommandList::BindShadersCommand>(payload);
+			stats.shaderBinds++;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "BindShaders %u\n", command.shader);
+			break;
+		}
+
+		case RenderCommandType::BindMesh:
+		{
+			CommandList::BindMeshCommand command = ReadPayload<CommandList::BindMeshCommand>(payload);
+			stats.meshBinds++;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "BindMesh %u\n", command.mesh);
+			break;
+		}
+
+		case RenderCommandType::UpdateConstants:
+		{
+			CommandList::UpdateConstantsCommand command = ReadPayload<CommandList::UpdateConstantsCommand>(payload);
+			stats.constantUpdates++;
+			stats.constantBytes += command.size;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "UpdateConstants slot=%u size=%u hash=%08x\n",
+					command.slot, command.size, HashBytes(payload + sizeof(command), command.size));
+			break;
+		}
+
+		case RenderCommandType::Draw:
+		{
+			CommandList::DrawCommand command = ReadPayload<CommandList::DrawCommand>(payload);
+			stats.draws++;
+			stats.instances++;
+			stats.indices += command.indexCount;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "Draw %u start=%u base=%d\n", command.indexCount, command.startIndex, command.baseVertex);
+			break;
+		}
+
+		case RenderCommandType::DrawInstanced:
+		{
+			CommandList::DrawInstancedCommand command = ReadPayload<CommandList::DrawInstancedCommand>(payload);
+			stats.draws++;
+			stats.instances += command.instanceCount;
+			stats.indices += (size_t)command.indexCount * command.instanceCount;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "DrawInstanced %u x%u start=%u base=%d firstInstance=%u\n",
+					command.indexCount, command.instanceCount, command.startIndex, command.baseVertex, command.startInstance);
+			break;
+		}
+
+		case RenderCommandType::SetViewport:
+		{
+			CommandList::SetViewportCommand command = ReadPayload<CommandList::SetViewportCommand>(payload);
+			stats.viewports++;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "SetViewport %.1f %.1f %.1f %.1f\n", command.x, command.y, command.width, command.height);
+			break;
+		}
+
+		case RenderCommandType::UpdateInstances:
+		{
+			CommandList::UpdateInstancesCommand command = ReadPayload<CommandList::UpdateInstancesCommand>(payload);
+			size_t size = (size_t)command.stride * command.count;
+			stats.instanceUpdates++;
+			stats.instanceBytes += size;
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "UpdateInstances stride=%u count=%u hash=%08x\n",
+					command.stride, command.count, HashBytes(payload + sizeof(command), size));
+			break;
+		}
+
+		default:
+			if (keepTranscript)
+				snprintf(line, sizeof(line), "Unknown %u size=%u\n", (unsigned int)header.type, header.size);
+			break;
+		}
+
+		if (keepTranscript)
+			transcript += line;
+	}
+}
+
+void NullBackend::ResetStats()
+{
+	stats = {};
+	transcript.clear();
+}
+
+// Getters
+NullBackend::Stats NullBackend::GetStats() { return stats; }
+const std::string& NullBackend::GetTranscript() { return transcript; }
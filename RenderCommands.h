@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// See RenderCommands.cpp for usage details
+
+enum class RenderCommandType : unsigned int
+{
+	ClearTargets,
+	BindShaders,
+	BindMesh,
+	UpdateConstants,
+	Draw,
+	DrawInstanced,
+	SetViewport,
+	UpdateInstances
+};
+
+// Records a frame's rendering work into a flat byte stream,
+// which a backend then executes (or just inspects)
+class CommandList
+{
+public:
+	// Every command starts with one of these, followed by its payload
+	struct Header
+	{
+		RenderCommandType type;
+		unsigned int size;			// Payload bytes, a multiple of 4
+	};
+
+	struct ClearTargetsCommand { float color[4]; float depth; };
+	struct BindShadersCommand { unsigned int shader; };
+	struct BindMeshCommand { unsigned int mesh; };
+	struct UpdateConstantsCommand { unsigned int slot; unsigned int size; };	// Followed by the data
+	struct DrawCommand { unsigned int indexCount; unsigned int startIndex; int baseVertex; };
+	struct DrawInstancedCommand { unsigned int indexCount; unsigned int instanceCount; unsigned int startIndex; int baseVertex; unsigned int startInstance; };
+	struct SetViewportCommand { float x; float y; float width; float height; };	// Pixels, depth range 0-1
+	struct UpdateInstancesCommand { unsigned int stride; unsigned int count; };	// Followed by the data
+
+	CommandList();
+	~CommandList();
+
+	void Clear();
+
+	// Recording
+	void ClearTargets(const float pColor[4], float pDepth);
+	void BindShaders(unsigned int pShader);
+	void BindMesh(unsigned int pMesh);
+	void UpdateConstants(unsigned int pSlot, const void* pData, unsigned int pSize);
+	void Draw(unsigned int pIndexCount, unsigned int pStartIndex = 0, int pBaseVertex = 0);
+	void DrawInstanced(unsigned int pIndexCount, unsigned int pInstanceCount, unsigned int pStartIndex = 0, int pBaseVertex = 0, unsigned int pStartInstance = 0);
+	void SetViewport(float pX, float pY, float pWidth, float pHeight);
+	void UpdateInstances(const void* pData, unsigned int pStride, unsigned int pCount);
+
+	// Reading, starting from offset 0: returns false at the end of the stream
+	bool Next(size_t& pOffset, Header& pHeader, const unsigned char*& pPayload) const;
+
+	// Getters
+	unsigned int GetCommandCount() const;
+	size_t GetByteSize() const;
+
+private:
+	void* Append(RenderCommandType pType, unsigned int pSize);
+
+	std::vector<unsigned char> data;
+	unsigned int commandCount;
+};
+
+// Something that can execute a command list
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() {}
+	virtual void Execute(const CommandList& pCommands) = 0;
+};
+
+// Executes nothing, but counts what would have been done and can
+// keep a text transcript of every command (for golden files)
+class NullBackend : public RenderBackend
+{
+public:
+	// Totals since the last ResetStats()
+	struct Stats
+	{
+		unsigned int commands;
+		unsigned int clears;
+		unsigned int shaderBinds;
+		unsigned int meshBinds;
+		unsigned int constantUpdates;
+		size_t constantBytes;
+		unsigned int draws;
+		unsigned int instances;
+		size_t indices;
+		unsigned int viewports;
+		unsigned int instanceUpdates;
+		size_t instanceBytes;
+	};
+
+	NullBackend(bool pKeepTranscript = false);
+	~NullBackend();
+
+	void Execute(const CommandList& pCommands) override;
+	void ResetStats();
+
+	// Getters
+	Stats GetStats();
+	const std::string& GetTranscript();
+
+private:
+	bool keepTranscript;
+	std::string transcript;
+	Stats stats;
+};
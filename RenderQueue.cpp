@@ -0,0 +1,187 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+#include <utility>
+
+// --------------- Basic usage -----------------
+//
+// Collects a frame's draws as 64-bit sort keys, sorts
+// them so draws sharing a shader and mesh end up next
+// to each other, and works out which binds can be
+// skipped.  No graphics API is involved, the caller
+// does the actual binding and drawing:
+//
+//   queue.Clear();
+//   queue.Push(RenderQueue::MakeKey(layer, shaderId, meshSlot, depth), entityIndex, meshHandle);
+//   queue.Sort();
+//
+//   for (const RenderQueue::DrawCall& call : queue.BuildDrawCalls())
+//   {
+//       if (call.bindShader) { /* set shaders for entity call.index */ }
+//       if (call.bindMesh)   { /* set vertex & index buffers */ }
+//       /* update per-object constants and draw */
+//   }
+//
+// Layers sort first (opaque before transparent, etc.),
+// then shaders, then meshes, then depth.  Depth is near
+// to far by default, or far to near with pBackToFront.
+//
+// The key only has room for 16 bits of mesh, so key it
+// on something small and dense that two live meshes
+// never share (a MeshManager slot index).  Whether a draw
+// needs its mesh bound is decided by the full mesh id
+// passed to Push() (the handle, with its generation), so
+// even ids that share key bits never skip a bind.
+//
+// Sort() is an LSD radix sort over the key's 8 bytes,
+// skipping bytes that are the same in every key (often
+// the layer and shader bytes), so it's stable and linear
+// in the number of draws.
+// ---------------------------------------------
+
+// Key layout
+namespace
+{
+	const int LayerShift = 60;
+	const int ShaderShift = 48;
+	const int MeshShift = 32;
+	const unsigned long long LayerMask = 0xF;
+	const unsigned long long ShaderMask = 0xFFF;
+	const unsigned long long MeshMask = 0xFFFF;
+}
+
+
+// --------------------------------------------------------
+// Packs the sort fields into a key.  Depth should be
+// zero or positive (view depth or distance to camera),
+// and ids wrap if they don't fit in their bits.
+// --------------------------------------------------------
+unsigned long long RenderQueue::MakeKey(unsigned int pLayer, unsigned int pShader, unsigned int pMesh, float pDepth, bool pBackToFront)
+{
+	// Positive floats sort the same as their bit patterns
+	if (!(pDepth > 0.0f))
+		pDepth = 0.0f;
+	unsigned int depthBits = 0;
+	memcpy(&depthBits, &pDepth, sizeof(depthBits));
+	if (pBackToFront)
+		depthBits = ~depthBits;
+
+	return
+		((pLayer & LayerMask) << LayerShift) |
+		((pShader & ShaderMask) << ShaderShift) |
+		((pMesh & MeshMask) << MeshShift) |
+		depthBits;
+}
+
+unsigned int RenderQueue::GetLayer(unsigned long long pKey) { return (unsigned int)((pKey >> LayerShift) & LayerMask); }
+unsigned int RenderQueue::GetShader(unsigned long long pKey) { return (unsigned int)((pKey >> ShaderShift) & ShaderMask); }
+unsigned int RenderQueue::GetMesh(unsigned long long pKey) { return (unsigned int)((pKey >> MeshShift) & MeshMask); }
+
+
+RenderQueue::RenderQueue() :
+	stats()
+{
+}
+
+RenderQueue::~RenderQueue()
+{
+}
+
+
+// --------------------------------------------------------
+// Empties the queue, keeping its memory for the next frame
+// --------------------------------------------------------
+void RenderQueue::Clear()
+{
+	items.clear();
+	drawCalls.clear();
+}
+
+void RenderQueue::Push(unsigned long long pKey, unsigned int pIndex, unsigned int pMesh)
+{
+	items.push_back({ pKey, pIndex, pMesh });
+}
+
+
+// --------------------------------------------------------
+// Stable LSD radix sort of the items by key, one byte per pass
+// --------------------------------------------------------
+void RenderQueue::Sort()
+{
+	size_t count = items.size();
+	if (count < 2)
+		return;
+
+	// Histograms for all 8 bytes in one read of the keys
+	unsigned int histograms[8][256] = {};
+	for (const Item& item : items)
+		for (int byte = 0; byte < 8; byte++)
+			histograms[byte][(item.key >> (byte * 8)) & 0xFF]++;
+
+	scratch.resize(count);
+	std::vector<Item>* source = &items;
+	std::vector<Item>* target = &scratch;
+	for (int byte = 0; byte < 8; byte++)
+	{
+		// Every key has the same value here, nothing to do
+		unsigned int* histogram = histograms[byte];
+		if (histogram[(items[0].key >> (byte * 8)) & 0xFF] == count)
+			continue;
+
+		// Bucket offsets
+		unsigned int offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++)
+		{
+			unsigned int bucketCount = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketCount;
+		}
+
+		Item* out = target->data();
+		for (const Item& item : *source)
+			out[histogram[(item.key >> (byte * 8)) & 0xFF]++] = item;
+		std::swap(source, target);
+	}
+
+	// Odd number of passes leaves the result in scratch
+	if (source != &items)
+		items.swap(scratch);
+}
+
+
+// --------------------------------------------------------
+// Walks the sorted items, flagging the binds that differ
+// from the previous draw.  The first draw binds everything.
+// Meshes are compared by their full id, not the key bits
+// --------------------------------------------------------
+const std::vector<RenderQueue::DrawCall>& RenderQueue::BuildDrawCalls()
+{
+	drawCalls.clear();
+	drawCalls.reserve(items.size());
+	stats = {};
+
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		unsigned long long key = items[i].key;
+		unsigned long long previous = i > 0 ? items[i - 1].key : 0;
+
+		DrawCall call = {};
+		call.index = items[i].index;
+		call.bindShader = i == 0 || GetShader(key) != GetShader(previous);
+		call.bindMesh = i == 0 || items[i].mesh != items[i - 1].mesh;
+		drawCalls.push_back(call);
+
+		stats.drawCalls++;
+		stats.shaderBinds += call.bindShader;
+		stats.meshBinds += call.bindMesh;
+	}
+
+	stats.shaderBindsSkipped = stats.drawCalls - stats.shaderBinds;
+	stats.meshBindsSkipped = stats.drawCalls - stats.meshBinds;
+	return drawCalls;
+}
+
+
+// Getters
+const std::vector<RenderQueue::Item>& RenderQueue::GetItems() { return items; }
+RenderQueue::Stats RenderQueue::GetStats() { return stats; }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+
+// See RenderQueue.cpp for usage details
+
+class RenderQueue
+{
+public:
+	// One queued draw: a sort key, the caller's index for it,
+	// and the whole mesh id (the key only keeps 16 bits of it)
+	struct Item
+	{
+		unsigned long long key;
+		unsigned int index;
+		unsigned int mesh;
+	};
+
+	// A sorted draw, with the binds it actually needs
+	struct DrawCall
+	{
+		unsigned int index;
+		bool bindShader;
+		bool bindMesh;
+	};
+
+	// Counts for the last BuildDrawCalls()
+	struct Stats
+	{
+		int drawCalls;
+		int shaderBinds;
+		int meshBinds;
+		int shaderBindsSkipped;		// Compared to binding everything for every draw
+		int meshBindsSkipped;
+	};
+
+	// Key layout, most significant first:
+	// layer (4 bits), shader (12 bits), mesh (16 bits), depth (32 bits)
+	static unsigned long long MakeKey(unsigned int pLayer, unsigned int pShader, unsigned int pMesh, float pDepth, bool pBackToFront = false);
+	static unsigned int GetLayer(unsigned long long pKey);
+	static unsigned int GetShader(unsigned long long pKey);
+	static unsigned int GetMesh(unsigned long long pKey);
+
+	RenderQueue();
+	~RenderQueue();
+
+	void Clear();
+	void Push(unsigned long long pKey, unsigned int pIndex, unsigned int pMesh);
+	void Sort();
+	const std::vector<DrawCall>& BuildDrawCalls();
+
+	// Getters
+	const std::vector<Item>& GetItems();
+	Stats GetStats();
+
+private:
+	std::vector<Item> items;
+	std::vector<Item> scratch;
+	std::vector<DrawCall> drawCalls;
+	Stats stats;
+};
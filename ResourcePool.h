@@ -0,0 +1,129 @@
+#pragma once
+
+#include <new>
+#include <utility>
+#include <vector>
+
+// --------------- Basic usage -----------------
+//
+// Fixed-capacity storage for objects that are looked up
+// far more often than they're created, handed out as
+// small handles instead of pointers:
+//
+//   ResourcePool<Mesh> pool(1024);
+//   ResourcePool<Mesh>::Handle handle = pool.Create(vertices, vertexCount, indices, indexCount, "Cube");
+//   Mesh* mesh = pool.Get(handle);	// Null once destroyed
+//   pool.Destroy(handle);
+//
+// A handle is a 32-bit slot index and generation.  Every
+// slot's storage is allocated up front and objects are
+// built in place, so Get() is an array index and a
+// compare, and objects never move.  Destroying an object
+// bumps its slot's generation, so stale handles get null
+// instead of whatever reuses the slot.  A zeroed handle
+// is never valid.
+//
+// The pool does no locking and no reference counting:
+// whoever owns it decides when objects go.
+// ---------------------------------------------
+
+template<class T>
+class ResourcePool
+{
+public:
+	// Slot index in the low 16 bits, generation in the high 16
+	struct Handle
+	{
+		unsigned int value;
+
+		unsigned int GetIndex() const { return value & 0xFFFF; }
+		unsigned int GetGeneration() const { return value >> 16; }
+		bool operator==(const Handle& pOther) const { return value == pOther.value; }
+		bool operator!=(const Handle& pOther) const { return value != pOther.value; }
+	};
+
+	ResourcePool(unsigned int pCapacity) :
+		capacity(pCapacity < 0xFFFF ? pCapacity : 0xFFFF),
+		slots(capacity),
+		count(0)
+	{
+		// Lowest slots first
+		freeSlots.reserve(capacity);
+		for (unsigned int i = capacity; i > 0; i--)
+			freeSlots.push_back(i - 1);
+	}
+
+	~ResourcePool()
+	{
+		for (Slot& slot : slots)
+		{
+			if (slot.alive)
+				((T*)slot.storage)->~T();
+		}
+	}
+
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	// Builds an object in a free slot.  Returns a zeroed
+	// handle when the pool is full
+	template<class... Args>
+	Handle Create(Args&&... pArgs)
+	{
+		if (freeSlots.empty())
+			return Handle{ 0 };
+
+		unsigned int index = freeSlots.back();
+		Slot& slot = slots[index];
+		new (slot.storage) T(std::forward<Args>(pArgs)...);
+		freeSlots.pop_back();
+		slot.alive = true;
+		count++;
+		return Handle{ ((unsigned int)slot.generation << 16) | index };
+	}
+
+	// False if the handle was already stale
+	bool Destroy(Handle pHandle)
+	{
+		T* object = Get(pHandle);
+		if (!object)
+			return false;
+
+		object->~T();
+		Slot& slot = slots[pHandle.GetIndex()];
+		slot.alive = false;
+		slot.generation = slot.generation == 0xFFFF ? 1 : slot.generation + 1;
+		freeSlots.push_back(pHandle.GetIndex());
+		count--;
+		return true;
+	}
+
+	T* Get(Handle pHandle)
+	{
+		// Against the capacity rather than slots.size(), which
+		// GCC can't relate to the array's length at -O3 and warns
+		// about (-Warray-bounds) for indices past it
+		unsigned int index = pHandle.GetIndex();
+		if (index >= capacity)
+			return 0;
+		Slot& slot = slots[index];
+		return slot.alive && slot.generation == pHandle.GetGeneration() ? (T*)slot.storage : 0;
+	}
+
+	// Getters
+	unsigned int GetCount() { return count; }
+	unsigned int GetCapacity() { return capacity; }
+
+private:
+	struct Slot
+	{
+		alignas(T) unsigned char storage[sizeof(T)];
+		unsigned short generation = 1;
+		bool alive = false;
+	};
+
+	unsigned int capacity;
+	std::vector<Slot> slots;
+	std::vector<unsigned int> freeSlots;
+	unsigned int count;
+};
@@ -0,0 +1,914 @@
+#include "SceneFile.h"
+#include "Log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// --------------- Basic usage -----------------
+//
+// Saves and loads a SceneData (entities, their transforms
+// and meshes, and the cameras):
+//
+//   SceneData scene;
+//   scene.meshNames.push_back("Cube");
+//   scene.AddEntity(0, position, rotation, scale, SceneData::EntityOccluder);
+//   SceneFile::Save(FixPath("Scene.bin"), scene);
+//   SceneFile::Load(FixPath("Scene.bin"), scene);		// False (and logged) if missing or damaged
+//   SceneFile::Read(data, size, "Scene.bin", scene);		// The same, from a file already in memory
+//
+// The binary file is a header (magic, version, counts and
+// where each section starts) followed by the entities'
+// arrays exactly as they sit in SceneData, each 16 byte
+// aligned.  Loading maps the file and copies each array
+// in one go, so a million entities is a few tens of MB of
+// memcpy.  Files from another version are rejected, as
+// are truncated ones and ones referring to meshes or
+// cameras they don't have.  Saves write a temporary file
+// and rename it into place.  Little endian only, like
+// everything this runs on.
+//
+// SaveText() and LoadText() do the same in JSON, with
+// one entity per line, so scenes can be diffed, reviewed
+// and edited by hand, then loaded or saved as binary.
+//
+// SceneSaver saves on its own thread.  Save() copies (or
+// moves) the scene and returns; only one save runs at a
+// time, so it returns false while the last one is still
+// writing.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const unsigned int SceneFileMagic = 0x454E4353;	// "SCNE"
+	const unsigned int SceneFileVersion = 1;
+	const unsigned int TextVersion = 1;
+	const size_t SectionAlignment = 16;
+
+	struct SceneFileHeader
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned int entityCount;
+		unsigned int cameraCount;
+		unsigned int meshNameCount;
+		unsigned int activeCamera;
+		unsigned long long fileSize;
+
+		// From the start of the file
+		unsigned long long meshNamesOffset;
+		unsigned long long meshNamesSize;
+		unsigned long long positionsOffset;
+		unsigned long long rotationsOffset;
+		unsigned long long scalesOffset;
+		unsigned long long meshesOffset;
+		unsigned long long flagsOffset;
+		unsigned long long camerasOffset;
+	};
+
+	unsigned long long AlignSection(unsigned long long offset)
+	{
+		return (offset + SectionAlignment - 1) & ~(unsigned long long)(SectionAlignment - 1);
+	}
+
+	// The whole file, read only, for as long as this lives
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& path) : data(0), size(0)
+		{
+#ifdef _WIN32
+			mapping = 0;
+			file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+			LARGE_INTEGER fileSize;
+			if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+				return;
+			mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+			if (!mapping)
+				return;
+			data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			size = data ? (size_t)fileSize.QuadPart : 0;
+#else
+			file = open(path.c_str(), O_RDONLY);
+			struct stat info;
+			if (file < 0 || fstat(file, &info) != 0 || info.st_size == 0)
+				return;
+			void* view = mmap(0, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (view == MAP_FAILED)
+				return;
+			data = (const unsigned char*)view;
+			size = (size_t)info.st_size;
+			madvise(view, size, MADV_SEQUENTIAL);
+#endif
+		}
+
+		~MappedFile()
+		{
+#ifdef _WIN32
+			if (data)
+				UnmapViewOfFile(data);
+			if (mapping)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+#else
+			if (data)
+				munmap((void*)data, size);
+			if (file >= 0)
+				close(file);
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const unsigned char* GetData() { return data; }
+		size_t GetSize() { return size; }
+
+	private:
+#ifdef _WIN32
+		HANDLE file;
+		HANDLE mapping;
+#else
+		int file;
+#endif
+		const unsigned char* data;
+		size_t size;
+	};
+
+	// Every per-entity array the same length, and every
+	// reference pointing at something that exists
+	bool IsConsistent(const SceneData& scene, const std::string& path)
+	{
+		size_t count = scene.meshes.size();
+		if (scene.positions.size() != count * 3 || scene.rotations.size() != count * 3 ||
+			scene.scales.size() != count * 3 || scene.entityFlags.size() != count)
+		{
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "%s: the entity arrays have different lengths", path.c_str());
+			return false;
+		}
+
+		for (unsigned int mesh : scene.meshes)
+		{
+			if (mesh >= scene.meshNames.size())
+			{
+				Log::Write(Log::Severity::Error, Log::Category::Assets, "%s: an entity refers to mesh %u of %zu", path.c_str(), mesh, scene.meshNames.size());
+				return false;
+			}
+		}
+
+		if (!scene.cameras.empty() && scene.activeCamera >= scene.cameras.size())
+		{
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "%s: the active camera is %u of %zu", path.c_str(), scene.activeCamera, scene.cameras.size());
+			return false;
+		}
+		return true;
+	}
+
+	// Just enough JSON for scene files: objects, arrays,
+	// numbers, strings (ASCII escapes only), true and false
+	struct JsonValue
+	{
+		enum class Type { Null, Bool, Number, String, Array, Object };
+
+		Type type = Type::Null;
+		bool boolean = false;
+		double number = 0;
+		std::string text;
+		std::vector<JsonValue> items;
+		std::vector<std::pair<std::string, JsonValue>> members;
+
+		const JsonValue* Find(const char* name) const
+		{
+			for (const std::pair<std::string, JsonValue>& member : members)
+			{
+				if (member.first == name)
+					return &member.second;
+			}
+			return 0;
+		}
+	};
+
+	class JsonReader
+	{
+	public:
+		JsonReader(const std::string& text) : at(text.c_str()), end(text.c_str() + text.size()), line(1) {}
+
+		bool Parse(JsonValue& value)
+		{
+			if (!ParseValue(value, 0))
+				return false;
+			SkipSpace();
+			return at == end || Fail("extra text after the scene");
+		}
+
+		const std::string& GetError() { return error; }
+
+	private:
+		void SkipSpace()
+		{
+			while (at < end && (*at == ' ' || *at == '\t' || *at == '\r' || *at == '\n'))
+			{
+				if (*at == '\n')
+					line++;
+				at++;
+			}
+		}
+
+		bool Fail(const char* message)
+		{
+			if (error.empty())
+				error = "line " + std::to_string(line) + ": " + message;
+			return false;
+		}
+
+		bool Expect(char c)
+		{
+			SkipSpace();
+			if (at == end || *at != c)
+				return Fail((std::string("expected '") + c + "'").c_str());
+			at++;
+			return true;
+		}
+
+		bool ParseString(std::string& text)
+		{
+			if (!Expect('"'))
+				return false;
+			while (at < end && *at != '"')
+			{
+				char c = *at++;
+				if (c == '\\')
+				{
+					if (at == end)
+						break;
+					c = *at++;
+					switch (c)
+					{
+					case 'n': c = '\n'; break;
+					case 't': c = '\t'; break;
+					case 'r': c = '\r'; break;
+					case 'b': c = '\b'; break;
+					case 'f': c = '\f'; break;
+					case 'u':
+						if (end - at < 4)
+							return Fail("bad \\u escape");
+						c = (char)strtol(std::string(at, 4).c_str(), 0, 16);
+						at += 4;
+						break;
+					}
+				}
+				text.push_back(c);
+			}
+			return Expect('"');
+		}
+
+		bool ParseValue(JsonValue& value, int depth)
+		{
+			if (depth > 16)
+				return Fail("nested too deeply");
+
+			SkipSpace();
+			if (at == end)
+				return Fail("unexpected end");
+
+			if (*at == '{')
+			{
+				at++;
+				value.type = JsonValue::Type::Object;
+				SkipSpace();
+				if (at < end && *at == '}')
+				{
+					at++;
+					return true;
+				}
+				while (true)
+				{
+					value.members.emplace_back();
+					if (!ParseString(value.members.back().first) || !Expect(':') || !ParseValue(value.members.back().second, depth + 1))
+						return false;
+					SkipSpace();
+					if (at == end || *at != ',')
+						return Expect('}');
+					at++;
+				}
+			}
+			if (*at == '[')
+			{
+				at++;
+				value.type = JsonValue::Type::Array;
+				SkipSpace();
+				if (at < end && *at == ']')
+				{
+					at++;
+					return true;
+				}
+				while (true)
+				{
+					value.items.emplace_back();
+					if (!ParseValue(value.items.back(), depth + 1))
+						return false;
+					SkipSpace();
+					if (at == end || *at != ',')
+						return Expect(']');
+					at++;
+				}
+			}
+			if (*at == '"')
+			{
+				value.type = JsonValue::Type::String;
+				return ParseString(value.text);
+			}
+			if (end - at >= 4 && strncmp(at, "true", 4) == 0)
+			{
+				at += 4;
+				value.type = JsonValue::Type::Bool;
+				value.boolean = true;
+				return true;
+			}
+			if (end - at >= 5 && strncmp(at, "false", 5) == 0)
+			{
+				at += 5;
+				value.type = JsonValue::Type::Bool;
+				return true;
+			}
+
+			// The text is null terminated, so strtod stops in time
+			char* numberEnd = 0;
+			value.number = strtod(at, &numberEnd);
+			if (numberEnd == at)
+				return Fail("expected a value");
+			at = numberEnd;
+			value.type = JsonValue::Type::Number;
+			return true;
+		}
+
+		const char* at;
+		const char* end;
+		int line;
+		std::string error;
+	};
+
+	bool ReadNumber(const JsonValue& object, const char* name, float& number)
+	{
+		const JsonValue* value = object.Find(name);
+		if (!value || value->type != JsonValue::Type::Number)
+			return false;
+		number = (float)value->number;
+		return true;
+	}
+
+	bool ReadNumbers(const JsonValue& object, const char* name, float* numbers, size_t count)
+	{
+		const JsonValue* value = object.Find(name);
+		if (!value || value->type != JsonValue::Type::Array || value->items.size() != count)
+			return false;
+		for (size_t i = 0; i < count; i++)
+		{
+			if (value->items[i].type != JsonValue::Type::Number)
+				return false;
+			numbers[i] = (float)value->items[i].number;
+		}
+		return true;
+	}
+
+	bool ReadFlag(const JsonValue& object, const char* name, bool& flag)
+	{
+		const JsonValue* value = object.Find(name);
+		if (!value || value->type != JsonValue::Type::Bool)
+			return false;
+		flag = value->boolean;
+		return true;
+	}
+
+	// Nine digits are enough to get the same float back
+	void AppendNumber(std::string& text, float number)
+	{
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "%.9g", number);
+		text += buffer;
+	}
+
+	void AppendNumbers(std::string& text, const float* numbers, size_t count)
+	{
+		text += '[';
+		for (size_t i = 0; i < count; i++)
+		{
+			text += i == 0 ? "" : ", ";
+			AppendNumber(text, numbers[i]);
+		}
+		text += ']';
+	}
+
+	void AppendString(std::string& text, const std::string& value)
+	{
+		char buffer[8];
+		text += '"';
+		for (unsigned char c : value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				text += '\\';
+				text += (char)c;
+			}
+			else if (c < 0x20)
+			{
+				snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+				text += buffer;
+			}
+			else
+				text += (char)c;
+		}
+		text += '"';
+	}
+}
+
+
+// --------------------------------------------------------
+// Adds one entity to the end of every array
+// --------------------------------------------------------
+void SceneData::AddEntity(unsigned int pMesh, const float pPosition[3], const float pRotation[3], const float pScale[3], unsigned char pFlags)
+{
+	positions.insert(positions.end(), pPosition, pPosition + 3);
+	rotations.insert(rotations.end(), pRotation, pRotation + 3);
+	scales.insert(scales.end(), pScale, pScale + 3);
+	meshes.push_back(pMesh);
+	entityFlags.push_back(pFlags);
+}
+
+void SceneData::Clear()
+{
+	meshNames.clear();
+	positions.clear();
+	rotations.clear();
+	scales.clear();
+	meshes.clear();
+	entityFlags.clear();
+	cameras.clear();
+	activeCamera = 0;
+}
+
+// Getters
+size_t SceneData::GetEntityCount() const { return meshes.size(); }
+
+
+// --------------------------------------------------------
+// Writes the scene as binary, replacing any old file
+// --------------------------------------------------------
+bool SceneFile::Save(const std::string& path, const SceneData& scene)
+{
+	if (!IsConsistent(scene, path))
+		return false;
+
+	// Names as a length and the characters, one after another
+	std::vector<unsigned char> names;
+	for (const std::string& name : scene.meshNames)
+	{
+		unsigned int length = (unsigned int)name.size();
+		names.insert(names.end(), (const unsigned char*)&length, (const unsigned char*)&length + sizeof(length));
+		names.insert(names.end(), name.begin(), name.end());
+	}
+
+	unsigned long long count = scene.GetEntityCount();
+	SceneFileHeader header = {};
+	header.magic = SceneFileMagic;
+	header.version = SceneFileVersion;
+	header.entityCount = (unsigned int)count;
+	header.cameraCount = (unsigned int)scene.cameras.size();
+	header.meshNameCount = (unsigned int)scene.meshNames.size();
+	header.activeCamera = scene.activeCamera;
+	header.meshNamesOffset = AlignSection(sizeof(header));
+	header.meshNamesSize = names.size();
+	header.positionsOffset = AlignSection(header.meshNamesOffset + names.size());
+	header.rotationsOffset = AlignSection(header.positionsOffset + count * 3 * sizeof(float));
+	header.scalesOffset = AlignSection(header.rotationsOffset + count * 3 * sizeof(float));
+	header.meshesOffset = AlignSection(header.scalesOffset + count * 3 * sizeof(float));
+	header.flagsOffset = AlignSection(header.meshesOffset + count * sizeof(unsigned int));
+	header.camerasOffset = AlignSection(header.flagsOffset + count);
+	header.fileSize = header.camerasOffset + scene.cameras.size() * sizeof(SceneData::CameraDesc);
+
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "Couldn't write %s", tempPath.c_str());
+			return false;
+		}
+
+		// Zeros up to each section's offset
+		const char padding[SectionAlignment] = {};
+		auto writeSection = [&](unsigned long long offset, const void* data, size_t size)
+			{
+				file.write(padding, (std::streamsize)(offset - (unsigned long long)file.tellp()));
+				file.write((const char*)data, size);
+			};
+		file.write((const char*)&header, sizeof(header));
+		writeSection(header.meshNamesOffset, names.data(), names.size());
+		writeSection(header.positionsOffset, scene.positions.data(), scene.positions.size() * sizeof(float));
+		writeSection(header.rotationsOffset, scene.rotations.data(), scene.rotations.size() * sizeof(float));
+		writeSection(header.scalesOffset, scene.scales.data(), scene.scales.size() * sizeof(float));
+		writeSection(header.meshesOffset, scene.meshes.data(), scene.meshes.size() * sizeof(unsigned int));
+		writeSection(header.flagsOffset, scene.entityFlags.data(), scene.entityFlags.size());
+		writeSection(header.camerasOffset, scene.cameras.data(), scene.cameras.size() * sizeof(SceneData::CameraDesc));
+		if (!file)
+		{
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "Couldn't write %s", tempPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "Couldn't replace %s", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Maps a binary scene and copies its arrays out.  The
+// scene is only replaced if the whole file checks out
+// --------------------------------------------------------
+bool SceneFile::Load(const std::string& path, SceneData& scene)
+{
+	MappedFile file(path);
+	if (!file.GetData())
+	{
+		Log::Write(Log::Severity::Warning, Log::Category::Assets, "Couldn't open %s", path.c_str());
+		return false;
+	}
+	return Read(file.GetData(), file.GetSize(), path, scene);
+}
+
+
+// --------------------------------------------------------
+// Parses a binary scene already in memory, checking it
+// as Load() does.  The path is only for the log
+// --------------------------------------------------------
+bool SceneFile::Read(const unsigned char* data, size_t size, const std::string& path, SceneData& scene)
+{
+	SceneFileHeader header;
+	if (size < sizeof(header))
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s isn't a scene file", path.c_str());
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != SceneFileMagic)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s isn't a scene file", path.c_str());
+		return false;
+	}
+	if (header.version != SceneFileVersion)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s is scene version %u, expected %u", path.c_str(), header.version, SceneFileVersion);
+		return false;
+	}
+
+	// Every section inside the file
+	unsigned long long count = header.entityCount;
+	auto inside = [size](unsigned long long offset, unsigned long long bytes) { return offset <= size && bytes <= size - offset; };
+	if (header.fileSize != size ||
+		!inside(header.meshNamesOffset, header.meshNamesSize) ||
+		!inside(header.positionsOffset, count * 3 * sizeof(float)) ||
+		!inside(header.rotationsOffset, count * 3 * sizeof(float)) ||
+		!inside(header.scalesOffset, count * 3 * sizeof(float)) ||
+		!inside(header.meshesOffset, count * sizeof(unsigned int)) ||
+		!inside(header.flagsOffset, count) ||
+		!inside(header.camerasOffset, header.cameraCount * (unsigned long long)sizeof(SceneData::CameraDesc)))
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s is truncated or damaged", path.c_str());
+		return false;
+	}
+
+	// The arrays are read in place below, so the data (a mapping
+	// starts on a page) and their offsets have to keep them aligned
+	auto aligned = [data](unsigned long long offset) { return ((size_t)data + offset) % alignof(float) == 0; };
+	static_assert(alignof(unsigned int) == alignof(float) && alignof(SceneData::CameraDesc) == alignof(float), "Sections are 4 byte aligned");
+	if (!aligned(header.positionsOffset) ||
+		!aligned(header.rotationsOffset) ||
+		!aligned(header.scalesOffset) ||
+		!aligned(header.meshesOffset) ||
+		!aligned(header.camerasOffset))
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s has misaligned sections", path.c_str());
+		return false;
+	}
+
+	SceneData loaded;
+	const unsigned char* names = data + header.meshNamesOffset;
+	const unsigned char* namesEnd = names + header.meshNamesSize;
+	for (unsigned int i = 0; i < header.meshNameCount; i++)
+	{
+		unsigned int length;
+		if (namesEnd - names < (long long)sizeof(length))
+			break;
+		memcpy(&length, names, sizeof(length));
+		names += sizeof(length);
+		if ((unsigned long long)(namesEnd - names) < length)
+			break;
+		loaded.meshNames.emplace_back((const char*)names, length);
+		names += length;
+	}
+	if (loaded.meshNames.size() != header.meshNameCount)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s is truncated or damaged", path.c_str());
+		return false;
+	}
+
+	// The bulk of it: one copy per array
+	const float* positions = (const float*)(data + header.positionsOffset);
+	const float* rotations = (const float*)(data + header.rotationsOffset);
+	const float* scales = (const float*)(data + header.scalesOffset);
+	const unsigned int* meshes = (const unsigned int*)(data + header.meshesOffset);
+	const unsigned char* flags = data + header.flagsOffset;
+	const SceneData::CameraDesc* cameras = (const SceneData::CameraDesc*)(data + header.camerasOffset);
+	loaded.positions.assign(positions, positions + count * 3);
+	loaded.rotations.assign(rotations, rotations + count * 3);
+	loaded.scales.assign(scales, scales + count * 3);
+	loaded.meshes.assign(meshes, meshes + count);
+	loaded.entityFlags.assign(flags, flags + count);
+	loaded.cameras.assign(cameras, cameras + header.cameraCount);
+	loaded.activeCamera = header.activeCamera;
+	if (!IsConsistent(loaded, path))
+		return false;
+
+	scene = std::move(loaded);
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Writes the scene as JSON, replacing any old file
+// --------------------------------------------------------
+bool SceneFile::SaveText(const std::string& path, const SceneData& scene)
+{
+	if (!IsConsistent(scene, path))
+		return false;
+
+	std::string text;
+	text.reserve(256 + scene.cameras.size() * 256 + scene.GetEntityCount() * 128);
+	text += "{\n\t\"version\": " + std::to_string(TextVersion) + ",\n";
+
+	text += "\t\"meshes\": [";
+	for (size_t i = 0; i < scene.meshNames.size(); i++)
+	{
+		text += i == 0 ? "" : ", ";
+		AppendString(text, scene.meshNames[i]);
+	}
+	text += "],\n";
+
+	text += "\t\"activeCamera\": " + std::to_string(scene.activeCamera) + ",\n";
+	text += "\t\"cameras\": [\n";
+	for (size_t i = 0; i < scene.cameras.size(); i++)
+	{
+		const SceneData::CameraDesc& camera = scene.cameras[i];
+		text += "\t\t{ \"position\": ";
+		AppendNumbers(text, camera.position, 3);
+		text += ", \"rotation\": ";
+		AppendNumbers(text, camera.rotation, 3);
+		text += ", \"fov\": ";
+		AppendNumber(text, camera.fov);
+		text += ", \"nearClip\": ";
+		AppendNumber(text, camera.nearClip);
+		text += ", \"farClip\": ";
+		AppendNumber(text, camera.farClip);
+		text += ", \"movementSpeed\": ";
+		AppendNumber(text, camera.movementSpeed);
+		text += ", \"lookSpeed\": ";
+		AppendNumber(text, camera.lookSpeed);
+		text += ", \"orthographicWidth\": ";
+		AppendNumber(text, camera.orthographicWidth);
+		text += std::string(", \"perspective\": ") + (camera.flags & SceneData::CameraPerspective ? "true" : "false");
+		text += std::string(", \"reversedZ\": ") + (camera.flags & SceneData::CameraReversedZ ? "true" : "false");
+		text += i + 1 < scene.cameras.size() ? " },\n" : " }\n";
+	}
+	text += "\t],\n";
+
+	text += "\t\"entities\": [\n";
+	for (size_t i = 0; i < scene.GetEntityCount(); i++)
+	{
+		text += "\t\t{ \"mesh\": " + std::to_string(scene.meshes[i]) + ", \"position\": ";
+		AppendNumbers(text, &scene.positions[i * 3], 3);
+		text += ", \"rotation\": ";
+		AppendNumbers(text, &scene.rotations[i * 3], 3);
+		text += ", \"scale\": ";
+		AppendNumbers(text, &scene.scales[i * 3], 3);
+		text += std::string(", \"occluder\": ") + (scene.entityFlags[i] & SceneData::EntityOccluder ? "true" : "false");
+		text += i + 1 < scene.GetEntityCount() ? " },\n" : " }\n";
+	}
+	text += "\t]\n}\n";
+
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), text.size());
+		if (!file)
+		{
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "Couldn't write %s", tempPath.c_str());
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "Couldn't replace %s", path.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Reads a JSON scene.  Every field has to be there, so a
+// typo is an error instead of a silently zeroed value
+// --------------------------------------------------------
+bool SceneFile::LoadText(const std::string& path, SceneData& scene)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		Log::Write(Log::Severity::Warning, Log::Category::Assets, "Couldn't open %s", path.c_str());
+		return false;
+	}
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	JsonValue root;
+	JsonReader reader(text);
+	if (!reader.Parse(root))
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s: %s", path.c_str(), reader.GetError().c_str());
+		return false;
+	}
+
+	float version = 0;
+	if (root.type != JsonValue::Type::Object || !ReadNumber(root, "version", version))
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s isn't a scene file", path.c_str());
+		return false;
+	}
+	if ((unsigned int)version != TextVersion)
+	{
+		Log::Write(Log::Severity::Error, Log::Category::Assets, "%s is scene version %u, expected %u", path.c_str(), (unsigned int)version, TextVersion);
+		return false;
+	}
+
+	SceneData loaded;
+	const JsonValue* meshes = root.Find("meshes");
+	const JsonValue* cameras = root.Find("cameras");
+	const JsonValue* entities = root.Find("entities");
+	float activeCamera = 0;
+	bool valid = meshes && meshes->type == JsonValue::Type::Array &&
+		cameras && cameras->type == JsonValue::Type::Array &&
+		entities && entities->type == JsonValue::Type::Array &&
+		ReadNumber(root, "activeCamera", activeCamera);
+	loaded.activeCamera = (unsigned int)activeCamera;
+
+	for (size_t i = 0; valid && i < meshes->items.size(); i++)
+	{
+		valid = meshes->items[i].type == JsonValue::Type::String;
+		loaded.meshNames.push_back(meshes->items[i].text);
+	}
+
+	for (size_t i = 0; valid && i < cameras->items.size(); i++)
+	{
+		const JsonValue& object = cameras->items[i];
+		SceneData::CameraDesc camera = {};
+		bool perspective = false;
+		bool reversedZ = false;
+		valid = ReadNumbers(object, "position", camera.position, 3) && ReadNumbers(object, "rotation", camera.rotation, 3) &&
+			ReadNumber(object, "fov", camera.fov) && ReadNumber(object, "nearClip", camera.nearClip) &&
+			ReadNumber(object, "farClip", camera.farClip) && ReadNumber(object, "movementSpeed", camera.movementSpeed) &&
+			ReadNumber(object, "lookSpeed", camera.lookSpeed) && ReadNumber(object, "orthographicWidth", camera.orthographicWidth) &&
+			ReadFlag(object, "perspective", perspective) && ReadFlag(object, "reversedZ", reversedZ);
+		camera.flags = (perspective ? SceneData::CameraPerspective : 0) | (reversedZ ? SceneData::CameraReversedZ : 0);
+		loaded.cameras.push_back(camera);
+		if (!valid)
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "%s: camera %zu is missing a field", path.c_str(), i);
+	}
+
+	for (size_t i = 0; valid && i < entities->items.size(); i++)
+	{
+		const JsonValue& object = entities->items[i];
+		float mesh = 0;
+		float position[3];
+		float rotation[3];
+		float scale[3];
+		bool occluder = false;
+		valid = ReadNumber(object, "mesh", mesh) && ReadNumbers(object, "position", position, 3) &&
+			ReadNumbers(object, "rotation", rotation, 3) && ReadNumbers(object, "scale", scale, 3) &&
+			ReadFlag(object, "occluder", occluder) && mesh >= 0;
+		loaded.AddEntity((unsigned int)mesh, position, rotation, scale, occluder ? SceneData::EntityOccluder : 0);
+		if (!valid)
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "%s: entity %zu is missing a field", path.c_str(), i);
+	}
+
+	if (!valid || !IsConsistent(loaded, path))
+	{
+		if (!valid)
+			Log::Write(Log::Severity::Error, Log::Category::Assets, "%s isn't a valid scene", path.c_str());
+		return false;
+	}
+
+	scene = std::move(loaded);
+	return true;
+}
+
+
+SceneSaver::SceneSaver() :
+	busy(false),
+	succeeded(true),
+	lastSaveMs(0.0)
+{
+}
+
+SceneSaver::~SceneSaver()
+{
+	Wait();
+}
+
+
+// --------------------------------------------------------
+// Copies the scene and writes it on the saver's thread,
+// as binary and (with a path) as text.  False if the last
+// save is still going
+// --------------------------------------------------------
+bool SceneSaver::Save(const SceneData& pScene, const std::string& pPath, const std::string& pTextPath)
+{
+	if (busy.load(std::memory_order_acquire))
+		return false;
+	Wait();
+
+	// Reuses last time's capacity, so usually just memcpy
+	snapshot = pScene;
+	Start(pPath, pTextPath);
+	return true;
+}
+
+// Same, for a scene built just to be saved
+bool SceneSaver::Save(SceneData&& pScene, const std::string& pPath, const std::string& pTextPath)
+{
+	if (busy.load(std::memory_order_acquire))
+		return false;
+	Wait();
+
+	snapshot = std::move(pScene);
+	Start(pPath, pTextPath);
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Writes the snapshot on a new thread
+// --------------------------------------------------------
+void SceneSaver::Start(const std::string& pPath, const std::string& pTextPath)
+{
+	busy.store(true, std::memory_order_relaxed);
+	thread = std::thread([this, pPath, pTextPath]()
+		{
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			bool saved = SceneFile::Save(pPath, snapshot);
+			if (saved && !pTextPath.empty())
+				saved = SceneFile::SaveText(pTextPath, snapshot);
+
+			lastSaveMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			succeeded = saved;
+			busy.store(false, std::memory_order_release);
+		});
+}
+
+
+// --------------------------------------------------------
+// Blocks until the current save (if any) is written
+// --------------------------------------------------------
+void SceneSaver::Wait()
+{
+	if (thread.joinable())
+		thread.join();
+}
+
+// Getters
+bool SceneSaver::IsBusy() { return busy.load(std::memory_order_acquire); }
+bool SceneSaver::Succeeded() { return succeeded; }
+double SceneSaver::GetLastSaveMs() { return lastSaveMs; }
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// See SceneFile.cpp for usage details
+
+// Everything needed to rebuild a scene, with the entities as
+// struct-of-arrays so saving and loading are bulk copies
+struct SceneData
+{
+	enum EntityFlags
+	{
+		EntityOccluder = 1
+	};
+
+	enum CameraFlags
+	{
+		CameraPerspective = 1,
+		CameraReversedZ = 2
+	};
+
+	struct CameraDesc
+	{
+		float position[3];
+		float rotation[3];			// Pitch, yaw, roll
+		float fov;					// Radians
+		float nearClip;
+		float farClip;
+		float movementSpeed;
+		float lookSpeed;
+		float orthographicWidth;
+		unsigned int flags;			// CameraFlags
+	};
+
+	// Entities refer to meshes by index into this, and meshes
+	// are found by name when the scene is instantiated
+	std::vector<std::string> meshNames;
+
+	// Per entity, three floats each for the transforms
+	std::vector<float> positions;
+	std::vector<float> rotations;	// Pitch, yaw, roll
+	std::vector<float> scales;
+	std::vector<unsigned int> meshes;
+	std::vector<unsigned char> entityFlags;
+
+	std::vector<CameraDesc> cameras;
+	unsigned int activeCamera = 0;
+
+	void AddEntity(unsigned int pMesh, const float pPosition[3], const float pRotation[3], const float pScale[3], unsigned char pFlags);
+	void Clear();
+
+	// Getters
+	size_t GetEntityCount() const;
+};
+
+namespace SceneFile
+{
+	// Binary, memory mapped on load
+	bool Save(const std::string& path, const SceneData& scene);
+	bool Load(const std::string& path, SceneData& scene);
+	bool Read(const unsigned char* data, size_t size, const std::string& path, SceneData& scene);
+
+	// JSON, one entity per line, for diffs and hand edits
+	bool SaveText(const std::string& path, const SceneData& scene);
+	bool LoadText(const std::string& path, SceneData& scene);
+}
+
+// Saves snapshots of a scene on its own thread, so the
+// frame only pays for the copy (or a move, for a scene
+// built just to be saved)
+class SceneSaver
+{
+public:
+	SceneSaver();
+	~SceneSaver();
+
+	bool Save(const SceneData& pScene, const std::string& pPath, const std::string& pTextPath = "");
+	bool Save(SceneData&& pScene, const std::string& pPath, const std::string& pTextPath = "");
+	void Wait();
+
+	// Getters
+	bool IsBusy();
+	bool Succeeded();			// The last finished save
+	double GetLastSaveMs();		// On the saving thread
+
+private:
+	void Start(const std::string& pPath, const std::string& pTextPath);
+
+	std::thread thread;
+	SceneData snapshot;
+	std::atomic<bool> busy;
+	std::atomic<bool> succeeded;
+	std::atomic<double> lastSaveMs;
+};
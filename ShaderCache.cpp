@@ -0,0 +1,174 @@
+#include "ShaderCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// --------------- Basic usage -----------------
+//
+// Keeps compiled shader bytecode on disk, one file per
+// key, so a warm start doesn't have to compile anything:
+//
+//   ShaderCache cache(FixPath("ShaderCache"));
+//   unsigned long long key = ShaderCache::MakeKey(source, defines, "main", "vs_5_0", compiler->GetId());
+//   if (!cache.Load(key, bytecode, metadata))
+//   {
+//       /* compile and reflect */
+//       cache.Store(key, bytecode, metadata);
+//   }
+//
+// The key is a 64 bit FNV-1a hash of the source text,
+// the defines, the entry point, the target profile and
+// the compiler's id (its version and flags), so editing
+// any of them just misses.  Stale files are never read
+// again, but aren't cleaned up either; delete the folder
+// to clear the cache.
+//
+// Each file holds a small header (magic, version, key and
+// sizes) before the bytecode and its metadata (text, like
+// the shader's reflection), so truncated or mismatched
+// files are treated as misses.  Stores write a temporary
+// file and rename it into place, so a reader never sees
+// a half written file.  Only uses the standard library.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const unsigned int CacheFileMagic = 0x43524853;	// "SHRC"
+	const unsigned int CacheFileVersion = 2;
+
+	struct CacheFileHeader
+	{
+		unsigned int magic;
+		unsigned int version;
+		unsigned long long key;
+		unsigned long long size;
+		unsigned long long metadataSize;
+	};
+
+	const unsigned long long FnvOffset = 14695981039346656037ull;
+	const unsigned long long FnvPrime = 1099511628211ull;
+
+	// Strings are hashed with a terminator, so "ab" + "c" != "a" + "bc"
+	unsigned long long HashString(unsigned long long hash, const std::string& text)
+	{
+		for (unsigned char c : text)
+			hash = (hash ^ c) * FnvPrime;
+		return (hash ^ 0xFF) * FnvPrime;
+	}
+}
+
+
+ShaderCache::ShaderCache(const std::string& pDirectory) :
+	directory(pDirectory),
+	stats()
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+}
+
+ShaderCache::~ShaderCache()
+{
+}
+
+
+// --------------------------------------------------------
+// Hashes everything that affects the compiler's output
+// --------------------------------------------------------
+unsigned long long ShaderCache::MakeKey(const std::string& pSource, const Defines& pDefines,
+	const std::string& pEntryPoint, const std::string& pTarget, const std::string& pCompilerId)
+{
+	unsigned long long hash = FnvOffset;
+	hash = HashString(hash, pSource);
+	for (const std::pair<std::string, std::string>& define : pDefines)
+	{
+		hash = HashString(hash, define.first);
+		hash = HashString(hash, define.second);
+	}
+	hash = HashString(hash, pEntryPoint);
+	hash = HashString(hash, pTarget);
+	hash = HashString(hash, pCompilerId);
+	return hash;
+}
+
+
+// --------------------------------------------------------
+// Reads the bytecode (and metadata) stored for a key, if
+// there is any
+// --------------------------------------------------------
+bool ShaderCache::Load(unsigned long long pKey, std::vector<unsigned char>& pBytecode, std::string& pMetadata)
+{
+	std::ifstream file(GetPath(pKey), std::ios::binary);
+	CacheFileHeader header = {};
+	if (file)
+		file.read((char*)&header, sizeof(header));
+	if (!file || header.magic != CacheFileMagic || header.version != CacheFileVersion || header.key != pKey || header.size == 0)
+	{
+		stats.misses++;
+		return false;
+	}
+
+	pBytecode.resize((size_t)header.size);
+	file.read((char*)pBytecode.data(), pBytecode.size());
+	pMetadata.resize((size_t)header.metadataSize);
+	file.read(pMetadata.data(), pMetadata.size());
+	if (!file)
+	{
+		pBytecode.clear();
+		pMetadata.clear();
+		stats.misses++;
+		return false;
+	}
+
+	stats.hits++;
+	stats.bytesLoaded += pBytecode.size();
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Writes the bytecode for a key, replacing any old file
+// --------------------------------------------------------
+bool ShaderCache::Store(unsigned long long pKey, const std::vector<unsigned char>& pBytecode, const std::string& pMetadata)
+{
+	if (pBytecode.empty())
+		return false;
+
+	std::string path = GetPath(pKey);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		CacheFileHeader header = { CacheFileMagic, CacheFileVersion, pKey, pBytecode.size(), pMetadata.size() };
+		file.write((const char*)&header, sizeof(header));
+		file.write((const char*)pBytecode.data(), pBytecode.size());
+		file.write(pMetadata.data(), pMetadata.size());
+		if (!file)
+			return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tempPath, error);
+		return false;
+	}
+
+	stats.stores++;
+	return true;
+}
+
+// Getters
+const std::string& ShaderCache::GetDirectory() { return directory; }
+ShaderCache::Stats ShaderCache::GetStats() { return stats; }
+
+std::string ShaderCache::GetPath(unsigned long long pKey)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.cso", pKey);
+	return (std::filesystem::path(directory) / name).string();
+}
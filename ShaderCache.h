@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// See ShaderCache.cpp for usage details
+
+class ShaderCache
+{
+public:
+	// Preprocessor defines passed to the compiler, name then value
+	using Defines = std::vector<std::pair<std::string, std::string>>;
+
+	// Lookups since the cache was created
+	struct Stats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int stores;
+		size_t bytesLoaded;
+	};
+
+	ShaderCache(const std::string& pDirectory);
+	~ShaderCache();
+
+	// Everything that changes the compiled bytecode goes into the key
+	static unsigned long long MakeKey(const std::string& pSource, const Defines& pDefines,
+		const std::string& pEntryPoint, const std::string& pTarget, const std::string& pCompilerId);
+
+	// The metadata is the shader's reflection (see ShaderReflection)
+	bool Load(unsigned long long pKey, std::vector<unsigned char>& pBytecode, std::string& pMetadata);
+	bool Store(unsigned long long pKey, const std::vector<unsigned char>& pBytecode, const std::string& pMetadata);
+
+	// Getters
+	const std::string& GetDirectory();
+	std::string GetPath(unsigned long long pKey);
+	Stats GetStats();
+
+private:
+	std::string directory;
+	Stats stats;
+};
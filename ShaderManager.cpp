@@ -0,0 +1,347 @@
+#include "ShaderManager.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "MemoryTracker.h"
+
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+// --------------- Basic usage -----------------
+//
+// Loads shaders from their HLSL source through an on-disk
+// bytecode cache, and recompiles them in the background
+// when the source changes:
+//
+//   ShaderManager shaders(std::make_shared<D3DShaderCompiler>(), FixPath("ShaderCache"));
+//   shaders.Add({ "PixelShader.hlsl", "main", "ps_5_0", {}, FixPath("PixelShader.cso") },
+//       [&](unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)
+//       { /* create the shader, return false on failure */ });
+//
+// Then once per frame, between frames:
+//
+//   shaders.Update();
+//
+// Add() loads the shader right away, so it's ready for
+// the first frame: from the cache if the source, defines,
+// entry point, target and compiler all match a previous
+// run (see ShaderCache), otherwise by compiling it on
+// the calling thread and caching the result.  If there's
+// no source to compile (only the .cso files are shipped
+// next to the exe) or it doesn't compile, the fallback
+// bytecode file is used instead.
+//
+// The create function also gets the shader's reflection
+// (its inputs and constant buffers).  It's cached with
+// the bytecode, so the compiler only reflects what it
+// just compiled, or fallback bytecode.
+//
+// Every source file is watched (see FileWatcher).  When
+// Update() notices a change, the shader is recompiled as
+// a JobSystem job.  Finished compiles are only committed
+// in Update(), so shaders never change in the middle of a
+// frame: the create function gets the new bytecode and
+// swaps its objects in, or returns false to keep the old
+// ones.  Failed compiles keep the old shader too, and log
+// the compiler's errors (also in GetErrors()).
+//
+// #includes aren't part of the cache key or watched, so
+// after editing an included file, Reload() the shaders
+// that include it.  Reload() always compiles, skipping
+// the cache, and stores the result over the stale entry,
+// so the next run picks up the edit too.
+// The compiler sits behind the ShaderCompiler interface
+// (D3DShaderCompiler on Windows), so the cache and file
+// watching work anywhere.
+// ---------------------------------------------
+
+ShaderManager::ShaderManager(std::shared_ptr<ShaderCompiler> pCompiler, const std::string& pCacheDirectory, double pPollSeconds) :
+	compiler(pCompiler),
+	compilerId(pCompiler->GetId()),
+	cache(pCacheDirectory),
+	pollSeconds(pPollSeconds),
+	lastPoll(std::chrono::high_resolution_clock::now()),
+	stats()
+{
+}
+
+ShaderManager::~ShaderManager()
+{
+	// Jobs only hold their own results and the compiler,
+	// but there's no point leaving them running
+	WaitIdle();
+}
+
+
+// --------------------------------------------------------
+// Loads a shader right away (cache, compile or fallback)
+// and starts watching its source.  Returns its id
+// --------------------------------------------------------
+unsigned int ShaderManager::Add(const ShaderDesc& pDesc, const CreateFunction& pCreate)
+{
+	MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+	unsigned int id = (unsigned int)shaders.size();
+	shaders.push_back({ pDesc, pCreate, 0, false, ShaderReflection(), "", 0, false, false });
+	Shader& shader = shaders[id];
+	stats.shaders++;
+	watcher.Watch(pDesc.sourcePath);
+
+	std::string source;
+	std::vector<unsigned char> bytecode;
+	std::string metadata;
+	ShaderReflection reflection;
+	bool reflected = false;
+	if (ReadSource(pDesc.sourcePath, source))
+	{
+		unsigned long long key = ShaderCache::MakeKey(source, pDesc.defines, pDesc.entryPoint, pDesc.target, compilerId);
+		if (cache.Load(key, bytecode, metadata))
+		{
+			stats.cacheHits++;
+			reflected = reflection.Parse(metadata);
+		}
+		else
+		{
+			stats.cacheMisses++;
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			stats.compiles++;
+			if (compiler->Compile(source, pDesc.sourcePath, pDesc.defines, pDesc.entryPoint, pDesc.target, bytecode, shader.errors))
+			{
+				reflected = compiler->Reflect(bytecode, reflection);
+				cache.Store(key, bytecode, reflected ? reflection.Serialize() : "");
+			}
+			else
+			{
+				stats.failedCompiles++;
+				bytecode.clear();
+				Log::Write(Log::Severity::Error, Log::Category::Graphics, "%s: %s", pDesc.sourcePath.c_str(), shader.errors.c_str());
+			}
+			stats.lastCompileMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+	}
+
+	// Prebuilt bytecode when there's nothing better
+	if (bytecode.empty() && !pDesc.fallbackPath.empty())
+	{
+		std::ifstream file(pDesc.fallbackPath, std::ios::binary);
+		bytecode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// Old cache files (or fallback bytecode) aren't reflected yet
+	if (!bytecode.empty() && !reflected && !compiler->Reflect(bytecode, reflection))
+		Log::Write(Log::Severity::Warning, Log::Category::Graphics, "Couldn't reflect %s", pDesc.sourcePath.c_str());
+
+	if (bytecode.empty() || !Swap(id, bytecode, reflection))
+		Log::Write(Log::Severity::Error, Log::Category::Graphics, "Couldn't load shader %s", pDesc.sourcePath.c_str());
+	return id;
+}
+
+
+// --------------------------------------------------------
+// Commits finished compiles, then checks the sources for
+// changes.  Call between frames
+// --------------------------------------------------------
+void ShaderManager::Update()
+{
+	for (unsigned int i = 0; i < shaders.size(); i++)
+	{
+		if (shaders[i].job && shaders[i].job->done.load(std::memory_order_acquire))
+			FinishCompile(i);
+	}
+
+	std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+	if (std::chrono::duration<double>(now - lastPoll).count() < pollSeconds)
+		return;
+	lastPoll = now;
+
+	for (const std::string& path : watcher.Poll())
+	{
+		for (unsigned int i = 0; i < shaders.size(); i++)
+		{
+			if (shaders[i].desc.sourcePath == path)
+				QueueCompile(i, false);
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Recompiles a shader in the background, even if the
+// cache has bytecode for its source (which is stale when
+// a file it includes changed)
+// --------------------------------------------------------
+void ShaderManager::Reload(unsigned int pShader)
+{
+	QueueCompile(pShader, true);
+}
+
+
+// --------------------------------------------------------
+// Starts a compile, or queues one for when the compile in
+// flight is done.  Unless forced, a compile just swaps in
+// cached bytecode if the source went back to an earlier
+// version
+// --------------------------------------------------------
+void ShaderManager::QueueCompile(unsigned int pShader, bool pForce)
+{
+	Shader& shader = shaders[pShader];
+	shader.forceCompile = shader.forceCompile || pForce;
+	if (shader.job)
+	{
+		shader.recompile = true;
+		return;
+	}
+	StartCompile(pShader);
+}
+
+
+// --------------------------------------------------------
+// Blocks until every compile in flight is done, then
+// commits them.  Mostly for shutdown and tests
+// --------------------------------------------------------
+void ShaderManager::WaitIdle()
+{
+	for (unsigned int i = 0; i < shaders.size(); i++)
+	{
+		while (shaders[i].job)
+		{
+			while (!shaders[i].job->done.load(std::memory_order_acquire))
+				std::this_thread::yield();
+			FinishCompile(i);
+		}
+	}
+}
+
+
+// --------------------------------------------------------
+// Reads a whole text file
+// --------------------------------------------------------
+bool ShaderManager::ReadSource(const std::string& pPath, std::string& pSource)
+{
+	std::ifstream file(pPath, std::ios::binary);
+	if (!file)
+		return false;
+	pSource.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return !pSource.empty();
+}
+
+
+// --------------------------------------------------------
+// Hands new bytecode to the shader's create function
+// --------------------------------------------------------
+bool ShaderManager::Swap(unsigned int pShader, const std::vector<unsigned char>& pBytecode, const ShaderReflection& pReflection)
+{
+	Shader& shader = shaders[pShader];
+	if (!shader.create(pShader, pBytecode, pReflection))
+		return false;
+
+	shader.reflection = pReflection;
+	shader.version++;
+	shader.loaded = true;
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Reads the source on this thread and compiles it on a
+// worker, unless the cache already has it and the compile
+// isn't forced
+// --------------------------------------------------------
+void ShaderManager::StartCompile(unsigned int pShader)
+{
+	MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+	Shader& shader = shaders[pShader];
+	shader.recompile = false;
+
+	std::string source;
+	if (!ReadSource(shader.desc.sourcePath, source))
+		return;	// Mid-save, most likely; the next change will be picked up
+	bool force = shader.forceCompile;
+	shader.forceCompile = false;
+
+	unsigned long long key = ShaderCache::MakeKey(source, shader.desc.defines, shader.desc.entryPoint, shader.desc.target, compilerId);
+	std::vector<unsigned char> bytecode;
+	std::string metadata;
+	ShaderReflection reflection;
+	if (!force && cache.Load(key, bytecode, metadata) && (reflection.Parse(metadata) || compiler->Reflect(bytecode, reflection)))
+	{
+		stats.cacheHits++;
+		if (Swap(pShader, bytecode, reflection))
+		{
+			shader.errors.clear();
+			stats.reloads++;
+		}
+		return;
+	}
+	if (!force)
+		stats.cacheMisses++;
+
+	std::shared_ptr<CompileJob> job = std::make_shared<CompileJob>();
+	job->key = key;
+	shader.job = job;
+	stats.pendingCompiles++;
+
+	// The job gets its own copies, so the manager can change (or go) meanwhile
+	std::shared_ptr<ShaderCompiler> jobCompiler = compiler;
+	ShaderDesc desc = shader.desc;
+	JobSystem::Submit([job, jobCompiler, desc, source]()
+		{
+			MemoryTracker::Scope scope(MemoryTracker::Tag::Assets);
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			job->succeeded = jobCompiler->Compile(source, desc.sourcePath, desc.defines, desc.entryPoint, desc.target, job->bytecode, job->errors);
+			if (job->succeeded && !jobCompiler->Reflect(job->bytecode, job->reflection))
+			{
+				job->succeeded = false;
+				job->errors = "Couldn't reflect the compiled shader";
+			}
+			job->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			job->done.store(true, std::memory_order_release);
+		});
+}
+
+
+// --------------------------------------------------------
+// Swaps in a finished compile's bytecode (or logs its
+// errors), then starts over if the source changed again
+// --------------------------------------------------------
+void ShaderManager::FinishCompile(unsigned int pShader)
+{
+	Shader& shader = shaders[pShader];
+	std::shared_ptr<CompileJob> job = shader.job;
+	shader.job = 0;
+	stats.pendingCompiles--;
+	stats.compiles++;
+	stats.lastCompileMs = job->milliseconds;
+
+	if (job->succeeded)
+	{
+		cache.Store(job->key, job->bytecode, job->reflection.Serialize());
+		if (Swap(pShader, job->bytecode, job->reflection))
+		{
+			shader.errors.clear();
+			stats.reloads++;
+			Log::Write(Log::Severity::Info, Log::Category::Graphics, "Reloaded %s (%.0f ms)", shader.desc.sourcePath.c_str(), job->milliseconds);
+		}
+		else
+		{
+			Log::Write(Log::Severity::Error, Log::Category::Graphics, "Couldn't create %s, keeping the previous version", shader.desc.sourcePath.c_str());
+		}
+	}
+	else
+	{
+		stats.failedCompiles++;
+		shader.errors = job->errors;
+		Log::Write(Log::Severity::Error, Log::Category::Graphics, "%s: %s", shader.desc.sourcePath.c_str(), job->errors.c_str());
+	}
+
+	if (shader.recompile)
+		StartCompile(pShader);
+}
+
+// Getters
+ShaderManager::Stats ShaderManager::GetStats() { return stats; }
+unsigned int ShaderManager::GetShaderCount() { return (unsigned int)shaders.size(); }
+const ShaderManager::ShaderDesc& ShaderManager::GetDesc(unsigned int pShader) { return shaders[pShader].desc; }
+unsigned int ShaderManager::GetVersion(unsigned int pShader) { return shaders[pShader].version; }
+const std::string& ShaderManager::GetErrors(unsigned int pShader) { return shaders[pShader].errors; }
+const ShaderReflection& ShaderManager::GetReflection(unsigned int pShader) { return shaders[pShader].reflection; }
+bool ShaderManager::IsLoaded(unsigned int pShader) { return shaders[pShader].loaded; }
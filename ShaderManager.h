@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileWatcher.h"
+#include "ShaderCache.h"
+#include "ShaderReflection.h"
+
+// See ShaderManager.cpp for usage details
+
+// Turns shader source into bytecode.  Called from worker
+// threads, possibly for several shaders at once
+class ShaderCompiler
+{
+public:
+	virtual ~ShaderCompiler() {}
+	virtual bool Compile(const std::string& pSource, const std::string& pSourceName, const ShaderCache::Defines& pDefines,
+		const std::string& pEntryPoint, const std::string& pTarget,
+		std::vector<unsigned char>& pBytecode, std::string& pErrors) = 0;
+
+	// Reads the inputs and constant buffers out of bytecode.  Also
+	// called from worker threads
+	virtual bool Reflect(const std::vector<unsigned char>& pBytecode, ShaderReflection& pReflection) = 0;
+
+	// Compiler version and flags, part of every cache key
+	virtual std::string GetId() = 0;
+};
+
+class ShaderManager
+{
+public:
+	// Where a shader comes from
+	struct ShaderDesc
+	{
+		std::string sourcePath;
+		std::string entryPoint;
+		std::string target;				// Profile, like "vs_5_0"
+		ShaderCache::Defines defines;
+		std::string fallbackPath;		// Prebuilt bytecode, used when the source can't be compiled
+	};
+
+	// Creates the API objects for new bytecode, on the main thread.
+	// Returning false keeps whatever the shader had before
+	using CreateFunction = std::function<bool(unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)>;
+
+	// Totals since the manager was created
+	struct Stats
+	{
+		int shaders;
+		unsigned int cacheHits;
+		unsigned int cacheMisses;
+		unsigned int compiles;			// Startup and background
+		unsigned int failedCompiles;
+		unsigned int reloads;			// Shaders swapped after their source changed
+		int pendingCompiles;
+		double lastCompileMs;
+	};
+
+	ShaderManager(std::shared_ptr<ShaderCompiler> pCompiler, const std::string& pCacheDirectory, double pPollSeconds = 0.25);
+	~ShaderManager();
+
+	unsigned int Add(const ShaderDesc& pDesc, const CreateFunction& pCreate);
+	void Update();
+	void Reload(unsigned int pShader);
+	void WaitIdle();
+
+	// Getters
+	Stats GetStats();
+	unsigned int GetShaderCount();
+	const ShaderDesc& GetDesc(unsigned int pShader);
+	unsigned int GetVersion(unsigned int pShader);		// Bumped every time its bytecode is swapped in
+	const std::string& GetErrors(unsigned int pShader);	// From its last failed compile, if any
+	const ShaderReflection& GetReflection(unsigned int pShader);
+	bool IsLoaded(unsigned int pShader);
+
+private:
+	// A compile running on a worker.  The worker only fills in
+	// the results; the main thread commits them in Update()
+	struct CompileJob
+	{
+		unsigned long long key;
+		bool succeeded;
+		std::vector<unsigned char> bytecode;
+		ShaderReflection reflection;
+		std::string errors;
+		double milliseconds;
+		std::atomic<bool> done{ false };
+	};
+
+	struct Shader
+	{
+		ShaderDesc desc;
+		CreateFunction create;
+		unsigned int version;
+		bool loaded;
+		ShaderReflection reflection;
+		std::string errors;
+		std::shared_ptr<CompileJob> job;	// In flight, if any
+		bool recompile;						// Source changed again while compiling
+		bool forceCompile;					// The next compile skips the cache
+	};
+
+	bool ReadSource(const std::string& pPath, std::string& pSource);
+	bool Swap(unsigned int pShader, const std::vector<unsigned char>& pBytecode, const ShaderReflection& pReflection);
+	void QueueCompile(unsigned int pShader, bool pForce);
+	void StartCompile(unsigned int pShader);
+	void FinishCompile(unsigned int pShader);
+
+	std::shared_ptr<ShaderCompiler> compiler;
+	std::string compilerId;
+	ShaderCache cache;
+	FileWatcher watcher;
+	std::vector<Shader> shaders;
+
+	// Files are only checked every so often
+	double pollSeconds;
+	std::chrono::high_resolution_clock::time_point lastPoll;
+
+	Stats stats;
+};
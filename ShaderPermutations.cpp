@@ -0,0 +1,90 @@
+#include "ShaderPermutations.h"
+
+// --------------- Basic usage -----------------
+//
+// Variants of one shader, switched on and off with
+// feature bits.  Each feature is a preprocessor define
+// the source can test with #if:
+//
+//   ShaderPermutations pixelShaders(shaderManager, desc, { "SHOW_DEPTH" }, create);
+//   unsigned int shader = pixelShaders.Get(pixelShaders.GetFeatureBit("SHOW_DEPTH"));
+//
+// Get() returns the ShaderManager's id for that variant,
+// adding it the first time it's asked for (which loads
+// it right away, like ShaderManager::Add()).  Bit i turns
+// on features[i]; every feature is defined, as 1 or 0, so
+// sources don't need #ifdef.  The defines are part of the
+// cache key, so every variant is compiled once and cached
+// on its own, and watched and reloaded like any other
+// shader.
+//
+// Only the variant with no features uses the desc's
+// fallback bytecode, since that's what the prebuilt .cso
+// files hold.
+// ---------------------------------------------
+
+ShaderPermutations::ShaderPermutations(std::shared_ptr<ShaderManager> pManager, const ShaderManager::ShaderDesc& pDesc,
+	const std::vector<std::string>& pFeatures, const ShaderManager::CreateFunction& pCreate) :
+	manager(pManager),
+	desc(pDesc),
+	features(pFeatures),
+	create(pCreate)
+{
+}
+
+ShaderPermutations::~ShaderPermutations()
+{
+}
+
+
+// --------------------------------------------------------
+// Returns the shader for a set of feature bits, loading
+// it on first use.  Unknown bits are ignored
+// --------------------------------------------------------
+unsigned int ShaderPermutations::Get(unsigned int pFeatures)
+{
+	pFeatures &= (1u << features.size()) - 1;
+	for (const std::pair<unsigned int, unsigned int>& variant : variants)
+	{
+		if (variant.first == pFeatures)
+			return variant.second;
+	}
+
+	ShaderManager::ShaderDesc variantDesc = desc;
+	ShaderCache::Defines defines = GetDefines(pFeatures);
+	variantDesc.defines.insert(variantDesc.defines.end(), defines.begin(), defines.end());
+	if (pFeatures != 0)
+		variantDesc.fallbackPath.clear();
+
+	unsigned int shader = manager->Add(variantDesc, create);
+	variants.push_back({ pFeatures, shader });
+	return shader;
+}
+
+
+// --------------------------------------------------------
+// The defines for a set of feature bits
+// --------------------------------------------------------
+ShaderCache::Defines ShaderPermutations::GetDefines(unsigned int pFeatures)
+{
+	ShaderCache::Defines defines;
+	for (unsigned int i = 0; i < features.size(); i++)
+		defines.push_back({ features[i], (pFeatures & (1u << i)) ? "1" : "0" });
+	return defines;
+}
+
+// Getters
+const std::vector<std::string>& ShaderPermutations::GetFeatures() { return features; }
+unsigned int ShaderPermutations::GetVariantCount() { return (unsigned int)variants.size(); }
+unsigned int ShaderPermutations::GetVariantFeatures(unsigned int pVariant) { return variants[pVariant].first; }
+unsigned int ShaderPermutations::GetVariantShader(unsigned int pVariant) { return variants[pVariant].second; }
+
+unsigned int ShaderPermutations::GetFeatureBit(const std::string& pFeature)
+{
+	for (unsigned int i = 0; i < features.size(); i++)
+	{
+		if (features[i] == pFeature)
+			return 1u << i;
+	}
+	return 0;
+}
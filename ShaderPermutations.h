@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ShaderManager.h"
+
+// See ShaderPermutations.cpp for usage details
+
+class ShaderPermutations
+{
+public:
+	ShaderPermutations(std::shared_ptr<ShaderManager> pManager, const ShaderManager::ShaderDesc& pDesc,
+		const std::vector<std::string>& pFeatures, const ShaderManager::CreateFunction& pCreate);
+	~ShaderPermutations();
+
+	unsigned int Get(unsigned int pFeatures);
+	ShaderCache::Defines GetDefines(unsigned int pFeatures);
+
+	// Getters
+	unsigned int GetFeatureBit(const std::string& pFeature);
+	const std::vector<std::string>& GetFeatures();
+	unsigned int GetVariantCount();
+	unsigned int GetVariantFeatures(unsigned int pVariant);
+	unsigned int GetVariantShader(unsigned int pVariant);
+
+private:
+	std::shared_ptr<ShaderManager> manager;
+	ShaderManager::ShaderDesc desc;
+	std::vector<std::string> features;
+	ShaderManager::CreateFunction create;
+
+	// Feature bits and the manager's id, for every variant used so far
+	std::vector<std::pair<unsigned int, unsigned int>> variants;
+};
@@ -0,0 +1,270 @@
+#include "ShaderReflection.h"
+
+#include <sstream>
+
+// --------------- Basic usage -----------------
+//
+// What a compiled shader expects from the CPU: its vertex
+// inputs and its constant buffers, with every variable's
+// offset.  The compiler fills it in (see ShaderCompiler::
+// Reflect), and the ShaderManager stores it as text next
+// to the cached bytecode:
+//
+//   input POSITION 0 float 3
+//   input COLOR 0 float 4
+//   input TINT 0 float 4
+//   cbuffer ExternalData 0 64
+//   variable viewProjection 0 64
+//
+// so warm starts (and other platforms) never need the
+// compiler's reflection API.  Variables belong to the
+// cbuffer line before them.
+//
+// Input layouts come from matching the inputs against a
+// description of the C++ vertex:
+//
+//   std::vector<ShaderReflection::InputElement> layout;
+//   if (!reflection.BuildInputLayout(vertexFormat, layout, errors))
+//       /* the shader reads something the vertex doesn't have */
+//
+// The layout holds one element per shader input, at the
+// offset of the matching vertex member, so shaders that
+// read fewer members still work with the same vertex
+// buffers.  Permutations with the same inputs have the
+// same GetInputSignature(), so they can share a layout.
+//
+// CheckVariable() compares a C++ struct member (offsetof
+// and sizeof) with the shader's idea of it, so the two
+// can't silently drift apart.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const char* TypeNames[] = { "float", "uint", "sint" };
+
+	const unsigned long long FnvOffset = 14695981039346656037ull;
+	const unsigned long long FnvPrime = 1099511628211ull;
+
+	unsigned long long HashValue(unsigned long long hash, unsigned int value)
+	{
+		for (int i = 0; i < 4; i++)
+			hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * FnvPrime;
+		return hash;
+	}
+
+	std::string TypeName(ShaderReflection::ComponentType type)
+	{
+		return TypeNames[(int)type];
+	}
+
+	bool ParseType(const std::string& name, ShaderReflection::ComponentType& type)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (name == TypeNames[i])
+			{
+				type = (ShaderReflection::ComponentType)i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::string ElementName(const ShaderReflection::InputElement& element)
+	{
+		return element.semanticName + std::to_string(element.semanticIndex);
+	}
+}
+
+
+ShaderReflection::ShaderReflection()
+{
+}
+
+ShaderReflection::~ShaderReflection()
+{
+}
+
+void ShaderReflection::AddInput(const InputElement& pInput) { inputs.push_back(pInput); }
+void ShaderReflection::AddConstantBuffer(const ConstantBuffer& pBuffer) { constantBuffers.push_back(pBuffer); }
+
+void ShaderReflection::Clear()
+{
+	inputs.clear();
+	constantBuffers.clear();
+}
+
+
+// --------------------------------------------------------
+// Writes the metadata as text, one line per item
+// --------------------------------------------------------
+std::string ShaderReflection::Serialize() const
+{
+	std::ostringstream text;
+	for (const InputElement& input : inputs)
+		text << "input " << input.semanticName << " " << input.semanticIndex << " " << TypeName(input.type) << " " << input.componentCount << "\n";
+	for (const ConstantBuffer& buffer : constantBuffers)
+	{
+		text << "cbuffer " << buffer.name << " " << buffer.slot << " " << buffer.size << "\n";
+		for (const Variable& variable : buffer.variables)
+			text << "variable " << variable.name << " " << variable.offset << " " << variable.size << "\n";
+	}
+	return text.str();
+}
+
+
+// --------------------------------------------------------
+// Reads metadata written by Serialize().  Anything
+// malformed fails the whole parse and leaves it empty
+// --------------------------------------------------------
+bool ShaderReflection::Parse(const std::string& pText)
+{
+	Clear();
+
+	std::istringstream text(pText);
+	std::string line;
+	while (std::getline(text, line))
+	{
+		std::istringstream words(line);
+		std::string kind;
+		if (!(words >> kind))
+			continue;
+
+		bool valid = false;
+		if (kind == "input")
+		{
+			InputElement input = {};
+			std::string type;
+			valid = (bool)(words >> input.semanticName >> input.semanticIndex >> type >> input.componentCount) &&
+				ParseType(type, input.type) && input.componentCount >= 1 && input.componentCount <= 4;
+			if (valid)
+				inputs.push_back(input);
+		}
+		else if (kind == "cbuffer")
+		{
+			ConstantBuffer buffer = {};
+			valid = (bool)(words >> buffer.name >> buffer.slot >> buffer.size);
+			if (valid)
+				constantBuffers.push_back(buffer);
+		}
+		else if (kind == "variable")
+		{
+			Variable variable = {};
+			valid = (bool)(words >> variable.name >> variable.offset >> variable.size) &&
+				!constantBuffers.empty() && variable.offset + variable.size <= constantBuffers.back().size;
+			if (valid)
+				constantBuffers.back().variables.push_back(variable);
+		}
+
+		if (!valid)
+		{
+			Clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Finds each input in the vertex format, by semantic.
+// The vertex member may have more components than the
+// shader reads, but not fewer, and must be the same type
+// --------------------------------------------------------
+bool ShaderReflection::BuildInputLayout(const std::vector<InputElement>& pVertexFormat, std::vector<InputElement>& pLayout, std::string& pErrors) const
+{
+	pLayout.clear();
+	pErrors.clear();
+	for (const InputElement& input : inputs)
+	{
+		const InputElement* member = 0;
+		for (const InputElement& element : pVertexFormat)
+		{
+			if (element.semanticName == input.semanticName && element.semanticIndex == input.semanticIndex)
+			{
+				member = &element;
+				break;
+			}
+		}
+
+		if (!member)
+			pErrors += "The vertex has no " + ElementName(input) + "\n";
+		else if (member->type != input.type || member->componentCount < input.componentCount)
+			pErrors += ElementName(input) + " is " + TypeName(member->type) + std::to_string(member->componentCount) +
+				" in the vertex but " + TypeName(input.type) + std::to_string(input.componentCount) + " in the shader\n";
+		else
+			pLayout.push_back(*member);
+	}
+
+	if (!pErrors.empty())
+	{
+		pErrors.pop_back();
+		pLayout.clear();
+		return false;
+	}
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Checks that a C++ struct member lines up with a shader
+// variable
+// --------------------------------------------------------
+bool ShaderReflection::CheckVariable(const std::string& pBuffer, const std::string& pVariable, unsigned int pOffset, unsigned int pSize, std::string& pErrors) const
+{
+	const Variable* variable = FindVariable(pBuffer, pVariable);
+	if (!variable)
+	{
+		pErrors = pBuffer + " has no variable " + pVariable;
+		return false;
+	}
+	if (variable->offset != pOffset || variable->size != pSize)
+	{
+		pErrors = pBuffer + "." + pVariable + " is " + std::to_string(variable->size) + " bytes at offset " + std::to_string(variable->offset) +
+			" in the shader but " + std::to_string(pSize) + " bytes at offset " + std::to_string(pOffset) + " on the CPU";
+		return false;
+	}
+	return true;
+}
+
+// Getters
+const std::vector<ShaderReflection::InputElement>& ShaderReflection::GetInputs() const { return inputs; }
+const std::vector<ShaderReflection::ConstantBuffer>& ShaderReflection::GetConstantBuffers() const { return constantBuffers; }
+
+const ShaderReflection::ConstantBuffer* ShaderReflection::FindConstantBuffer(const std::string& pName) const
+{
+	for (const ConstantBuffer& buffer : constantBuffers)
+	{
+		if (buffer.name == pName)
+			return &buffer;
+	}
+	return 0;
+}
+
+const ShaderReflection::Variable* ShaderReflection::FindVariable(const std::string& pBuffer, const std::string& pVariable) const
+{
+	const ConstantBuffer* buffer = FindConstantBuffer(pBuffer);
+	if (!buffer)
+		return 0;
+	for (const Variable& variable : buffer->variables)
+	{
+		if (variable.name == pVariable)
+			return &variable;
+	}
+	return 0;
+}
+
+unsigned long long ShaderReflection::GetInputSignature() const
+{
+	unsigned long long hash = FnvOffset;
+	for (const InputElement& input : inputs)
+	{
+		for (char c : input.semanticName)
+			hash = (hash ^ (unsigned char)c) * FnvPrime;
+		hash = HashValue(hash, input.semanticIndex);
+		hash = HashValue(hash, (unsigned int)input.type);
+		hash = HashValue(hash, input.componentCount);
+	}
+	return hash;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// See ShaderReflection.cpp for usage details
+
+class ShaderReflection
+{
+public:
+	enum class ComponentType
+	{
+		Float,
+		UInt,
+		SInt
+	};
+
+	// One vertex shader input, or one member of a vertex
+	// (the offset is only used for vertices)
+	struct InputElement
+	{
+		std::string semanticName;
+		unsigned int semanticIndex;
+		ComponentType type;
+		unsigned int componentCount;	// 1 to 4, 32 bits each
+		unsigned int offset;			// Bytes into the vertex
+	};
+
+	struct Variable
+	{
+		std::string name;
+		unsigned int offset;	// Bytes into the buffer
+		unsigned int size;
+	};
+
+	struct ConstantBuffer
+	{
+		std::string name;
+		unsigned int slot;		// Register, like b0
+		unsigned int size;
+		std::vector<Variable> variables;
+	};
+
+	ShaderReflection();
+	~ShaderReflection();
+
+	void AddInput(const InputElement& pInput);
+	void AddConstantBuffer(const ConstantBuffer& pBuffer);
+	void Clear();
+
+	// Stored metadata, cached alongside the bytecode
+	std::string Serialize() const;
+	bool Parse(const std::string& pText);
+
+	// Matches the inputs against a vertex's members
+	bool BuildInputLayout(const std::vector<InputElement>& pVertexFormat, std::vector<InputElement>& pLayout, std::string& pErrors) const;
+	bool CheckVariable(const std::string& pBuffer, const std::string& pVariable, unsigned int pOffset, unsigned int pSize, std::string& pErrors) const;
+
+	// Getters
+	const std::vector<InputElement>& GetInputs() const;
+	const std::vector<ConstantBuffer>& GetConstantBuffers() const;
+	const ConstantBuffer* FindConstantBuffer(const std::string& pName) const;
+	const Variable* FindVariable(const std::string& pBuffer, const std::string& pVariable) const;
+	unsigned long long GetInputSignature() const;	// Same inputs, same signature (and same layout)
+
+private:
+	std::vector<InputElement> inputs;
+	std::vector<ConstantBuffer> constantBuffers;
+};
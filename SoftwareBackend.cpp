@@ -0,0 +1,710 @@
+#include "SoftwareBackend.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+// SSE2 is part of every x64 target; other targets use the scalar loop
+#if !defined(SOFTWARE_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define SOFTWARE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// --------------- Basic usage -----------------
+//
+// A CPU reference implementation of the pipeline in
+// VertexShader.hlsl and PixelShader.hlsl, for rendering
+// without a D3D11 device (build machines, CI, Linux):
+//
+//   SoftwareBackend software(1280, 720);
+//   software.RegisterMesh(handle.GetIndex(), (const SoftwareBackend::InputVertex*)mesh->GetVertices().data(),
+//       mesh->GetVertexCount(), mesh->GetIndices().data(), mesh->GetIndexCount());
+//
+//   software.Execute(commands);		// Same command lists as the D3D11 backend
+//   software.SavePNG(FixPath("Frame.png"));
+//
+// Constant slot 0 is read as VertexShaderData, instances
+// as InstanceData and vertices as Vertex, just like the
+// shaders, though the layouts are spelled out in plain
+// floats (Constants, Instance and InputVertex) so this
+// builds anywhere without DirectXMath; Game checks they
+// still match.  Draw uses instance 0, like D3D11 does
+// with a per-instance stream bound, and draws of
+// instances that were never uploaded are skipped.  Every BindShaders id
+// runs that one pipeline.  The state matches the D3D11
+// defaults Graphics uses: back faces (counter-clockwise on
+// screen) are culled, depth is clipped to [0, w] and tested
+// with LESS, and there's no blending.  The viewport
+// covers the whole target until a SetViewport command.
+// For reversed Z cameras, SetReversedDepth(true) tests
+// with GREATER instead, like Game's reversed depth state.
+//
+// Draws are transformed and set up on the calling thread,
+// then binned into 64x64 pixel tiles.  The tiles are
+// rasterized on the JobSystem at the end of Execute() (or
+// before a clear), four pixels at a time (SSE2 when
+// available) with edge functions at pixel centers and the
+// top-left fill rule.  Each tile draws its triangles in
+// submission order and only one thread touches a tile, so
+// the image doesn't depend on the thread count, and the
+// scalar path gives the same bits as the SIMD one.
+//
+// Vertices snap to 1/256 of a pixel like D3D11, but the
+// math is floating point, so edge pixels aren't guaranteed
+// to match a GPU exactly; compare against images from this
+// backend instead.
+// ---------------------------------------------
+
+// Annonymous namespace to hold helpers only accessible in this file
+namespace
+{
+	const int TileSize = 64;
+
+	// Clip position (xyzw) then color (rgba)
+	const int ShadedVertexSize = 8;
+
+	// Snaps to D3D11's 8 bits of subpixel precision
+	float SnapToSubpixel(float value)
+	{
+		return std::floor(value * 256.0f + 0.5f) * (1.0f / 256.0f);
+	}
+
+	// [0, 1] float to an 8-bit UNORM channel
+	unsigned int ToUnorm8(float value)
+	{
+		value = std::min(std::max(value, 0.0f), 1.0f);
+		return (unsigned int)(value * 255.0f + 0.5f);
+	}
+
+	// Clips a polygon against a plane, keeping the side where
+	// distance(v) = v[plane] * sign + v[3] * wScale is >= 0
+	int ClipPolygon(const float (*input)[ShadedVertexSize], int inputSize, float (*output)[ShadedVertexSize], int component, float sign, float wScale)
+	{
+		int outputSize = 0;
+		for (int i = 0; i < inputSize; i++)
+		{
+			const float* a = input[i];
+			const float* b = input[(i + 1) % inputSize];
+			float distanceA = a[component] * sign + a[3] * wScale;
+			float distanceB = b[component] * sign + b[3] * wScale;
+			if (distanceA >= 0.0f)
+				std::copy(a, a + ShadedVertexSize, output[outputSize++]);
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+			{
+				float t = distanceA / (distanceA - distanceB);
+				for (int k = 0; k < ShadedVertexSize; k++)
+					output[outputSize][k] = a[k] + (b[k] - a[k]) * t;
+				outputSize++;
+			}
+		}
+		return outputSize;
+	}
+
+	// PNG chunks end with a CRC-32 of their type and data
+	unsigned int Crc32(const unsigned char* bytes, size_t size, unsigned int crc = 0)
+	{
+		static unsigned int table[256] = {};
+		if (table[1] == 0)
+		{
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int value = i;
+				for (int bit = 0; bit < 8; bit++)
+					value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				table[i] = value;
+			}
+		}
+
+		crc = ~crc;
+		for (size_t i = 0; i < size; i++)
+			crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	void AppendBigEndian(std::vector<unsigned char>& bytes, unsigned int value)
+	{
+		bytes.push_back((unsigned char)(value >> 24));
+		bytes.push_back((unsigned char)(value >> 16));
+		bytes.push_back((unsigned char)(value >> 8));
+		bytes.push_back((unsigned char)value);
+	}
+
+	void AppendChunk(std::vector<unsigned char>& png, const char type[4], const std::vector<unsigned char>& data)
+	{
+		AppendBigEndian(png, (unsigned int)data.size());
+		size_t start = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+		AppendBigEndian(png, Crc32(&png[start], png.size() - start));
+	}
+}
+
+
+// --------------------------------------------------------
+// Allocates the color and depth buffers and the tile bins
+// --------------------------------------------------------
+SoftwareBackend::SoftwareBackend(int pWidth, int pHeight) :
+	width(std::max(pWidth, 1)),
+	height(std::max(pHeight, 1)),
+	boundMesh(0),
+	constants(),
+	multithreaded(true),
+	reversedDepth(false),
+	stats()
+{
+	stride = (width + 3) & ~3;
+	color.resize((size_t)stride * height, 0);
+	depth.resize((size_t)stride * height, 1.0f);
+
+	tilesX = (width + TileSize - 1) / TileSize;
+	tilesY = (height + TileSize - 1) / TileSize;
+	tileTriangles.resize((size_t)tilesX * tilesY);
+	tilePixels.resize(tileTriangles.size(), 0);
+
+	SetViewport(0.0f, 0.0f, (float)width, (float)height);
+}
+
+SoftwareBackend::~SoftwareBackend()
+{
+}
+
+
+// --------------------------------------------------------
+// Keeps CPU copies of a mesh's vertices and indices
+// --------------------------------------------------------
+void SoftwareBackend::RegisterMesh(unsigned int pMesh, const InputVertex* pVertices, size_t pVertexCount, const unsigned int* pIndices, size_t pIndexCount)
+{
+	if (pMesh >= meshes.size())
+		meshes.resize(pMesh + 1);
+	meshes[pMesh].vertices.assign(pVertices, pVertices + pVertexCount);
+	meshes[pMesh].indices.assign(pIndices, pIndices + pIndexCount);
+}
+
+
+// --------------------------------------------------------
+// Runs every command, then rasterizes whatever was drawn
+// --------------------------------------------------------
+void SoftwareBackend::Execute(const CommandList& pCommands)
+{
+	size_t offset = 0;
+	CommandList::Header header;
+	const unsigned char* payload = 0;
+	while (pCommands.Next(offset, header, payload))
+	{
+		switch (header.type)
+		{
+		case RenderCommandType::ClearTargets:
+		{
+			CommandList::ClearTargetsCommand command;
+			memcpy(&command, payload, sizeof(command));
+
+			// Earlier draws have to land before they're cleared
+			Flush();
+			unsigned int clearColor =
+				ToUnorm8(command.color[0]) | (ToUnorm8(command.color[1]) << 8) |
+				(ToUnorm8(command.color[2]) << 16) | (ToUnorm8(command.color[3]) << 24);
+			std::fill(color.begin(), color.end(), clearColor);
+			std::fill(depth.begin(), depth.end(), command.depth);
+			break;
+		}
+
+		case RenderCommandType::BindMesh:
+		{
+			CommandList::BindMeshCommand command;
+			memcpy(&command, payload, sizeof(command));
+			boundMesh = command.mesh;
+			break;
+		}
+
+		case RenderCommandType::UpdateConstants:
+		{
+			CommandList::UpdateConstantsCommand command;
+			memcpy(&command, payload, sizeof(command));
+			if (command.slot == 0)
+				memcpy(&constants, payload + sizeof(command), std::min<size_t>(command.size, sizeof(constants)));
+			break;
+		}
+
+		case RenderCommandType::UpdateInstances:
+		{
+			CommandList::UpdateInstancesCommand command;
+			memcpy(&command, payload, sizeof(command));
+			instances.resize(command.stride == sizeof(Instance) ? command.count : 0);
+			if (!instances.empty())
+				memcpy(instances.data(), payload + sizeof(command), instances.size() * sizeof(Instance));
+			break;
+		}
+
+		case RenderCommandType::Draw:
+		{
+			CommandList::DrawCommand command;
+			memcpy(&command, payload, sizeof(command));
+			DrawIndexed(command.indexCount, command.startIndex, command.baseVertex, 0);
+			break;
+		}
+
+		case RenderCommandType::DrawInstanced:
+		{
+			CommandList::DrawInstancedCommand command;
+			memcpy(&command, payload, sizeof(command));
+			for (unsigned int i = 0; i < command.instanceCount; i++)
+				DrawIndexed(command.indexCount, command.startIndex, command.baseVertex, command.startInstance + i);
+			break;
+		}
+
+		case RenderCommandType::SetViewport:
+		{
+			CommandList::SetViewportCommand command;
+			memcpy(&command, payload, sizeof(command));
+			SetViewport(command.x, command.y, command.width, command.height);
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+
+	Flush();
+}
+
+
+// --------------------------------------------------------
+// Maps clip space to a rectangle of the render target, and
+// keeps rasterization inside the pixels it covers
+// --------------------------------------------------------
+void SoftwareBackend::SetViewport(float pX, float pY, float pWidth, float pHeight)
+{
+	viewport[0] = pX;
+	viewport[1] = pY;
+	viewport[2] = pWidth;
+	viewport[3] = pHeight;
+
+	// Pixels whose centers are inside the viewport and the target
+	scissor[0] = std::max((int)std::ceil(pX - 0.5f), 0);
+	scissor[1] = std::max((int)std::ceil(pY - 0.5f), 0);
+	scissor[2] = std::min((int)std::ceil(pX + pWidth - 0.5f) - 1, width - 1);
+	scissor[3] = std::min((int)std::ceil(pY + pHeight - 0.5f) - 1, height - 1);
+}
+
+
+// --------------------------------------------------------
+// The vertex shader, clipping, culling and triangle setup
+// for one instance of an indexed draw of the bound mesh
+// --------------------------------------------------------
+void SoftwareBackend::DrawIndexed(unsigned int pIndexCount, unsigned int pStartIndex, int pBaseVertex, unsigned int pInstance)
+{
+	if (boundMesh >= meshes.size() || pInstance >= instances.size())
+		return;
+	const MeshData& mesh = meshes[boundMesh];
+	const Instance& instance = instances[pInstance];
+	stats.draws++;
+
+	// float4 worldPosition = mul(float4(input.localPosition, 1.0f), world);
+	// output.screenPosition = mul(viewProjection, worldPosition);
+	// output.color = input.color * instanceTint;
+	// The two matrices are multiplied once per draw instead
+	float m[16];
+	for (int row = 0; row < 4; row++)
+		for (int col = 0; col < 4; col++)
+			m[row * 4 + col] =
+				instance.world[row][0] * constants.viewProjection[0][col] +
+				instance.world[row][1] * constants.viewProjection[1][col] +
+				instance.world[row][2] * constants.viewProjection[2][col] +
+				instance.world[row][3] * constants.viewProjection[3][col];
+	const float* tint = instance.colorTint;
+
+	shadedVertices.resize(mesh.vertices.size() * ShadedVertexSize);
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		const InputVertex& vertex = mesh.vertices[i];
+		float* shaded = &shadedVertices[i * ShadedVertexSize];
+		for (int col = 0; col < 4; col++)
+			shaded[col] = vertex.position[0] * m[0 * 4 + col] + vertex.position[1] * m[1 * 4 + col] + vertex.position[2] * m[2 * 4 + col] + m[3 * 4 + col];
+		shaded[4] = vertex.color[0] * tint[0];
+		shaded[5] = vertex.color[1] * tint[1];
+		shaded[6] = vertex.color[2] * tint[2];
+		shaded[7] = vertex.color[3] * tint[3];
+	}
+
+	size_t vertexCount = mesh.vertices.size();
+	size_t endIndex = std::min<size_t>((size_t)pStartIndex + pIndexCount, mesh.indices.size());
+	for (size_t i = pStartIndex; i + 2 < endIndex; i += 3)
+	{
+		stats.triangles++;
+
+		const float* triangle[3];
+		bool valid = true;
+		for (int j = 0; j < 3; j++)
+		{
+			long long index = (long long)mesh.indices[i + j] + pBaseVertex;
+			valid &= index >= 0 && (size_t)index < vertexCount;
+			triangle[j] = valid ? &shadedVertices[(size_t)index * ShadedVertexSize] : 0;
+		}
+		if (!valid)
+			continue;
+
+		// Skip triangles entirely outside one of the frustum planes
+		int outside[6] = {};
+		for (const float* v : triangle)
+		{
+			outside[0] += v[0] < -v[3];
+			outside[1] += v[0] > v[3];
+			outside[2] += v[1] < -v[3];
+			outside[3] += v[1] > v[3];
+			outside[4] += v[2] < 0.0f;
+			outside[5] += v[2] > v[3];
+		}
+		if (std::find(outside, outside + 6, 3) != outside + 6)
+			continue;
+
+		// Clip against the near (z >= 0) and far (z <= w) planes
+		// only when needed; x and y are handled by the tile bounds
+		if (outside[4] == 0 && outside[5] == 0)
+		{
+			SetupTriangle(triangle[0], triangle[1], triangle[2]);
+			continue;
+		}
+
+		float polygon[5][ShadedVertexSize];
+		float clipped[5][ShadedVertexSize];
+		for (int j = 0; j < 3; j++)
+			std::copy(triangle[j], triangle[j] + ShadedVertexSize, polygon[j]);
+		int polygonSize = ClipPolygon(polygon, 3, clipped, 2, 1.0f, 0.0f);
+		polygonSize = ClipPolygon(clipped, polygonSize, polygon, 2, -1.0f, 1.0f);
+		for (int j = 1; j + 1 < polygonSize; j++)
+			SetupTriangle(polygon[0], polygon[j], polygon[j + 1]);
+	}
+}
+
+
+// --------------------------------------------------------
+// Projects a clipped triangle to the screen, culls back
+// faces and bins what's left into the tiles it touches
+// --------------------------------------------------------
+void SoftwareBackend::SetupTriangle(const float* pV0, const float* pV1, const float* pV2)
+{
+	Triangle triangle;
+	const float* vertices[3] = { pV0, pV1, pV2 };
+	for (int i = 0; i < 3; i++)
+	{
+		const float* v = vertices[i];
+		if (!(v[3] > 0.0f))
+			return;
+
+		float invW = 1.0f / v[3];
+		triangle.x[i] = SnapToSubpixel(viewport[0] + (v[0] * invW * 0.5f + 0.5f) * viewport[2]);
+		triangle.y[i] = SnapToSubpixel(viewport[1] + (0.5f - v[1] * invW * 0.5f) * viewport[3]);
+		triangle.z[i] = v[2] * invW;
+		triangle.invW[i] = invW;
+		for (int k = 0; k < 4; k++)
+			triangle.color[i][k] = v[4 + k] * invW;
+	}
+
+	// Front faces are clockwise on screen (y down), which gives a positive area
+	float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+	if (!(area > 0.0f))
+		return;
+	triangle.invArea = 1.0f / area;
+
+	// Top edges run right, left edges run up
+	for (int i = 0; i < 3; i++)
+	{
+		float dx = triangle.x[(i + 1) % 3] - triangle.x[i];
+		float dy = triangle.y[(i + 1) % 3] - triangle.y[i];
+		triangle.inclusive[i] = (dy == 0.0f && dx > 0.0f) || dy < 0.0f;
+	}
+
+	// Pixel bounds, clamped to the viewport before converting to int
+	float minXf = std::max(std::min({ triangle.x[0], triangle.x[1], triangle.x[2] }), (float)scissor[0]);
+	float maxXf = std::min(std::max({ triangle.x[0], triangle.x[1], triangle.x[2] }), (float)scissor[2]);
+	float minYf = std::max(std::min({ triangle.y[0], triangle.y[1], triangle.y[2] }), (float)scissor[1]);
+	float maxYf = std::min(std::max({ triangle.y[0], triangle.y[1], triangle.y[2] }), (float)scissor[3]);
+	if (minXf > maxXf || minYf > maxYf)
+		return;
+	triangle.minX = (int)minXf;
+	triangle.maxX = (int)maxXf;
+	triangle.minY = (int)minYf;
+	triangle.maxY = (int)maxYf;
+
+	unsigned int index = (unsigned int)triangles.size();
+	triangles.push_back(triangle);
+	stats.rasterizedTriangles++;
+
+	for (int tileY = triangle.minY / TileSize; tileY <= triangle.maxY / TileSize; tileY++)
+		for (int tileX = triangle.minX / TileSize; tileX <= triangle.maxX / TileSize; tileX++)
+			tileTriangles[(size_t)tileY * tilesX + tileX].push_back(index);
+}
+
+
+// --------------------------------------------------------
+// Rasterizes every binned triangle, one job per tile
+// --------------------------------------------------------
+void SoftwareBackend::Flush()
+{
+	if (triangles.empty())
+		return;
+
+	unsigned int tileCount = (unsigned int)tileTriangles.size();
+	if (multithreaded)
+		JobSystem::ParallelFor(tileCount, [this](unsigned int tile) { RasterizeTile(tile); });
+	else
+		for (unsigned int tile = 0; tile < tileCount; tile++)
+			RasterizeTile(tile);
+
+	for (unsigned int tile = 0; tile < tileCount; tile++)
+	{
+		stats.pixels += tilePixels[tile];
+		tilePixels[tile] = 0;
+		tileTriangles[tile].clear();
+	}
+	triangles.clear();
+}
+
+
+// --------------------------------------------------------
+// Draws a tile's triangles in order: depth test, then the
+// interpolated color (the pixel shader just returns it)
+// --------------------------------------------------------
+void SoftwareBackend::RasterizeTile(unsigned int pTile)
+{
+	const std::vector<unsigned int>& binned = tileTriangles[pTile];
+	if (binned.empty())
+		return;
+
+	int tileMinX = (int)(pTile % tilesX) * TileSize;
+	int tileMinY = (int)(pTile / tilesX) * TileSize;
+	int tileMaxX = std::min(tileMinX + TileSize, width) - 1;
+	int tileMaxY = std::min(tileMinY + TileSize, height) - 1;
+	size_t pixels = 0;
+
+	for (unsigned int index : binned)
+	{
+		const Triangle& t = triangles[index];
+		int firstX = std::max(t.minX, tileMinX);
+		int minX = firstX & ~3;
+		int maxX = std::min(t.maxX, tileMaxX);
+		int minY = std::max(t.minY, tileMinY);
+		int maxY = std::min(t.maxY, tileMaxY);
+
+		// Edge i runs from vertex i to i + 1, and weights the vertex opposite it
+		float edgeA[3];
+		float edgeB[3];
+		for (int i = 0; i < 3; i++)
+		{
+			edgeA[i] = t.y[i] - t.y[(i + 1) % 3];
+			edgeB[i] = t.x[(i + 1) % 3] - t.x[i];
+		}
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			float py = y + 0.5f;
+			float row[3];
+			for (int i = 0; i < 3; i++)
+				row[i] = edgeB[i] * (py - t.y[i]);
+			unsigned int* colorRow = &color[(size_t)y * stride];
+			float* depthRow = &depth[(size_t)y * stride];
+
+#ifdef SOFTWARE_USE_SSE2
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 pixelOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			const __m128 firstCenter = _mm_set1_ps(firstX + 0.5f);
+			const __m128 lastCenter = _mm_set1_ps(maxX + 0.5f);
+			for (int x = minX; x <= maxX; x += 4)
+			{
+				__m128 px = _mm_add_ps(_mm_set1_ps((float)x), pixelOffsets);
+				__m128 e[3];
+				// Lanes outside the triangle's (viewport clamped) bounds are
+				// masked off, which also keeps them out of the row padding
+				__m128 inside = _mm_and_ps(_mm_cmpge_ps(px, firstCenter), _mm_cmple_ps(px, lastCenter));
+				for (int i = 0; i < 3; i++)
+				{
+					e[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[i]), _mm_sub_ps(px, _mm_set1_ps(t.x[i]))), _mm_set1_ps(row[i]));
+					__m128 covered = t.inclusive[i] ? _mm_cmpge_ps(e[i], zero) : _mm_cmpgt_ps(e[i], zero);
+					inside = _mm_and_ps(inside, covered);
+				}
+				if (_mm_movemask_ps(inside) == 0)
+					continue;
+
+				// Edge 1 (v1 -> v2) weights v0, and so on
+				__m128 invArea = _mm_set1_ps(t.invArea);
+				__m128 l0 = _mm_mul_ps(e[1], invArea);
+				__m128 l1 = _mm_mul_ps(e[2], invArea);
+				__m128 l2 = _mm_mul_ps(e[0], invArea);
+
+				__m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(t.z[0])), _mm_mul_ps(l1, _mm_set1_ps(t.z[1]))), _mm_mul_ps(l2, _mm_set1_ps(t.z[2])));
+				__m128 current = _mm_loadu_ps(depthRow + x);
+				__m128 pass = _mm_and_ps(inside, reversedDepth ? _mm_cmpgt_ps(z, current) : _mm_cmplt_ps(z, current));
+				int passMask = _mm_movemask_ps(pass);
+				if (passMask == 0)
+					continue;
+				_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(pass, z), _mm_andnot_ps(pass, current)));
+
+				__m128 invW = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(t.invW[0])), _mm_mul_ps(l1, _mm_set1_ps(t.invW[1]))), _mm_mul_ps(l2, _mm_set1_ps(t.invW[2])));
+				__m128 w = _mm_div_ps(_mm_set1_ps(1.0f), invW);
+				__m128i packed = _mm_setzero_si128();
+				for (int k = 0; k < 4; k++)
+				{
+					__m128 channel = _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(t.color[0][k])), _mm_mul_ps(l1, _mm_set1_ps(t.color[1][k]))), _mm_mul_ps(l2, _mm_set1_ps(t.color[2][k])));
+					channel = _mm_mul_ps(channel, w);
+					channel = _mm_min_ps(_mm_max_ps(channel, zero), _mm_set1_ps(1.0f));
+					__m128i unorm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(channel, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+					packed = _mm_or_si128(packed, _mm_slli_epi32(unorm, k * 8));
+				}
+				__m128i currentColor = _mm_loadu_si128((const __m128i*)(colorRow + x));
+				__m128i passInt = _mm_castps_si128(pass);
+				_mm_storeu_si128((__m128i*)(colorRow + x), _mm_or_si128(_mm_and_si128(passInt, packed), _mm_andnot_si128(passInt, currentColor)));
+
+				for (int lane = 0; lane < 4; lane++)
+					pixels += (passMask >> lane) & 1;
+			}
+#else
+			for (int x = minX; x <= maxX; x += 4)
+			{
+				for (int lane = 0; lane < 4; lane++)
+				{
+					if (x + lane < firstX || x + lane > maxX)
+						continue;
+
+					float px = (float)x + (lane + 0.5f);
+					float e[3];
+					bool inside = true;
+					for (int i = 0; i < 3; i++)
+					{
+						e[i] = edgeA[i] * (px - t.x[i]) + row[i];
+						inside &= t.inclusive[i] ? e[i] >= 0.0f : e[i] > 0.0f;
+					}
+					if (!inside)
+						continue;
+
+					float l0 = e[1] * t.invArea;
+					float l1 = e[2] * t.invArea;
+					float l2 = e[0] * t.invArea;
+
+					float z = (l0 * t.z[0] + l1 * t.z[1]) + l2 * t.z[2];
+					if (reversedDepth ? !(z > depthRow[x + lane]) : !(z < depthRow[x + lane]))
+						continue;
+					depthRow[x + lane] = z;
+
+					float invW = (l0 * t.invW[0] + l1 * t.invW[1]) + l2 * t.invW[2];
+					float w = 1.0f / invW;
+					unsigned int packed = 0;
+					for (int k = 0; k < 4; k++)
+					{
+						float channel = ((l0 * t.color[0][k] + l1 * t.color[1][k]) + l2 * t.color[2][k]) * w;
+						packed |= ToUnorm8(channel) << (k * 8);
+					}
+					colorRow[x + lane] = packed;
+					pixels++;
+				}
+			}
+#endif
+		}
+	}
+
+	tilePixels[pTile] += pixels;
+}
+
+
+// --------------------------------------------------------
+// Writes the color buffer as an 8-bit RGB PNG.  The
+// image data is stored without compression, which keeps
+// the writer small and the output exact.
+// --------------------------------------------------------
+bool SoftwareBackend::SavePNG(const std::string& pPath)
+{
+	// Filter type 0 (none), then RGB, for every row
+	std::vector<unsigned char> raw;
+	raw.reserve((size_t)(width * 3 + 1) * height);
+	for (int y = 0; y < height; y++)
+	{
+		raw.push_back(0);
+		for (int x = 0; x < width; x++)
+		{
+			unsigned int pixel = color[(size_t)y * stride + x];
+			raw.push_back((unsigned char)pixel);
+			raw.push_back((unsigned char)(pixel >> 8));
+			raw.push_back((unsigned char)(pixel >> 16));
+		}
+	}
+
+	// zlib stream of stored deflate blocks (64 KB max each)
+	std::vector<unsigned char> zlib = { 0x78, 0x01 };
+	size_t offset = 0;
+	do
+	{
+		size_t blockSize = std::min<size_t>(raw.size() - offset, 65535);
+		zlib.push_back(offset + blockSize == raw.size() ? 1 : 0);
+		zlib.push_back((unsigned char)blockSize);
+		zlib.push_back((unsigned char)(blockSize >> 8));
+		zlib.push_back((unsigned char)~blockSize);
+		zlib.push_back((unsigned char)(~blockSize >> 8));
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+		offset += blockSize;
+	} while (offset < raw.size());
+
+	unsigned int adlerA = 1;
+	unsigned int adlerB = 0;
+	for (unsigned char byte : raw)
+	{
+		adlerA = (adlerA + byte) % 65521;
+		adlerB = (adlerB + adlerA) % 65521;
+	}
+	AppendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+	std::vector<unsigned char> header;
+	AppendBigEndian(header, (unsigned int)width);
+	AppendBigEndian(header, (unsigned int)height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });	// 8 bits per channel, RGB, no interlacing
+
+	std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	AppendChunk(png, "IHDR", header);
+	AppendChunk(png, "IDAT", zlib);
+	AppendChunk(png, "IEND", {});
+
+	std::ofstream file(pPath, std::ios::binary);
+	if (!file)
+		return false;
+	file.write((const char*)png.data(), png.size());
+	return (bool)file;
+}
+
+void SoftwareBackend::ResetStats()
+{
+	stats = {};
+}
+
+// Getters
+int SoftwareBackend::GetWidth() { return width; }
+int SoftwareBackend::GetHeight() { return height; }
+unsigned int SoftwareBackend::GetPixel(int pX, int pY) { return color[(size_t)pY * stride + pX]; }
+float SoftwareBackend::GetDepth(int pX, int pY) { return depth[(size_t)pY * stride + pX]; }
+SoftwareBackend::Stats SoftwareBackend::GetStats() { return stats; }
+
+bool SoftwareBackend::UsesSIMD()
+{
+#ifdef SOFTWARE_USE_SSE2
+	return true;
+#else
+	return false;
+#endif
+}
+
+// FNV-1a of the visible pixels, for comparing frames
+unsigned int SoftwareBackend::GetImageHash()
+{
+	unsigned int hash = 2166136261u;
+	for (int y = 0; y < height; y++)
+	{
+		const unsigned char* bytes = (const unsigned char*)&color[(size_t)y * stride];
+		for (size_t i = 0; i < (size_t)width * 4; i++)
+			hash = (hash ^ bytes[i]) * 16777619u;
+	}
+	return hash;
+}
+
+// Setters
+void SoftwareBackend::SetMultithreaded(bool pMultithreaded) { multithreaded = pMultithreaded; }
+void SoftwareBackend::SetReversedDepth(bool pReversedDepth) { reversedDepth = pReversedDepth; }
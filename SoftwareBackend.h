@@ -0,0 +1,121 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "RenderCommands.h"
+
+// See SoftwareBackend.cpp for usage details
+
+class SoftwareBackend : public RenderBackend
+{
+public:
+	// Vertex's layout, in plain floats so nothing here needs
+	// DirectXMath
+	struct InputVertex
+	{
+		float position[3];
+		float color[4];
+	};
+
+	// VertexShaderData's layout, read from constant slot 0
+	struct Constants
+	{
+		float viewProjection[4][4];	// Row vectors times this, like XMFLOAT4X4
+	};
+
+	// InstanceData's layout, read from UpdateInstances
+	struct Instance
+	{
+		float world[4][4];
+		float colorTint[4];
+	};
+
+	// Totals since the last ResetStats()
+	struct Stats
+	{
+		unsigned int draws;
+		size_t triangles;			// Submitted by draws
+		size_t rasterizedTriangles;	// Survived clipping and culling
+		size_t pixels;				// Passed the depth test and were written
+	};
+
+	SoftwareBackend(int pWidth, int pHeight);
+	~SoftwareBackend();
+
+	// CPU copies of the geometry that BindMesh ids refer to
+	void RegisterMesh(unsigned int pMesh, const InputVertex* pVertices, size_t pVertexCount, const unsigned int* pIndices, size_t pIndexCount);
+
+	void Execute(const CommandList& pCommands) override;
+	bool SavePNG(const std::string& pPath);
+	void ResetStats();
+
+	// Getters
+	int GetWidth();
+	int GetHeight();
+	unsigned int GetPixel(int pX, int pY);	// RGBA, red in the lowest byte
+	float GetDepth(int pX, int pY);
+	unsigned int GetImageHash();
+	Stats GetStats();
+	static bool UsesSIMD();
+
+	// Setters
+	void SetMultithreaded(bool pMultithreaded);
+	void SetReversedDepth(bool pReversedDepth);	// GREATER instead of LESS
+
+private:
+	// A front facing, snapped screen space triangle.  Attributes
+	// are divided by w for perspective correct interpolation.
+	struct Triangle
+	{
+		float x[3];
+		float y[3];
+		float z[3];
+		float invW[3];
+		float color[3][4];
+		float invArea;
+		bool inclusive[3];	// Top-left edges include pixels exactly on them
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+	};
+
+	struct MeshData
+	{
+		std::vector<InputVertex> vertices;
+		std::vector<unsigned int> indices;
+	};
+
+	void SetViewport(float pX, float pY, float pWidth, float pHeight);
+	void DrawIndexed(unsigned int pIndexCount, unsigned int pStartIndex, int pBaseVertex, unsigned int pInstance);
+	void SetupTriangle(const float* pV0, const float* pV1, const float* pV2);
+	void Flush();
+	void RasterizeTile(unsigned int pTile);
+
+	// Render target, rows are padded to a multiple of 4 pixels
+	int width;
+	int height;
+	int stride;
+	std::vector<unsigned int> color;
+	std::vector<float> depth;
+
+	// Registered meshes and bound state
+	std::vector<MeshData> meshes;
+	unsigned int boundMesh;
+	Constants constants;
+	std::vector<Instance> instances;
+	float viewport[4];	// x, y, width, height
+	int scissor[4];		// Pixels the viewport covers: min x, min y, max x, max y
+
+	// Triangles waiting to be rasterized, binned into tiles
+	int tilesX;
+	int tilesY;
+	std::vector<float> shadedVertices;
+	std::vector<Triangle> triangles;
+	std::vector<std::vector<unsigned int>> tileTriangles;
+	std::vector<size_t> tilePixels;
+
+	bool multithreaded;
+	bool reversedDepth;
+	Stats stats;
+};
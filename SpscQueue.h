@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// --------------- Basic usage -----------------
+//
+// A fixed-capacity, lock-free queue between exactly one
+// producer thread and exactly one consumer thread:
+//
+//   SpscQueue<InputEvent> queue(4096);
+//
+//   // Producer
+//   if (!queue.Push(event)) { /* full, the event is dropped */ }
+//
+//   // Consumer
+//   InputEvent event;
+//   while (queue.Pop(event)) { }
+//
+// Capacity is rounded up to a power of two and every slot
+// is allocated up front, so neither side ever allocates,
+// locks or waits.  The head (consumer) and tail (producer)
+// live on separate cache lines, and each side keeps a
+// copy of the other's index so it only reads the shared
+// one when the queue looks full or empty.
+//
+// Peek() lets the consumer look at the oldest item before
+// deciding to Pop() it; the item stays put until it does.
+// ---------------------------------------------
+
+template<class T>
+class SpscQueue
+{
+public:
+	SpscQueue(unsigned int pCapacity) :
+		head(0),
+		cachedTail(0),
+		tail(0),
+		cachedHead(0)
+	{
+		capacity = 1;
+		while (capacity < pCapacity)
+			capacity *= 2;
+		mask = capacity - 1;
+		items.resize(capacity);
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	// Producer only.  Returns false, without blocking, when full
+	bool Push(const T& pItem)
+	{
+		unsigned int index = tail.load(std::memory_order_relaxed);
+		if (index - cachedHead == capacity)
+		{
+			cachedHead = head.load(std::memory_order_acquire);
+			if (index - cachedHead == capacity)
+				return false;
+		}
+
+		items[index & mask] = pItem;
+		tail.store(index + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only.  The oldest item, or null when empty
+	T* Peek()
+	{
+		unsigned int index = head.load(std::memory_order_relaxed);
+		if (index == cachedTail)
+		{
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (index == cachedTail)
+				return nullptr;
+		}
+		return &items[index & mask];
+	}
+
+	// Consumer only.  Drops the item Peek() returned
+	void Pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	// Consumer only.  Returns false when empty
+	bool Pop(T& pItem)
+	{
+		T* item = Peek();
+		if (!item)
+			return false;
+
+		pItem = std::move(*item);
+		Pop();
+		return true;
+	}
+
+	// Getters
+	unsigned int GetCapacity() const { return capacity; }
+
+	// Only exact on the consumer's thread while the producer is idle
+	unsigned int GetSize() const
+	{
+		return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+	}
+
+private:
+	// Written by the consumer
+	alignas(64) std::atomic<unsigned int> head;
+	unsigned int cachedTail;
+
+	// Written by the producer
+	alignas(64) std::atomic<unsigned int> tail;
+	unsigned int cachedHead;
+
+	alignas(64) unsigned int capacity;
+	unsigned int mask;
+	std::vector<T> items;
+};
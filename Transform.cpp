@@ -2,125 +2,176 @@
 
 using namespace DirectX;	// for overload operators
 
-Transform::Transform() : 
-	position(0, 0, 0),		// This is technically faster
-	rotation(0, 0, 0), 
-	scale(1, 1, 1),
-	matrixDirty(false)
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
 {
-	// Initialize values
-	XMStoreFloat4x4(&worldMatrix, DirectX::XMMatrixIdentity());
-	XMStoreFloat4x4(&worldInverseTransposeMatrix, DirectX::XMMatrixIdentity());
+	const float Zero[3] = { 0, 0, 0 };
+	const float One[3] = { 1, 1, 1 };
+
+	static_assert(sizeof(XMFLOAT3) == 3 * sizeof(float), "The pool copies float arrays straight in");
 }
 
-Transform::Transform(float initialX, float initialY, float initialZ) :
-	position(initialX, initialY, initialZ),
-	rotation(0, 0, 0),
-	scale(1, 1, 1),
-	matrixDirty(false)
+TransformPool::TransformPool(size_t pCount, const float* pPositions, const float* pRotations, const float* pScales) :
+	positions((const XMFLOAT3*)pPositions, (const XMFLOAT3*)pPositions + pCount),
+	rotations((const XMFLOAT3*)pRotations, (const XMFLOAT3*)pRotations + pCount),
+	scales((const XMFLOAT3*)pScales, (const XMFLOAT3*)pScales + pCount),
+	matrixDirty(pCount, 1),
+	worldMatrices(new XMFLOAT4X4[pCount]),
+	worldInverseTransposeMatrices(new XMFLOAT4X4[pCount])
 {
-	// Initialize values
-	XMStoreFloat4x4(&worldMatrix, DirectX::XMMatrixIdentity());
-	XMStoreFloat4x4(&worldInverseTransposeMatrix, DirectX::XMMatrixIdentity());
 }
 
-Transform::~Transform()
+TransformPool::~TransformPool()
 {
 
 }
 
-// Rebuilds the world matrix, meant to 
-// be called in the GetMatrix() method
-void Transform::UpdateWorldMatrix()
+// Rebuilds one transform's matrices, meant to
+// be called in Transform's GetMatrix() methods
+void TransformPool::UpdateWorldMatrix(unsigned int pIndex)
 {
 	// Create separate matrices
-	XMMATRIX positionMat = XMMatrixTranslationFromVector(XMLoadFloat3(&position));
-	XMMATRIX rotationMat = XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&rotation));
-	XMMATRIX scaleMat = XMMatrixScalingFromVector(XMLoadFloat3(&scale));
+	XMMATRIX positionMat = XMMatrixTranslationFromVector(XMLoadFloat3(&positions[pIndex]));
+	XMMATRIX rotationMat = XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&rotations[pIndex]));
+	XMMATRIX scaleMat = XMMatrixScalingFromVector(XMLoadFloat3(&scales[pIndex]));
 
 	// Create world matrix
 	XMMATRIX worldMat = scaleMat * rotationMat * positionMat;
 
 	// Store world matrix to a variable
-	XMStoreFloat4x4(&worldMatrix, worldMat);
-	XMStoreFloat4x4(&worldInverseTransposeMatrix, XMMatrixInverse(0, XMMatrixTranspose(worldMat)));
+	XMStoreFloat4x4(&worldMatrices[pIndex], worldMat);
+	XMStoreFloat4x4(&worldInverseTransposeMatrices[pIndex], XMMatrixInverse(0, XMMatrixTranspose(worldMat)));
+	matrixDirty[pIndex] = 0;
+}
+
+
+Transform::Transform() :
+	Transform(Zero, Zero, One)
+{
+}
+
+Transform::Transform(float initialX, float initialY, float initialZ) :
+	Transform(Zero, Zero, One)
+{
+	pool->positions[index] = XMFLOAT3(initialX, initialY, initialZ);
+}
+
+Transform::Transform(const float pPosition[3], const float pRotation[3], const float pScale[3]) :
+	pool(std::make_shared<TransformPool>(1, pPosition, pRotation, pScale)),
+	index(0)
+{
+}
+
+Transform::Transform(std::shared_ptr<TransformPool> pPool, unsigned int pIndex) :
+	pool(std::move(pPool)),
+	index(pIndex)
+{
+	// The matrices are built when first asked for, so scenes
+	// with lots of entities don't write them all up front
+}
+
+Transform::Transform(const Transform& pOther) :
+	Transform(&pOther.pool->positions[pOther.index].x, &pOther.pool->rotations[pOther.index].x, &pOther.pool->scales[pOther.index].x)
+{
+}
+
+Transform& Transform::operator=(const Transform& pOther)
+{
+	if (this != &pOther)
+		*this = Transform(pOther);
+	return *this;
+}
+
+Transform::~Transform()
+{
+
+}
+
+// Rebuilds the world matrix, meant to 
+// be called in the GetMatrix() method
+void Transform::UpdateWorldMatrix()
+{
+	pool->UpdateWorldMatrix(index);
 }
 
 // Setters
 void Transform::SetPosition(float x, float y, float z)
 {
+	XMFLOAT3& position = pool->positions[index];
 	position.x = x;
 	position.y = y;
 	position.z = z;
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::SetPosition(DirectX::XMFLOAT3 pPosition)
 {
-	position = pPosition;
+	pool->positions[index] = pPosition;
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::SetRotation(float pitch, float yaw, float roll)
 {
+	XMFLOAT3& rotation = pool->rotations[index];
 	rotation.x = pitch;
 	rotation.y = yaw;
 	rotation.z = roll;
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::SetRotation(DirectX::XMFLOAT3 pRotation)
 {
-	rotation = pRotation;
+	pool->rotations[index] = pRotation;
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::SetScale(float x, float y, float z)
 {
+	XMFLOAT3& scale = pool->scales[index];
 	scale.x = x;
 	scale.y = y;
 	scale.z = z;
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::SetScale(DirectX::XMFLOAT3 pScale)
 {
-	scale = pScale;
+	pool->scales[index] = pScale;
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 
 // Getters
 DirectX::XMFLOAT3 Transform::GetPosition()
 {
-	return position;
+	return pool->positions[index];
 }
 DirectX::XMFLOAT3 Transform::GetPitchYawRoll()
 {
-	return rotation;
+	return pool->rotations[index];
 }
 DirectX::XMFLOAT3 Transform::GetScale()
 {
-	return scale;
+	return pool->scales[index];
 }
 DirectX::XMFLOAT4X4 Transform::GetWorldMatrix()
 {
 	// Update matrix if dirty
-	if (matrixDirty)
-	{
+	if (pool->matrixDirty[index])
 		UpdateWorldMatrix();
-
-		matrixDirty = false;
-	}
-	return worldMatrix;
+	return pool->worldMatrices[index];
 }
 DirectX::XMFLOAT4X4 Transform::GetWorldInverseTransposeMatrix()
 {
-	return worldInverseTransposeMatrix;
+	// Update matrix if dirty
+	if (pool->matrixDirty[index])
+		UpdateWorldMatrix();
+	return pool->worldInverseTransposeMatrices[index];
 }
 DirectX::XMFLOAT3 Transform::GetRight()
 {
 	// Load data into math types
+	XMFLOAT3& rotation = pool->rotations[index];
 	XMFLOAT3 rightward(1.0f, 0.0f, 0.0f);
 	XMVECTOR rightVec = XMLoadFloat3(&rightward);
 
@@ -138,6 +189,7 @@ DirectX::XMFLOAT3 Transform::GetRight()
 DirectX::XMFLOAT3 Transform::GetUp()
 {
 	// Load data into math types
+	XMFLOAT3& rotation = pool->rotations[index];
 	XMFLOAT3 upward(0.0f, 1.0f, 0.0f);
 	XMVECTOR upVec = XMLoadFloat3(&upward);
 
@@ -155,6 +207,7 @@ DirectX::XMFLOAT3 Transform::GetUp()
 DirectX::XMFLOAT3 Transform::GetForward()
 {
 	// Load data into math types
+	XMFLOAT3& rotation = pool->rotations[index];
 	XMFLOAT3 forward(0.0f, 0.0f, 1.0f);
 	XMVECTOR forwardVec = XMLoadFloat3(&forward);
 
@@ -180,6 +233,7 @@ void Transform::MoveAbsolute(float x, float y, float z)
 void Transform::MoveAbsolute(DirectX::XMFLOAT3 pOffset)
 {
 	// Load data into math types
+	XMFLOAT3& position = pool->positions[index];
 	XMVECTOR posVec = XMLoadFloat3(&position);
 	XMVECTOR offsetVec = XMLoadFloat3(&pOffset);
 
@@ -189,7 +243,7 @@ void Transform::MoveAbsolute(DirectX::XMFLOAT3 pOffset)
 	// Back to storage type
 	XMStoreFloat3(&position, posVec);
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::MoveRelative(float x, float y, float z)
 {
@@ -200,6 +254,8 @@ void Transform::MoveRelative(float x, float y, float z)
 void Transform::MoveRelative(DirectX::XMFLOAT3 pOffset)
 {
 	// Load data into math types
+	XMFLOAT3& position = pool->positions[index];
+	XMFLOAT3& rotation = pool->rotations[index];
 	XMVECTOR posVec = XMLoadFloat3(&position);
 	XMVECTOR offsetVec = XMLoadFloat3(&pOffset);
 
@@ -212,7 +268,7 @@ void Transform::MoveRelative(DirectX::XMFLOAT3 pOffset)
 	// Back to storage type
 	XMStoreFloat3(&position, posVec);
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::Rotate(float pitch, float yaw, float roll)
 {
@@ -223,6 +279,7 @@ void Transform::Rotate(float pitch, float yaw, float roll)
 void Transform::Rotate(DirectX::XMFLOAT3 pRotation)
 {
 	// Load data into math types
+	XMFLOAT3& rotation = pool->rotations[index];
 	XMVECTOR rotVec = XMLoadFloat3(&rotation);
 	XMVECTOR rotationOffsetVec = XMLoadFloat3(&pRotation);
 
@@ -232,7 +289,7 @@ void Transform::Rotate(DirectX::XMFLOAT3 pRotation)
 	// Back to storage type
 	XMStoreFloat3(&rotation, rotVec);
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
 void Transform::Scale(float pScale)
 {
@@ -249,6 +306,7 @@ void Transform::Scale(float x, float y, float z)
 void Transform::Scale(DirectX::XMFLOAT3 pScale)
 {
 	// Load data into math types
+	XMFLOAT3& scale = pool->scales[index];
 	XMVECTOR scVec = XMLoadFloat3(&scale);
 	XMVECTOR scOffsetVec = XMLoadFloat3(&pScale);
 
@@ -258,5 +316,5 @@ void Transform::Scale(DirectX::XMFLOAT3 pScale)
 	// Back to storage type
 	XMStoreFloat3(&scale, scVec);
 
-	matrixDirty = true;
+	pool->matrixDirty[index] = 1;
 }
\ No newline at end of file
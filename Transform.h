@@ -1,14 +1,51 @@
 #pragma once
 
 #include <DirectXMath.h>
+#include <memory>
+#include <vector>
+
+// --------------------------------------------------------
+// Storage for lots of transforms at once, struct-of-arrays,
+// so a scene's worth is a bulk copy of each array.  Their
+// matrices aren't touched until first asked for
+// --------------------------------------------------------
+class TransformPool
+{
+public:
+	// Three floats per transform in each array
+	TransformPool(size_t pCount, const float* pPositions, const float* pRotations, const float* pScales);
+	~TransformPool();
+
+private:
+	friend class Transform;
+
+	void UpdateWorldMatrix(unsigned int pIndex);
+
+	std::vector<DirectX::XMFLOAT3> positions;
+	std::vector<DirectX::XMFLOAT3> rotations;	// Pitch, yaw, roll
+	std::vector<DirectX::XMFLOAT3> scales;
+	std::vector<unsigned char> matrixDirty;
+
+	// Left uninitialized, so their pages stay untouched until used
+	std::unique_ptr<DirectX::XMFLOAT4X4[]> worldMatrices;
+	std::unique_ptr<DirectX::XMFLOAT4X4[]> worldInverseTransposeMatrices;
+};
 
 class Transform
 {
 public:
 	Transform();
 	Transform(float initialX, float initialY, float initialZ);
+	Transform(const float pPosition[3], const float pRotation[3], const float pScale[3]);
+	Transform(std::shared_ptr<TransformPool> pPool, unsigned int pIndex);
 	~Transform();
 
+	// Copies get their own storage, so they don't move together
+	Transform(const Transform& pOther);
+	Transform& operator=(const Transform& pOther);
+	Transform(Transform&& pOther) = default;
+	Transform& operator=(Transform&& pOther) = default;
+
 	void UpdateWorldMatrix();
 
 	// Setters
@@ -40,11 +77,7 @@ public:
 	void Scale(DirectX::XMFLOAT3 pScale);
 	void Scale(float pScale);
 private:
-	DirectX::XMFLOAT3 position;
-	DirectX::XMFLOAT3 rotation;
-	DirectX::XMFLOAT3 scale;
-
-	bool matrixDirty;
-	DirectX::XMFLOAT4X4 worldMatrix;
-	DirectX::XMFLOAT4X4 worldInverseTransposeMatrix;
-};
\ No newline at end of file
+	// Entities share their scene's pool; anything else has one of its own
+	std::shared_ptr<TransformPool> pool;
+	unsigned int index;
+};
@@ -12,7 +12,16 @@ struct VertexShaderInput
 	//  |    |                |
 	//  v    v                v
 	float3 localPosition	: POSITION;     // XYZ position
+#if !FLAT_TINT
 	float4 color			: COLOR;        // RGBA color
+#endif
+
+	// Per instance, from the frame's instance buffer (InstanceData)
+	float4 worldRow0		: WORLD0;
+	float4 worldRow1		: WORLD1;
+	float4 worldRow2		: WORLD2;
+	float4 worldRow3		: WORLD3;
+	float4 instanceTint		: TINT;
 };
 
 // Struct representing the data we're sending down the pipeline
@@ -32,12 +41,10 @@ struct VertexToPixel
 };
 
 // Constant buffer
+// - Offsets are checked against VertexShaderData (BufferStructs.h) when this loads
 cbuffer ExternalData : register(b0)
 {
-    float4 colorTint;
-    matrix worldMatrix;	// matrix is always 4x4, or you can do float4x4
-    matrix viewMatrix;
-    matrix projectionMatrix;
+    matrix viewProjection;	// matrix is always 4x4, or you can do float4x4
 };
 
 // --------------------------------------------------------
@@ -60,13 +67,22 @@ VertexToPixel main( VertexShaderInput input )
 	// - Each of these components is then automatically divided by the W component, 
 	//   which we're leaving at 1.0 for now (this is more useful when dealing with 
 	//   a perspective projection matrix, which we'll get to in the future).
-    matrix wvp = mul(projectionMatrix, mul(viewMatrix, worldMatrix));
-    output.screenPosition = mul(wvp, float4(input.localPosition, 1.0f));	// Ordered like this because of row/col major differences
+	// - The world matrix arrives as rows, exactly as the CPU stored them, so
+	//   it multiplies on the right; the cbuffer's matrix is packed column
+	//   major, so it multiplies on the left
+	float4x4 world = float4x4(input.worldRow0, input.worldRow1, input.worldRow2, input.worldRow3);
+	float4 worldPosition = mul(float4(input.localPosition, 1.0f), world);
+    output.screenPosition = mul(viewProjection, worldPosition);	// Ordered like this because of row/col major differences
 
 	// Pass the color through 
 	// - The values will be interpolated per-pixel by the rasterizer
 	// - We don't need to alter it here, but we do need to send it to the pixel shader
-	output.color = input.color * colorTint;
+	// - FLAT_TINT variants don't read it at all (so their input layout skips it)
+#if FLAT_TINT
+	output.color = input.instanceTint;
+#else
+	output.color = input.color * input.instanceTint;
+#endif
 
 	// Whatever we return will make its way through the pipeline to the
 	// next programmable stage we're using (the pixel shader for now)
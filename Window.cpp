@@ -2,8 +2,12 @@
 #include "Window.h"
 #include "Graphics.h"
 #include "Input.h"
+#include "WindowEvents.h"
 
+#include <atomic>
+#include <future>
 #include <sstream>
+#include <thread>
 
 // Include ImGui files for input
 #include "ImGui/imgui_impl_win32.h"
@@ -26,19 +30,32 @@ namespace Window
 		bool windowCreated = false;
 		bool consoleCreated = false;
 
-		// Window details
+		// Window details.  The size is the one the swap
+		// chain has, which catches up once a frame
 		std::wstring windowTitle;
 		unsigned int windowWidth = 0;
 		unsigned int windowHeight = 0;
 		bool windowStats = false;
 		HWND windowHandle = 0;
-		bool hasFocus = false;
-		bool isMinimized = false;
+		std::atomic<bool> hasFocus = false;
+		std::atomic<bool> isMinimized = false;
+		std::atomic<bool> quitRequested = false;
 		
 		// Function pointer to call
 		// when the window resizes
 		void (*onResize)() = 0;
 
+		// The thread that owns the window and pumps its
+		// messages, and what it passes along
+		std::thread messageThread;
+		WindowEvents* events = 0;
+		std::vector<WindowMessage> frameMessages;
+		bool trackingMouse = false;		// Message thread only
+
+		// Sent to ourselves to destroy the window from the
+		// thread that owns it
+		const UINT DestroyMessage = WM_APP + 1;
+
 		// Basic FPS tracking
 		float fpsTimeElapsed = 0.0f;
 		__int64 fpsFrameCounter = 0;
@@ -46,6 +63,133 @@ namespace Window
 	}
 }
 
+namespace Window
+{
+	// Annonymous namespace to hold helpers only accessible in this file
+	namespace
+	{
+		// ----------------------------------------------------
+		// Registers the window class and creates the window.
+		// Runs on the message thread, which then owns it
+		// ----------------------------------------------------
+		HRESULT CreateMainWindow(HINSTANCE appInstance)
+		{
+			// Start window creation by filling out the
+			// appropriate window class struct
+			WNDCLASS wndClass = {}; // Zero out the memory
+			wndClass.style = CS_HREDRAW | CS_VREDRAW;	// Redraw on horizontal or vertical movement/adjustment
+			wndClass.lpfnWndProc = ProcessMessage;
+			wndClass.cbClsExtra = 0;
+			wndClass.cbWndExtra = 0;
+			wndClass.hInstance = appInstance;						// Our app's handle
+			wndClass.hIcon = LoadIcon(NULL, IDI_APPLICATION);	// Default icon
+			wndClass.hCursor = LoadCursor(NULL, IDC_ARROW);		// Default arrow cursor
+			wndClass.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
+			wndClass.lpszMenuName = NULL;
+			wndClass.lpszClassName = L"GraphicsWindowClass";
+
+			// Attempt to register the window class we've defined
+			if (!RegisterClass(&wndClass))
+			{
+				// Get the most recent error
+				DWORD error = GetLastError();
+
+				// If the class exists, that's actually fine.  Otherwise,
+				// we can't proceed with the next step.
+				if (error != ERROR_CLASS_ALREADY_EXISTS)
+					return HRESULT_FROM_WIN32(error);
+			}
+
+			// Adjust the width and height so the "client size" matches
+			// the width and height given (the inner-area of the window)
+			RECT clientRect;
+			SetRect(&clientRect, 0, 0, windowWidth, windowHeight);
+			AdjustWindowRect(
+				&clientRect,
+				WS_OVERLAPPEDWINDOW,	// Has a title bar, border, min and max buttons, etc.
+				false);					// No menu bar
+
+			// Center the window to the screen
+			RECT desktopRect;
+			GetClientRect(GetDesktopWindow(), &desktopRect);
+			int centeredX = (desktopRect.right / 2) - (clientRect.right / 2);
+			int centeredY = (desktopRect.bottom / 2) - (clientRect.bottom / 2);
+
+			// Actually ask Windows to create the window itself
+			// using our settings so far.  This will return the
+			// handle of the window, which we'll keep around for later
+			windowHandle = CreateWindow(
+				wndClass.lpszClassName,
+				windowTitle.c_str(),
+				WS_OVERLAPPEDWINDOW,
+				centeredX,
+				centeredY,
+				clientRect.right - clientRect.left,	// Calculated width
+				clientRect.bottom - clientRect.top,	// Calculated height
+				0,			// No parent window
+				0,			// No menu
+				appInstance,// The app's handle
+				0);			// No other windows in our application
+
+			// Ensure the window was created properly
+			if (windowHandle == NULL)
+			{
+				DWORD error = GetLastError();
+				return HRESULT_FROM_WIN32(error);
+			}
+
+			// The window exists but is not visible yet
+			// We need to tell Windows to show it, and how to show it
+			ShowWindow(windowHandle, SW_SHOW);
+			return S_OK;
+		}
+
+
+		// ----------------------------------------------------
+		// The message thread: creates the window, reports how
+		// that went, then pumps its messages until it's
+		// destroyed.  Blocking in GetMessage() (or in a drag
+		// or resize, which runs its own loop) only holds up
+		// this thread, never the game loop
+		// ----------------------------------------------------
+		void RunMessageThread(HINSTANCE appInstance, std::promise<HRESULT> created)
+		{
+			HRESULT result = CreateMainWindow(appInstance);
+			created.set_value(result);
+			if (FAILED(result))
+				return;
+
+			MSG msg = {};
+			while (GetMessage(&msg, NULL, 0, 0) > 0)
+			{
+				TranslateMessage(&msg);
+				DispatchMessage(&msg);
+			}
+		}
+
+
+		// ----------------------------------------------------
+		// Messages ImGui's Win32 handler reads, which are
+		// passed along to the render thread
+		// ----------------------------------------------------
+		bool IsForImGui(UINT message)
+		{
+			return
+				(message >= WM_MOUSEFIRST && message <= WM_MOUSELAST) ||
+				(message >= WM_KEYFIRST && message <= WM_KEYLAST) ||
+				message == WM_NCMOUSEMOVE ||
+				message == WM_MOUSELEAVE ||
+				message == WM_NCMOUSELEAVE ||
+				message == WM_SETFOCUS ||
+				message == WM_KILLFOCUS ||
+				message == WM_INPUTLANGCHANGE ||
+				message == WM_IME_CHAR ||
+				message == WM_SETCURSOR ||
+				message == WM_DEVICECHANGE;
+		}
+	}
+}
+
 // Getters for window-related information
 unsigned int Window::Width() { return windowWidth; }
 unsigned int Window::Height() { return windowHeight; }
@@ -53,6 +197,10 @@ float Window::AspectRatio() { return (float)windowWidth / windowHeight; }
 HWND Window::Handle() { return windowHandle; }
 bool Window::HasFocus() { return hasFocus; }
 bool Window::IsMinimized() { return isMinimized; }
+bool Window::QuitRequested() { return quitRequested; }
+unsigned long long Window::GetResizesReceived() { return events ? events->GetResizesPosted() : 0; }
+unsigned long long Window::GetResizesApplied() { return events ? events->GetResizesTaken() : 0; }
+unsigned long long Window::GetDroppedMessageCount() { return events ? events->GetDroppedCount() : 0; }
 
 // --------------------------------------------------------
 // Creates the actual window for our application
@@ -84,78 +232,83 @@ HRESULT Window::Create(
 	windowStats = statsInTitleBar;
 	onResize = resizeCallback;
 
-	// Start window creation by filling out the
-	// appropriate window class struct
-	WNDCLASS wndClass = {}; // Zero out the memory
-	wndClass.style = CS_HREDRAW | CS_VREDRAW;	// Redraw on horizontal or vertical movement/adjustment
-	wndClass.lpfnWndProc = ProcessMessage;
-	wndClass.cbClsExtra = 0;
-	wndClass.cbWndExtra = 0;
-	wndClass.hInstance = appInstance;						// Our app's handle
-	wndClass.hIcon = LoadIcon(NULL, IDI_APPLICATION);	// Default icon
-	wndClass.hCursor = LoadCursor(NULL, IDC_ARROW);		// Default arrow cursor
-	wndClass.hbrBackground = (HBRUSH)GetStockObject(BLACK_BRUSH);
-	wndClass.lpszMenuName = NULL;
-	wndClass.lpszClassName = L"GraphicsWindowClass";
-
-	// Attempt to register the window class we've defined
-	if (!RegisterClass(&wndClass))
+	// Messages for ImGui, which runs on this thread.  Input
+	// has its own queue
+	events = new WindowEvents(1024);
+	frameMessages.reserve(1024);
+
+	// A window belongs to the thread that creates it, and only
+	// that thread gets its messages, so the message thread
+	// creates it and reports back
+	std::promise<HRESULT> created;
+	std::future<HRESULT> result = created.get_future();
+	messageThread = std::thread(RunMessageThread, appInstance, std::move(created));
+	HRESULT hr = result.get();
+	if (FAILED(hr))
 	{
-		// Get the most recent error
-		DWORD error = GetLastError();
-
-		// If the class exists, that's actually fine.  Otherwise,
-		// we can't proceed with the next step.
-		if (error != ERROR_CLASS_ALREADY_EXISTS)
-			return HRESULT_FROM_WIN32(error);
+		messageThread.join();
+		delete events;
+		events = 0;
+		return hr;
 	}
 
-	// Adjust the width and height so the "client size" matches
-	// the width and height given (the inner-area of the window)
-	RECT clientRect;
-	SetRect(&clientRect, 0, 0, width, height);
-	AdjustWindowRect(
-		&clientRect,
-		WS_OVERLAPPEDWINDOW,	// Has a title bar, border, min and max buttons, etc.
-		false);					// No menu bar
-
-	// Center the window to the screen
-	RECT desktopRect;
-	GetClientRect(GetDesktopWindow(), &desktopRect);
-	int centeredX = (desktopRect.right / 2) - (clientRect.right / 2);
-	int centeredY = (desktopRect.bottom / 2) - (clientRect.bottom / 2);
-
-	// Actually ask Windows to create the window itself
-	// using our settings so far.  This will return the
-	// handle of the window, which we'll keep around for later
-	windowHandle = CreateWindow(
-		wndClass.lpszClassName,
-		windowTitle.c_str(),
-		WS_OVERLAPPEDWINDOW,
-		centeredX,
-		centeredY,
-		clientRect.right - clientRect.left,	// Calculated width
-		clientRect.bottom - clientRect.top,	// Calculated height
-		0,			// No parent window
-		0,			// No menu
-		appInstance,// The app's handle
-		0);			// No other windows in our application
-
-	// Ensure the window was created properly
-	if (windowHandle == NULL)
+	// Share input state (capture, the cursor, key states) with
+	// the message thread, so ImGui can change the cursor and
+	// read modifier keys from here
+	AttachThreadInput(GetCurrentThreadId(), GetThreadId(messageThread.native_handle()), TRUE);
+
+	// Return an "everything is ok" HRESULT value
+	windowCreated = true;
+	return S_OK;
+}
+
+
+// --------------------------------------------------------
+// Catches up with the message thread, on the thread that
+// renders.  Call once a frame, before updating:
+//  - Applies the newest window size, so a drag resizes the
+//    swap chain at most once a frame however many sizes
+//    the window went through
+//  - Hands ImGui the messages it needs, in order
+// --------------------------------------------------------
+void Window::ProcessEvents()
+{
+	unsigned int width = 0;
+	unsigned int height = 0;
+	if (events->TakeResize(width, height) && (width != windowWidth || height != windowHeight))
 	{
-		DWORD error = GetLastError();
-		return HRESULT_FROM_WIN32(error);
+		// Save the new client area dimensions.
+		windowWidth = width;
+		windowHeight = height;
+
+		// Let other systems know
+		Graphics::ResizeBuffers(windowWidth, windowHeight);
+		if (onResize)
+			onResize();
 	}
 
-	// The window exists but is not visible yet
-	// We need to tell Windows to show it, and how to show it
-	windowCreated = true;
-	ShowWindow(windowHandle, SW_SHOW);
+	frameMessages.clear();
+	events->Drain(frameMessages);
+	for (const WindowMessage& message : frameMessages)
+		ImGui_ImplWin32_WndProcHandler(windowHandle, message.message, (WPARAM)message.wParam, (LPARAM)message.lParam);
+}
 
-	// Return an "everything is ok" HRESULT value
-	return S_OK;
 
+// --------------------------------------------------------
+// Destroys the window and waits for the message thread to
+// finish.  Call before Input::ShutDown(), since the thread
+// queues input right up until it stops
+// --------------------------------------------------------
+void Window::ShutDown()
+{
+	if (!windowCreated)
+		return;
+
+	PostMessage(windowHandle, DestroyMessage, 0, 0);
+	messageThread.join();
+	delete events;
+	events = 0;
+	windowCreated = false;
 }
 
 
@@ -261,19 +414,40 @@ void Window::CreateConsoleWindow(int bufferLines, int bufferColumns, int windowL
 // Handles messages that are sent to our window by the
 // operating system.  Ignoring these would cause our program
 // to hang and the OS would think it was unresponsive.
+// This runs on the message thread, so it only queues
+// things and sets flags; anything touching the GPU or UI
+// waits for ProcessEvents() on the render thread.
 // --------------------------------------------------------
 LRESULT Window::ProcessMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
-	// Call ImGui's message handler and return early if necessary
-	if (ImGui_ImplWin32_WndProcHandler(hWnd, uMsg, wParam, lParam))
-		return true;
+	// Stamp and queue keyboard and mouse input for Input::Update()
+	Input::ProcessMessage(uMsg, wParam, lParam);
+
+	// ImGui isn't thread-safe, so its messages go to the
+	// render thread (see ProcessEvents())
+	if (IsForImGui(uMsg))
+	{
+		WindowMessage message = { uMsg, (unsigned long long)wParam, (long long)lParam };
+		events->Post(message);
+	}
 
 	// Check the incoming message and handle any we care about
 	switch (uMsg)
 	{
+		// The close button, Alt-F4 or Window::Quit().  The game
+		// loop finishes its frame, then calls ShutDown()
+	case WM_CLOSE:
+		quitRequested = true;
+		return 0;
+
+		// From ShutDown(), since only this thread can destroy the window
+	case DestroyMessage:
+		DestroyWindow(hWnd);
+		return 0;
+
 		// This is the message that signifies the window closing
 	case WM_DESTROY:
-		PostQuitMessage(0); // Send a quit message to our own program
+		PostQuitMessage(0); // Ends this thread's message loop
 		return 0;
 
 		// Prevent beeping when we "alt-enter" into fullscreen
@@ -286,29 +460,58 @@ LRESULT Window::ProcessMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPara
 		((MINMAXINFO*)lParam)->ptMinTrackSize.y = 200;
 		return 0;
 
-		// Sent when the window size changes
+		// Sent when the window size changes, many times over
+		// while dragging a border.  Only the newest size is
+		// kept, for the render thread to apply once a frame
 	case WM_SIZE:
 		// Don't adjust anything when minimizing,
 		// since we end up with a width/height of zero
 		// and that doesn't play well with the GPU
 		isMinimized = wParam == SIZE_MINIMIZED;
-		if (isMinimized)
-			return 0;
-		
-		// Save the new client area dimensions.
-		windowWidth = LOWORD(lParam);
-		windowHeight = HIWORD(lParam);
-
-		// Let other systems know
-		Graphics::ResizeBuffers(windowWidth, windowHeight);
-		if(onResize)
-			onResize();
-
+		if (!isMinimized)
+			events->PostResize(LOWORD(lParam), HIWORD(lParam));
 		return 0;
 
-		// Has the mouse wheel been scrolled?
+		// Everything's drawn by the render thread, and erasing
+		// here too would flicker while resizing
+	case WM_ERASEBKGND:
+		return 1;
+
+		// Capture, mouse tracking and the cursor only work from
+		// the thread that owns the window, so they're handled
+		// here rather than by ImGui.  Capture keeps button
+		// releases coming when dragging outside the window
+	case WM_LBUTTONDOWN: case WM_RBUTTONDOWN: case WM_MBUTTONDOWN: case WM_XBUTTONDOWN:
+		if (GetCapture() == NULL)
+			SetCapture(hWnd);
+		break;
+
+	case WM_LBUTTONUP: case WM_RBUTTONUP: case WM_MBUTTONUP: case WM_XBUTTONUP:
+		if ((wParam & (MK_LBUTTON | MK_RBUTTON | MK_MBUTTON | MK_XBUTTON1 | MK_XBUTTON2)) == 0 && GetCapture() == hWnd)
+			ReleaseCapture();
+		break;
+
+	case WM_MOUSEMOVE:
+		if (!trackingMouse)
+		{
+			TRACKMOUSEEVENT track = { sizeof(TRACKMOUSEEVENT), TME_LEAVE, hWnd, 0 };
+			trackingMouse = TrackMouseEvent(&track) != 0;
+		}
+		break;
+
+	case WM_MOUSELEAVE:
+		trackingMouse = false;
+		break;
+
+		// ImGui sets the cursor once it sees this, so don't
+		// let the class cursor replace it in the client area
+	case WM_SETCURSOR:
+		if (LOWORD(lParam) == HTCLIENT)
+			return TRUE;
+		break;
+
+		// Has the mouse wheel been scrolled?  (Already queued above)
 	case WM_MOUSEWHEEL:
-		Input::SetWheelDelta(GET_WHEEL_DELTA_WPARAM(wParam) / (float)WHEEL_DELTA);
 		return 0;
 
 		// Is our focus state changing?
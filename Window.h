@@ -12,6 +12,10 @@ namespace Window
 	HWND Handle();
 	bool HasFocus();
 	bool IsMinimized();
+	bool QuitRequested();		// The window was asked to close
+	unsigned long long GetResizesReceived();
+	unsigned long long GetResizesApplied();
+	unsigned long long GetDroppedMessageCount();
 
 	// Window-related functions
 	HRESULT Create(
@@ -21,13 +25,15 @@ namespace Window
 		std::wstring titleBarText,
 		bool statsInTitleBar,
 		void (*resizeCallback)());
+	void ProcessEvents();
 	void UpdateStats(float totalTime);
 	void Quit();
+	void ShutDown();
 
 	// Helper function for allocating a console window
 	void CreateConsoleWindow(int bufferLines, int bufferColumns, int windowLines, int windowColumns);
 
-	// OS-level message handling
+	// OS-level message handling, on the window's own thread
 	LRESULT ProcessMessage(
 		HWND hWnd,
 		UINT uMsg,
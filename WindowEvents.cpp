@@ -0,0 +1,135 @@
+#include "WindowEvents.h"
+
+// --------------- Basic usage -----------------
+//
+// Carries window messages from the thread that owns the
+// window to the thread that updates and renders, and
+// keeps just the newest window size:
+//
+//   WindowEvents events(1024);
+//
+//   // In the window procedure
+//   WindowMessage message = { uMsg, wParam, lParam };
+//   events.Post(message);
+//   events.PostResize(width, height);		// On WM_SIZE
+//
+//   // Once per frame, on the render thread
+//   unsigned int width, height;
+//   if (events.TakeResize(width, height)) { }	// Resize the swap chain once
+//   std::vector<WindowMessage> messages;
+//   events.Drain(messages);
+//
+// Messages keep their order and none are merged.  Like
+// InputQueue, it's an SpscQueue underneath, so there's
+// one producer and one consumer, neither ever locks, and
+// messages that don't fit are dropped and counted rather
+// than stalling the window thread.
+//
+// Resizes are different: dragging a window's border sends
+// a size for every step of the drag, and resizing the
+// swap chain for each one would be slow and pointless
+// since only the last matters.  PostResize() just
+// overwrites a single pending size, and TakeResize()
+// hands it over at most once a frame, and only when it
+// differs from the last size taken.  Zero sizes (a
+// minimized window) are never posted.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const unsigned long long PendingBit = 1ull << 63;
+
+	unsigned long long PackSize(unsigned int width, unsigned int height)
+	{
+		return ((unsigned long long)(width & 0x7FFFFFFF) << 32) | height;
+	}
+}
+
+
+WindowEvents::WindowEvents(unsigned int pCapacity) :
+	messages(pCapacity),
+	pendingSize(0),
+	takenSize(0),
+	posted(0),
+	dropped(0),
+	resizesPosted(0),
+	resizesTaken(0)
+{
+}
+
+
+// --------------------------------------------------------
+// Queues a message.  Returns false, and counts it as
+// dropped, when the queue is full
+// --------------------------------------------------------
+bool WindowEvents::Post(const WindowMessage& pMessage)
+{
+	if (!messages.Push(pMessage))
+	{
+		dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return false;
+	}
+	posted.store(posted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Replaces any size that hasn't been taken yet
+// --------------------------------------------------------
+void WindowEvents::PostResize(unsigned int pWidth, unsigned int pHeight)
+{
+	if (pWidth == 0 || pHeight == 0)
+		return;
+
+	pendingSize.store(PendingBit | PackSize(pWidth, pHeight), std::memory_order_release);
+	resizesPosted.store(resizesPosted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+
+// --------------------------------------------------------
+// Appends every queued message, oldest first.  Returns
+// how many were appended
+// --------------------------------------------------------
+size_t WindowEvents::Drain(std::vector<WindowMessage>& pMessages)
+{
+	size_t count = 0;
+	WindowMessage* message = messages.Peek();
+	while (message)
+	{
+		pMessages.push_back(*message);
+		messages.Pop();
+		count++;
+		message = messages.Peek();
+	}
+	return count;
+}
+
+
+// --------------------------------------------------------
+// Gets the newest posted size, if one arrived since the
+// last call and it's not the size already taken
+// --------------------------------------------------------
+bool WindowEvents::TakeResize(unsigned int& pWidth, unsigned int& pHeight)
+{
+	unsigned long long size = pendingSize.exchange(0, std::memory_order_acquire);
+	if (!(size & PendingBit))
+		return false;
+
+	size &= ~PendingBit;
+	if (size == takenSize)
+		return false;
+
+	takenSize = size;
+	pWidth = (unsigned int)(size >> 32);
+	pHeight = (unsigned int)(size & 0xFFFFFFFF);
+	resizesTaken.store(resizesTaken.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return true;
+}
+
+// Getters
+unsigned long long WindowEvents::GetPostedCount() { return posted.load(std::memory_order_relaxed); }
+unsigned long long WindowEvents::GetDroppedCount() { return dropped.load(std::memory_order_relaxed); }
+unsigned long long WindowEvents::GetResizesPosted() { return resizesPosted.load(std::memory_order_relaxed); }
+unsigned long long WindowEvents::GetResizesTaken() { return resizesTaken.load(std::memory_order_relaxed); }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <vector>
+
+// See WindowEvents.cpp for usage details
+
+// A window message passed along as it arrived, in plain
+// integers so nothing here needs Windows.h
+struct WindowMessage
+{
+	unsigned int message;
+	unsigned long long wParam;
+	long long lParam;
+};
+
+class WindowEvents
+{
+public:
+	WindowEvents(unsigned int pCapacity);
+
+	// Window thread
+	bool Post(const WindowMessage& pMessage);
+	void PostResize(unsigned int pWidth, unsigned int pHeight);
+
+	// Consumer thread
+	size_t Drain(std::vector<WindowMessage>& pMessages);
+	bool TakeResize(unsigned int& pWidth, unsigned int& pHeight);
+
+	// Getters
+	unsigned long long GetPostedCount();
+	unsigned long long GetDroppedCount();
+	unsigned long long GetResizesPosted();
+	unsigned long long GetResizesTaken();
+
+private:
+	SpscQueue<WindowMessage> messages;
+
+	// The newest size, width high and height low, with
+	// PendingBit set until it's taken
+	std::atomic<unsigned long long> pendingSize;
+	unsigned long long takenSize;		// Consumer only
+
+	// Only written by the window thread
+	std::atomic<unsigned long long> posted;
+	std::atomic<unsigned long long> dropped;
+	std::atomic<unsigned long long> resizesPosted;
+
+	// Only written by the consumer
+	std::atomic<unsigned long long> resizesTaken;
+};
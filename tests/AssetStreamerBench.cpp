@@ -0,0 +1,94 @@
+#include "BenchHarness.h"
+#include "AssetStreamer.h"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	// Streams every file with a checksumming decode and no
+	// upload budget to speak of, so reading is what's timed
+	unsigned int StreamAll(const std::vector<std::string>& pPaths, bool pUseIORing, const char* pLabel)
+	{
+		std::atomic<unsigned int> checksum(0);
+		AssetStreamer::DecodeFunction decode = [&checksum](AssetStreamer::Buffer& data)
+			{
+				unsigned int sum = 0;
+				for (unsigned char byte : data)
+					sum = sum * 31 + byte;
+				checksum += sum;
+				return true;
+			};
+		size_t uploads = 0;
+		unsigned long long bytes = 0;
+		AssetStreamer::UploadFunction upload = [&](unsigned int, AssetStreamer::Buffer& data, bool) { uploads++; bytes += data.size(); };
+
+		Clock::time_point start = Clock::now();
+		AssetStreamer streamer((size_t)1 << 30, 64 * 1024 * 1024, 1024 * 1024, pUseIORing);
+		const float origin[3] = { 0, 0, 0 };
+		for (const std::string& path : pPaths)
+			streamer.Request(path, origin, decode, upload);
+		while (uploads < pPaths.size())
+			streamer.Update();
+		double seconds = SecondsSince(start);
+
+		std::string label = std::string(pLabel) + ", total";
+		BenchHarness::Report(label.c_str(), seconds * 1000.0, "ms");
+		label = std::string(pLabel) + ", throughput";
+		BenchHarness::Report(label.c_str(), bytes / (1024.0 * 1024.0) / seconds, "MB/s");
+		if (pUseIORing)
+		{
+			AssetStreamer::Stats stats = streamer.GetStats();
+			BenchHarness::ReportCount("io_uring available", stats.ioRing);
+			BenchHarness::ReportCount("Files read past the OS cache", stats.unbufferedReads);
+		}
+		return checksum;
+	}
+}
+
+
+BENCH(StreamThousandsOfFiles)
+{
+	// Mostly small, some big, like real content.  They were just
+	// written, so the ifstream reads come from the OS cache while
+	// O_DIRECT ones go to the device every time.  That's after
+	// writing them back, or the unbuffered reads would wait on it
+	const int AssetCount = 4000;
+	std::error_code error;
+	std::filesystem::path folder = std::filesystem::temp_directory_path(error) / "AssetStreamerBench";
+	std::filesystem::remove_all(folder, error);
+	std::filesystem::create_directories(folder, error);
+
+	std::mt19937 random(44);
+	std::vector<std::string> paths;
+	std::vector<unsigned char> contents;
+	for (int i = 0; i < AssetCount; i++)
+	{
+		contents.resize(i % 16 == 0 ? 256 * 1024 + random() % (768 * 1024) : 1024 + random() % (31 * 1024));
+		for (size_t b = 0; b < contents.size(); b++)
+			contents[b] = (unsigned char)(b * 31 + i);
+		paths.push_back((folder / ("Asset" + std::to_string(i) + ".bin")).string());
+		std::ofstream(paths.back(), std::ios::binary | std::ios::trunc).write((const char*)contents.data(), contents.size());
+	}
+
+#ifndef _WIN32
+	sync();
+#endif
+
+	unsigned int streamChecksum = StreamAll(paths, false, "std::ifstream");
+	unsigned int ringChecksum = StreamAll(paths, true, "io_uring");
+	BenchHarness::ReportCount("Checksums match", streamChecksum == ringChecksum);
+	std::filesystem::remove_all(folder, error);
+}
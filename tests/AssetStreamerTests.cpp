@@ -0,0 +1,234 @@
+#include "TestHarness.h"
+#include "AssetStreamer.h"
+#include "IORing.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Files of random sizes at random spots around the view,
+	// mostly small and some big, like real content
+	struct AssetFiles
+	{
+		std::string folder;
+		std::vector<std::string> paths;
+		std::vector<float> positions;
+		unsigned int checksum;
+		size_t largestBytes;
+		unsigned long long totalBytes;
+
+		AssetFiles(const std::string& pName, int count)
+		{
+			folder = TestHarness::MakeTempFolder(pName);
+			checksum = 0;
+			largestBytes = 0;
+			totalBytes = 0;
+			std::mt19937 random(44);
+			std::vector<unsigned char> contents;
+			for (int i = 0; i < count; i++)
+			{
+				contents.resize(i % 16 == 0 ? 64 * 1024 + random() % (192 * 1024) : 1024 + random() % (15 * 1024));
+				for (size_t b = 0; b < contents.size(); b++)
+					contents[b] = (unsigned char)(b * 31 + i);
+				checksum += Sum(contents);
+				largestBytes = contents.size() > largestBytes ? contents.size() : largestBytes;
+				totalBytes += contents.size();
+
+				paths.push_back(folder + "/Asset" + std::to_string(i) + ".bin");
+				std::ofstream(paths.back(), std::ios::binary | std::ios::trunc).write((const char*)contents.data(), contents.size());
+				for (int c = 0; c < 3; c++)
+					positions.push_back((float)(random() % 20001) / 100.0f - 100.0f);
+			}
+		}
+
+		~AssetFiles()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(folder, error);
+		}
+
+		float Distance(unsigned int asset)
+		{
+			const float* position = &positions[asset * 3];
+			return std::sqrt(position[0] * position[0] + position[1] * position[1] + position[2] * position[2]);
+		}
+
+		template<class Data> static unsigned int Sum(const Data& data)
+		{
+			unsigned int sum = 0;
+			for (unsigned char byte : data)
+				sum = sum * 31 + byte;
+			return sum;
+		}
+	};
+
+	// Pumped like a frame loop until the last one is uploaded.
+	// The chunk size isn't a whole number of sectors, so the
+	// ring has to round it up
+	void StreamWithinBudget(const std::string& pName, bool pUseIORing)
+	{
+		const int AssetCount = 3000;
+		const size_t Budget = 512 * 1024;
+		AssetFiles files(pName, AssetCount);
+
+		// Decoded on the workers, so the checksum is too
+		std::atomic<unsigned int> checksum(0);
+		std::atomic<bool> sectorAligned(true);
+		AssetStreamer::DecodeFunction decode = [&](AssetStreamer::Buffer& data)
+			{
+				checksum += AssetFiles::Sum(data);
+				if ((size_t)data.data() % AssetStreamer::Buffer::allocator_type::SectorSize != 0)
+					sectorAligned = false;
+				return true;
+			};
+
+		int uploads = 0;
+		size_t frameBytes = 0;
+		int frameUploads = 0;
+		bool allSucceeded = true;
+		AssetStreamer::UploadFunction upload = [&](unsigned int, AssetStreamer::Buffer& data, bool succeeded)
+			{
+				allSucceeded = allSucceeded && succeeded;
+				frameBytes += data.size();
+				frameUploads++;
+				uploads++;
+			};
+
+		AssetStreamer streamer(Budget, 64 * 1024 * 1024, 10000, pUseIORing);
+		for (int i = 0; i < AssetCount; i++)
+			streamer.Request(files.paths[i], &files.positions[i * 3], decode, upload);
+
+		// Only a single asset may go over
+		bool budgetRespected = true;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		while (uploads < AssetCount && std::chrono::steady_clock::now() - start < std::chrono::seconds(60))
+		{
+			frameBytes = 0;
+			frameUploads = 0;
+			streamer.Update();
+			budgetRespected = budgetRespected && (frameBytes <= Budget || frameUploads == 1) &&
+				streamer.GetStats().uploadedLastFrame == frameBytes;
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+		}
+		CHECK(uploads == AssetCount);
+		CHECK(allSucceeded);
+		CHECK(budgetRespected);
+		CHECK(checksum == files.checksum);
+		CHECK(sectorAligned);
+
+		AssetStreamer::Stats stats = streamer.GetStats();
+		CHECK(stats.completed == (unsigned int)AssetCount);
+		CHECK(stats.failed == 0);
+		CHECK(stats.bufferedBytes == 0);
+		CHECK(stats.bytesRead == files.totalBytes);
+		CHECK(stats.ioRing == (pUseIORing && IORing(1).IsAvailable()));
+	}
+}
+
+
+TEST(EverythingArrivesWithinBudget)
+{
+	StreamWithinBudget("AssetStreamerBudget", false);
+}
+
+
+TEST(RingReadsArriveWithinBudget)
+{
+	StreamWithinBudget("AssetStreamerRing", true);
+}
+
+
+TEST(NearestAreUploadedFirst)
+{
+	// Everything read and decoded before the first Update(),
+	// so the uploads come strictly nearest first
+	const int AssetCount = 2000;
+	AssetFiles files("AssetStreamerOrder", AssetCount);
+	std::vector<float> distances;
+	AssetStreamer::DecodeFunction decode = [](AssetStreamer::Buffer&) { return true; };
+	AssetStreamer::UploadFunction upload = [&](unsigned int asset, AssetStreamer::Buffer&, bool)
+		{
+			distances.push_back(files.Distance(asset));
+		};
+
+	AssetStreamer streamer(64 * 1024);
+	for (int i = 0; i < AssetCount; i++)
+		streamer.Request(files.paths[i], &files.positions[i * 3], decode, upload);
+	streamer.WaitIdle();
+	while (distances.size() < (size_t)AssetCount)
+		streamer.Update();
+
+	bool nearestFirst = true;
+	for (size_t i = 1; i < distances.size(); i++)
+		nearestFirst = nearestFirst && distances[i - 1] <= distances[i];
+	CHECK(nearestFirst);
+}
+
+
+TEST(ReadingPausesWhenTooMuchWaits)
+{
+	// A small buffer: reading stops until uploads make room,
+	// so at most one file more than the limit is ever held
+	const int AssetCount = 2000;
+	const size_t MaxBuffered = 256 * 1024;
+	AssetFiles files("AssetStreamerBuffered", AssetCount);
+	int uploads = 0;
+	AssetStreamer::DecodeFunction decode = [](AssetStreamer::Buffer&) { return true; };
+	AssetStreamer::UploadFunction upload = [&uploads](unsigned int, AssetStreamer::Buffer&, bool) { uploads++; };
+
+	AssetStreamer streamer(32 * 1024, MaxBuffered);
+	for (int i = 0; i < AssetCount; i++)
+		streamer.Request(files.paths[i], &files.positions[i * 3], decode, upload);
+
+	size_t peakBuffered = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (uploads < AssetCount && std::chrono::steady_clock::now() - start < std::chrono::seconds(30))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		size_t buffered = streamer.GetStats().bufferedBytes;
+		peakBuffered = buffered > peakBuffered ? buffered : peakBuffered;
+		streamer.Update();
+	}
+	CHECK(uploads == AssetCount);
+	CHECK(peakBuffered > 0);
+	CHECK(peakBuffered < MaxBuffered + files.largestBytes);
+}
+
+
+TEST(FailuresStillReachTheUpload)
+{
+	// A missing file, and one its decode turns down
+	AssetFiles files("AssetStreamerFailures", 2);
+	std::vector<bool> results(3, true);
+	std::vector<size_t> sizes(3, 1);
+	AssetStreamer::DecodeFunction accept = [](AssetStreamer::Buffer&) { return true; };
+	AssetStreamer::DecodeFunction reject = [](AssetStreamer::Buffer&) { return false; };
+	AssetStreamer::UploadFunction upload = [&](unsigned int asset, AssetStreamer::Buffer& data, bool succeeded)
+		{
+			results[asset] = succeeded;
+			sizes[asset] = data.size();
+		};
+
+	AssetStreamer streamer(1024 * 1024);
+	const float origin[3] = { 0, 0, 0 };
+	unsigned int missing = streamer.Request(files.folder + "/Missing.bin", origin, accept, upload);
+	unsigned int rejected = streamer.Request(files.paths[0], origin, reject, upload);
+	unsigned int good = streamer.Request(files.paths[1], origin, accept, upload);
+	streamer.WaitIdle();
+	streamer.Update();
+
+	CHECK(!results[missing] && sizes[missing] == 0);
+	CHECK(!results[rejected] && sizes[rejected] == 0);
+	CHECK(results[good] && sizes[good] > 0);
+	CHECK(streamer.GetStats().failed == 2);
+	CHECK(streamer.GetStats().completed == 1);
+}
@@ -0,0 +1,95 @@
+#include "BenchHarness.h"
+#include "JobSystem.h"
+
+#include <cstdio>
+#include <vector>
+
+// --------------- Basic usage -----------------
+//
+// Benchmarks build like the tests, one executable per
+// file linked with this file (which has main()), and are
+// registered with ctest under the "bench" label.  BENCH()
+// defines a case and Report() prints a number from it:
+//
+//   BENCH(RadixSort)
+//   {
+//       BenchHarness::Clock::time_point start = BenchHarness::Clock::now();
+//       queue.Sort();
+//       BenchHarness::Report("Sort", BenchHarness::SecondsSince(start) * 1000.0, "ms");
+//   }
+//
+// Every case runs, in the order they appear in the file,
+// with the JobSystem using every core.  Nothing is
+// checked here (the tests do that), so they only fail if
+// they crash.  To see the numbers:
+//
+//   ctest --test-dir build -L bench --verbose
+//
+// and to leave them out of a test run, "-LE bench".
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	struct Bench
+	{
+		const char* name;
+		BenchHarness::BenchFunction function;
+	};
+
+	// Filled in by static initializers, so it can't be a plain global
+	std::vector<Bench>& GetBenches()
+	{
+		static std::vector<Bench> benches;
+		return benches;
+	}
+}
+
+
+// --------------------------------------------------------
+// Adds a case, before main() runs
+// --------------------------------------------------------
+bool BenchHarness::Register(const char* name, BenchFunction function)
+{
+	GetBenches().push_back({ name, function });
+	return true;
+}
+
+
+// --------------------------------------------------------
+// One line per number, lined up under the case's name
+// --------------------------------------------------------
+void BenchHarness::Report(const char* label, double value, const char* unit)
+{
+	std::printf("  %-36s %12.3f %s\n", label, value, unit);
+	std::fflush(stdout);
+}
+
+
+void BenchHarness::ReportCount(const char* label, long long count)
+{
+	std::printf("  %-36s %12lld\n", label, count);
+	std::fflush(stdout);
+}
+
+
+double BenchHarness::SecondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+
+int main()
+{
+	JobSystem::Initialize();
+
+	for (const Bench& bench : GetBenches())
+	{
+		std::printf("%s\n", bench.name);
+		std::fflush(stdout);
+		bench.function();
+	}
+
+	JobSystem::ShutDown();
+	return 0;
+}
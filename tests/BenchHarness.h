@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+
+// See BenchHarness.cpp for usage details
+
+namespace BenchHarness
+{
+	using BenchFunction = void (*)();
+	using Clock = std::chrono::steady_clock;
+
+	// Called by BENCH()
+	bool Register(const char* name, BenchFunction function);
+
+	// Prints one measurement of the current bench
+	void Report(const char* label, double value, const char* unit);
+	void ReportCount(const char* label, long long count);
+
+	// Seconds elapsed since the given start time
+	double SecondsSince(Clock::time_point start);
+}
+
+#define BENCH(name) \
+	static void name(); \
+	static bool name##Registered = BenchHarness::Register(#name, name); \
+	static void name()
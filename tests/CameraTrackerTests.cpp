@@ -0,0 +1,94 @@
+#include "TestHarness.h"
+#include "CameraTracker.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Camera without DirectXMath or Input: Update() takes the
+	// movement that input would have made, and rebuilding the
+	// view just counts, like Camera::UpdateViewMatrix() does
+	struct TrackedCamera
+	{
+		CameraTracker tracker;
+		CameraTracker::Pose pose = { { 0.0f, 0.0f, -5.0f }, { 0.0f, 0.0f, 0.0f } };
+		int viewBuilds = 0;
+
+		TrackedCamera()
+		{
+			UpdateViewMatrix();
+		}
+
+		void UpdateViewMatrix()
+		{
+			viewBuilds++;
+			tracker.MatricesChanged();
+			tracker.ViewUpdated(pose);
+		}
+
+		void Update(float moveX, float turnYaw)
+		{
+			pose.position[0] += moveX;
+			pose.pitchYawRoll[1] += turnYaw;
+			if (tracker.NeedsViewUpdate(pose))
+				UpdateViewMatrix();
+		}
+	};
+}
+
+
+TEST(IdleUpdatesRebuildNothing)
+{
+	TrackedCamera camera;
+	unsigned int updates = camera.tracker.GetViewUpdateCount();
+	unsigned long long version = camera.tracker.GetVersion();
+	CHECK(updates == 1);
+
+	for (int frame = 0; frame < 10000; frame++)
+		camera.Update(0.0f, 0.0f);
+	CHECK(camera.tracker.GetViewUpdateCount() == updates);
+	CHECK(camera.tracker.GetVersion() == version);
+	CHECK(camera.viewBuilds == 1);
+}
+
+
+TEST(OneMoveRebuildsOnce)
+{
+	TrackedCamera camera;
+	unsigned int updates = camera.tracker.GetViewUpdateCount();
+	unsigned long long version = camera.tracker.GetVersion();
+
+	camera.Update(0.5f, 0.0f);
+	for (int frame = 0; frame < 100; frame++)
+		camera.Update(0.0f, 0.0f);
+	CHECK(camera.tracker.GetViewUpdateCount() == updates + 1);
+	CHECK(camera.tracker.GetVersion() == version + 1);
+
+	// Turning counts as moving too
+	camera.Update(0.0f, 0.01f);
+	camera.Update(0.0f, 0.0f);
+	CHECK(camera.tracker.GetViewUpdateCount() == updates + 2);
+}
+
+
+TEST(MarkedDirtyRebuildsInPlace)
+{
+	// As Camera::SetPosition() does, even to where it already is
+	TrackedCamera camera;
+	unsigned int updates = camera.tracker.GetViewUpdateCount();
+	camera.tracker.MarkViewDirty();
+	camera.Update(0.0f, 0.0f);
+	camera.Update(0.0f, 0.0f);
+	CHECK(camera.tracker.GetViewUpdateCount() == updates + 1);
+}
+
+
+TEST(ProjectionChangesOnlyTheVersion)
+{
+	TrackedCamera camera;
+	unsigned int updates = camera.tracker.GetViewUpdateCount();
+	unsigned long long version = camera.tracker.GetVersion();
+	camera.tracker.MatricesChanged();
+	camera.Update(0.0f, 0.0f);
+	CHECK(camera.tracker.GetViewUpdateCount() == updates);
+	CHECK(camera.tracker.GetVersion() == version + 1);
+}
@@ -0,0 +1,226 @@
+#include "TestHarness.h"
+#include "DirtyRanges.h"
+#include "JobSystem.h"
+
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const unsigned int ElementCount = 1 << 20;
+	const unsigned int MergeGap = 32;
+	const unsigned int MaxRanges = 64;
+
+	// A frame's worth of random ranges, up to 64 elements each
+	std::vector<DirtyRanges::Range> MakeAdds(unsigned int count)
+	{
+		std::mt19937 random(1234);
+		std::vector<DirtyRanges::Range> adds(count);
+		for (DirtyRanges::Range& add : adds)
+		{
+			add.count = 1 + random() % 64;
+			add.first = random() % (ElementCount - add.count);
+		}
+		return adds;
+	}
+
+	std::vector<unsigned char> Mark(const std::vector<DirtyRanges::Range>& ranges)
+	{
+		std::vector<unsigned char> marked(ElementCount);
+		for (const DirtyRanges::Range& range : ranges)
+			memset(marked.data() + range.first, 1, range.count);
+		return marked;
+	}
+
+	bool SameRanges(const DirtyRanges& a, const DirtyRanges& b)
+	{
+		const std::vector<DirtyRanges::Range>& rangesA = a.GetRanges();
+		const std::vector<DirtyRanges::Range>& rangesB = b.GetRanges();
+		bool same = rangesA.size() == rangesB.size();
+		for (size_t i = 0; same && i < rangesA.size(); i++)
+			same = rangesA[i].first == rangesB[i].first && rangesA[i].count == rangesB[i].count;
+		return same;
+	}
+}
+
+
+TEST(AddsMergeIntoSortedRanges)
+{
+	DirtyRanges dirty;
+	CHECK(dirty.IsEmpty());
+	dirty.Add(10, 5);
+	dirty.Add(0, 2);
+	dirty.Add(15, 5);	// Touching: joins
+	dirty.Add(12, 2);	// Inside: nothing new
+	dirty.Add(30, 0);	// Empty: ignored
+	CHECK(dirty.GetRanges().size() == 2);
+	CHECK(dirty.GetRanges()[0].first == 0 && dirty.GetRanges()[0].count == 2);
+	CHECK(dirty.GetRanges()[1].first == 10 && dirty.GetRanges()[1].count == 10);
+	CHECK(dirty.GetDirtyCount() == 12);
+
+	// Bridging both
+	dirty.Add(1, 10);
+	CHECK(dirty.GetRanges().size() == 1 && dirty.GetDirtyCount() == 20);
+	dirty.Clear();
+	CHECK(dirty.IsEmpty() && dirty.GetDirtyCount() == 0);
+}
+
+
+TEST(NoGapMatchesABitmap)
+{
+	// A frame's ranges are exactly its runs of marked elements
+	std::vector<DirtyRanges::Range> adds = MakeAdds(1000);
+	std::vector<unsigned char> marked = Mark(adds);
+	DirtyRanges dirty;
+	for (const DirtyRanges::Range& add : adds)
+		dirty.Add(add.first, add.count);
+
+	std::vector<DirtyRanges::Range> runs;
+	for (unsigned int i = 0; i < ElementCount; i++)
+	{
+		if (!marked[i])
+			continue;
+		unsigned int first = i;
+		while (i < ElementCount && marked[i])
+			i++;
+		runs.push_back({ first, i - first });
+	}
+
+	const std::vector<DirtyRanges::Range>& ranges = dirty.GetRanges();
+	bool same = ranges.size() == runs.size();
+	for (size_t i = 0; same && i < runs.size(); i++)
+		same = ranges[i].first == runs[i].first && ranges[i].count == runs[i].count;
+	CHECK(same);
+}
+
+
+TEST(GapsAndLimitsCoverEverything)
+{
+	// Nothing marked is left out, whatever's left between
+	// ranges is wider than the gap, and there are never more
+	// ranges than the limit
+	std::vector<DirtyRanges::Range> adds = MakeAdds(1000);
+	std::vector<unsigned char> marked = Mark(adds);
+	DirtyRanges gapped(MergeGap);
+	DirtyRanges limited(MergeGap, MaxRanges);
+	for (const DirtyRanges::Range& add : adds)
+	{
+		gapped.Add(add.first, add.count);
+		limited.Add(add.first, add.count);
+	}
+	CHECK(limited.GetRanges().size() <= MaxRanges);
+	CHECK(gapped.GetRanges().size() > MaxRanges);
+
+	for (const DirtyRanges* dirty : { &gapped, &limited })
+	{
+		const std::vector<DirtyRanges::Range>& ranges = dirty->GetRanges();
+		bool valid = true;
+		for (size_t i = 1; i < ranges.size(); i++)
+			valid = valid && ranges[i].first > ranges[i - 1].first + ranges[i - 1].count + MergeGap;
+		std::vector<unsigned char> covered = Mark(ranges);
+		for (unsigned int i = 0; i < ElementCount; i++)
+			valid = valid && (covered[i] || !marked[i]);
+		CHECK(valid);
+	}
+}
+
+
+TEST(ParallelAddsMatchSerial)
+{
+	// Jobs marking the same frame in pieces, behind one lock
+	std::vector<DirtyRanges::Range> adds = MakeAdds(1000);
+	DirtyRanges serial(MergeGap);
+	for (const DirtyRanges::Range& add : adds)
+		serial.Add(add.first, add.count);
+
+	DirtyRanges shared(MergeGap);
+	std::mutex sharedLock;
+	const unsigned int pieceCount = 16;
+	JobSystem::ParallelFor(pieceCount, [&](unsigned int piece)
+		{
+			for (size_t i = piece; i < adds.size(); i += pieceCount)
+			{
+				std::lock_guard<std::mutex> lock(sharedLock);
+				shared.Add(adds[i].first, adds[i].count);
+			}
+		});
+	CHECK(SameRanges(shared, serial));
+
+	// Or each on its own, added together after
+	std::vector<DirtyRanges> pieces(pieceCount, DirtyRanges(MergeGap));
+	JobSystem::ParallelFor(pieceCount, [&](unsigned int piece)
+		{
+			for (size_t i = piece; i < adds.size(); i += pieceCount)
+				pieces[piece].Add(adds[i].first, adds[i].count);
+		});
+	DirtyRanges combined(MergeGap);
+	for (const DirtyRanges& piece : pieces)
+		combined.Add(piece);
+	CHECK(SameRanges(combined, serial));
+}
+
+
+TEST(CopyPerFrameUploadsStayInSync)
+{
+	// The bookkeeping DynamicMesh::Upload() does, with the GPU
+	// buffer's copies as plain arrays: a band of 24 rows moves
+	// a row a frame across a 256x256 grid
+	const unsigned int GridSize = 256;
+	const unsigned int BandRows = 24;
+	const unsigned int FrameCount = 600;
+	const unsigned int CopyCount = 4;
+
+	std::vector<unsigned int> staging(GridSize * GridSize);
+	std::vector<std::vector<unsigned int>> copies(CopyCount, staging);
+	std::vector<DirtyRanges> stale(CopyCount, DirtyRanges(64, 256));
+	unsigned int currentCopy = 0;
+	unsigned long long uploaded = 0;
+	bool copiesMatch = true;
+
+	unsigned int lastFirst = 0;
+	unsigned int lastEnd = 0;
+	for (unsigned int frame = 1; frame <= FrameCount; frame++)
+	{
+		// Write the rows entering and leaving the band
+		unsigned int first = frame % GridSize;
+		unsigned int end = first + BandRows < GridSize ? first + BandRows : GridSize;
+		unsigned int fromRow = first < lastFirst ? first : lastFirst;
+		unsigned int toRow = end > lastEnd ? end : lastEnd;
+		DirtyRanges changed(64, 256);
+		for (unsigned int row = fromRow; row < toRow; row++)
+		{
+			bool inBand = row >= first && row < end;
+			bool wasInBand = row >= lastFirst && row < lastEnd;
+			if (!inBand && !wasInBand)
+				continue;
+			for (unsigned int x = 0; x < GridSize; x++)
+				staging[row * GridSize + x] = inBand ? frame : 0;
+			changed.Add(row * GridSize, GridSize);
+		}
+		lastFirst = first;
+		lastEnd = end;
+
+		if (!changed.IsEmpty())
+		{
+			for (DirtyRanges& copyStale : stale)
+				copyStale.Add(changed);
+			currentCopy = (currentCopy + 1) % CopyCount;
+			for (const DirtyRanges::Range& range : stale[currentCopy].GetRanges())
+			{
+				memcpy(copies[currentCopy].data() + range.first, staging.data() + range.first, sizeof(unsigned int) * range.count);
+				uploaded += range.count;
+			}
+			stale[currentCopy].Clear();
+		}
+
+		// What would be drawn this frame
+		copiesMatch = copiesMatch && copies[currentCopy] == staging;
+	}
+	CHECK(copiesMatch);
+
+	// Far less than the whole grid every frame
+	CHECK(uploaded < (unsigned long long)FrameCount * GridSize * GridSize / 4);
+}
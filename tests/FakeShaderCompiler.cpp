@@ -0,0 +1,88 @@
+#include "FakeShaderCompiler.h"
+
+#include <chrono>
+#include <thread>
+
+// --------------- Basic usage -----------------
+//
+// Stands in for D3DShaderCompiler in the shader tests:
+//
+//   std::shared_ptr<ShaderCompiler> compiler = std::make_shared<FakeShaderCompiler>();
+//   ShaderManager manager(compiler, cacheFolder, 0.0);
+//
+// "Compiling" copies the source into the bytecode, after
+// a short sleep, followed by the target and the included
+// text (which stands in for a file the source #includes,
+// so it isn't part of the cache key).  It understands
+// "#if NAME", "#if !NAME", "#else" and "#endif" lines (a
+// define is on unless it's "0"), and fails on "#error".
+// Reflection comes from the "//@ " lines that survive, in
+// ShaderReflection's text format.
+//
+// Set the included text before starting compiles, not
+// while they run; compiles happen on worker threads.
+// ---------------------------------------------
+
+bool FakeShaderCompiler::Compile(const std::string& pSource, const std::string& pSourceName, const ShaderCache::Defines& pDefines,
+	const std::string& pEntryPoint, const std::string& pTarget,
+	std::vector<unsigned char>& pBytecode, std::string& pErrors)
+{
+	std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+	std::string output;
+	std::vector<bool> active = { true };
+	size_t lineStart = 0;
+	while (lineStart < pSource.size())
+	{
+		size_t lineEnd = pSource.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+			lineEnd = pSource.size();
+		std::string line = pSource.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		if (line.rfind("#if ", 0) == 0)
+		{
+			bool negate = line[4] == '!';
+			std::string name = line.substr(negate ? 5 : 4);
+			bool defined = false;
+			for (const std::pair<std::string, std::string>& define : pDefines)
+				defined |= define.first == name && define.second != "0";
+			active.push_back(active.back() && defined != negate);
+		}
+		else if (line == "#else" && active.size() > 1)
+			active.back() = active[active.size() - 2] && !active.back();
+		else if (line == "#endif" && active.size() > 1)
+			active.pop_back();
+		else if (active.back() && line.rfind("#error", 0) == 0)
+		{
+			pErrors = pSourceName + "(1,1): error X1503: #error directive";
+			return false;
+		}
+		else if (active.back())
+			output += line + "\n";
+	}
+
+	pBytecode.assign(output.begin(), output.end());
+	pBytecode.insert(pBytecode.end(), pTarget.begin(), pTarget.end());
+	pBytecode.insert(pBytecode.end(), includedText.begin(), includedText.end());
+	return true;
+}
+
+
+bool FakeShaderCompiler::Reflect(const std::vector<unsigned char>& pBytecode, ShaderReflection& pReflection)
+{
+	std::string code(pBytecode.begin(), pBytecode.end());
+	std::string metadata;
+	for (size_t found = code.find("//@ "); found != std::string::npos; found = code.find("//@ ", found + 1))
+	{
+		size_t lineEnd = code.find('\n', found);
+		metadata += code.substr(found + 4, lineEnd == std::string::npos ? std::string::npos : lineEnd + 1 - (found + 4));
+	}
+	return pReflection.Parse(metadata);
+}
+
+
+std::string FakeShaderCompiler::GetId() { return "Fake compiler 2"; }
+
+// Setters
+void FakeShaderCompiler::SetIncludedText(const std::string& pText) { includedText = pText; }
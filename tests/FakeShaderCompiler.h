@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "ShaderManager.h"
+
+// See FakeShaderCompiler.cpp for usage details
+
+class FakeShaderCompiler : public ShaderCompiler
+{
+public:
+	bool Compile(const std::string& pSource, const std::string& pSourceName, const ShaderCache::Defines& pDefines,
+		const std::string& pEntryPoint, const std::string& pTarget,
+		std::vector<unsigned char>& pBytecode, std::string& pErrors) override;
+	bool Reflect(const std::vector<unsigned char>& pBytecode, ShaderReflection& pReflection) override;
+	std::string GetId() override;
+
+	// Setters
+	void SetIncludedText(const std::string& pText);
+
+private:
+	std::string includedText;
+};
@@ -0,0 +1,149 @@
+#include "TestHarness.h"
+#include "FontBaker.h"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// A context with the default font baked by the FontBaker, as
+	// Game sets it up but with no window or renderer
+	struct HeadlessContext
+	{
+		ImGuiContext* context;
+
+		HeadlessContext(const std::string& cachePath, int syncGlyphsPerFrame)
+		{
+			context = ImGui::CreateContext();
+			ImGuiIO& io = ImGui::GetIO();
+			io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+			io.DisplaySize = ImVec2(1280, 720);
+			io.DeltaTime = 1.0f / 60.0f;
+			io.IniFilename = nullptr;
+			FontBaker::Initialize(io.Fonts, cachePath, syncGlyphsPerFrame);
+			io.Fonts->AddFontDefault();
+			ImGui::NewFrame();
+		}
+
+		~HeadlessContext()
+		{
+			ImGui::Render();
+			FontBaker::ShutDown();
+			ImGui::DestroyContext(context);
+		}
+
+		// Asks for every printable ASCII glyph at a size nothing
+		// has used yet, which is what makes the loader bake them
+		ImFontBaked* LoadGlyphs(float size)
+		{
+			ImFontBaked* baked = ImGui::GetFont()->GetFontBaked(size);
+			for (ImWchar c = 0x21; c < 0x7F; c++)
+				baked->FindGlyph(c);
+			return baked;
+		}
+
+		// Pumps Update() like a frame loop until the workers are done
+		bool WaitForGlyphs()
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			while (FontBaker::GetStats().pendingGlyphs > 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				FontBaker::Update();
+			}
+			return FontBaker::GetStats().pendingGlyphs == 0;
+		}
+	};
+
+	// Whether a glyph's atlas rectangle is still nothing but the
+	// placeholder fill, which a real bitmap never is
+	bool IsPlaceholder(ImFontBaked* baked, ImWchar c)
+	{
+		ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+		ImFontGlyph* glyph = baked->FindGlyph(c);
+		ImTextureRect* r = ImFontAtlasPackGetRect(atlas, glyph->PackId);
+		ImTextureData* texture = atlas->TexData;
+		const unsigned char* first = (const unsigned char*)texture->GetPixelsAt(r->x, r->y);
+		for (int y = 0; y < r->h; y++)
+		{
+			const unsigned char* row = (const unsigned char*)texture->GetPixelsAt(r->x, r->y + y);
+			for (int x = 0; x < r->w * texture->BytesPerPixel; x++)
+				if (row[x] != first[x % texture->BytesPerPixel])
+					return false;
+		}
+		return true;
+	}
+}
+
+
+TEST(UpdateCommitsFinishedGlyphs)
+{
+	// No main thread budget, so every glyph goes to a worker and
+	// shows the placeholder until Update() commits it
+	HeadlessContext imgui("", 0);
+	FontBaker::Stats before = FontBaker::GetStats();
+	ImFontBaked* baked = imgui.LoadGlyphs(31.0f);
+	FontBaker::Stats queued = FontBaker::GetStats();
+	int loaded = queued.pendingGlyphs - before.pendingGlyphs;
+	CHECK(loaded > 0);
+	CHECK(queued.syncGlyphs == before.syncGlyphs);
+
+	CHECK(imgui.WaitForGlyphs());
+	FontBaker::Stats after = FontBaker::GetStats();
+	CHECK(after.asyncGlyphs - before.asyncGlyphs == queued.pendingGlyphs);
+	CHECK(after.cacheEntries >= loaded);
+
+	bool committed = true;
+	for (ImWchar c = 0x21; c < 0x7F; c++)
+		committed = committed && (!baked->FindGlyph(c)->Visible || !IsPlaceholder(baked, c));
+	CHECK(committed);
+}
+
+
+TEST(CacheRoundTrip)
+{
+	// Baked and saved by one run, then copied from the cache by
+	// the next without rasterizing anything.  NewFrame() queues a
+	// few glyphs of its own, so only the ones asked for count
+	std::string folder = TestHarness::MakeTempFolder("FontBakerCache");
+	std::string path = folder + "/FontCache.bin";
+	int baked = 0;
+	{
+		HeadlessContext imgui(path, 0);
+		FontBaker::Stats before = FontBaker::GetStats();
+		imgui.LoadGlyphs(29.0f);
+		baked = FontBaker::GetStats().pendingGlyphs - before.pendingGlyphs;
+		CHECK(baked > 0);
+		CHECK(imgui.WaitForGlyphs());
+		CHECK(FontBaker::GetStats().asyncGlyphs - before.asyncGlyphs >= baked);
+
+		// Saved as soon as the bake finished, not only on shutdown
+		std::error_code error;
+		CHECK(std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) > 0);
+	}
+
+	{
+		HeadlessContext imgui(path, 0);
+		FontBaker::Stats before = FontBaker::GetStats();
+		CHECK(before.cacheEntries > 0);
+		ImFontBaked* glyphs = imgui.LoadGlyphs(29.0f);
+		FontBaker::Stats after = FontBaker::GetStats();
+		CHECK(after.pendingGlyphs == 0);
+		CHECK(after.syncGlyphs == before.syncGlyphs);
+		CHECK(after.cachedGlyphs - before.cachedGlyphs >= baked);
+
+		bool copied = true;
+		for (ImWchar c = 0x21; c < 0x7F; c++)
+			copied = copied && (!glyphs->FindGlyph(c)->Visible || !IsPlaceholder(glyphs, c));
+		CHECK(copied);
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
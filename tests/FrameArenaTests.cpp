@@ -0,0 +1,183 @@
+#include "TestHarness.h"
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+#include "JobSystem.h"
+#include "ParallelRecorder.h"
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Same size as the vertex shader's constant buffer
+	struct FrameConstants
+	{
+		float colorTint[4];
+		float worldViewProjection[16];
+	};
+
+	// A frame's worth of throwaway data: a list of visible draws
+	// grown one at a time, a copy of every draw's constants and
+	// some labels too long for the small string buffer
+	size_t BuildTransientData(int drawCount, FrameArena& arena)
+	{
+		FrameVector<unsigned int> visible{ FrameAllocator<unsigned int>(&arena) };
+		for (int i = 0; i < drawCount; i += 2)
+			visible.push_back((unsigned int)i);
+
+		FrameVector<FrameConstants> constants(visible.size(), FrameConstants(), FrameAllocator<FrameConstants>(&arena));
+		for (size_t i = 0; i < visible.size(); i++)
+			constants[i].colorTint[0] = (float)visible[i];
+
+		size_t labelBytes = 0;
+		for (int i = 0; i < 64; i++)
+		{
+			FrameString label{ FrameAllocator<char>(&arena) };
+			label.append("Transient label for draw ").append(std::to_string(i).c_str());
+			labelBytes += label.size();
+		}
+		return visible.size() + constants.size() + labelBytes;
+	}
+
+	// Sorts a frame of draws with random meshes and depths
+	void BuildFrameQueue(RenderQueue& queue, std::vector<unsigned int>& meshes, int drawCount, int meshCount)
+	{
+		std::mt19937 random(7);
+		queue.Clear();
+		meshes.resize(drawCount);
+		for (int i = 0; i < drawCount; i++)
+		{
+			meshes[i] = random() % meshCount;
+			queue.Push(RenderQueue::MakeKey(0, 0, meshes[i], (float)(1 + random() % 500)), (unsigned int)i, meshes[i]);
+		}
+		queue.Sort();
+	}
+
+	// Records one draw the way Game::RecordDraw() does
+	void RecordFrameDraw(CommandList& commands, const RenderQueue::DrawCall& call, const std::vector<unsigned int>& meshes)
+	{
+		if (call.bindShader)
+			commands.BindShaders(0);
+		if (call.bindMesh)
+			commands.BindMesh(meshes[call.index]);
+
+		FrameConstants constants = {};
+		constants.colorTint[0] = (float)call.index;
+		commands.UpdateConstants(0, &constants, sizeof(constants));
+		commands.Draw(36);
+	}
+}
+
+
+TEST(AllocationsAreAlignedAndSeparate)
+{
+	FrameArena arena(1024, 1);
+	arena.BeginFrame();
+	unsigned char* a = (unsigned char*)arena.Allocate(3, 1);
+	unsigned char* b = (unsigned char*)arena.Allocate(16, 16);
+	unsigned char* c = (unsigned char*)arena.Allocate(64, 64);
+	CHECK((uintptr_t)b % 16 == 0);
+	CHECK((uintptr_t)c % 64 == 0);
+	memset(a, 1, 3);
+	memset(b, 2, 16);
+	memset(c, 3, 64);
+	CHECK(a[2] == 1 && b[0] == 2 && b[15] == 2 && c[0] == 3);
+
+	const char* label = arena.Format("Entity %d", 42);
+	CHECK(strcmp(label, "Entity 42") == 0);
+	CHECK(arena.GetStats().frameBytes >= 3 + 16 + 64 + 10);
+}
+
+
+TEST(LastFrameStaysValid)
+{
+	// Double buffered: one frame's memory survives the next
+	// BeginFrame(), and is reused by the one after
+	FrameArena arena(1024, 1);
+	arena.BeginFrame();
+	const char* first = arena.Format("First frame");
+	arena.BeginFrame();
+	const char* second = arena.Format("Second frame");
+	CHECK(strcmp(first, "First frame") == 0);
+	CHECK(first != second);
+
+	arena.BeginFrame();
+	CHECK(arena.Format("Third frame") == first);
+	CHECK(arena.GetStats().frame == 3);
+}
+
+
+TEST(OverflowGrowsThenSettles)
+{
+	// Too small for a frame at first, then merged into one
+	// block big enough for it
+	FrameArena arena(256, 1);
+	for (int frame = 0; frame < 4; frame++)
+	{
+		arena.BeginFrame();
+		BuildTransientData(2000, arena);
+	}
+	FrameArena::Stats grown = arena.GetStats();
+	CHECK(grown.overflows > 0);
+	CHECK(grown.peakFrameBytes > 256);
+
+	for (int frame = 0; frame < 10; frame++)
+	{
+		arena.BeginFrame();
+		BuildTransientData(2000, arena);
+	}
+	CHECK(arena.GetStats().blockAllocations == grown.blockAllocations);
+	CHECK(arena.GetStats().overflows == grown.overflows);
+}
+
+
+TEST(SteadyFramesDontAllocate)
+{
+	// Whole frames, the way Game::Draw() records them in parallel,
+	// with transient lists and labels on the main thread and the
+	// workers, once the queue and lists have grown.  Any thread
+	// may end up with every chunk, so each gets room for them all
+	const int DrawCount = 20000;
+	FrameArena arena(2 * 1024 * 1024);
+	RenderQueue queue;
+	std::vector<unsigned int> meshes;
+	ParallelRecorder recorder(256);
+	CommandList frameCommands;
+	const float clearColor[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
+	size_t checksum = 0;
+	unsigned long long allocations = 0;
+	unsigned int blockAllocations = 0;
+	for (int frame = 0; frame < 10 + 50; frame++)
+	{
+		if (frame == 10)
+		{
+			allocations = AllocationCounter::GetCount();
+			blockAllocations = arena.GetStats().blockAllocations;
+		}
+
+		arena.BeginFrame();
+		frameCommands.Clear();
+		frameCommands.ClearTargets(clearColor, 1.0f);
+		BuildFrameQueue(queue, meshes, DrawCount, 16);
+		const std::vector<CommandList>& lists = recorder.Record(queue.BuildDrawCalls(),
+			[&meshes](CommandList& commands, const RenderQueue::DrawCall& call) { RecordFrameDraw(commands, call, meshes); });
+		checksum += lists.size();
+
+		JobSystem::ParallelFor((unsigned int)recorder.GetChunks().size(), [&](unsigned int chunk)
+			{
+				FrameVector<unsigned int> indices{ FrameAllocator<unsigned int>(&arena) };
+				for (unsigned int i = 0; i < recorder.GetChunks()[chunk].count; i++)
+					indices.push_back(recorder.GetChunks()[chunk].first + i);
+			});
+		checksum += BuildTransientData(DrawCount, arena);
+		for (int i = 0; i < 64; i++)
+			checksum += arena.Format("Entity %d", i)[0];
+	}
+	CHECK(AllocationCounter::GetCount() == allocations);
+	CHECK(arena.GetStats().blockAllocations == blockAllocations);
+	CHECK(checksum > 0);
+}
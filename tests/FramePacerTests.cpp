@@ -0,0 +1,120 @@
+#include "TestHarness.h"
+#include "FramePacer.h"
+
+#include <random>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const double TargetFps = 144.0;
+	const double TargetMs = 1000.0 / TargetFps;
+
+	// A clock that moves a little on every read, and sleeps
+	// that wake 0.1 to 1.5 ms late, like a default Windows timer
+	struct FakeClock
+	{
+		unsigned long long time = 1000000000;
+		unsigned long long sleepCalls = 0;
+		std::mt19937 random{ 48 };
+
+		FramePacer MakePacer()
+		{
+			return FramePacer(
+				[this]() { return time += 50; },
+				[this](unsigned long long nanoseconds) { time += nanoseconds + 100000 + random() % 1400000; sleepCalls++; });
+		}
+
+		// Between 1 and 5 ms of work
+		void Work() { time += 1000000 + random() % 4000000; }
+	};
+}
+
+
+TEST(AverageIntervalIsTheTarget)
+{
+	const int FrameCount = 10000;
+	FakeClock clock;
+	FramePacer pacer = clock.MakePacer();
+	pacer.SetTargetFps(TargetFps);
+	CHECK(pacer.GetTargetFps() > TargetFps - 0.01 && pacer.GetTargetFps() < TargetFps + 0.01);
+
+	unsigned long long firstStart = 0;
+	double maxLateMs = 0.0;
+	int lateFrames = 0;
+	double sleptMs = 0.0;
+	for (int f = 0; f < FrameCount; f++)
+	{
+		pacer.WaitForNextFrame();
+		if (f == 0)
+			firstStart = clock.time;
+		FramePacer::Stats stats = pacer.GetStats();
+		maxLateMs = stats.lastLateMs > maxLateMs ? stats.lastLateMs : maxLateMs;
+		lateFrames += stats.lastLateMs > 0.001 ? 1 : 0;
+		sleptMs += stats.lastSleepMs;
+		clock.Work();
+	}
+
+	// Within a microsecond on average.  A sleep that wakes later
+	// than the margin allows for makes a frame late, but only
+	// until the margin catches up, and never by more than the
+	// oversleep
+	double averageMs = (clock.time - firstStart) / 1000000.0 / FrameCount;
+	CHECK(averageMs > TargetMs - 0.001 && averageMs < TargetMs + 0.001);
+	CHECK(lateFrames < FrameCount / 100);
+	CHECK(maxLateMs < 1.5);
+	CHECK(pacer.GetStats().missedFrames == 0);
+	CHECK(pacer.GetStats().frames == FrameCount);
+
+	// Most of the wait is asleep, with the margin covering the oversleep
+	CHECK(sleptMs > FrameCount * (TargetMs - 5.0) * 0.5);
+	CHECK(pacer.GetStats().spinMarginMs >= 1.0 && pacer.GetStats().spinMarginMs <= TargetMs);
+}
+
+
+TEST(NoCatchUpBurstAfterAHitch)
+{
+	// Every tenth frame takes 20 ms; the one after still
+	// waits a whole interval
+	FakeClock clock;
+	FramePacer pacer = clock.MakePacer();
+	pacer.SetTargetFps(TargetFps);
+
+	bool noBurst = true;
+	unsigned long long lastStart = 0;
+	bool afterHitch = false;
+	for (int f = 0; f < 1000; f++)
+	{
+		pacer.WaitForNextFrame();
+		if (afterHitch)
+			noBurst = noBurst && (clock.time - lastStart) / 1000000.0 >= TargetMs * 0.99;
+		lastStart = clock.time;
+		afterHitch = f % 10 == 0;
+		if (afterHitch)
+			clock.time += 20000000;
+		else
+			clock.Work();
+	}
+	CHECK(noBurst);
+	CHECK(pacer.GetStats().missedFrames == 100);
+}
+
+
+TEST(NoLimitNeverWaits)
+{
+	FakeClock clock;
+	FramePacer pacer = clock.MakePacer();
+	pacer.SetTargetFps(TargetFps);
+	pacer.WaitForNextFrame();
+	pacer.SetTargetFps(0.0);
+	CHECK(pacer.GetTargetFps() == 0.0);
+
+	unsigned long long sleepCalls = clock.sleepCalls;
+	for (int f = 0; f < 1000; f++)
+	{
+		pacer.WaitForNextFrame();
+		clock.Work();
+	}
+	CHECK(clock.sleepCalls == sleepCalls);
+	CHECK(pacer.GetStats().lastLateMs == 0.0);
+	CHECK(pacer.GetStats().frames == 1001);
+}
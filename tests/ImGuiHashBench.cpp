@@ -0,0 +1,104 @@
+#include "BenchHarness.h"
+
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	const size_t BufferSize = 1 << 20;
+	const int Iterations = 64;
+
+	// Byte-at-a-time CRC32, the loop ImGui used to fall back to
+	// without SSE 4.2
+	struct ReferenceCrc32
+	{
+		unsigned int table[256];
+
+		ReferenceCrc32()
+		{
+#ifdef IMGUI_USE_LEGACY_CRC32_ADLER
+			const unsigned int polynomial = 0xEDB88320;
+#else
+			const unsigned int polynomial = 0x82F63B78;
+#endif
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int crc = i;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+				table[i] = crc;
+			}
+		}
+
+		unsigned int Data(const unsigned char* data, size_t size, unsigned int seed) const
+		{
+			unsigned int crc = ~seed;
+			for (size_t i = 0; i < size; i++)
+				crc = (crc >> 8) ^ table[(crc & 0xFF) ^ data[i]];
+			return ~crc;
+		}
+	};
+
+	std::vector<unsigned char> MakeBuffer()
+	{
+		std::vector<unsigned char> buffer(BufferSize);
+		unsigned int state = 12345;
+		for (unsigned char& byte : buffer)
+		{
+			state = state * 1664525 + 1013904223;
+			byte = (unsigned char)(state >> 24);
+		}
+		return buffer;
+	}
+
+	// Accumulated so the work can't be optimized away
+	volatile ImGuiID sink = 0;
+}
+
+
+BENCH(HashData)
+{
+	std::vector<unsigned char> buffer = MakeBuffer();
+	double megabytes = (double)BufferSize * Iterations / (1024.0 * 1024.0);
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < Iterations; i++)
+		sink = sink + ImHashData(buffer.data(), buffer.size(), i);
+	BenchHarness::Report("ImHashData", megabytes / SecondsSince(start), "MB/s");
+
+	ReferenceCrc32 reference;
+	start = Clock::now();
+	for (int i = 0; i < Iterations; i++)
+		sink = sink + reference.Data(buffer.data(), buffer.size(), i);
+	BenchHarness::Report("Byte-at-a-time reference", megabytes / SecondsSince(start), "MB/s");
+}
+
+
+BENCH(HashStr)
+{
+	// Labels shaped like the ones the Inspector hashes every frame
+	std::vector<std::string> labels;
+	size_t labelBytes = 0;
+	while (labelBytes < BufferSize)
+	{
+		std::string label = "Position##" + std::to_string(labels.size());
+		if (labels.size() % 8 == 0)
+			label = "Entity " + std::to_string(labels.size()) + "###entity" + std::to_string(labels.size());
+		labelBytes += label.size();
+		labels.push_back(label);
+	}
+
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < Iterations; i++)
+		for (const std::string& label : labels)
+			sink = sink + ImHashStr(label.c_str(), 0, i);
+	BenchHarness::Report("ImHashStr", (double)labelBytes * Iterations / (1024.0 * 1024.0) / SecondsSince(start), "MB/s");
+	BenchHarness::Report("Labels hashed", (double)labels.size() * Iterations / SecondsSince(start) / 1000000.0, "M/s");
+}
@@ -0,0 +1,105 @@
+#include "TestHarness.h"
+
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Byte-at-a-time CRC32 with a table generated at runtime, kept
+	// independent from ImGui's own tables so it can verify them
+	struct ReferenceCrc32
+	{
+		unsigned int table[256];
+
+		ReferenceCrc32()
+		{
+#ifdef IMGUI_USE_LEGACY_CRC32_ADLER
+			const unsigned int polynomial = 0xEDB88320;
+#else
+			const unsigned int polynomial = 0x82F63B78;	// CRC32c, matches SSE 4.2 / ARMv8 instructions
+#endif
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				unsigned int crc = i;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (crc >> 1) ^ ((crc & 1) ? polynomial : 0);
+				table[i] = crc;
+			}
+		}
+
+		unsigned int Data(const unsigned char* data, size_t size, unsigned int seed) const
+		{
+			unsigned int crc = ~seed;
+			for (size_t i = 0; i < size; i++)
+				crc = (crc >> 8) ^ table[(crc & 0xFF) ^ data[i]];
+			return ~crc;
+		}
+
+		// Mirrors ImHashStr(): "###" resets the hash back to the seed
+		unsigned int Str(const char* str, unsigned int seed) const
+		{
+			const char* start = str;
+			while (*str)
+			{
+				if (str[0] == '#' && str[1] == '#' && str[2] == '#')
+				{
+					str += 3;
+					start = str;
+					continue;
+				}
+				str++;
+			}
+			return Data((const unsigned char*)start, str - start, seed);
+		}
+	};
+}
+
+
+TEST(HashDataMatchesTheReference)
+{
+	// Every size the unrolled loops handle, at every alignment,
+	// whichever code path (SSE 4.2, ARMv8 CRC or slicing-by-8
+	// tables) was selected at compile time
+	ReferenceCrc32 reference;
+	std::vector<unsigned char> buffer(4096);
+	unsigned int state = 12345;
+	for (unsigned char& byte : buffer)
+	{
+		state = state * 1664525 + 1013904223;
+		byte = (unsigned char)(state >> 24);
+	}
+
+	bool matches = true;
+	for (size_t size = 0; size < 64; size++)
+		for (size_t offset = 0; offset < 8; offset++)
+			matches = matches && ImHashData(buffer.data() + offset, size, (ImGuiID)size) == reference.Data(buffer.data() + offset, size, (unsigned int)size);
+	CHECK(matches);
+	CHECK(ImHashData(buffer.data(), buffer.size(), 7) == reference.Data(buffer.data(), buffer.size(), 7));
+}
+
+
+TEST(HashStrMatchesTheReference)
+{
+	// Labels shaped like the ones the Inspector hashes every frame,
+	// with and without their length
+	ReferenceCrc32 reference;
+	bool matches = true;
+	for (unsigned int i = 0; i < 1000; i++)
+	{
+		std::string label = "Position##" + std::to_string(i);
+		if (i % 8 == 0)
+			label = "Entity " + std::to_string(i) + "###entity" + std::to_string(i);
+		matches = matches &&
+			ImHashStr(label.c_str(), 0, i) == reference.Str(label.c_str(), i) &&
+			ImHashStr(label.c_str(), label.size(), i) == reference.Str(label.c_str(), i);
+	}
+	CHECK(matches);
+
+	// The ID only depends on what follows "###"
+	CHECK(ImHashStr("Entity 1###entity", 0, 3) == ImHashStr("Entity 2###entity", 0, 3));
+	CHECK(ImHashStr("Position##1", 0, 3) != ImHashStr("Position##2", 0, 3));
+}
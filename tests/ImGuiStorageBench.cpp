@@ -0,0 +1,86 @@
+#include "BenchHarness.h"
+
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	// Incremental sorted insertion is O(N) per key, so past this
+	// it's skipped (it would take minutes) and the sorted lookups
+	// use a bulk BuildSortByKey() instead
+	const int MaxSortedInsertKeys = 20000;
+
+	volatile int sink = 0;
+
+	void Run(int keyCount)
+	{
+		// Keys in random order, like the IDs of tree nodes
+		std::vector<ImGuiID> keys(keyCount);
+		for (int i = 0; i < keyCount; i++)
+			keys[i] = ImHashData(&i, sizeof(i));
+
+		std::string prefix = std::to_string(keyCount) + " keys, ";
+		ImGuiStorage sorted;
+		Clock::time_point start = Clock::now();
+		if (keyCount <= MaxSortedInsertKeys)
+		{
+			for (int i = 0; i < keyCount; i++)
+				sorted.SetInt(keys[i], i);
+			BenchHarness::Report((prefix + "sorted insert").c_str(), SecondsSince(start) * 1000.0, "ms");
+		}
+		else
+		{
+			for (int i = 0; i < keyCount; i++)
+				sorted.Data.push_back(ImGuiStoragePair(keys[i], i));
+			sorted.BuildSortByKey();
+		}
+
+		start = Clock::now();
+		for (int i = 0; i < keyCount; i++)
+			sink = sink + sorted.GetInt(keys[i]);
+		BenchHarness::Report((prefix + "sorted lookup").c_str(), SecondsSince(start) * 1000.0, "ms");
+
+		ImGuiStorage hashed;
+		hashed.SetUseHashIndex(true);
+		start = Clock::now();
+		for (int i = 0; i < keyCount; i++)
+			hashed.SetInt(keys[i], i);
+		BenchHarness::Report((prefix + "hashed insert").c_str(), SecondsSince(start) * 1000.0, "ms");
+
+		start = Clock::now();
+		for (int i = 0; i < keyCount; i++)
+			sink = sink + hashed.GetInt(keys[i]);
+		BenchHarness::Report((prefix + "hashed lookup").c_str(), SecondsSince(start) * 1000.0, "ms");
+	}
+}
+
+
+BENCH(Storage1K)
+{
+	Run(1000);
+}
+
+
+BENCH(Storage10K)
+{
+	Run(10000);
+}
+
+
+BENCH(Storage100K)
+{
+	Run(100000);
+}
+
+
+BENCH(Storage1M)
+{
+	Run(1000000);
+}
@@ -0,0 +1,66 @@
+#include "TestHarness.h"
+
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Keys in random order, like the IDs of tree nodes
+	std::vector<ImGuiID> MakeKeys(int keyCount)
+	{
+		std::vector<ImGuiID> keys(keyCount);
+		for (int i = 0; i < keyCount; i++)
+			keys[i] = ImHashData(&i, sizeof(i));
+		return keys;
+	}
+}
+
+
+TEST(HashIndexAgreesWithSorted)
+{
+	const int KeyCount = 20000;
+	std::vector<ImGuiID> keys = MakeKeys(KeyCount);
+	ImGuiStorage sorted;
+	ImGuiStorage hashed;
+	hashed.SetUseHashIndex(true);
+	for (int i = 0; i < KeyCount; i++)
+	{
+		sorted.SetInt(keys[i], i);
+		hashed.SetInt(keys[i], i);
+	}
+
+	// Including on missing keys
+	bool matches = true;
+	for (int i = 0; i < KeyCount; i++)
+		matches = matches &&
+			sorted.GetInt(keys[i], -1) == i && hashed.GetInt(keys[i], -1) == i &&
+			sorted.GetInt(keys[i] + 1, -1) == hashed.GetInt(keys[i] + 1, -1);
+	CHECK(matches);
+}
+
+
+TEST(HashIndexAfterOverwrites)
+{
+	// Set twice, the second value wins on both
+	const int KeyCount = 5000;
+	std::vector<ImGuiID> keys = MakeKeys(KeyCount);
+	ImGuiStorage sorted;
+	ImGuiStorage hashed;
+	hashed.SetUseHashIndex(true);
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int i = 0; i < KeyCount; i++)
+		{
+			sorted.SetInt(keys[i], i + pass * KeyCount);
+			hashed.SetInt(keys[i], i + pass * KeyCount);
+		}
+	}
+
+	bool matches = true;
+	for (int i = 0; i < KeyCount; i++)
+		matches = matches && sorted.GetInt(keys[i], -1) == i + KeyCount && hashed.GetInt(keys[i], -1) == i + KeyCount;
+	CHECK(matches);
+}
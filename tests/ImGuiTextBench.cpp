@@ -0,0 +1,150 @@
+#include "BenchHarness.h"
+
+#include <cstdio>
+#include <string>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	// A context with the default font and no window, as in
+	// ImGuiTextTests.cpp
+	struct HeadlessContext
+	{
+		ImGuiContext* context;
+
+		HeadlessContext()
+		{
+			context = ImGui::CreateContext();
+			ImGuiIO& io = ImGui::GetIO();
+			io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+			io.DisplaySize = ImVec2(1280, 720);
+			io.DeltaTime = 1.0f / 60.0f;
+			io.IniFilename = nullptr;
+			io.Fonts->AddFontDefault();
+			ImGui::NewFrame();
+		}
+
+		~HeadlessContext()
+		{
+			ImGui::Render();
+			ImGui::DestroyContext(context);
+		}
+	};
+
+	// A 10 MB log, mostly ASCII with a few accented characters
+	std::string MakeLog()
+	{
+		const size_t logBytes = 10 * 1024 * 1024;
+		const char* categories[] = { "Render", "Input", "Assets", "Physics", "Caf\xC3\xA9" };
+		const char* severities[] = { "INFO", "WARN", "ERROR" };
+		std::string log;
+		log.reserve(logBytes + 256);
+		char line[256];
+		for (unsigned int i = 0; log.size() < logBytes; i++)
+		{
+			snprintf(line, sizeof(line), "[%08.3f] [%s] %s: Drew %u entities in %.2f ms (frame %u), camera at (%.1f, %.1f, %.1f)\n",
+				i * 0.016, categories[i % 5], severities[(i / 7) % 3], i % 97, (i % 300) * 0.01, i, (i % 13) * 1.5, (i % 7) * -0.5, (i % 11) * 2.0);
+			log += line;
+		}
+		return log;
+	}
+
+	// Decoding and measuring one codepoint at a time, how
+	// ImFont::CalcTextSizeA() used to work
+	float ReferenceTextWidth(ImFont* font, float size, const char* text, const char* textEnd)
+	{
+		ImFontBaked* baked = font->GetFontBaked(size);
+		const float scale = size / baked->Size;
+		float maxWidth = 0.0f;
+		float lineWidth = 0.0f;
+		while (text < textEnd)
+		{
+			unsigned int c = 0;
+			text += ImTextCharFromUtf8(&c, text, textEnd);
+			if (c == '\n')
+			{
+				maxWidth = ImMax(maxWidth, lineWidth);
+				lineWidth = 0.0f;
+				continue;
+			}
+			if (c == '\r')
+				continue;
+			lineWidth += baked->GetCharAdvance((ImWchar)c) * scale;
+		}
+		return ImMax(maxWidth, lineWidth);
+	}
+
+	volatile float sink = 0.0f;
+}
+
+
+BENCH(MeasureTenMegabyteLog)
+{
+	HeadlessContext imgui;
+	ImFont* font = ImGui::GetFont();
+	const float fontSize = ImGui::GetFontSize();
+	std::string log = MakeLog();
+	const char* text = log.c_str();
+	const char* textEnd = text + log.size();
+
+	// Load the glyphs up front so their rasterization isn't measured
+	ImGui::CalcTextSize(text, text + 4096);
+
+	Clock::time_point start = Clock::now();
+	sink = sink + font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, text, textEnd).x;
+	BenchHarness::Report("CalcTextSizeA", SecondsSince(start) * 1000.0, "ms");
+
+	start = Clock::now();
+	sink = sink + ReferenceTextWidth(font, fontSize, text, textEnd);
+	BenchHarness::Report("One codepoint at a time", SecondsSince(start) * 1000.0, "ms");
+
+	// Every line wrapped at a typical window width
+	start = Clock::now();
+	for (const char* s = text; s < textEnd; )
+		s = ImTextCalcWordWrapNextLineStart(font->CalcWordWrapPosition(fontSize, s, textEnd, 400.0f), textEnd);
+	BenchHarness::Report("CalcWordWrapPosition, whole log", SecondsSince(start) * 1000.0, "ms");
+
+	// The first megabyte, in chunks small enough for 16-bit indices
+	const size_t renderBytes = 1024 * 1024;
+	const size_t chunkBytes = 8 * 1024;
+	ImDrawList drawList(ImGui::GetDrawListSharedData());
+	start = Clock::now();
+	for (size_t offset = 0; offset < renderBytes; offset += chunkBytes)
+	{
+		drawList._ResetForNewFrame();
+		drawList.PushClipRect(ImVec2(0, 0), ImVec2(100000, 100000));
+		drawList.PushTexture(ImGui::GetIO().Fonts->TexRef);
+		drawList.AddText(font, fontSize, ImVec2(0, 0), IM_COL32_WHITE, text + offset, text + offset + chunkBytes);
+	}
+	BenchHarness::Report("RenderText, first megabyte", SecondsSince(start) * 1000.0, "ms");
+}
+
+
+BENCH(LayoutCacheOnTenMegabyteLog)
+{
+	HeadlessContext imgui;
+	ImFont* font = ImGui::GetFont();
+	const float fontSize = ImGui::GetFontSize();
+	std::string log = MakeLog();
+	ImGui::CalcTextSize(log.c_str(), log.c_str() + 4096);
+
+	ImGuiTextLayoutCache layout;
+	Clock::time_point start = Clock::now();
+	layout.Update(log.c_str(), log.c_str() + log.size(), font, fontSize);
+	BenchHarness::Report("Build from scratch", SecondsSince(start) * 1000.0, "ms");
+
+	start = Clock::now();
+	layout.Update(log.c_str(), log.c_str() + log.size(), font, fontSize);
+	BenchHarness::Report("Update, unchanged", SecondsSince(start) * 1000.0, "ms");
+
+	log += "[99999.999] [Render] INFO: One more line\n";
+	start = Clock::now();
+	layout.Update(log.c_str(), log.c_str() + log.size(), font, fontSize);
+	BenchHarness::Report("Update, one line appended", SecondsSince(start) * 1000.0, "ms");
+}
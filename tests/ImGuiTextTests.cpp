@@ -0,0 +1,130 @@
+#include "TestHarness.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// A context with the default font and no window, its
+	// glyphs baked on demand as they would be with a renderer
+	// that updates the font texture
+	struct HeadlessContext
+	{
+		ImGuiContext* context;
+
+		HeadlessContext()
+		{
+			context = ImGui::CreateContext();
+			ImGuiIO& io = ImGui::GetIO();
+			io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+			io.DisplaySize = ImVec2(1280, 720);
+			io.DeltaTime = 1.0f / 60.0f;
+			io.IniFilename = nullptr;
+			io.Fonts->AddFontDefault();
+			ImGui::NewFrame();
+		}
+
+		~HeadlessContext()
+		{
+			ImGui::Render();
+			ImGui::DestroyContext(context);
+		}
+	};
+
+	// A generated log, mostly ASCII with a few accented characters
+	std::string MakeLog(size_t logBytes)
+	{
+		const char* categories[] = { "Render", "Input", "Assets", "Physics", "Caf\xC3\xA9" };
+		const char* severities[] = { "INFO", "WARN", "ERROR" };
+		std::string log;
+		char line[256];
+		for (unsigned int i = 0; log.size() < logBytes; i++)
+		{
+			snprintf(line, sizeof(line), "[%08.3f] [%s] %s: Drew %u entities in %.2f ms (frame %u), camera at (%.1f, %.1f, %.1f)\n",
+				i * 0.016, categories[i % 5], severities[(i / 7) % 3], i % 97, (i % 300) * 0.01, i, (i % 13) * 1.5, (i % 7) * -0.5, (i % 11) * 2.0);
+			log += line;
+		}
+		return log;
+	}
+
+	// Widest line of the text, decoding and measuring one codepoint
+	// at a time (how ImFont::CalcTextSizeA() used to work)
+	float ReferenceTextWidth(ImFont* font, float size, const char* text, const char* textEnd)
+	{
+		ImFontBaked* baked = font->GetFontBaked(size);
+		const float scale = size / baked->Size;
+		float maxWidth = 0.0f;
+		float lineWidth = 0.0f;
+		while (text < textEnd)
+		{
+			unsigned int c = 0;
+			text += ImTextCharFromUtf8(&c, text, textEnd);
+			if (c == '\n')
+			{
+				maxWidth = ImMax(maxWidth, lineWidth);
+				lineWidth = 0.0f;
+				continue;
+			}
+			if (c == '\r')
+				continue;
+			lineWidth += baked->GetCharAdvance((ImWchar)c) * scale;
+		}
+		return ImMax(maxWidth, lineWidth);
+	}
+}
+
+
+TEST(TextSizeMatchesTheReference)
+{
+	HeadlessContext imgui;
+	ImFont* font = ImGui::GetFont();
+	const float fontSize = ImGui::GetFontSize();
+	std::string log = MakeLog(256 * 1024);
+	const char* text = log.c_str();
+	const char* textEnd = text + log.size();
+
+	float width = font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, text, textEnd).x;
+	CHECK(width > 0.0f);
+	CHECK(width == ReferenceTextWidth(font, fontSize, text, textEnd));
+}
+
+
+TEST(LayoutCacheMatchesTheText)
+{
+	HeadlessContext imgui;
+	ImFont* font = ImGui::GetFont();
+	const float fontSize = ImGui::GetFontSize();
+	std::string log = MakeLog(256 * 1024);
+
+	ImGuiTextLayoutCache layout;
+	layout.Update(log.c_str(), log.c_str() + log.size(), font, fontSize);
+	CHECK(layout.MaxLineWidth == font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, log.c_str(), log.c_str() + log.size()).x);
+	int lines = layout.size();
+
+	// Appending a line only adds that line
+	log += "[99999.999] [Render] INFO: One more line, and the widest one by some margin so far, with nothing in it but padding\n";
+	layout.Update(log.c_str(), log.c_str() + log.size(), font, fontSize);
+	CHECK(layout.size() == lines + 1);
+	CHECK(layout.MaxLineWidth == font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, log.c_str(), log.c_str() + log.size()).x);
+}
+
+
+TEST(LatinOneUsesTheFlatIndex)
+{
+	// Accented Latin-1 text is measured from the flat advance
+	// table, as ASCII is, rather than looked up one at a time
+	HeadlessContext imgui;
+	ImFont* font = ImGui::GetFont();
+	const float fontSize = ImGui::GetFontSize();
+	const char* text = "Caf\xC3\xA9 na\xC3\xAFve \xC3\xA0 la cr\xC3\xA8me br\xC3\xBBl\xC3\xA9" "e";
+	const char* textEnd = text + strlen(text);
+
+	float width = font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, text, textEnd).x;
+	CHECK(font->GetFontBaked(fontSize)->IndexAdvanceX.Size >= 0x100);
+	CHECK(width == ReferenceTextWidth(font, fontSize, text, textEnd));
+}
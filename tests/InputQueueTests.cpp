@@ -0,0 +1,148 @@
+#include "TestHarness.h"
+#include "InputQueue.h"
+#include "SpscQueue.h"
+
+#include <thread>
+#include <vector>
+
+TEST(SpscQueueIsFifoAndBounded)
+{
+	SpscQueue<int> queue(5);
+	CHECK(queue.GetCapacity() == 8);
+	CHECK(queue.Peek() == nullptr);
+
+	for (int i = 0; i < 8; i++)
+		CHECK(queue.Push(i));
+	CHECK(!queue.Push(8));
+	CHECK(queue.GetSize() == 8);
+
+	int value = -1;
+	CHECK(queue.Peek() && *queue.Peek() == 0);
+	CHECK(queue.Pop(value) && value == 0);
+	CHECK(queue.Push(8));
+
+	// Wraps around the ring
+	for (int i = 1; i <= 8; i++)
+		CHECK(queue.Pop(value) && value == i);
+	CHECK(!queue.Pop(value));
+	CHECK(queue.GetSize() == 0);
+}
+
+
+TEST(SpscQueueAcrossThreads)
+{
+	const int Count = 200000;
+	SpscQueue<int> queue(256);
+	std::thread producer([&queue]()
+		{
+			for (int i = 0; i < Count; i++)
+			{
+				while (!queue.Push(i))
+					std::this_thread::yield();
+			}
+		});
+
+	int expected = 0;
+	bool inOrder = true;
+	while (expected < Count)
+	{
+		int value;
+		if (!queue.Pop(value))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		inOrder = inOrder && value == expected;
+		expected++;
+	}
+	producer.join();
+	CHECK(inOrder);
+	CHECK(queue.GetSize() == 0);
+}
+
+
+TEST(EventsArriveInOrder)
+{
+	// The producer retries when the queue is full, unlike the
+	// window procedure, so every event gets through.  Each
+	// carries its sequence number in x
+	const int Count = 200000;
+	InputQueue queue(4096);
+	std::thread producer([&queue]()
+		{
+			for (int i = 0; i < Count; i++)
+			{
+				InputEvent event = {};
+				event.type = i % 2 == 0 ? InputEvent::Type::KeyDown : InputEvent::Type::KeyUp;
+				event.key = (unsigned char)(i / 2);
+				event.x = i;
+				event.time = InputQueue::Now();
+				while (!queue.Push(event))
+					std::this_thread::yield();
+			}
+		});
+
+	std::vector<InputEvent> events;
+	int expected = 0;
+	bool inOrder = true;
+	while (expected < Count)
+	{
+		events.clear();
+		unsigned long long now = InputQueue::Now();
+		if (queue.Drain(events, now) == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		for (const InputEvent& event : events)
+			inOrder = inOrder && event.x == expected++ && event.time <= now;
+	}
+	producer.join();
+	CHECK(inOrder);
+	CHECK(queue.GetPushedCount() == (unsigned long long)Count);
+}
+
+
+TEST(FullQueueDropsTheNewest)
+{
+	InputQueue queue(4096);
+	for (unsigned int i = 0; i < queue.GetCapacity() + 100; i++)
+	{
+		InputEvent event = {};
+		event.type = InputEvent::Type::RawMouseMove;
+		event.x = (int)i;
+		event.time = InputQueue::Now();
+		queue.Push(event);
+	}
+	CHECK(queue.GetDroppedCount() == 100);
+	CHECK(queue.GetPushedCount() == queue.GetCapacity());
+
+	std::vector<InputEvent> events;
+	queue.Drain(events, InputQueue::Now());
+	CHECK(events.size() == queue.GetCapacity());
+	bool kept = true;
+	for (size_t i = 0; i < events.size(); i++)
+		kept = kept && events[i].x == (int)i;
+	CHECK(kept);
+}
+
+
+TEST(LaterEventsWaitForTheNextDrain)
+{
+	// A tap within one frame, then something after the cutoff
+	InputQueue queue(16);
+	unsigned long long cutoff = InputQueue::Now();
+	InputEvent down = { InputEvent::Type::KeyDown, 'Q', 0, 0, 0.0f, cutoff - 2 };
+	InputEvent up = { InputEvent::Type::KeyUp, 'Q', 0, 0, 0.0f, cutoff - 1 };
+	InputEvent later = { InputEvent::Type::KeyDown, 'W', 0, 0, 0.0f, cutoff + 1 };
+	queue.Push(down);
+	queue.Push(up);
+	queue.Push(later);
+
+	std::vector<InputEvent> thisFrame;
+	std::vector<InputEvent> nextFrame;
+	CHECK(queue.Drain(thisFrame, cutoff) == 2);
+	CHECK(queue.Drain(nextFrame, cutoff + 1) == 1);
+	CHECK(thisFrame.size() == 2 && thisFrame[0].type == InputEvent::Type::KeyDown && thisFrame[1].type == InputEvent::Type::KeyUp);
+	CHECK(nextFrame.size() == 1 && nextFrame[0].key == 'W');
+}
@@ -0,0 +1,195 @@
+#include "TestHarness.h"
+#include "InputRecording.h"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// A few minutes of 60 fps input: mostly quiet frames, some
+	// with keys, mouse movement or the wheel, and a slightly
+	// uneven frame rate
+	void MakeRecording(InputRecording& recording, int frameCount)
+	{
+		std::mt19937 random(47);
+		auto chance = [&random]() { return (random() % 10000) / 10000.0f; };
+		auto movement = [&random]() { return (int)(random() % 41) - 20; };
+		const unsigned char keys[] = { 'W', 'A', 'S', 'D', ' ', 0x10 };
+		bool down[sizeof(keys)] = {};
+
+		recording.Clear();
+		recording.heldKeys.push_back('W');
+		down[0] = true;
+		recording.startMouseX = 640;
+		recording.startMouseY = 360;
+		int mouseX = recording.startMouseX;
+		int mouseY = recording.startMouseY;
+		float totalTime = 0.0f;
+		std::vector<InputEvent> events;
+		for (int f = 0; f < frameCount; f++)
+		{
+			events.clear();
+			for (size_t k = 0; k < sizeof(keys); k++)
+			{
+				if (chance() < 0.02f)
+				{
+					down[k] = !down[k];
+					events.push_back({ down[k] ? InputEvent::Type::KeyDown : InputEvent::Type::KeyUp, keys[k], 0, 0, 0.0f, 0 });
+				}
+			}
+			if (chance() < 0.3f)
+			{
+				for (int m = 0; m < 8; m++)
+				{
+					int x = movement();
+					int y = movement();
+					events.push_back({ InputEvent::Type::RawMouseMove, 0, x, y, 0.0f, 0 });
+				}
+				mouseX += movement();
+				mouseY += movement();
+			}
+			if (chance() < 0.01f)
+				events.push_back({ InputEvent::Type::MouseWheel, 0, 0, 0, chance() < 0.5f ? -1.0f : 1.0f, 0 });
+
+			float deltaTime = 1.0f / 60.0f + (chance() - 0.5f) * 0.002f;
+			totalTime += deltaTime;
+			recording.AddFrame(deltaTime, totalTime, mouseX, mouseY, events);
+			recording.frames.back().flags = chance() < 0.05f ? InputRecording::MouseCaptured : 0;
+		}
+	}
+
+	// A fly camera that only reads what a recording holds,
+	// like Camera::Update() reading Input
+	struct FlyCamera
+	{
+		float position[3];
+		float yaw;
+		float pitch;
+		float speed;
+	};
+
+	FlyCamera Simulate(const InputRecording& recording)
+	{
+		FlyCamera camera = { { 0.0f, 0.0f, -5.0f }, 0.0f, 0.0f, 5.0f };
+		unsigned char state[256] = {};
+		for (unsigned char key : recording.heldKeys)
+			state[key] = 1;
+
+		for (const InputRecording::Frame& frame : recording.frames)
+		{
+			int rawX = 0;
+			int rawY = 0;
+			for (unsigned int i = frame.firstEvent; i < frame.firstEvent + frame.eventCount; i++)
+			{
+				const InputEvent& event = recording.events[i];
+				if (event.type == InputEvent::Type::KeyDown || event.type == InputEvent::Type::KeyUp)
+					state[event.key] = event.type == InputEvent::Type::KeyDown;
+				else if (event.type == InputEvent::Type::RawMouseMove)
+				{
+					rawX += event.x;
+					rawY += event.y;
+				}
+				else if (event.type == InputEvent::Type::MouseWheel)
+					camera.speed = std::fmax(camera.speed + event.wheel, 1.0f);
+			}
+
+			float step = camera.speed * frame.deltaTime;
+			float forward = (state['W'] ? step : 0.0f) - (state['S'] ? step : 0.0f);
+			float right = (state['D'] ? step : 0.0f) - (state['A'] ? step : 0.0f);
+			camera.position[0] += forward * std::sin(camera.yaw) + right * std::cos(camera.yaw);
+			camera.position[1] += (state[' '] ? step : 0.0f) - (state[0x10] ? step : 0.0f);
+			camera.position[2] += forward * std::cos(camera.yaw) - right * std::sin(camera.yaw);
+			if (!(frame.flags & InputRecording::MouseCaptured))
+			{
+				camera.yaw += rawX * 0.002f;
+				camera.pitch = std::fmin(std::fmax(camera.pitch + rawY * 0.002f, -1.5f), 1.5f);
+			}
+		}
+		return camera;
+	}
+}
+
+
+TEST(SaveAndLoadRoundTrip)
+{
+	std::string folder = TestHarness::MakeTempFolder("InputRecordingTests");
+	std::string path = folder + "/Recording.inp";
+	InputRecording recording;
+	MakeRecording(recording, 20000);
+	CHECK(recording.GetFrameCount() == 20000);
+	CHECK(recording.GetSeconds() > 300.0 && recording.GetSeconds() < 370.0);
+	CHECK(recording.Save(path));
+
+	// Quiet frames take a few bytes
+	std::error_code error;
+	CHECK(std::filesystem::file_size(path, error) < 20000 * 24);
+
+	InputRecording loaded;
+	CHECK(loaded.Load(path));
+	CHECK(loaded.heldKeys == recording.heldKeys);
+	CHECK(loaded.startMouseX == recording.startMouseX && loaded.startMouseY == recording.startMouseY);
+	CHECK(loaded.frames.size() == recording.frames.size());
+	CHECK(loaded.events.size() == recording.events.size());
+
+	bool same = loaded.frames.size() == recording.frames.size() && loaded.events.size() == recording.events.size();
+	for (size_t i = 0; same && i < loaded.frames.size(); i++)
+	{
+		const InputRecording::Frame& a = loaded.frames[i];
+		const InputRecording::Frame& b = recording.frames[i];
+		same = a.deltaTime == b.deltaTime && a.totalTime == b.totalTime && a.mouseX == b.mouseX && a.mouseY == b.mouseY &&
+			a.flags == b.flags && a.firstEvent == b.firstEvent && a.eventCount == b.eventCount;
+	}
+	for (size_t i = 0; same && i < loaded.events.size(); i++)
+	{
+		const InputEvent& a = loaded.events[i];
+		const InputEvent& b = recording.events[i];
+		same = a.type == b.type && a.key == b.key && a.x == b.x && a.y == b.y && a.wheel == b.wheel;
+	}
+	CHECK(same);
+
+	// So a replay ends exactly where the original did
+	FlyCamera original = Simulate(recording);
+	FlyCamera replayed = Simulate(loaded);
+	CHECK(memcmp(&original, &replayed, sizeof(FlyCamera)) == 0);
+
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(DamagedFilesAreRejected)
+{
+	std::string folder = TestHarness::MakeTempFolder("InputRecordingDamaged");
+	std::string path = folder + "/Recording.inp";
+	InputRecording recording;
+	MakeRecording(recording, 1000);
+	CHECK(recording.Save(path));
+
+	std::error_code error;
+	std::vector<char> bytes((size_t)std::filesystem::file_size(path, error));
+	std::ifstream(path, std::ios::binary).read(bytes.data(), bytes.size());
+	auto rejects = [&](const std::vector<char>& contents)
+		{
+			std::string damagedPath = folder + "/Damaged.inp";
+			std::ofstream(damagedPath, std::ios::binary | std::ios::trunc).write(contents.data(), contents.size());
+			InputRecording damaged;
+			return !damaged.Load(damagedPath) && damaged.frames.empty();
+		};
+
+	// Cut short, and a newer version
+	std::vector<char> truncated(bytes.begin(), bytes.begin() + bytes.size() / 2);
+	std::vector<char> newer = bytes;
+	newer[4]++;
+	CHECK(rejects(truncated));
+	CHECK(rejects(newer));
+	CHECK(rejects(std::vector<char>()));
+
+	InputRecording missing;
+	CHECK(!missing.Load(folder + "/Missing.inp"));
+	std::filesystem::remove_all(folder, error);
+}
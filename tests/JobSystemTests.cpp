@@ -0,0 +1,78 @@
+#include "TestHarness.h"
+#include "AllocationCounter.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(EveryPieceRunsOnce)
+{
+	std::vector<std::atomic<unsigned int>> runs(1000);
+	JobSystem::ParallelFor((unsigned int)runs.size(), [&runs](unsigned int piece) { runs[piece]++; });
+	bool once = true;
+	for (std::atomic<unsigned int>& count : runs)
+		once = once && count == 1;
+	CHECK(once);
+
+	// Nothing to do, and a single piece
+	unsigned int calls = 0;
+	JobSystem::ParallelFor(0, [&calls](unsigned int piece) { calls++; });
+	JobSystem::ParallelFor(1, [&calls](unsigned int piece) { calls += piece + 1; });
+	CHECK(calls == 1);
+}
+
+
+TEST(SteadyFramesDontAllocate)
+{
+	// A frame's worth of ParallelFor() calls, some nested, after
+	// a first frame to warm up whatever the workers touch
+	std::atomic<unsigned long long> sum = 0;
+	auto frame = [&sum]()
+		{
+			for (int pass = 0; pass < 8; pass++)
+			{
+				JobSystem::ParallelFor(64, [&sum](unsigned int piece)
+					{
+						JobSystem::ParallelFor(4, [&sum, piece](unsigned int inner) { sum += piece * 4 + inner; });
+					});
+			}
+		};
+	frame();
+	JobSystem::WaitIdle();
+
+	unsigned long long before = AllocationCounter::GetCount();
+	for (int f = 0; f < 100; f++)
+		frame();
+	JobSystem::WaitIdle();
+	CHECK(AllocationCounter::GetCount() == before);
+	CHECK(sum == 101ull * 8 * (256 * 255 / 2));
+}
+
+
+TEST(EveryBatchBusyStillFinishes)
+{
+	// More calls at once than there are batches: the rest run
+	// on their own threads
+	const unsigned int ThreadCount = 80;
+	std::atomic<unsigned int> started = 0;
+	std::atomic<unsigned int> pieces = 0;
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < ThreadCount; t++)
+	{
+		threads.emplace_back([&]()
+			{
+				started++;
+				while (started < ThreadCount)
+					std::this_thread::yield();
+				JobSystem::ParallelFor(16, [&pieces](unsigned int piece)
+					{
+						std::this_thread::yield();
+						pieces++;
+					});
+			});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	CHECK(pieces == ThreadCount * 16);
+}
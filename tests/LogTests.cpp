@@ -0,0 +1,177 @@
+#include "TestHarness.h"
+#include "Log.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	const int RingSize = 8192;
+	const int FilterLinesPerFrame = 250000;
+
+	// Writes until the line is taken, emptying the ring on
+	// this thread when it's full (there's no writer thread)
+	void WriteOrDrain(Log::Severity severity, const char* format, int value)
+	{
+		while (!Log::Write(severity, Log::Category::General, format, value))
+			Log::Update();
+	}
+
+	// "producer 2 line 17" gives 2 and 17
+	bool ParseLine(const std::string& line, int& producer, int& index)
+	{
+		size_t found = line.find("producer ");
+		return found != std::string::npos && sscanf(line.c_str() + found, "producer %d line %d", &producer, &index) == 2;
+	}
+
+	// Every producer's lines, each in the order it wrote them
+	bool EachProducerInOrder(const std::vector<std::string>& lines, int producerCount, int linesPerProducer)
+	{
+		std::vector<int> next(producerCount, 0);
+		for (const std::string& line : lines)
+		{
+			int producer = -1, index = -1;
+			if (!ParseLine(line, producer, index) || producer < 0 || producer >= producerCount || index != next[producer])
+				return false;
+			next[producer]++;
+		}
+		for (int count : next)
+			if (count != linesPerProducer)
+				return false;
+		return true;
+	}
+}
+
+
+TEST(FullRingDropsAndCountsMessages)
+{
+	// No writer thread, so nothing empties the ring until Update()
+	Log::Update();
+	Log::ClearConsole();
+	unsigned long long droppedBefore = Log::GetConsoleStats().droppedMessages;
+
+	const int ProducerCount = 4;
+	const int LinesPerProducer = 4096;
+	std::atomic<int> accepted(0);
+	std::atomic<int> refused(0);
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < ProducerCount; producer++)
+	{
+		producers.emplace_back([producer, &accepted, &refused]()
+			{
+				for (int i = 0; i < LinesPerProducer; i++)
+				{
+					if (Log::Write(Log::Severity::Info, Log::Category::General, "producer %d line %d", producer, i))
+						accepted++;
+					else
+						refused++;
+				}
+			});
+	}
+	for (std::thread& producer : producers)
+		producer.join();
+
+	// Exactly a ring's worth gets in, and every other message is counted
+	CHECK(accepted == RingSize);
+	CHECK(accepted + refused == ProducerCount * LinesPerProducer);
+	CHECK(Log::GetConsoleStats().droppedMessages - droppedBefore == (unsigned long long)refused);
+
+	Log::Update();
+	CHECK(Log::GetConsoleStats().lines == RingSize);
+	CHECK(Log::Write(Log::Severity::Info, Log::Category::General, "room again"));
+	Log::Update();
+}
+
+
+TEST(FilterIndexesASliceEachUpdate)
+{
+	Log::Update();
+	Log::ClearConsole();
+	const int LineCount = FilterLinesPerFrame * 2 + 100000;
+	for (int i = 0; i < LineCount; i++)
+		WriteOrDrain(Log::Severity::Info, i % 7 == 0 ? "needle %d" : "hay %d", i);
+	Log::Update();
+	CHECK(Log::GetConsoleStats().lines == LineCount);
+
+	// Nothing is shown until the first slice has been checked
+	Log::SetConsoleFilter("needle");
+	Log::ConsoleStats stats = Log::GetConsoleStats();
+	CHECK(stats.filterScanned == 0 && stats.shownLines == 0);
+
+	int expectedScanned[] = { FilterLinesPerFrame, FilterLinesPerFrame * 2, LineCount };
+	for (int scanned : expectedScanned)
+	{
+		Log::Update();
+		stats = Log::GetConsoleStats();
+		CHECK(stats.filterScanned == scanned);
+		CHECK(stats.shownLines == (scanned + 6) / 7);
+	}
+
+	bool matches = true;
+	for (int row = 0; row < stats.shownLines; row++)
+		matches = matches && Log::GetConsoleLine(row) == "needle " + std::to_string(row * 7);
+	CHECK(matches);
+
+	// Lines arriving once the index is complete are checked as they come in
+	WriteOrDrain(Log::Severity::Warning, "needle %d", LineCount);
+	WriteOrDrain(Log::Severity::Warning, "hay %d", LineCount + 1);
+	Log::Update();
+	stats = Log::GetConsoleStats();
+	CHECK(stats.shownLines == (LineCount + 6) / 7 + 1);
+	CHECK(Log::GetConsoleLine(stats.shownLines - 1) == "needle " + std::to_string(LineCount));
+
+	// No filter shows everything again, straight away
+	Log::SetConsoleFilter("");
+	stats = Log::GetConsoleStats();
+	CHECK(stats.shownLines == LineCount + 2 && stats.filterScanned == LineCount + 2);
+	Log::ClearConsole();
+}
+
+
+TEST(ProducersStayInOrder)
+{
+	// Through the writer thread this time, retrying when the ring
+	// is full, into the log file as well as the console
+	Log::Update();
+	Log::ClearConsole();
+	std::string logPath = TestHarness::MakeTempFolder("LogTests") + "/Log.txt";
+	Log::Initialize(logPath);
+
+	const int ProducerCount = 4;
+	const int LinesPerProducer = 2500;
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < ProducerCount; producer++)
+	{
+		producers.emplace_back([producer]()
+			{
+				for (int i = 0; i < LinesPerProducer; i++)
+					while (!Log::Write(Log::Severity::Info, Log::Category::General, "producer %d line %d", producer, i))
+						std::this_thread::yield();
+			});
+	}
+	for (std::thread& producer : producers)
+		producer.join();
+	Log::ShutDown();
+	Log::Update();
+
+	std::vector<std::string> fileLines;
+	std::ifstream file(logPath);
+	for (std::string line; std::getline(file, line); )
+		fileLines.push_back(line);
+	CHECK(EachProducerInOrder(fileLines, ProducerCount, LinesPerProducer));
+
+	// The console gets the lines in the same order as the file
+	std::vector<std::string> consoleLines;
+	for (int row = 0; row < Log::GetConsoleStats().shownLines; row++)
+		consoleLines.push_back(Log::GetConsoleLine(row));
+	CHECK(EachProducerInOrder(consoleLines, ProducerCount, LinesPerProducer));
+	bool sameOrder = consoleLines.size() == fileLines.size();
+	for (size_t i = 0; i < consoleLines.size() && sameOrder; i++)
+		sameOrder = fileLines[i].find(consoleLines[i]) != std::string::npos;
+	CHECK(sameOrder);
+}
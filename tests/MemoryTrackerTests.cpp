@@ -0,0 +1,124 @@
+#include "TestHarness.h"
+#include "AllocationCounter.h"
+#include "JobSystem.h"
+#include "MemoryTracker.h"
+
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Nothing else in these tests uses it
+	const MemoryTracker::Tag TestTag = MemoryTracker::Tag::Assets;
+}
+
+
+TEST(ScopesChargeTheirTag)
+{
+	MemoryTracker::Stats before = MemoryTracker::GetStats(TestTag);
+	std::vector<int>* numbers = nullptr;
+	{
+		MemoryTracker::Scope scope(TestTag);
+		CHECK(MemoryTracker::GetThreadTag() == TestTag);
+		{
+			MemoryTracker::Scope inner(MemoryTracker::Tag::Meshes);
+			CHECK(MemoryTracker::GetThreadTag() == MemoryTracker::Tag::Meshes);
+		}
+		CHECK(MemoryTracker::GetThreadTag() == TestTag);
+		numbers = new std::vector<int>(1000);
+	}
+	CHECK(MemoryTracker::GetThreadTag() == MemoryTracker::Tag::General);
+
+	MemoryTracker::Stats during = MemoryTracker::GetStats(TestTag);
+	CHECK(during.liveAllocations - before.liveAllocations == 2);
+	CHECK(during.liveBytes - before.liveBytes == (long long)(sizeof(std::vector<int>) + 1000 * sizeof(int)));
+	CHECK(during.totalAllocations - before.totalAllocations == 2);
+
+	// Freed outside the scope, still credited back to the tag
+	delete numbers;
+	MemoryTracker::Stats after = MemoryTracker::GetStats(TestTag);
+	CHECK(after.liveBytes == before.liveBytes);
+	CHECK(after.liveAllocations == before.liveAllocations);
+}
+
+
+TEST(TagsTravelWithTheMemory)
+{
+	// Allocated on the workers, both ways, and freed here
+	const unsigned int pieceCount = 64;
+	MemoryTracker::Stats before = MemoryTracker::GetStats(TestTag);
+	std::vector<TrackedVector<unsigned char, TestTag>> buffers(pieceCount);
+	std::vector<std::string> names(pieceCount);
+	JobSystem::ParallelFor(pieceCount, [&](unsigned int piece)
+		{
+			buffers[piece].resize(1024 * (piece + 1));
+			MemoryTracker::Scope scope(TestTag);
+			names[piece].assign(4096, 'a' + piece % 26);
+		});
+
+	long long expectedBytes = 0;
+	for (unsigned int piece = 0; piece < pieceCount; piece++)
+		expectedBytes += 1024 * (piece + 1) + names[piece].capacity() + 1;
+	MemoryTracker::Stats during = MemoryTracker::GetStats(TestTag);
+	CHECK(during.liveBytes - before.liveBytes == expectedBytes);
+	CHECK(during.liveAllocations - before.liveAllocations == 2 * pieceCount);
+
+	buffers.clear();
+	names.clear();
+	CHECK(MemoryTracker::GetStats(TestTag).liveBytes == before.liveBytes);
+}
+
+
+TEST(BudgetWarnsAndClears)
+{
+	MemoryTracker::Stats before = MemoryTracker::GetStats(TestTag);
+	std::vector<unsigned char>* buffer = nullptr;
+	{
+		MemoryTracker::Scope scope(TestTag);
+		buffer = new std::vector<unsigned char>(1024 * 1024);
+	}
+
+	MemoryTracker::SetBudget(TestTag, (size_t)before.liveBytes + 512 * 1024);
+	MemoryTracker::CheckBudgets();
+	CHECK(MemoryTracker::GetStats(TestTag).overBudget);
+	CHECK(MemoryTracker::GetStats(TestTag).budgetBytes == (size_t)before.liveBytes + 512 * 1024);
+
+	delete buffer;
+	MemoryTracker::CheckBudgets();
+	CHECK(!MemoryTracker::GetStats(TestTag).overBudget);
+	MemoryTracker::SetBudget(TestTag, 0);
+}
+
+
+TEST(ImGuiAllocationsAreTagged)
+{
+	MemoryTracker::Stats before = MemoryTracker::GetStats(MemoryTracker::Tag::ImGui);
+	void* pointer = MemoryTracker::ImGuiAlloc(300, nullptr);
+	CHECK(pointer != nullptr);
+	CHECK(MemoryTracker::GetStats(MemoryTracker::Tag::ImGui).liveBytes - before.liveBytes == 300);
+	MemoryTracker::ImGuiFree(pointer, nullptr);
+	MemoryTracker::ImGuiFree(nullptr, nullptr);
+	CHECK(MemoryTracker::GetStats(MemoryTracker::Tag::ImGui).liveBytes == before.liveBytes);
+}
+
+
+TEST(EveryAllocationIsCounted)
+{
+	unsigned long long count = AllocationCounter::GetThreadCount();
+	unsigned long long bytes = AllocationCounter::GetBytes();
+	std::string* text = new std::string(100, 'x');
+	CHECK(AllocationCounter::GetThreadCount() - count == 2);
+	CHECK(AllocationCounter::GetBytes() - bytes >= sizeof(std::string) + 101);
+	delete text;
+
+	// Nothing at all
+	count = AllocationCounter::GetThreadCount();
+	std::vector<int> reused;
+	reused.reserve(64);
+	unsigned long long reserved = AllocationCounter::GetThreadCount();
+	for (int i = 0; i < 64; i++)
+		reused.push_back(i);
+	CHECK(reserved - count == 1);
+	CHECK(AllocationCounter::GetThreadCount() == reserved);
+}
@@ -0,0 +1,174 @@
+#include "TestHarness.h"
+#include "TestMath.h"
+#include "MultiViewRenderer.h"
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using namespace TestMath;
+
+	const float BoundsMin[3] = { -0.5f, -0.5f, -0.5f };
+	const float BoundsMax[3] = { 0.5f, 0.5f, 0.5f };
+
+	// Same size as the vertex shader's constant buffer
+	struct ViewConstants
+	{
+		float viewProjection[16];
+	};
+
+	// Boxes all around, with a few hundred meshes between them,
+	// seen by views turned a little further to the right each so
+	// neighbours overlap.  Distances are all from the first view
+	struct Scene
+	{
+		std::vector<float> worlds;
+		std::vector<unsigned int> meshes;
+		std::vector<float> distances;
+		std::vector<float> viewProjections;
+
+		Scene(int objectCount, int viewCount)
+		{
+			std::mt19937 random(2024);
+			auto spread = [&random](float low, float high) { return low + (high - low) * (random() % 10000) / 10000.0f; };
+			worlds.resize((size_t)objectCount * 16);
+			meshes.resize(objectCount);
+			distances.resize(objectCount);
+			for (int i = 0; i < objectCount; i++)
+			{
+				float x = spread(-60.0f, 60.0f);
+				float y = spread(-6.0f, 6.0f);
+				float z = spread(-60.0f, 60.0f);
+				float sx = spread(0.3f, 3.0f);
+				float sy = spread(0.3f, 3.0f);
+				float sz = spread(0.3f, 3.0f);
+				ScaleTranslation(sx, sy, sz, x, y, z, &worlds[(size_t)i * 16]);
+				meshes[i] = random() % 200;
+				distances[i] = std::sqrt(x * x + y * y + z * z);
+			}
+
+			viewProjections.resize((size_t)viewCount * 16);
+			float projection[16];
+			PerspectiveFovLH(1.2f, 16.0f / 9.0f, 0.1f, 200.0f, projection);
+			for (int view = 0; view < viewCount; view++)
+			{
+				float yaw = (view - (viewCount - 1) * 0.5f) * 0.6f;
+				float c = std::cos(yaw), s = std::sin(yaw);
+				const float viewMatrix[16] = { c, 0, s, 0,   0, 1, 0, 0,   -s, 0, c, 0,   0, 0, 0, 1 };
+				MultiplyMatrices(viewMatrix, projection, &viewProjections[(size_t)view * 16]);
+			}
+		}
+
+		void Cull(unsigned int view, OcclusionCuller& culler, std::vector<bool>& visible)
+		{
+			culler.BeginFrame(&viewProjections[(size_t)view * 16]);
+			culler.BuildHierarchy();
+			for (size_t i = 0; i < meshes.size(); i++)
+				visible[i] = culler.TestBounds(&worlds[i * 16], BoundsMin, BoundsMax) == OcclusionCuller::Result::Visible;
+		}
+
+		unsigned long long Key(unsigned int object)
+		{
+			return RenderQueue::MakeKey(0, 0, meshes[object], distances[object]);
+		}
+
+		// Like Game: the objects' worlds are uploaded once for every
+		// view, so a view only sets its camera, with its first bind
+		void Record(CommandList& commands, unsigned int view, const RenderQueue::DrawCall& call)
+		{
+			if (call.bindShader)
+			{
+				ViewConstants constants;
+				memcpy(constants.viewProjection, &viewProjections[(size_t)view * 16], sizeof(constants.viewProjection));
+				commands.BindShaders(0);
+				commands.UpdateConstants(0, &constants, sizeof(constants));
+			}
+			if (call.bindMesh)
+				commands.BindMesh(meshes[call.index]);
+			commands.DrawInstanced(36, 1, 0, 0, call.index);
+		}
+	};
+}
+
+
+TEST(SplitScreenTilesTheTarget)
+{
+	for (unsigned int viewCount = 1; viewCount <= 4; viewCount++)
+	{
+		std::vector<MultiViewRenderer::Viewport> viewports = MultiViewRenderer::SplitScreen(viewCount, 1920.0f, 1080.0f);
+		CHECK(viewports.size() == viewCount);
+
+		float area = 0.0f;
+		bool inside = true;
+		for (const MultiViewRenderer::Viewport& viewport : viewports)
+		{
+			area += viewport.width * viewport.height;
+			inside = inside && viewport.x >= 0.0f && viewport.y >= 0.0f &&
+				viewport.x + viewport.width <= 1920.0f && viewport.y + viewport.height <= 1080.0f;
+		}
+		CHECK(inside);
+		CHECK(area <= 1920.0f * 1080.0f);
+	}
+}
+
+
+TEST(SharedSortMatchesEachViewAlone)
+{
+	// Shared culling, sorting and recording, twice to reuse
+	// everything, against each view culled, sorted and recorded
+	// on its own
+	const int ObjectCount = 20000;
+	const int ViewCount = 4;
+	Scene scene(ObjectCount, ViewCount);
+	MultiViewRenderer::CullFunction cull = [&](unsigned int view, OcclusionCuller& culler, std::vector<bool>& visible) { scene.Cull(view, culler, visible); };
+	MultiViewRenderer::KeyFunction key = [&](unsigned int object) { return scene.Key(object); };
+	MultiViewRenderer::MeshFunction mesh = [&](unsigned int object) { return scene.meshes[object]; };
+	MultiViewRenderer::RecordFunction record = [&](CommandList& commands, unsigned int view, const RenderQueue::DrawCall& call) { scene.Record(commands, view, call); };
+
+	MultiViewRenderer renderer;
+	std::vector<MultiViewRenderer::Viewport> viewports = MultiViewRenderer::SplitScreen(ViewCount, 1920.0f, 1080.0f);
+	renderer.SetViewports(viewports);
+	renderer.Render(ObjectCount, cull, key, mesh, record);
+	const std::vector<CommandList>& lists = renderer.Render(ObjectCount, cull, key, mesh, record);
+	CHECK(lists.size() == ViewCount);
+
+	OcclusionCuller culler(320, 180);
+	RenderQueue queue;
+	std::vector<bool> visible;
+	int viewObjects = 0;
+	for (unsigned int view = 0; view < ViewCount; view++)
+	{
+		visible.assign(ObjectCount, false);
+		scene.Cull(view, culler, visible);
+		CHECK(visible == renderer.GetVisibility(view));
+
+		queue.Clear();
+		for (unsigned int i = 0; i < ObjectCount; i++)
+			if (visible[i])
+				queue.Push(key(i), i, mesh(i));
+		queue.Sort();
+		viewObjects += (int)queue.BuildDrawCalls().size();
+		CHECK(renderer.GetViewStats(view).drawCalls == (int)queue.BuildDrawCalls().size());
+
+		CommandList alone;
+		alone.SetViewport(viewports[view].x, viewports[view].y, viewports[view].width, viewports[view].height);
+		for (const RenderQueue::DrawCall& call : queue.BuildDrawCalls())
+			scene.Record(alone, view, call);
+
+		NullBackend sharedBackend(true);
+		NullBackend aloneBackend(true);
+		sharedBackend.Execute(lists[view]);
+		aloneBackend.Execute(alone);
+		CHECK(sharedBackend.GetTranscript() == aloneBackend.GetTranscript());
+		CHECK(sharedBackend.GetStats().constantUpdates == 1);
+	}
+
+	// Neighbours overlap, so the shared sort has less to do
+	MultiViewRenderer::Stats stats = renderer.GetStats();
+	CHECK(stats.viewObjects == viewObjects);
+	CHECK(stats.sortedObjects > 0 && stats.sortedObjects < stats.viewObjects);
+}
@@ -0,0 +1,87 @@
+#include "BenchHarness.h"
+#include "TestMath.h"
+#include "OcclusionCuller.h"
+
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using namespace TestMath;
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	// Unit box, shared by walls and occludees
+	const float BoxPositions[] =
+	{
+		-0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, 0.5f, -0.5f,   -0.5f, 0.5f, -0.5f,
+		-0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f, 0.5f,  0.5f,   -0.5f, 0.5f,  0.5f,
+	};
+	const unsigned int BoxIndices[] =
+	{
+		0, 2, 1,   0, 3, 2,   4, 5, 6,   4, 6, 7,   0, 1, 5,   0, 5, 4,
+		3, 6, 2,   3, 7, 6,   0, 4, 7,   0, 7, 3,   1, 2, 6,   1, 6, 5,
+	};
+	const float BoundsMin[3] = { -0.5f, -0.5f, -0.5f };
+	const float BoundsMax[3] = { 0.5f, 0.5f, 0.5f };
+}
+
+
+BENCH(GeneratedInterior)
+{
+	// Rows of walls with doorways in front of the camera, the
+	// same interior as OcclusionCullerTests.cpp
+	std::vector<float> walls;
+	for (int row = 0; row < 5; row++)
+	{
+		float z = 8.0f + row * 12.0f;
+		float door = -12.0f + row * 6.0f;
+		float world[16];
+		ScaleTranslation(door + 30.0f, 8.0f, 0.5f, (door - 30.0f) * 0.5f, 0.0f, z, world);
+		walls.insert(walls.end(), world, world + 16);
+		ScaleTranslation(30.0f - door - 2.0f, 8.0f, 0.5f, (door + 2.0f + 30.0f) * 0.5f, 0.0f, z, world);
+		walls.insert(walls.end(), world, world + 16);
+	}
+
+	const int OccludeeCount = 10000;
+	const int Frames = 100;
+	std::mt19937 random(1234);
+	auto spread = [&random](float low, float high) { return low + (high - low) * (random() % 10000) / 10000.0f; };
+	std::vector<float> occludees((size_t)OccludeeCount * 16);
+	for (int i = 0; i < OccludeeCount; i++)
+	{
+		float scale = spread(0.2f, 1.5f);
+		float x = spread(-30.0f, 30.0f);
+		float y = spread(-3.0f, 3.0f);
+		float z = spread(2.0f, 70.0f);
+		ScaleTranslation(scale, scale, scale, x, y, z, &occludees[(size_t)i * 16]);
+	}
+
+	float viewProjection[16];
+	PerspectiveFovLH(1.2f, 16.0f / 9.0f, 0.1f, 200.0f, viewProjection);
+
+	OcclusionCuller culler(320, 180);
+	double frameSeconds = 0.0;
+	double rasterizeSeconds = 0.0;
+	int occluded = 0;
+	for (int frame = 0; frame < Frames; frame++)
+	{
+		Clock::time_point start = Clock::now();
+		culler.BeginFrame(viewProjection);
+		for (size_t wall = 0; wall < walls.size(); wall += 16)
+			culler.RenderOccluder(&walls[wall], BoxPositions, sizeof(float) * 3, 8, BoxIndices, 36);
+		rasterizeSeconds += SecondsSince(start);
+		culler.BuildHierarchy();
+
+		occluded = 0;
+		for (int i = 0; i < OccludeeCount; i++)
+			occluded += culler.TestBounds(&occludees[(size_t)i * 16], BoundsMin, BoundsMax) == OcclusionCuller::Result::Occluded;
+		frameSeconds += SecondsSince(start);
+	}
+
+	BenchHarness::Report("Frame, 10k occludees", frameSeconds * 1000.0 / Frames, "ms");
+	BenchHarness::Report("Rasterizing occluders", rasterizeSeconds * 1000.0 / Frames, "ms");
+	BenchHarness::Report("Occluded", 100.0 * occluded / OccludeeCount, "%");
+	BenchHarness::ReportCount("Uses SIMD", OcclusionCuller::UsesSIMD());
+}
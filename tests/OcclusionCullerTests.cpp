@@ -0,0 +1,178 @@
+#include "TestHarness.h"
+#include "TestMath.h"
+#include "OcclusionCuller.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using namespace TestMath;
+
+	// Unit box, shared by walls and occludees
+	const float BoxPositions[] =
+	{
+		-0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f, 0.5f, -0.5f,   -0.5f, 0.5f, -0.5f,
+		-0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f, 0.5f,  0.5f,   -0.5f, 0.5f,  0.5f,
+	};
+	const unsigned int BoxIndices[] =
+	{
+		0, 2, 1,   0, 3, 2,   4, 5, 6,   4, 6, 7,   0, 1, 5,   0, 5, 4,
+		3, 6, 2,   3, 7, 6,   0, 4, 7,   0, 7, 3,   1, 2, 6,   1, 6, 5,
+	};
+	const float BoundsMin[3] = { -0.5f, -0.5f, -0.5f };
+	const float BoundsMax[3] = { 0.5f, 0.5f, 0.5f };
+
+	// A generated interior: rows of walls with doorways in front
+	// of the camera, and boxes scattered through the rooms behind
+	struct Interior
+	{
+		std::vector<std::vector<float>> walls;
+		std::vector<std::vector<float>> boxes;
+		float viewProjection[16];
+
+		Interior(int boxCount)
+		{
+			// Walls every 12 units, each split by a doorway at a different spot
+			for (int row = 0; row < 5; row++)
+			{
+				float z = 8.0f + row * 12.0f;
+				float door = -12.0f + row * 6.0f;
+				float world[16];
+				ScaleTranslation(door + 30.0f, 8.0f, 0.5f, (door - 30.0f) * 0.5f, 0.0f, z, world);
+				walls.push_back(std::vector<float>(world, world + 16));
+				ScaleTranslation(30.0f - door - 2.0f, 8.0f, 0.5f, (door + 2.0f + 30.0f) * 0.5f, 0.0f, z, world);
+				walls.push_back(std::vector<float>(world, world + 16));
+			}
+
+			// Raw generator output rather than the distributions,
+			// which differ between standard libraries
+			std::mt19937 random(1234);
+			auto spread = [&random](float low, float high) { return low + (high - low) * (random() % 10000) / 10000.0f; };
+			for (int i = 0; i < boxCount; i++)
+			{
+				float world[16];
+				float scale = spread(0.2f, 1.5f);
+				float x = spread(-30.0f, 30.0f);
+				float y = spread(-3.0f, 3.0f);
+				float z = spread(2.0f, 70.0f);
+				ScaleTranslation(scale, scale, scale, x, y, z, world);
+				boxes.push_back(std::vector<float>(world, world + 16));
+			}
+
+			// Camera at the origin looking down +Z
+			PerspectiveFovLH(1.2f, 16.0f / 9.0f, 0.1f, 200.0f, viewProjection);
+		}
+
+		void Render(OcclusionCuller& culler)
+		{
+			culler.BeginFrame(viewProjection);
+			for (const std::vector<float>& wall : walls)
+				culler.RenderOccluder(wall.data(), BoxPositions, sizeof(float) * 3, 8, BoxIndices, 36);
+			culler.BuildHierarchy();
+		}
+	};
+
+	// Occlusion test of an axis-aligned box against every pixel
+	// of the full resolution depth buffer, without the hierarchy
+	bool ReferenceBoxOccluded(OcclusionCuller& culler, const float worldViewProjection[16])
+	{
+		float minX = FLT_MAX, minY = FLT_MAX, minZ = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+		for (int i = 0; i < 8; i++)
+		{
+			float p[3] = { (i & 1) ? BoundsMax[0] : BoundsMin[0], (i & 2) ? BoundsMax[1] : BoundsMin[1], (i & 4) ? BoundsMax[2] : BoundsMin[2] };
+			float clip[4];
+			for (int col = 0; col < 4; col++)
+				clip[col] = p[0] * worldViewProjection[col] + p[1] * worldViewProjection[4 + col] + p[2] * worldViewProjection[8 + col] + worldViewProjection[12 + col];
+			if (clip[2] < 0.0f || clip[3] <= 0.0f)
+				return false;
+
+			minX = std::min(minX, (clip[0] / clip[3] * 0.5f + 0.5f) * culler.GetWidth());
+			maxX = std::max(maxX, (clip[0] / clip[3] * 0.5f + 0.5f) * culler.GetWidth());
+			minY = std::min(minY, (0.5f - clip[1] / clip[3] * 0.5f) * culler.GetHeight());
+			maxY = std::max(maxY, (0.5f - clip[1] / clip[3] * 0.5f) * culler.GetHeight());
+			minZ = std::min(minZ, clip[2] / clip[3]);
+		}
+
+		int x0 = (int)std::max(minX, 0.0f), x1 = (int)std::min(maxX, culler.GetWidth() - 1.0f);
+		int y0 = (int)std::max(minY, 0.0f), y1 = (int)std::min(maxY, culler.GetHeight() - 1.0f);
+		const float* depth = culler.GetLevelDepth(0);
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++)
+				if (depth[y * culler.GetLevelWidth(0) + x] >= minZ)
+					return false;
+		return x0 <= x1 && y0 <= y1;
+	}
+}
+
+
+TEST(HierarchyIsConservative)
+{
+	// The hierarchy may keep boxes that the full resolution
+	// buffer would cull, but never the other way around
+	Interior interior(5000);
+	OcclusionCuller culler(320, 180);
+	interior.Render(culler);
+	CHECK(culler.GetStats().occluderTriangles == 10 * 12);
+
+	int occluded = 0;
+	int outsideView = 0;
+	bool conservative = true;
+	for (const std::vector<float>& box : interior.boxes)
+	{
+		OcclusionCuller::Result result = culler.TestBounds(box.data(), BoundsMin, BoundsMax);
+		outsideView += result == OcclusionCuller::Result::OutsideView;
+		if (result != OcclusionCuller::Result::Occluded)
+			continue;
+
+		occluded++;
+		float worldViewProjection[16];
+		MultiplyMatrices(box.data(), interior.viewProjection, worldViewProjection);
+		conservative = conservative && ReferenceBoxOccluded(culler, worldViewProjection);
+	}
+	CHECK(conservative);
+
+	// Most of the rooms are behind a wall, and some boxes are off to the side
+	CHECK(occluded > 1000);
+	CHECK(outsideView > 0);
+	CHECK(culler.GetStats().testedObjects == (int)interior.boxes.size());
+	CHECK(culler.GetStats().occludedObjects == occluded);
+}
+
+
+TEST(NothingIsOccludedWithoutOccluders)
+{
+	Interior interior(1000);
+	OcclusionCuller culler(320, 180);
+	culler.BeginFrame(interior.viewProjection);
+	culler.BuildHierarchy();
+
+	bool noneOccluded = true;
+	for (const std::vector<float>& box : interior.boxes)
+		noneOccluded = noneOccluded && culler.TestBounds(box.data(), BoundsMin, BoundsMax) != OcclusionCuller::Result::Occluded;
+	CHECK(noneOccluded);
+}
+
+
+TEST(BoxInFrontOfAWallIsVisible)
+{
+	// One wall across the whole view, one box in front and one behind
+	float viewProjection[16];
+	PerspectiveFovLH(1.2f, 16.0f / 9.0f, 0.1f, 200.0f, viewProjection);
+	float wall[16];
+	float front[16];
+	float behind[16];
+	ScaleTranslation(60.0f, 40.0f, 0.5f, 0.0f, 0.0f, 20.0f, wall);
+	ScaleTranslation(1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 10.0f, front);
+	ScaleTranslation(1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 30.0f, behind);
+
+	OcclusionCuller culler(320, 180);
+	culler.BeginFrame(viewProjection);
+	culler.RenderOccluder(wall, BoxPositions, sizeof(float) * 3, 8, BoxIndices, 36);
+	culler.BuildHierarchy();
+	CHECK(culler.TestBounds(front, BoundsMin, BoundsMax) == OcclusionCuller::Result::Visible);
+	CHECK(culler.TestBounds(behind, BoundsMin, BoundsMax) == OcclusionCuller::Result::Occluded);
+}
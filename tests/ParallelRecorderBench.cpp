@@ -0,0 +1,85 @@
+#include "BenchHarness.h"
+#include "ParallelRecorder.h"
+
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	// Same size as the vertex shader's constant buffer
+	struct FrameConstants
+	{
+		float colorTint[4];
+		float worldViewProjection[16];
+	};
+
+	void RecordDraw(CommandList& commands, const RenderQueue::DrawCall& call, const std::vector<unsigned int>& meshes)
+	{
+		if (call.bindShader)
+			commands.BindShaders(0);
+		if (call.bindMesh)
+			commands.BindMesh(meshes[call.index]);
+
+		FrameConstants constants = {};
+		constants.colorTint[0] = (float)call.index;
+		commands.UpdateConstants(0, &constants, sizeof(constants));
+		commands.Draw(36);
+	}
+}
+
+
+BENCH(HundredThousandDraws)
+{
+	const int DrawCount = 100000;
+	std::mt19937 random(7);
+	RenderQueue queue;
+	std::vector<unsigned int> meshes(DrawCount);
+	for (int i = 0; i < DrawCount; i++)
+	{
+		meshes[i] = random() % 200;
+		queue.Push(RenderQueue::MakeKey(0, 0, meshes[i], 0.1f + (random() % 50000) / 100.0f), (unsigned int)i, meshes[i]);
+	}
+	queue.Sort();
+	const std::vector<RenderQueue::DrawCall>& calls = queue.BuildDrawCalls();
+
+	// Each warmed up once, like the recorder's lists
+	CommandList single;
+	double singleSeconds = 0.0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		Clock::time_point start = Clock::now();
+		single.Clear();
+		for (const RenderQueue::DrawCall& call : calls)
+			RecordDraw(single, call, meshes);
+		singleSeconds = SecondsSince(start);
+	}
+	BenchHarness::Report("One list, calling thread", singleSeconds * 1000.0, "ms");
+
+	ParallelRecorder recorder;
+	ParallelRecorder::RecordFunction record = [&meshes](CommandList& commands, const RenderQueue::DrawCall& call) { RecordDraw(commands, call, meshes); };
+	double parallelSeconds = 0.0;
+	for (int pass = 0; pass < 2; pass++)
+	{
+		Clock::time_point start = Clock::now();
+		recorder.Record(calls, record);
+		parallelSeconds = SecondsSince(start);
+	}
+	BenchHarness::Report("ParallelRecorder", parallelSeconds * 1000.0, "ms");
+	BenchHarness::ReportCount("Chunks", (long long)recorder.GetLists().size());
+
+	// Each chunk starts with nothing bound, like a deferred context
+	unsigned int binds = 0;
+	for (const CommandList& commands : recorder.GetLists())
+	{
+		NullBackend backend;
+		backend.Execute(commands);
+		binds += backend.GetStats().shaderBinds + backend.GetStats().meshBinds;
+	}
+	NullBackend backend;
+	backend.Execute(single);
+	BenchHarness::ReportCount("Binds repeated at chunk starts", (long long)binds - (backend.GetStats().shaderBinds + backend.GetStats().meshBinds));
+}
@@ -0,0 +1,175 @@
+#include "TestHarness.h"
+#include "JobSystem.h"
+#include "ParallelRecorder.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Same size as the vertex shader's constant buffer
+	struct FrameConstants
+	{
+		float colorTint[4];
+		float worldViewProjection[16];
+	};
+
+	// Sorts a frame of draws with random meshes and depths
+	void BuildFrameQueue(RenderQueue& queue, std::vector<unsigned int>& meshes, int drawCount, int meshCount)
+	{
+		std::mt19937 random(7);
+		queue.Clear();
+		meshes.resize(drawCount);
+		for (int i = 0; i < drawCount; i++)
+		{
+			meshes[i] = random() % meshCount;
+			queue.Push(RenderQueue::MakeKey(0, 0, meshes[i], (float)(1 + random() % 500)), (unsigned int)i, meshes[i]);
+		}
+		queue.Sort();
+	}
+
+	// Records one draw the way Game::RecordDraw() does: binds
+	// only when asked to, constants for every draw
+	void RecordFrameDraw(CommandList& commands, const RenderQueue::DrawCall& call, const std::vector<unsigned int>& meshes)
+	{
+		if (call.bindShader)
+			commands.BindShaders(0);
+		if (call.bindMesh)
+			commands.BindMesh(meshes[call.index]);
+
+		FrameConstants constants = {};
+		constants.colorTint[0] = (float)call.index;
+		constants.worldViewProjection[12] = (float)(call.index % 100);
+		commands.UpdateConstants(0, &constants, sizeof(constants));
+		commands.Draw(36 + (call.index % 4) * 12);
+	}
+
+	// Rewrites a NullBackend transcript with the bound shader and
+	// mesh on each draw line instead of separate bind lines, so
+	// lists that bind in different places can be compared.  State
+	// starts unbound, as it does on a fresh deferred context
+	std::string ResolveBinds(const std::string& transcript)
+	{
+		std::string result;
+		std::string shader = "none";
+		std::string mesh = "none";
+		size_t start = 0;
+		while (start < transcript.size())
+		{
+			size_t end = transcript.find('\n', start);
+			if (end == std::string::npos)
+				end = transcript.size();
+			std::string line = transcript.substr(start, end - start);
+			start = end + 1;
+
+			if (line.compare(0, 12, "BindShaders ") == 0)
+				shader = line.substr(12);
+			else if (line.compare(0, 9, "BindMesh ") == 0)
+				mesh = line.substr(9);
+			else if (line.compare(0, 4, "Draw") == 0)
+				result += "[shader " + shader + ", mesh " + mesh + "] " + line + "\n";
+			else
+				result += line + "\n";
+		}
+		return result;
+	}
+}
+
+
+TEST(PartitionCoversEveryDraw)
+{
+	std::vector<ParallelRecorder::Chunk> chunks;
+	const unsigned int counts[] = { 1, 255, 256, 1000, 1023, 100000 };
+	for (unsigned int count : counts)
+	{
+		ParallelRecorder::Partition(count, 256, 4, chunks);
+		CHECK(!chunks.empty() && chunks.size() <= 4);
+		unsigned int next = 0;
+		for (const ParallelRecorder::Chunk& chunk : chunks)
+		{
+			CHECK(chunk.first == next);
+			CHECK(chunk.count >= 256 || chunks.size() == 1);
+			next += chunk.count;
+		}
+		CHECK(next == count);
+	}
+
+	ParallelRecorder::Partition(0, 256, 4, chunks);
+	CHECK(chunks.empty());
+}
+
+
+TEST(ChunksMatchSingleList)
+{
+	RenderQueue queue;
+	std::vector<unsigned int> meshes;
+	BuildFrameQueue(queue, meshes, 5000, 50);
+	const std::vector<RenderQueue::DrawCall>& calls = queue.BuildDrawCalls();
+
+	CommandList single;
+	for (const RenderQueue::DrawCall& call : calls)
+		RecordFrameDraw(single, call, meshes);
+	NullBackend singleBackend(true);
+	singleBackend.Execute(single);
+	NullBackend::Stats singleStats = singleBackend.GetStats();
+
+	// Twice, the second time reusing the lists
+	ParallelRecorder recorder(256);
+	ParallelRecorder::RecordFunction record = [&](CommandList& commands, const RenderQueue::DrawCall& call)
+		{
+			RecordFrameDraw(commands, call, meshes);
+		};
+	for (int pass = 0; pass < 2; pass++)
+	{
+		const std::vector<CommandList>& lists = recorder.Record(calls, record);
+		CHECK(lists.size() == JobSystem::ThreadCount() + 1);
+		CHECK(lists.size() == recorder.GetChunks().size());
+
+		// Each chunk runs on a fresh backend, like a deferred context
+		std::string parallelTranscript;
+		NullBackend::Stats parallelStats = {};
+		for (const CommandList& commands : lists)
+		{
+			NullBackend chunkBackend(true);
+			chunkBackend.Execute(commands);
+			parallelTranscript += ResolveBinds(chunkBackend.GetTranscript());
+
+			NullBackend::Stats chunkStats = chunkBackend.GetStats();
+			parallelStats.shaderBinds += chunkStats.shaderBinds;
+			parallelStats.meshBinds += chunkStats.meshBinds;
+			parallelStats.draws += chunkStats.draws;
+			parallelStats.constantBytes += chunkStats.constantBytes;
+		}
+
+		CHECK(parallelStats.draws == singleStats.draws);
+		CHECK(parallelStats.constantBytes == singleStats.constantBytes);
+		CHECK(parallelTranscript == ResolveBinds(singleBackend.GetTranscript()));
+
+		// Only the chunk starts bind again
+		unsigned int extraBinds = (parallelStats.shaderBinds + parallelStats.meshBinds) - (singleStats.shaderBinds + singleStats.meshBinds);
+		CHECK(extraBinds <= 2 * (unsigned int)lists.size());
+	}
+}
+
+
+TEST(SmallFramesStayInOneList)
+{
+	RenderQueue queue;
+	std::vector<unsigned int> meshes;
+	BuildFrameQueue(queue, meshes, 100, 10);
+
+	ParallelRecorder recorder(256);
+	const std::vector<CommandList>& lists = recorder.Record(queue.BuildDrawCalls(),
+		[&](CommandList& commands, const RenderQueue::DrawCall& call) { RecordFrameDraw(commands, call, meshes); });
+	CHECK(lists.size() == 1);
+
+	NullBackend backend;
+	backend.Execute(lists[0]);
+	CHECK(backend.GetStats().draws == 100);
+
+	// Nothing to draw, nothing recorded
+	std::vector<RenderQueue::DrawCall> none;
+	CHECK(recorder.Record(none, [](CommandList&, const RenderQueue::DrawCall&) {}).empty());
+}
@@ -0,0 +1,88 @@
+#include "BenchHarness.h"
+#include "RenderCommands.h"
+#include "RenderQueue.h"
+
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	const int DrawCount = 100000;
+	const int MeshCount = 200;
+
+	// Same size as the vertex shader's constant buffer
+	struct FrameConstants
+	{
+		float colorTint[4];
+		float worldViewProjection[16];
+	};
+
+	// A sorted frame of draws with random meshes and depths
+	void BuildFrameQueue(RenderQueue& queue, std::vector<unsigned int>& meshes)
+	{
+		std::mt19937 random(7);
+		meshes.resize(DrawCount);
+		for (int i = 0; i < DrawCount; i++)
+		{
+			meshes[i] = random() % MeshCount;
+			queue.Push(RenderQueue::MakeKey(0, 0, meshes[i], 0.1f + (random() % 50000) / 100.0f), (unsigned int)i, meshes[i]);
+		}
+		queue.Sort();
+	}
+
+	// Records the frame the way Game::Draw() does: binds only
+	// when the mesh changes, constants for every draw
+	void RecordFrame(CommandList& commands, const std::vector<RenderQueue::DrawCall>& calls, const std::vector<unsigned int>& meshes)
+	{
+		const float clearColor[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
+		commands.Clear();
+		commands.ClearTargets(clearColor, 1.0f);
+		for (const RenderQueue::DrawCall& call : calls)
+		{
+			if (call.bindShader)
+				commands.BindShaders(0);
+			if (call.bindMesh)
+				commands.BindMesh(meshes[call.index]);
+
+			FrameConstants constants = {};
+			constants.colorTint[0] = (float)call.index;
+			constants.worldViewProjection[12] = (float)(call.index % 100);
+			commands.UpdateConstants(0, &constants, sizeof(constants));
+			commands.Draw(36 + (call.index % 4) * 12);
+		}
+	}
+}
+
+
+BENCH(HundredThousandDrawFrame)
+{
+	// The CPU side of a frame with no GPU behind it
+	RenderQueue queue;
+	std::vector<unsigned int> meshes;
+	BuildFrameQueue(queue, meshes);
+	const std::vector<RenderQueue::DrawCall>& calls = queue.BuildDrawCalls();
+
+	// Once to grow the list, then timed
+	CommandList commands;
+	RecordFrame(commands, calls, meshes);
+	Clock::time_point start = Clock::now();
+	RecordFrame(commands, calls, meshes);
+	BenchHarness::Report("Record", SecondsSince(start) * 1000.0, "ms");
+
+	NullBackend backend;
+	start = Clock::now();
+	backend.Execute(commands);
+	BenchHarness::Report("Execute on the null backend", SecondsSince(start) * 1000.0, "ms");
+
+	NullBackend transcript(true);
+	start = Clock::now();
+	transcript.Execute(commands);
+	BenchHarness::Report("Execute with a transcript", SecondsSince(start) * 1000.0, "ms");
+
+	BenchHarness::ReportCount("Commands", commands.GetCommandCount());
+	BenchHarness::Report("Command stream", commands.GetByteSize() / (1024.0 * 1024.0), "MB");
+}
@@ -0,0 +1,149 @@
+#include "TestHarness.h"
+#include "RenderCommands.h"
+#include "RenderQueue.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Same size as the vertex shader's constant buffer
+	struct FrameConstants
+	{
+		float colorTint[4];
+		float worldViewProjection[16];
+	};
+
+	// A small frame the way Game::Draw() records one: clear,
+	// viewport, then sorted draws that only bind when the
+	// shader or mesh changes, with constants for every draw
+	void RecordFrame(CommandList& commands, int drawCount)
+	{
+		// The engine's raw output is the same everywhere, unlike the
+		// standard distributions
+		std::mt19937 random(7);
+		RenderQueue queue;
+		for (int i = 0; i < drawCount; i++)
+		{
+			unsigned int mesh = random() % 4;
+			unsigned int shader = random() % 2;
+			float depth = (float)(1 + random() % 500);
+			queue.Push(RenderQueue::MakeKey(0, shader, mesh, depth), (unsigned int)(shader << 8 | mesh << 4 | (i & 15)), mesh);
+		}
+		queue.Sort();
+
+		const float clearColor[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
+		commands.Clear();
+		commands.ClearTargets(clearColor, 1.0f);
+		commands.SetViewport(0.0f, 0.0f, 1280.0f, 720.0f);
+		for (const RenderQueue::DrawCall& call : queue.BuildDrawCalls())
+		{
+			if (call.bindShader)
+				commands.BindShaders(call.index >> 8);
+			if (call.bindMesh)
+				commands.BindMesh(call.index >> 4 & 15);
+
+			FrameConstants constants = {};
+			constants.colorTint[0] = (float)(call.index & 15);
+			constants.worldViewProjection[12] = (float)call.index;
+			commands.UpdateConstants(0, &constants, sizeof(constants));
+			commands.Draw(36 + (call.index & 3) * 12);
+		}
+	}
+}
+
+
+TEST(MatchesGoldenTranscript)
+{
+	CommandList commands;
+	RecordFrame(commands, 24);
+
+	// A second view, instanced, with constants that aren't a
+	// multiple of 4 bytes
+	const unsigned char odd[7] = { 1, 2, 3, 4, 5, 6, 7 };
+	commands.SetViewport(960.0f, 0.0f, 320.0f, 180.0f);
+	commands.UpdateConstants(1, odd, sizeof(odd));
+	commands.DrawInstanced(6, 100, 12, -4, 3);
+
+	NullBackend backend(true);
+	backend.Execute(commands);
+	CHECK(TestHarness::MatchesGolden("CommandTranscript.txt", backend.GetTranscript()));
+}
+
+
+TEST(StatsCountEveryCommand)
+{
+	CommandList commands;
+	RecordFrame(commands, 24);
+	commands.DrawInstanced(6, 100);
+	const float instances[3][20] = {};
+	commands.UpdateInstances(instances, sizeof(instances[0]), 3);
+
+	NullBackend backend;
+	backend.Execute(commands);
+	NullBackend::Stats stats = backend.GetStats();
+	CHECK(stats.commands == commands.GetCommandCount());
+	CHECK(stats.clears == 1);
+	CHECK(stats.viewports == 1);
+	CHECK(stats.draws == 25);
+	CHECK(stats.instances == 24 + 100);
+	CHECK(stats.constantUpdates == 24);
+	CHECK(stats.constantBytes == 24 * sizeof(FrameConstants));
+	CHECK(stats.instanceUpdates == 1);
+	CHECK(stats.instanceBytes == sizeof(instances));
+	CHECK(stats.shaderBinds >= 1 && stats.shaderBinds <= 2);
+	CHECK(stats.meshBinds >= 1 && stats.meshBinds <= 8);
+	CHECK(backend.GetTranscript().empty());
+
+	backend.ResetStats();
+	CHECK(backend.GetStats().commands == 0);
+}
+
+
+TEST(RecordingIsDeterministic)
+{
+	CommandList first;
+	CommandList second;
+	RecordFrame(first, 500);
+	RecordFrame(second, 500);
+	CHECK(first.GetByteSize() == second.GetByteSize());
+
+	NullBackend a(true);
+	NullBackend b(true);
+	a.Execute(first);
+	b.Execute(second);
+	CHECK(!a.GetTranscript().empty());
+	CHECK(a.GetTranscript() == b.GetTranscript());
+}
+
+
+TEST(PayloadsStayAligned)
+{
+	CommandList commands;
+	const unsigned char odd[5] = { 9, 8, 7, 6, 5 };
+	commands.UpdateConstants(2, odd, sizeof(odd));
+	commands.BindMesh(3);
+
+	size_t offset = 0;
+	CommandList::Header header;
+	const unsigned char* payload = nullptr;
+	CHECK(commands.Next(offset, header, payload));
+	CHECK(header.type == RenderCommandType::UpdateConstants);
+	CHECK(header.size % 4 == 0);
+	CHECK(memcmp(payload + sizeof(CommandList::UpdateConstantsCommand), odd, sizeof(odd)) == 0);
+
+	CHECK(commands.Next(offset, header, payload));
+	CHECK(header.type == RenderCommandType::BindMesh);
+	CommandList::BindMeshCommand bind;
+	memcpy(&bind, payload, sizeof(bind));
+	CHECK(bind.mesh == 3);
+	CHECK(!commands.Next(offset, header, payload));
+	CHECK(offset == commands.GetByteSize());
+
+	commands.Clear();
+	offset = 0;
+	CHECK(commands.GetCommandCount() == 0 && !commands.Next(offset, header, payload));
+}
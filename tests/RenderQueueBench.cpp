@@ -0,0 +1,56 @@
+#include "BenchHarness.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+}
+
+
+BENCH(SortHundredThousandDraws)
+{
+	// Draws in "scene order", 8 shaders and 200 meshes mixed
+	const int DrawCount = 100000;
+	std::mt19937 random(42);
+	RenderQueue queue;
+	for (int i = 0; i < DrawCount; i++)
+	{
+		unsigned int mesh = random() % 200;
+		float depth = 0.1f + (random() % 50000) / 100.0f;
+		queue.Push(RenderQueue::MakeKey(i % 97 == 0 ? 1 : 0, random() % 8, mesh, depth), (unsigned int)i, mesh);
+	}
+
+	int unsortedShaderBinds = 0;
+	int unsortedMeshBinds = 0;
+	std::vector<RenderQueue::Item> unsorted = queue.GetItems();
+	for (size_t i = 0; i < unsorted.size(); i++)
+	{
+		unsortedShaderBinds += i == 0 || RenderQueue::GetShader(unsorted[i].key) != RenderQueue::GetShader(unsorted[i - 1].key);
+		unsortedMeshBinds += i == 0 || RenderQueue::GetMesh(unsorted[i].key) != RenderQueue::GetMesh(unsorted[i - 1].key);
+	}
+
+	Clock::time_point start = Clock::now();
+	queue.Sort();
+	BenchHarness::Report("Radix sort", SecondsSince(start) * 1000.0, "ms");
+
+	start = Clock::now();
+	std::stable_sort(unsorted.begin(), unsorted.end(),
+		[](const RenderQueue::Item& a, const RenderQueue::Item& b) { return a.key < b.key; });
+	BenchHarness::Report("std::stable_sort", SecondsSince(start) * 1000.0, "ms");
+
+	start = Clock::now();
+	queue.BuildDrawCalls();
+	BenchHarness::Report("BuildDrawCalls", SecondsSince(start) * 1000.0, "ms");
+
+	RenderQueue::Stats stats = queue.GetStats();
+	BenchHarness::ReportCount("Shader binds, unsorted", unsortedShaderBinds);
+	BenchHarness::ReportCount("Shader binds, sorted", stats.shaderBinds);
+	BenchHarness::ReportCount("Mesh binds, unsorted", unsortedMeshBinds);
+	BenchHarness::ReportCount("Mesh binds, sorted", stats.meshBinds);
+}
@@ -0,0 +1,150 @@
+#include "TestHarness.h"
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Draws in "scene order", with shaders and meshes mixed
+	void PushRandomDraws(RenderQueue& queue, int drawCount, int shaderCount, int meshCount)
+	{
+		std::mt19937 random(42);
+		std::uniform_int_distribution<int> pickShader(0, shaderCount - 1);
+		std::uniform_int_distribution<int> pickMesh(0, meshCount - 1);
+		std::uniform_real_distribution<float> pickDepth(0.1f, 500.0f);
+		for (int i = 0; i < drawCount; i++)
+		{
+			unsigned int mesh = pickMesh(random);
+			queue.Push(RenderQueue::MakeKey(i % 97 == 0 ? 1 : 0, pickShader(random), mesh, pickDepth(random)), (unsigned int)i, mesh);
+		}
+	}
+}
+
+
+TEST(KeyFieldsRoundTrip)
+{
+	unsigned long long key = RenderQueue::MakeKey(3, 1234, 54321, 10.0f);
+	CHECK(RenderQueue::GetLayer(key) == 3);
+	CHECK(RenderQueue::GetShader(key) == 1234);
+	CHECK(RenderQueue::GetMesh(key) == 54321);
+
+	// Ids too big for their bits wrap instead of spilling over
+	key = RenderQueue::MakeKey(0, 0x1001, 0x10002, 0.0f);
+	CHECK(RenderQueue::GetLayer(key) == 0);
+	CHECK(RenderQueue::GetShader(key) == 1);
+	CHECK(RenderQueue::GetMesh(key) == 2);
+}
+
+
+TEST(SortOrder)
+{
+	// Layer beats shader beats mesh beats depth
+	RenderQueue queue;
+	queue.Push(RenderQueue::MakeKey(1, 0, 0, 1.0f), 0, 0);
+	queue.Push(RenderQueue::MakeKey(0, 1, 0, 1.0f), 1, 0);
+	queue.Push(RenderQueue::MakeKey(0, 0, 1, 1.0f), 2, 1);
+	queue.Push(RenderQueue::MakeKey(0, 0, 0, 5.0f), 3, 0);
+	queue.Push(RenderQueue::MakeKey(0, 0, 0, 2.0f), 4, 0);
+	queue.Sort();
+
+	const std::vector<RenderQueue::Item>& items = queue.GetItems();
+	const unsigned int expected[] = { 4, 3, 2, 1, 0 };
+	CHECK(items.size() == 5);
+	for (size_t i = 0; i < items.size(); i++)
+		CHECK(items[i].index == expected[i]);
+
+	// Far to near when asked
+	queue.Clear();
+	queue.Push(RenderQueue::MakeKey(0, 0, 0, 2.0f, true), 0, 0);
+	queue.Push(RenderQueue::MakeKey(0, 0, 0, 8.0f, true), 1, 0);
+	queue.Push(RenderQueue::MakeKey(0, 0, 0, 4.0f, true), 2, 0);
+	queue.Sort();
+	CHECK(queue.GetItems()[0].index == 1);
+	CHECK(queue.GetItems()[1].index == 2);
+	CHECK(queue.GetItems()[2].index == 0);
+}
+
+
+TEST(SortMatchesStableSort)
+{
+	RenderQueue queue;
+	PushRandomDraws(queue, 20000, 8, 200);
+	std::vector<RenderQueue::Item> reference = queue.GetItems();
+	std::stable_sort(reference.begin(), reference.end(),
+		[](const RenderQueue::Item& a, const RenderQueue::Item& b) { return a.key < b.key; });
+
+	queue.Sort();
+	const std::vector<RenderQueue::Item>& sorted = queue.GetItems();
+	CHECK(sorted.size() == reference.size());
+	bool same = sorted.size() == reference.size();
+	for (size_t i = 0; same && i < sorted.size(); i++)
+		same = sorted[i].key == reference[i].key && sorted[i].index == reference[i].index && sorted[i].mesh == reference[i].mesh;
+	CHECK(same);
+}
+
+
+TEST(SkipsRepeatedBinds)
+{
+	RenderQueue queue;
+	PushRandomDraws(queue, 20000, 8, 200);
+	queue.Sort();
+	const std::vector<RenderQueue::DrawCall>& calls = queue.BuildDrawCalls();
+	const std::vector<RenderQueue::Item>& items = queue.GetItems();
+
+	CHECK(calls.size() == items.size());
+	CHECK(calls[0].bindShader && calls[0].bindMesh);
+	int shaderBinds = 0;
+	int meshBinds = 0;
+	for (size_t i = 0; i < calls.size(); i++)
+	{
+		CHECK(calls[i].index == items[i].index);
+		shaderBinds += calls[i].bindShader;
+		meshBinds += calls[i].bindMesh;
+	}
+
+	// 2 layers of 8 shaders, each with up to 200 meshes
+	RenderQueue::Stats stats = queue.GetStats();
+	CHECK(stats.drawCalls == 20000);
+	CHECK(stats.shaderBinds == shaderBinds && stats.meshBinds == meshBinds);
+	CHECK(stats.shaderBinds <= 16);
+	CHECK(stats.meshBinds <= 16 * 200);
+	CHECK(stats.shaderBindsSkipped + stats.shaderBinds == stats.drawCalls);
+	CHECK(stats.meshBindsSkipped + stats.meshBinds == stats.drawCalls);
+}
+
+
+TEST(MeshIdsSharingKeyBitsStillBind)
+{
+	// Slot 7 before and after being reused (a new generation in
+	// the high bits), so the keys can't tell them apart
+	const unsigned int oldMesh = (1u << 16) | 7;
+	const unsigned int newMesh = (2u << 16) | 7;
+	RenderQueue queue;
+	queue.Push(RenderQueue::MakeKey(0, 0, 7, 1.0f), 0, oldMesh);
+	queue.Push(RenderQueue::MakeKey(0, 0, 7, 2.0f), 1, newMesh);
+	queue.Push(RenderQueue::MakeKey(0, 0, 7, 3.0f), 2, newMesh);
+	queue.Sort();
+
+	const std::vector<RenderQueue::DrawCall>& calls = queue.BuildDrawCalls();
+	CHECK(calls.size() == 3);
+	CHECK(calls[0].bindMesh);
+	CHECK(calls[1].bindMesh);
+	CHECK(!calls[2].bindMesh);
+	CHECK(queue.GetStats().meshBinds == 2);
+}
+
+
+TEST(EmptyAndSingle)
+{
+	RenderQueue queue;
+	queue.Sort();
+	CHECK(queue.BuildDrawCalls().empty());
+
+	queue.Push(RenderQueue::MakeKey(0, 0, 0, 1.0f), 9, 0);
+	queue.Sort();
+	const std::vector<RenderQueue::DrawCall>& calls = queue.BuildDrawCalls();
+	CHECK(calls.size() == 1 && calls[0].index == 9 && calls[0].bindShader && calls[0].bindMesh);
+}
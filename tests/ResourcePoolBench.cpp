@@ -0,0 +1,90 @@
+#include "BenchHarness.h"
+#include "ResourcePool.h"
+
+#include <memory>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	// What a draw reads from a Mesh, without the D3D buffers
+	struct PooledMesh
+	{
+		unsigned int id;
+		unsigned int indexCount;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// Entities the old way, and the new
+	struct SharedMeshEntity
+	{
+		std::shared_ptr<PooledMesh> mesh;
+		std::shared_ptr<PooledMesh> GetMesh() { return mesh; }
+	};
+
+	struct HandleMeshEntity
+	{
+		ResourcePool<PooledMesh>::Handle mesh;
+		ResourcePool<PooledMesh>::Handle GetMesh() { return mesh; }
+	};
+}
+
+
+BENCH(HandleAgainstSharedPtr)
+{
+	// A few meshes shared by lots of entities, like the scene.
+	// Each entity's mesh is looked up through a copied shared_ptr
+	// (an atomic increment and decrement each), then through a
+	// pool handle
+	const unsigned int MeshCount = 64;
+	const int EntityCount = 100000;
+	const int Iterations = 100;
+	std::vector<std::shared_ptr<PooledMesh>> sharedMeshes;
+	ResourcePool<PooledMesh> pool(MeshCount);
+	std::vector<ResourcePool<PooledMesh>::Handle> handles;
+	for (unsigned int i = 0; i < MeshCount; i++)
+	{
+		PooledMesh mesh = { i, 3 * (i + 1), { -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f } };
+		sharedMeshes.push_back(std::make_shared<PooledMesh>(mesh));
+		handles.push_back(pool.Create(mesh));
+	}
+
+	std::vector<SharedMeshEntity> sharedEntities(EntityCount);
+	std::vector<HandleMeshEntity> handleEntities(EntityCount);
+	for (int i = 0; i < EntityCount; i++)
+	{
+		sharedEntities[i].mesh = sharedMeshes[i % MeshCount];
+		handleEntities[i].mesh = handles[i % MeshCount];
+	}
+
+	unsigned int sharedChecksum = 0;
+	Clock::time_point start = Clock::now();
+	for (int iteration = 0; iteration < Iterations; iteration++)
+	{
+		for (SharedMeshEntity& entity : sharedEntities)
+		{
+			std::shared_ptr<PooledMesh> mesh = entity.GetMesh();
+			sharedChecksum += mesh->id + mesh->indexCount;
+		}
+	}
+	BenchHarness::Report("shared_ptr copy, per lookup", SecondsSince(start) * 1e9 / ((double)EntityCount * Iterations), "ns");
+
+	unsigned int handleChecksum = 0;
+	start = Clock::now();
+	for (int iteration = 0; iteration < Iterations; iteration++)
+	{
+		for (HandleMeshEntity& entity : handleEntities)
+		{
+			PooledMesh* mesh = pool.Get(entity.GetMesh());
+			handleChecksum += mesh->id + mesh->indexCount;
+		}
+	}
+	BenchHarness::Report("Handle, per lookup", SecondsSince(start) * 1e9 / ((double)EntityCount * Iterations), "ns");
+
+	// Both read the same meshes, and keep the loops from being optimized out
+	BenchHarness::ReportCount("Checksums match", sharedChecksum == handleChecksum);
+}
@@ -0,0 +1,94 @@
+#include "TestHarness.h"
+#include "ResourcePool.h"
+
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// What a draw reads from a Mesh, without the D3D buffers.
+	// Counts the live ones so leaks and double destroys show
+	struct PooledMesh
+	{
+		static int live;
+
+		unsigned int id;
+		std::string name;
+
+		PooledMesh(unsigned int pId, const std::string& pName) : id(pId), name(pName) { live++; }
+		~PooledMesh() { live--; }
+	};
+
+	int PooledMesh::live = 0;
+}
+
+
+TEST(HandlesFindTheirObject)
+{
+	ResourcePool<PooledMesh> pool(64);
+	std::vector<ResourcePool<PooledMesh>::Handle> handles;
+	for (unsigned int i = 0; i < 64; i++)
+		handles.push_back(pool.Create(i, "Mesh " + std::to_string(i)));
+	CHECK(pool.GetCount() == 64);
+	CHECK(PooledMesh::live == 64);
+
+	bool found = true;
+	for (unsigned int i = 0; i < 64; i++)
+		found = found && pool.Get(handles[i]) && pool.Get(handles[i])->id == i && handles[i].GetIndex() == i;
+	CHECK(found);
+
+	// Full, and a zeroed handle is never valid
+	CHECK(pool.Create(64u, std::string("Too many")) == ResourcePool<PooledMesh>::Handle{ 0 });
+	CHECK(!pool.Get(ResourcePool<PooledMesh>::Handle{ 0 }));
+	CHECK(!pool.Get(ResourcePool<PooledMesh>::Handle{ (1u << 16) | 100 }));
+}
+
+
+TEST(StaleHandlesAreRejected)
+{
+	// Unload one, then load something new into its slot
+	ResourcePool<PooledMesh> pool(8);
+	ResourcePool<PooledMesh>::Handle stale = pool.Create(1u, std::string("Cube"));
+	pool.Create(2u, std::string("Sphere"));
+	CHECK(pool.Destroy(stale));
+	CHECK(PooledMesh::live == 1);
+
+	ResourcePool<PooledMesh>::Handle reused = pool.Create(1000u, std::string("Helix"));
+	CHECK(reused.GetIndex() == stale.GetIndex());
+	CHECK(reused.GetGeneration() != stale.GetGeneration());
+	CHECK(!pool.Get(stale));
+	CHECK(!pool.Destroy(stale));
+	CHECK(pool.Get(reused) && pool.Get(reused)->id == 1000);
+	CHECK(pool.GetCount() == 2);
+}
+
+
+TEST(GenerationsWrapPastZero)
+{
+	// A slot reused 0xFFFF times skips generation 0, so a
+	// zeroed handle still never matches
+	ResourcePool<PooledMesh> pool(1);
+	bool nonZero = true;
+	for (unsigned int i = 0; i < 0x10000; i++)
+	{
+		ResourcePool<PooledMesh>::Handle handle = pool.Create(i, std::string());
+		nonZero = nonZero && handle.GetGeneration() != 0;
+		pool.Destroy(handle);
+	}
+	CHECK(nonZero);
+	CHECK(pool.GetCount() == 0);
+	CHECK(!pool.Get(ResourcePool<PooledMesh>::Handle{ 0 }));
+}
+
+
+TEST(PoolDestroysWhatsLeft)
+{
+	{
+		ResourcePool<PooledMesh> pool(16);
+		for (unsigned int i = 0; i < 10; i++)
+			pool.Create(i, std::string("Mesh"));
+		CHECK(PooledMesh::live == 10);
+	}
+	CHECK(PooledMesh::live == 0);
+}
@@ -0,0 +1,192 @@
+#include "TestHarness.h"
+#include "SceneFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// Where SceneFile's header keeps the positions section's offset
+	const size_t PositionsOffsetAt = 48;
+
+	SceneData MakeScene(unsigned int entityCount)
+	{
+		std::mt19937 random(45);
+		auto between = [&random](float low, float high) { return low + (high - low) * (random() % 100000) / 100000.0f; };
+
+		SceneData scene;
+		scene.meshNames = { "Triangle", "Quad", "The weird one" };
+		for (unsigned int i = 0; i < entityCount; i++)
+		{
+			float position[3] = { between(-500.0f, 500.0f), between(-500.0f, 500.0f), between(-500.0f, 500.0f) };
+			float rotation[3] = { between(-3.14159f, 3.14159f), between(-3.14159f, 3.14159f), between(-3.14159f, 3.14159f) };
+			float scale[3] = { between(0.25f, 4.0f), between(0.25f, 4.0f), between(0.25f, 4.0f) };
+			scene.AddEntity(i % 3, position, rotation, scale, i % 50 == 0 ? SceneData::EntityOccluder : 0);
+		}
+
+		SceneData::CameraDesc camera = { { 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f, 0.0f }, 1.5708f, 0.01f, 500.0f, 1.0f, 0.01f, 10.0f, SceneData::CameraPerspective };
+		scene.cameras.push_back(camera);
+		camera.flags |= SceneData::CameraReversedZ;
+		scene.cameras.push_back(camera);
+		scene.activeCamera = 1;
+		return scene;
+	}
+
+	bool Same(const SceneData& a, const SceneData& b)
+	{
+		return a.meshNames == b.meshNames && a.positions == b.positions && a.rotations == b.rotations &&
+			a.scales == b.scales && a.meshes == b.meshes && a.entityFlags == b.entityFlags &&
+			a.cameras.size() == b.cameras.size() && a.activeCamera == b.activeCamera &&
+			memcmp(a.cameras.data(), b.cameras.data(), a.cameras.size() * sizeof(SceneData::CameraDesc)) == 0;
+	}
+
+	std::vector<char> ReadBytes(const std::string& path)
+	{
+		std::error_code error;
+		std::vector<char> bytes((size_t)std::filesystem::file_size(path, error));
+		std::ifstream(path, std::ios::binary).read(bytes.data(), bytes.size());
+		return bytes;
+	}
+
+	void WriteBytes(const std::string& path, const std::vector<char>& bytes)
+	{
+		std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), bytes.size());
+	}
+}
+
+
+TEST(BinaryRoundTrip)
+{
+	std::string folder = TestHarness::MakeTempFolder("SceneFileBinary");
+	std::string path = folder + "/Scene.bin";
+	SceneData scene = MakeScene(10000);
+	CHECK(scene.GetEntityCount() == 10000);
+	CHECK(SceneFile::Save(path, scene));
+
+	SceneData loaded;
+	CHECK(SceneFile::Load(path, loaded));
+	CHECK(Same(scene, loaded));
+
+	// Nothing left over from before
+	CHECK(SceneFile::Load(path, loaded));
+	CHECK(loaded.GetEntityCount() == 10000);
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(ReadFromMemory)
+{
+	// The file as the AssetStreamer hands it over, then the
+	// same bytes one past an aligned address
+	std::string folder = TestHarness::MakeTempFolder("SceneFileMemory");
+	std::string path = folder + "/Scene.bin";
+	SceneData scene = MakeScene(1000);
+	CHECK(SceneFile::Save(path, scene));
+	std::vector<char> bytes = ReadBytes(path);
+
+	SceneData loaded;
+	CHECK(SceneFile::Read((const unsigned char*)bytes.data(), bytes.size(), path, loaded));
+	CHECK(Same(scene, loaded));
+
+	std::vector<char> shifted(bytes.size() + 1);
+	memcpy(shifted.data() + 1, bytes.data(), bytes.size());
+	CHECK(!SceneFile::Read((const unsigned char*)shifted.data() + 1, bytes.size(), path, loaded));
+	CHECK(Same(scene, loaded));
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(TextRoundTrip)
+{
+	std::string folder = TestHarness::MakeTempFolder("SceneFileText");
+	std::string path = folder + "/Scene.json";
+	SceneData scene = MakeScene(500);
+	SceneData loaded;
+	CHECK(SceneFile::SaveText(path, scene));
+	CHECK(SceneFile::LoadText(path, loaded));
+	CHECK(Same(scene, loaded));
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(SaverWritesInTheBackground)
+{
+	std::string folder = TestHarness::MakeTempFolder("SceneFileSaver");
+	std::string path = folder + "/Scene.bin";
+	SceneData scene = MakeScene(2000);
+	SceneData moved = scene;
+	SceneData loaded;
+	{
+		SceneSaver saver;
+		CHECK(saver.Save(scene, path));
+		saver.Wait();
+		CHECK(!saver.IsBusy() && saver.Succeeded());
+		CHECK(SceneFile::Load(path, loaded) && Same(scene, loaded));
+
+		CHECK(saver.Save(std::move(moved), path, folder + "/Scene.json"));
+		saver.Wait();
+		CHECK(saver.Succeeded());
+	}
+	CHECK(SceneFile::LoadText(folder + "/Scene.json", loaded) && Same(scene, loaded));
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(DamagedFilesAreRejected)
+{
+	std::string folder = TestHarness::MakeTempFolder("SceneFileDamaged");
+	std::string path = folder + "/Scene.bin";
+	std::string damagedPath = folder + "/Damaged.bin";
+	SceneData scene = MakeScene(1000);
+	CHECK(SceneFile::Save(path, scene));
+	std::vector<char> bytes = ReadBytes(path);
+	auto rejects = [&](const std::vector<char>& contents)
+		{
+			WriteBytes(damagedPath, contents);
+			SceneData damaged;
+			return !SceneFile::Load(damagedPath, damaged);
+		};
+
+	// Cut short, a newer version, and a section that can't be
+	// read in place
+	std::vector<char> truncated(bytes.begin(), bytes.begin() + bytes.size() / 2);
+	std::vector<char> newer = bytes;
+	newer[4]++;
+	std::vector<char> misaligned = bytes;
+	misaligned[PositionsOffsetAt]++;
+	CHECK(rejects(truncated));
+	CHECK(rejects(newer));
+	CHECK(rejects(misaligned));
+	CHECK(!rejects(bytes));
+
+	// Saving won't write a bad mesh index, so edit the text
+	std::string textPath = folder + "/Scene.json";
+	CHECK(SceneFile::SaveText(textPath, scene));
+	std::vector<char> textBytes = ReadBytes(textPath);
+	std::string text(textBytes.begin(), textBytes.end());
+	size_t meshAt = text.find("\"mesh\": ");
+	CHECK(meshAt != std::string::npos);
+	text.replace(meshAt, 9, "\"mesh\": 7");
+	WriteBytes(textPath, std::vector<char>(text.begin(), text.end()));
+	SceneData fromText;
+	CHECK(!SceneFile::LoadText(textPath, fromText));
+
+	scene.meshes[0] = 7;
+	CHECK(!SceneFile::Save(damagedPath, scene));
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
@@ -0,0 +1,233 @@
+#include "TestHarness.h"
+#include "FakeShaderCompiler.h"
+#include "ShaderCache.h"
+#include "ShaderManager.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	void WriteTextFile(const std::string& path, const std::string& text)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file << text;
+	}
+
+	// Rewrites a source and moves its time stamp on, even on file
+	// systems with coarse times
+	void EditFile(const std::string& path, const std::string& text)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+		WriteTextFile(path, text);
+		std::filesystem::last_write_time(path, time + std::chrono::seconds(2), error);
+	}
+
+	// A few pixel shaders, each remembering the bytecode it was last created with
+	struct ShaderSet
+	{
+		std::vector<ShaderManager::ShaderDesc> descs;
+		std::vector<std::vector<unsigned char>> created;
+
+		ShaderSet(const std::string& folder, int count)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				std::string path = folder + "/Shader" + std::to_string(i) + ".hlsl";
+				WriteTextFile(path, "float4 main() : SV_TARGET { return " + std::to_string(i) + "; }");
+				descs.push_back({ path, "main", "ps_5_0", { { "INDEX", std::to_string(i) } }, "" });
+			}
+			created.resize(count);
+		}
+
+		void AddTo(ShaderManager& manager)
+		{
+			for (size_t i = 0; i < descs.size(); i++)
+				manager.Add(descs[i], [this, i](unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)
+					{
+						created[i] = bytecode;
+						return true;
+					});
+		}
+	};
+}
+
+
+TEST(CacheKeyCoversEveryInput)
+{
+	ShaderCache::Defines defines = { { "FOG", "1" } };
+	unsigned long long key = ShaderCache::MakeKey("source", defines, "main", "vs_5_0", "compiler");
+	CHECK(key == ShaderCache::MakeKey("source", defines, "main", "vs_5_0", "compiler"));
+	CHECK(key != ShaderCache::MakeKey("source2", defines, "main", "vs_5_0", "compiler"));
+	CHECK(key != ShaderCache::MakeKey("source", {}, "main", "vs_5_0", "compiler"));
+	CHECK(key != ShaderCache::MakeKey("source", { { "FOG", "0" } }, "main", "vs_5_0", "compiler"));
+	CHECK(key != ShaderCache::MakeKey("source", defines, "main2", "vs_5_0", "compiler"));
+	CHECK(key != ShaderCache::MakeKey("source", defines, "main", "ps_5_0", "compiler"));
+	CHECK(key != ShaderCache::MakeKey("source", defines, "main", "vs_5_0", "compiler2"));
+}
+
+
+TEST(CacheStoresAndLoads)
+{
+	std::string folder = TestHarness::MakeTempFolder("ShaderCacheTests");
+	ShaderCache cache(folder);
+	std::vector<unsigned char> bytecode = { 1, 2, 3, 4, 5 };
+	std::vector<unsigned char> loaded;
+	std::string metadata;
+	CHECK(!cache.Load(42, loaded, metadata));
+	CHECK(cache.Store(42, bytecode, "input POSITION 0 float 3\n"));
+	CHECK(cache.Load(42, loaded, metadata));
+	CHECK(loaded == bytecode);
+	CHECK(metadata == "input POSITION 0 float 3\n");
+
+	// Cut short, it's a miss rather than bad bytecode
+	std::error_code error;
+	std::filesystem::resize_file(cache.GetPath(42), std::filesystem::file_size(cache.GetPath(42), error) - 2, error);
+	CHECK(!cache.Load(42, loaded, metadata));
+
+	ShaderCache::Stats stats = cache.GetStats();
+	CHECK(stats.hits == 1 && stats.misses == 2 && stats.stores == 1);
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(WarmStartCompilesNothing)
+{
+	std::string folder = TestHarness::MakeTempFolder("ShaderManagerWarm");
+	std::shared_ptr<ShaderCompiler> compiler = std::make_shared<FakeShaderCompiler>();
+	ShaderSet set(folder, 8);
+	std::vector<std::vector<unsigned char>> coldBytecode;
+	{
+		ShaderManager cold(compiler, folder + "/Cache", 0.0);
+		set.AddTo(cold);
+		CHECK(cold.GetStats().compiles == 8);
+		CHECK(cold.GetStats().cacheMisses == 8);
+		for (unsigned int i = 0; i < 8; i++)
+			CHECK(cold.IsLoaded(i) && cold.GetVersion(i) == 1);
+		coldBytecode = set.created;
+	}
+
+	ShaderManager warm(compiler, folder + "/Cache", 0.0);
+	set.AddTo(warm);
+	CHECK(warm.GetStats().compiles == 0);
+	CHECK(warm.GetStats().cacheHits == 8);
+	CHECK(set.created == coldBytecode);
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(EditsReloadInTheBackground)
+{
+	std::string folder = TestHarness::MakeTempFolder("ShaderManagerEdits");
+	std::shared_ptr<ShaderCompiler> compiler = std::make_shared<FakeShaderCompiler>();
+	ShaderSet set(folder, 2);
+	ShaderManager manager(compiler, folder + "/Cache", 0.0);
+	set.AddTo(manager);
+
+	std::vector<unsigned char> before = set.created[0];
+	EditFile(set.descs[0].sourcePath, "float4 main() : SV_TARGET { return 0.5; }");
+	manager.Update();
+	CHECK(manager.GetStats().pendingCompiles == 1);
+	manager.WaitIdle();
+	manager.Update();
+	CHECK(manager.GetVersion(0) == 2);
+	CHECK(manager.GetVersion(1) == 1);
+	CHECK(set.created[0] != before);
+	CHECK(manager.GetStats().reloads == 1);
+
+	// Broken: the last good version stays, and the errors are kept
+	before = set.created[0];
+	EditFile(set.descs[0].sourcePath, "#error broken");
+	manager.Update();
+	manager.WaitIdle();
+	manager.Update();
+	CHECK(manager.GetVersion(0) == 2);
+	CHECK(set.created[0] == before);
+	CHECK(!manager.GetErrors(0).empty());
+	CHECK(manager.GetStats().failedCompiles == 1);
+
+	// Back to the first edit: straight from the cache
+	unsigned int compiles = manager.GetStats().compiles;
+	EditFile(set.descs[0].sourcePath, "float4 main() : SV_TARGET { return 0.5; }");
+	manager.Update();
+	manager.WaitIdle();
+	manager.Update();
+	CHECK(manager.GetStats().compiles == compiles);
+	CHECK(manager.GetVersion(0) == 3);
+	CHECK(set.created[0] == before);
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(ReloadSkipsTheCache)
+{
+	// The included text isn't part of the key, so only a
+	// manual Reload() can pick up a change to it
+	std::string folder = TestHarness::MakeTempFolder("ShaderManagerReload");
+	std::shared_ptr<FakeShaderCompiler> compiler = std::make_shared<FakeShaderCompiler>();
+	compiler->SetIncludedText("old include");
+	ShaderSet set(folder, 1);
+	{
+		ShaderManager manager(compiler, folder + "/Cache", 0.0);
+		set.AddTo(manager);
+		std::string first(set.created[0].begin(), set.created[0].end());
+		CHECK(first.find("old include") != std::string::npos);
+
+		compiler->SetIncludedText("new include");
+		manager.Reload(0);
+		manager.WaitIdle();
+		manager.Update();
+		std::string reloaded(set.created[0].begin(), set.created[0].end());
+		CHECK(reloaded.find("new include") != std::string::npos);
+		CHECK(manager.GetVersion(0) == 2);
+		CHECK(manager.GetStats().compiles == 2);
+		CHECK(manager.GetStats().cacheHits == 0);
+	}
+
+	// The next run gets the reloaded bytecode from the cache
+	ShaderManager next(compiler, folder + "/Cache", 0.0);
+	set.AddTo(next);
+	std::string cached(set.created[0].begin(), set.created[0].end());
+	CHECK(next.GetStats().cacheHits == 1);
+	CHECK(cached.find("new include") != std::string::npos);
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
+
+
+TEST(FallbackWithoutSource)
+{
+	std::string folder = TestHarness::MakeTempFolder("ShaderManagerFallback");
+	std::string fallbackPath = folder + "/Shader.cso";
+	WriteTextFile(fallbackPath, "prebuilt");
+
+	std::shared_ptr<ShaderCompiler> compiler = std::make_shared<FakeShaderCompiler>();
+	ShaderManager manager(compiler, folder + "/Cache", 0.0);
+	std::vector<unsigned char> created;
+	ShaderManager::CreateFunction create = [&created](unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)
+		{
+			created = bytecode;
+			return true;
+		};
+	unsigned int withFallback = manager.Add({ folder + "/Missing.hlsl", "main", "ps_5_0", {}, fallbackPath }, create);
+	CHECK(manager.IsLoaded(withFallback));
+	CHECK(std::string(created.begin(), created.end()) == "prebuilt");
+	CHECK(manager.GetStats().compiles == 0);
+
+	unsigned int without = manager.Add({ folder + "/AlsoMissing.hlsl", "main", "ps_5_0", {}, "" }, create);
+	CHECK(!manager.IsLoaded(without));
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
@@ -0,0 +1,187 @@
+#include "TestHarness.h"
+#include "FakeShaderCompiler.h"
+#include "ShaderPermutations.h"
+#include "ShaderReflection.h"
+#include "SoftwareBackend.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	// The vertex, instance and constants in plain floats; Game
+	// checks they match Vertex, InstanceData and VertexShaderData
+	using InputVertex = SoftwareBackend::InputVertex;
+	using Instance = SoftwareBackend::Instance;
+	using Constants = SoftwareBackend::Constants;
+
+	// Vertex members, then instance members, like Game's formats
+	const std::vector<ShaderReflection::InputElement> VertexFormat =
+	{
+		{ "POSITION", 0, ShaderReflection::ComponentType::Float, 3, offsetof(InputVertex, position) },
+		{ "COLOR", 0, ShaderReflection::ComponentType::Float, 4, offsetof(InputVertex, color) },
+		{ "WORLD", 0, ShaderReflection::ComponentType::Float, 4, offsetof(Instance, world) },
+		{ "WORLD", 1, ShaderReflection::ComponentType::Float, 4, offsetof(Instance, world) + 16 },
+		{ "WORLD", 2, ShaderReflection::ComponentType::Float, 4, offsetof(Instance, world) + 32 },
+		{ "WORLD", 3, ShaderReflection::ComponentType::Float, 4, offsetof(Instance, world) + 48 },
+		{ "TINT", 0, ShaderReflection::ComponentType::Float, 4, offsetof(Instance, colorTint) },
+	};
+
+	const std::string Metadata = "input POSITION 0 float 3\ninput COLOR 0 float 4\n"
+		"input WORLD 0 float 4\ninput WORLD 1 float 4\ninput WORLD 2 float 4\ninput WORLD 3 float 4\ninput TINT 0 float 4\n"
+		"cbuffer ExternalData 0 64\nvariable viewProjection 0 64\n";
+
+	// Mirrors VertexShader.hlsl, plus a feature that doesn't change its inputs
+	const std::string VertexSource =
+		"//@ input POSITION 0 float 3\n"
+		"#if !FLAT_TINT\n"
+		"//@ input COLOR 0 float 4\n"
+		"#endif\n"
+		"//@ input WORLD 0 float 4\n"
+		"//@ input WORLD 1 float 4\n"
+		"//@ input WORLD 2 float 4\n"
+		"//@ input WORLD 3 float 4\n"
+		"//@ input TINT 0 float 4\n"
+		"//@ cbuffer ExternalData 0 64\n"
+		"//@ variable viewProjection 0 64\n"
+		"#if FOG\n"
+		"//@ cbuffer FogData 1 16\n"
+		"//@ variable fogColor 0 16\n"
+		"#endif\n";
+}
+
+
+TEST(ParseAndSerializeRoundTrip)
+{
+	ShaderReflection reflection;
+	CHECK(reflection.Parse(Metadata));
+	CHECK(reflection.Serialize() == Metadata);
+	CHECK(reflection.GetInputs().size() == 7);
+	CHECK(reflection.GetConstantBuffers().size() == 1);
+
+	const ShaderReflection::Variable* variable = reflection.FindVariable("ExternalData", "viewProjection");
+	CHECK(variable && variable->offset == 0 && variable->size == 64);
+	CHECK(!reflection.FindVariable("ExternalData", "missing"));
+	CHECK(!reflection.FindConstantBuffer("Missing"));
+
+	// Variables need a cbuffer line before them
+	CHECK(!ShaderReflection().Parse("variable viewProjection 0 64\n"));
+}
+
+
+TEST(LayoutAndConstantsMatchTheVertex)
+{
+	ShaderReflection reflection;
+	CHECK(reflection.Parse(Metadata));
+
+	std::string errors;
+	std::vector<ShaderReflection::InputElement> layout;
+	CHECK(reflection.BuildInputLayout(VertexFormat, layout, errors));
+	CHECK(layout.size() == 7);
+	CHECK(layout.size() == 7 && layout[0].offset == offsetof(InputVertex, position) && layout[1].offset == offsetof(InputVertex, color));
+	CHECK(layout.size() == 7 && layout[5].offset == offsetof(Instance, world) + 48 && layout[6].offset == offsetof(Instance, colorTint));
+	CHECK(reflection.CheckVariable("ExternalData", "viewProjection", offsetof(Constants, viewProjection), sizeof(Constants::viewProjection), errors));
+	CHECK(errors.empty());
+}
+
+
+TEST(MismatchesAreReported)
+{
+	// A moved variable (the cbuffer from before the instance
+	// buffer), a member the vertex doesn't have and a type mismatch
+	ShaderReflection broken;
+	CHECK(broken.Parse("input POSITION 0 float 3\ninput TEXCOORD 0 float 2\ninput COLOR 0 uint 4\n"
+		"cbuffer ExternalData 0 80\nvariable colorTint 0 16\nvariable viewProjection 16 64\n"));
+
+	std::string errors;
+	std::vector<ShaderReflection::InputElement> layout;
+	CHECK(!broken.BuildInputLayout(VertexFormat, layout, errors));
+	CHECK(std::count(errors.begin(), errors.end(), '\n') == 1);
+
+	errors.clear();
+	CHECK(!broken.CheckVariable("ExternalData", "viewProjection", offsetof(Constants, viewProjection), sizeof(Constants::viewProjection), errors));
+	CHECK(!errors.empty());
+}
+
+
+TEST(SameInputsSameSignature)
+{
+	ShaderReflection a;
+	ShaderReflection b;
+	ShaderReflection c;
+	CHECK(a.Parse(Metadata));
+	CHECK(b.Parse(Metadata + "cbuffer FogData 1 16\nvariable fogColor 0 16\n"));
+	CHECK(c.Parse("input POSITION 0 float 3\n"));
+	CHECK(a.GetInputSignature() == b.GetInputSignature());
+	CHECK(a.GetInputSignature() != c.GetInputSignature());
+}
+
+
+TEST(PermutationsLoadAndCache)
+{
+	std::string folder = TestHarness::MakeTempFolder("ShaderPermutationsTests");
+	std::string sourcePath = folder + "/VertexShader.hlsl";
+	std::ofstream(sourcePath, std::ios::binary) << VertexSource;
+
+	// What Game's create function checks, minus the D3D objects
+	std::vector<unsigned long long> signatures;
+	bool layoutsMatch = true;
+	bool constantsMatch = true;
+	bool fogBuffers = true;
+	ShaderManager::CreateFunction create = [&](unsigned int shader, const std::vector<unsigned char>& bytecode, const ShaderReflection& reflection)
+		{
+			std::string errors;
+			constantsMatch = constantsMatch &&
+				reflection.CheckVariable("ExternalData", "viewProjection", offsetof(Constants, viewProjection), sizeof(Constants::viewProjection), errors);
+
+			std::vector<ShaderReflection::InputElement> layout;
+			layoutsMatch = layoutsMatch && reflection.BuildInputLayout(VertexFormat, layout, errors) &&
+				layout.size() == reflection.GetInputs().size() && layout[0].offset == offsetof(InputVertex, position);
+
+			if (std::find(signatures.begin(), signatures.end(), reflection.GetInputSignature()) == signatures.end())
+				signatures.push_back(reflection.GetInputSignature());
+			return true;
+		};
+
+	std::shared_ptr<ShaderCompiler> compiler = std::make_shared<FakeShaderCompiler>();
+	ShaderManager::ShaderDesc desc = { sourcePath, "main", "vs_5_0", {}, "" };
+	std::vector<std::string> features = { "FLAT_TINT", "FOG" };
+
+	// The second pass gets everything, reflection included, from the cache
+	for (int pass = 0; pass < 2; pass++)
+	{
+		signatures.clear();
+		std::shared_ptr<ShaderManager> manager = std::make_shared<ShaderManager>(compiler, folder + "/Cache", 0.0);
+		ShaderPermutations permutations(manager, desc, features, create);
+		for (unsigned int bits = 0; bits < 4; bits++)
+		{
+			unsigned int shader = permutations.Get(bits);
+			CHECK(permutations.Get(bits) == shader);
+			CHECK(manager->IsLoaded(shader));
+			fogBuffers = fogBuffers && (manager->GetReflection(shader).FindConstantBuffer("FogData") != nullptr) == ((bits & 2) != 0);
+		}
+
+		CHECK(permutations.GetVariantCount() == 4);
+		CHECK(permutations.GetFeatureBit("FOG") == 2);
+		CHECK(manager->GetStats().compiles == (pass == 0 ? 4u : 0u));
+
+		// Every feature is defined, on or off
+		ShaderCache::Defines defines = permutations.GetDefines(1);
+		CHECK(defines.size() == 2 && defines[0].second == "1" && defines[1].second == "0");
+	}
+	CHECK(layoutsMatch);
+	CHECK(constantsMatch);
+	CHECK(fogBuffers);
+
+	// With and without COLOR
+	CHECK(signatures.size() == 2);
+
+	std::error_code error;
+	std::filesystem::remove_all(folder, error);
+}
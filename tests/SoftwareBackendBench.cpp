@@ -0,0 +1,97 @@
+#include "BenchHarness.h"
+#include "TestMath.h"
+#include "SoftwareBackend.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using namespace TestMath;
+	using BenchHarness::Clock;
+	using BenchHarness::SecondsSince;
+
+	const unsigned int BoxIndices[] =
+	{
+		0, 2, 1,   0, 3, 2,   4, 5, 6,   4, 6, 7,   0, 1, 5,   0, 5, 4,
+		3, 6, 2,   3, 7, 6,   0, 4, 7,   0, 7, 3,   1, 2, 6,   1, 6, 5,
+	};
+
+	// 2000 boxes of different sizes scattered in front of a
+	// camera at the origin, registered as mesh 0
+	void BuildScene(SoftwareBackend& backend, CommandList& commands)
+	{
+		SoftwareBackend::InputVertex vertices[8];
+		for (int i = 0; i < 8; i++)
+		{
+			vertices[i] = {
+				{ (i == 1 || i == 2 || i == 5 || i == 6) ? 0.5f : -0.5f, (i == 2 || i == 3 || i == 6 || i == 7) ? 0.5f : -0.5f, i < 4 ? -0.5f : 0.5f },
+				{ (i & 1) ? 1.0f : 0.2f, (i & 2) ? 1.0f : 0.2f, (i & 4) ? 1.0f : 0.2f, 1.0f } };
+		}
+		backend.RegisterMesh(0, vertices, 8, BoxIndices, 36);
+
+		float projection[16];
+		PerspectiveFovLH(1.2f, (float)backend.GetWidth() / backend.GetHeight(), 0.1f, 200.0f, projection);
+
+		std::mt19937 random(99);
+		auto spread = [&random](float low, float high) { return low + (high - low) * (random() % 10000) / 10000.0f; };
+		std::vector<SoftwareBackend::Instance> instances(2000);
+		for (SoftwareBackend::Instance& instance : instances)
+		{
+			float sx = spread(0.3f, 3.0f);
+			float sy = spread(0.3f, 3.0f);
+			float sz = spread(0.3f, 3.0f);
+			float x = spread(-20.0f, 20.0f);
+			float y = spread(-10.0f, 10.0f);
+			float z = spread(5.0f, 60.0f);
+			ScaleTranslation(sx, sy, sz, x, y, z, &instance.world[0][0]);
+			std::fill(instance.colorTint, instance.colorTint + 4, 1.0f);
+		}
+
+		const float clearColor[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
+		SoftwareBackend::Constants constants;
+		memcpy(constants.viewProjection, projection, sizeof(projection));
+		commands.ClearTargets(clearColor, 1.0f);
+		commands.UpdateInstances(instances.data(), sizeof(SoftwareBackend::Instance), (unsigned int)instances.size());
+		commands.BindShaders(0);
+		commands.UpdateConstants(0, &constants, sizeof(constants));
+		commands.BindMesh(0);
+		for (unsigned int i = 0; i < instances.size(); i++)
+			commands.DrawInstanced(36, 1, 0, 0, i);
+	}
+
+	void Run(SoftwareBackend& backend, const CommandList& commands, const char* label)
+	{
+		const int Frames = 10;
+		backend.Execute(commands);	// Warms up the bins
+		backend.ResetStats();
+
+		Clock::time_point start = Clock::now();
+		for (int frame = 0; frame < Frames; frame++)
+			backend.Execute(commands);
+		double seconds = SecondsSince(start);
+		SoftwareBackend::Stats stats = backend.GetStats();
+
+		std::string prefix = label;
+		BenchHarness::Report((prefix + ", frame").c_str(), seconds * 1000.0 / Frames, "ms");
+		BenchHarness::Report((prefix + ", triangles").c_str(), stats.triangles / seconds / 1000000.0, "M/s");
+		BenchHarness::Report((prefix + ", pixels").c_str(), stats.pixels / seconds / 1000000.0, "M/s");
+	}
+}
+
+
+BENCH(TwoThousandBoxesAt720p)
+{
+	SoftwareBackend backend(1280, 720);
+	CommandList commands;
+	BuildScene(backend, commands);
+	BenchHarness::ReportCount("Uses SIMD", SoftwareBackend::UsesSIMD());
+
+	Run(backend, commands, "Multithreaded");
+	backend.SetMultithreaded(false);
+	Run(backend, commands, "One thread");
+}
@@ -0,0 +1,230 @@
+#include "TestHarness.h"
+#include "SoftwareBackend.h"
+#include "TestMath.h"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	using namespace TestMath;
+	using InputVertex = SoftwareBackend::InputVertex;
+
+	const int Width = 256;
+	const int Height = 144;
+	const float ClearColor[4] = { 0.4f, 0.6f, 0.75f, 0.0f };
+
+	// Mesh ids, as BindMesh sees them
+	enum MeshId { Triangle, Quad, Weird, Box };
+
+	// Game's three hardcoded meshes, plus a box with a different
+	// color in each corner (front faces clockwise)
+	void RegisterMeshes(SoftwareBackend& backend)
+	{
+		const float red[4] = { 1.0f, 0.0f, 0.0f, 1.0f };
+		const float green[4] = { 0.0f, 1.0f, 0.0f, 1.0f };
+		const float blue[4] = { 0.0f, 0.0f, 1.0f, 1.0f };
+		const float black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		const float gray[4] = { 0.5f, 0.5f, 0.5f, 1.0f };
+		auto vertex = [](float x, float y, const float color[4])
+			{
+				return InputVertex{ { x, y, 0.0f }, { color[0], color[1], color[2], color[3] } };
+			};
+
+		InputVertex triangleVertices[] = { vertex(0.0f, 0.5f, red), vertex(0.5f, -0.5f, blue), vertex(-0.5f, -0.5f, green) };
+		unsigned int triangleIndices[] = { 0, 1, 2 };
+		backend.RegisterMesh(Triangle, triangleVertices, 3, triangleIndices, 3);
+
+		InputVertex quadVertices[] = { vertex(-0.25f, 0.0f, blue), vertex(0.0f, 0.25f, red), vertex(0.0f, 0.0f, red), vertex(-0.25f, 0.25f, blue) };
+		unsigned int quadIndices[] = { 0, 1, 2,   0, 3, 1 };
+		backend.RegisterMesh(Quad, quadVertices, 4, quadIndices, 6);
+
+		InputVertex weirdVertices[] =
+		{
+			vertex(-0.25f, 0.0f, gray), vertex(0.25f, 0.125f, black), vertex(0.0f, 0.0f, gray), vertex(-0.125f, 0.25f, black),
+			vertex(-0.25f, 0.0f, gray), vertex(0.25f, -0.125f, black), vertex(0.0f, 0.0f, gray), vertex(-0.125f, -0.25f, black)
+		};
+		unsigned int weirdIndices[] = { 0, 1, 2,   0, 3, 1,   4, 6, 5,   4, 5, 7 };
+		backend.RegisterMesh(Weird, weirdVertices, 8, weirdIndices, 12);
+
+		InputVertex boxVertices[8];
+		for (int i = 0; i < 8; i++)
+		{
+			boxVertices[i] = {
+				{ (i == 1 || i == 2 || i == 5 || i == 6) ? 0.5f : -0.5f, (i == 2 || i == 3 || i == 6 || i == 7) ? 0.5f : -0.5f, i < 4 ? -0.5f : 0.5f },
+				{ (i & 1) ? 1.0f : 0.2f, (i & 2) ? 1.0f : 0.2f, (i & 4) ? 1.0f : 0.2f, 1.0f } };
+		}
+		unsigned int boxIndices[] =
+		{
+			0, 2, 1,   0, 3, 2,   4, 5, 6,   4, 6, 7,   0, 1, 5,   0, 5, 4,
+			3, 6, 2,   3, 7, 6,   0, 4, 7,   0, 7, 3,   1, 2, 6,   1, 6, 5,
+		};
+		backend.RegisterMesh(Box, boxVertices, 8, boxIndices, 36);
+	}
+
+	// Overlapping boxes scattered in front of a camera at the
+	// origin, drawn as instances of one draw, then the starter
+	// meshes, tinted, close up, in a second viewport.  Every
+	// object's world matrix and tint is uploaded once, and the
+	// camera is the only constant.  Viewports last across lists,
+	// like D3D11, so the first one is set too.  The reversed
+	// list flips depth (z' = w - z) for the GREATER test
+	void RecordScene(CommandList& commands, bool reversed)
+	{
+		SoftwareBackend::Constants constants;
+		PerspectiveFovLH(1.2f, (float)Width / Height, 0.1f, 200.0f, &constants.viewProjection[0][0]);
+		if (reversed)
+		{
+			const float flipDepth[16] = { 1, 0, 0, 0,   0, 1, 0, 0,   0, 0, -1, 0,   0, 0, 1, 1 };
+			float forward[16];
+			memcpy(forward, constants.viewProjection, sizeof(forward));
+			MultiplyMatrices(forward, flipDepth, &constants.viewProjection[0][0]);
+		}
+
+		// Raw generator output, so every standard library agrees
+		std::mt19937 random(99);
+		auto between = [&random](float low, float high) { return low + (high - low) * (random() % 10000) / 10000.0f; };
+		std::vector<SoftwareBackend::Instance> instances;
+		for (int i = 0; i < 60; i++)
+		{
+			float sx = between(0.3f, 3.0f);
+			float sy = between(0.3f, 3.0f);
+			float sz = between(0.3f, 3.0f);
+			float x = between(-15.0f, 15.0f);
+			float y = between(-8.0f, 8.0f);
+			float z = between(5.0f, 40.0f);
+			instances.push_back({ { { sx, 0, 0, 0 }, { 0, sy, 0, 0 }, { 0, 0, sz, 0 }, { x, y, z, 1 } }, { 1.0f, 1.0f, 1.0f, 1.0f } });
+		}
+
+		const float tints[3][4] = { { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 0.5f, 1.0f, 1.0f }, { 0.5f, 1.0f, 1.0f, 1.0f } };
+		for (unsigned int mesh = Triangle; mesh <= Weird; mesh++)
+		{
+			const float* tint = tints[mesh];
+			instances.push_back({ { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { mesh * 0.6f - 0.6f, 0, 1.5f, 1 } }, { tint[0], tint[1], tint[2], tint[3] } });
+		}
+
+		commands.ClearTargets(ClearColor, reversed ? 0.0f : 1.0f);
+		commands.UpdateInstances(instances.data(), sizeof(SoftwareBackend::Instance), (unsigned int)instances.size());
+		commands.SetViewport(0.0f, 0.0f, (float)Width, (float)Height);
+		commands.BindShaders(0);
+		commands.UpdateConstants(0, &constants, sizeof(constants));
+		commands.BindMesh(Box);
+		commands.DrawInstanced(36, 60);
+
+		commands.SetViewport(Width * 0.5f, 0.0f, Width * 0.5f, Height * 0.5f);
+		for (unsigned int mesh = Triangle; mesh <= Weird; mesh++)
+		{
+			commands.BindMesh(mesh);
+			commands.DrawInstanced(mesh == Triangle ? 3 : mesh == Quad ? 6 : 12, 1, 0, 0, 60 + mesh);
+		}
+	}
+
+	std::vector<unsigned int> CopyImage(SoftwareBackend& backend)
+	{
+		std::vector<unsigned int> image((size_t)Width * Height);
+		for (int y = 0; y < Height; y++)
+			for (int x = 0; x < Width; x++)
+				image[(size_t)y * Width + x] = backend.GetPixel(x, y);
+		return image;
+	}
+}
+
+
+TEST(FrameMatchesGoldenImage)
+{
+	// Compared byte for byte, so any change to the rasterizer
+	// shows up here.  On a mismatch the new image is left next
+	// to the test to look at, and to replace the golden one with
+	// if the change is intended
+	CommandList commands;
+	RecordScene(commands, false);
+	SoftwareBackend backend(Width, Height);
+	RegisterMeshes(backend);
+	backend.Execute(commands);
+
+	std::string path = "SoftwareFrame.tmp.png";
+	CHECK(backend.SavePNG(path));
+	std::ifstream file(path, std::ios::binary);
+	std::string png((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	CHECK(TestHarness::MatchesGolden("SoftwareFrame.png", png));
+
+	SoftwareBackend::Stats stats = backend.GetStats();
+	CHECK(stats.draws == 63);
+	CHECK(stats.triangles == 60 * 12 + 1 + 2 + 4);
+	CHECK(stats.pixels > (size_t)Width * Height / 4);
+}
+
+
+TEST(SingleThreadGivesTheSameImage)
+{
+	CommandList commands;
+	RecordScene(commands, false);
+	SoftwareBackend backend(Width, Height);
+	RegisterMeshes(backend);
+	backend.Execute(commands);
+	unsigned int hash = backend.GetImageHash();
+
+	backend.SetMultithreaded(false);
+	backend.Execute(commands);
+	CHECK(backend.GetImageHash() == hash);
+}
+
+
+TEST(ReversedDepthSeesTheSameSurfaces)
+{
+	// Give or take pixels where two boxes are nearly the same depth
+	CommandList commands;
+	CommandList reversedCommands;
+	RecordScene(commands, false);
+	RecordScene(reversedCommands, true);
+	SoftwareBackend backend(Width, Height);
+	RegisterMeshes(backend);
+	backend.Execute(commands);
+	std::vector<unsigned int> forward = CopyImage(backend);
+
+	backend.SetReversedDepth(true);
+	backend.Execute(reversedCommands);
+	std::vector<unsigned int> reversed = CopyImage(backend);
+	size_t mismatches = 0;
+	for (size_t i = 0; i < forward.size(); i++)
+		mismatches += forward[i] != reversed[i];
+	CHECK(mismatches < forward.size() / 1000);
+}
+
+
+TEST(DrawsReadTheirInstance)
+{
+	// Instance 0 is off to the side, instance 1 fills the middle.
+	// Draw uses instance 0, and instances never uploaded are skipped
+	SoftwareBackend backend(Width, Height);
+	RegisterMeshes(backend);
+	SoftwareBackend::Constants constants = { { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } } };
+	const SoftwareBackend::Instance instances[2] =
+	{
+		{ { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 5, 0, 0.5f, 1 } }, { 1, 1, 1, 1 } },
+		{ { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0.5f, 1 } }, { 1, 1, 1, 1 } },
+	};
+
+	CommandList commands;
+	commands.ClearTargets(ClearColor, 1.0f);
+	commands.UpdateInstances(instances, sizeof(SoftwareBackend::Instance), 2);
+	commands.BindShaders(0);
+	commands.UpdateConstants(0, &constants, sizeof(constants));
+	commands.BindMesh(Triangle);
+	commands.Draw(3);
+	commands.DrawInstanced(3, 1, 0, 0, 2);
+	backend.Execute(commands);
+	CHECK(backend.GetStats().draws == 1);
+	CHECK(backend.GetStats().pixels == 0);
+
+	commands.DrawInstanced(3, 1, 0, 0, 1);
+	backend.ResetStats();
+	backend.Execute(commands);
+	CHECK(backend.GetStats().draws == 2);
+	CHECK(backend.GetStats().pixels > 0);
+	CHECK(backend.GetPixel(Width / 2, Height / 2) != backend.GetPixel(0, 0));
+}
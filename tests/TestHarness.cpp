@@ -0,0 +1,125 @@
+#include "TestHarness.h"
+#include "JobSystem.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// --------------- Basic usage -----------------
+//
+// Each test file builds into its own executable, linked
+// with this file (which has main()).  TEST() defines a
+// case and CHECK() records a failure without stopping it:
+//
+//   TEST(SortIsStable)
+//   {
+//       queue.Sort();
+//       CHECK(queue.GetItems()[0].index == 3);
+//   }
+//
+// Every case runs, in the order they appear in the file,
+// with the JobSystem already started (three workers).
+// Failed checks are printed with their file and line,
+// and the exit code is the number of failed cases, so
+// ctest catches them.
+//
+// Golden files live in tests/Golden.  When the text
+// doesn't match, it's written next to the executable
+// (with the same name) for diffing, or for copying over
+// the golden file after a deliberate change.
+// ---------------------------------------------
+
+// Annonymous namespace to hold variables/helpers only accessible in this file
+namespace
+{
+	struct Test
+	{
+		const char* name;
+		TestHarness::TestFunction function;
+	};
+
+	// Filled in by static initializers, so it can't be a plain global
+	std::vector<Test>& GetTests()
+	{
+		static std::vector<Test> tests;
+		return tests;
+	}
+
+	int currentFailures = 0;
+}
+
+
+// --------------------------------------------------------
+// Adds a case, before main() runs
+// --------------------------------------------------------
+bool TestHarness::Register(const char* name, TestFunction function)
+{
+	GetTests().push_back({ name, function });
+	return true;
+}
+
+
+// --------------------------------------------------------
+// Reports a failed check; the case keeps running
+// --------------------------------------------------------
+void TestHarness::Fail(const char* file, int line, const char* condition)
+{
+	std::printf("  %s(%d): CHECK(%s) failed\n", file, line, condition);
+	currentFailures++;
+}
+
+
+// --------------------------------------------------------
+// Removes anything left from a previous run
+// --------------------------------------------------------
+std::string TestHarness::MakeTempFolder(const std::string& name)
+{
+	std::error_code error;
+	std::filesystem::path folder = std::filesystem::temp_directory_path(error) / name;
+	std::filesystem::remove_all(folder, error);
+	std::filesystem::create_directories(folder, error);
+	return folder.string();
+}
+
+
+// --------------------------------------------------------
+// Golden files are read from the source tree (see
+// tests/CMakeLists.txt)
+// --------------------------------------------------------
+bool TestHarness::MatchesGolden(const std::string& fileName, const std::string& text)
+{
+	std::ifstream file(std::string(TEST_GOLDEN_FOLDER) + "/" + fileName, std::ios::binary);
+	std::string golden((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (file && golden == text)
+		return true;
+
+	std::ofstream(fileName, std::ios::binary | std::ios::trunc) << text;
+	std::printf("  %s doesn't match; the output is in %s\n", fileName.c_str(),
+		std::filesystem::absolute(fileName).string().c_str());
+	return false;
+}
+
+
+int main()
+{
+	// The same number of workers on every machine, so work is
+	// split the same way everywhere
+	JobSystem::Initialize(3);
+
+	int failedTests = 0;
+	for (const Test& test : GetTests())
+	{
+		std::printf("%s\n", test.name);
+		std::fflush(stdout);
+		currentFailures = 0;
+		test.function();
+		if (currentFailures > 0)
+			failedTests++;
+	}
+	std::printf("%d of %d passed\n", (int)GetTests().size() - failedTests, (int)GetTests().size());
+
+	JobSystem::ShutDown();
+	return failedTests;
+}
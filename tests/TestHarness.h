@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+
+// See TestHarness.cpp for usage details
+
+namespace TestHarness
+{
+	using TestFunction = void (*)();
+
+	// Called by TEST() and CHECK()
+	bool Register(const char* name, TestFunction function);
+	void Fail(const char* file, int line, const char* condition);
+
+	// An empty folder under the system's temp folder
+	std::string MakeTempFolder(const std::string& name);
+
+	// Compares text against a file in tests/Golden, writing
+	// the text next to the test executable when they differ
+	bool MatchesGolden(const std::string& fileName, const std::string& text);
+}
+
+#define TEST(name) \
+	static void name(); \
+	static bool name##Registered = TestHarness::Register(#name, name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if (!(condition)) TestHarness::Fail(__FILE__, __LINE__, #condition); } while (0)
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+
+// Row-major matrices with row vectors, laid out like
+// DirectX::XMFLOAT4X4, for tests that can't use DirectXMath
+namespace TestMath
+{
+	// Scale then translation
+	inline void ScaleTranslation(float sx, float sy, float sz, float x, float y, float z, float result[16])
+	{
+		const float matrix[16] = { sx, 0, 0, 0,   0, sy, 0, 0,   0, 0, sz, 0,   x, y, z, 1 };
+		memcpy(result, matrix, sizeof(matrix));
+	}
+
+	// Same as XMMatrixPerspectiveFovLH()
+	inline void PerspectiveFovLH(float fov, float aspect, float nearClip, float farClip, float result[16])
+	{
+		float yScale = 1.0f / std::tan(fov * 0.5f);
+		float range = farClip / (farClip - nearClip);
+		const float matrix[16] = { yScale / aspect, 0, 0, 0,   0, yScale, 0, 0,   0, 0, range, 1,   0, 0, -range * nearClip, 0 };
+		memcpy(result, matrix, sizeof(matrix));
+	}
+
+	// result = a * b, which mustn't be either of them
+	inline void MultiplyMatrices(const float a[16], const float b[16], float result[16])
+	{
+		for (int row = 0; row < 4; row++)
+			for (int col = 0; col < 4; col++)
+				result[row * 4 + col] =
+					a[row * 4 + 0] * b[0 * 4 + col] +
+					a[row * 4 + 1] * b[1 * 4 + col] +
+					a[row * 4 + 2] * b[2 * 4 + col] +
+					a[row * 4 + 3] * b[3 * 4 + col];
+	}
+}
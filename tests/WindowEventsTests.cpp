@@ -0,0 +1,114 @@
+#include "TestHarness.h"
+#include "WindowEvents.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(MessagesAndNewestSizeAcrossThreads)
+{
+	// A producer posting mouse moves with a resize every 16,
+	// like a border being dragged.  Each message carries its
+	// sequence number in lParam, and each size grows, so an
+	// older one showing up after a newer one would be caught
+	const int MessageCount = 200000;
+	WindowEvents events(1024);
+	std::atomic<bool> producerDone = false;
+	std::thread producer([&events, &producerDone]()
+		{
+			for (int i = 0; i < MessageCount; i++)
+			{
+				WindowMessage message = { 0x0200, 0, i };	// WM_MOUSEMOVE
+				while (!events.Post(message))
+					std::this_thread::yield();
+				if (i % 16 == 15)
+					events.PostResize(640 + i / 16, 360 + i / 32);
+			}
+			producerDone = true;
+		});
+
+	std::vector<WindowMessage> messages;
+	long long expected = 0;
+	bool inOrder = true;
+	bool sizesGrow = true;
+	unsigned int lastWidth = 0;
+	unsigned int lastHeight = 0;
+	unsigned long long drains = 0;
+	while (true)
+	{
+		bool done = producerDone;
+		drains++;
+		unsigned int width = 0;
+		unsigned int height = 0;
+		if (events.TakeResize(width, height))
+		{
+			sizesGrow = sizesGrow && width > lastWidth && height >= lastHeight;
+			lastWidth = width;
+			lastHeight = height;
+		}
+
+		messages.clear();
+		size_t count = events.Drain(messages);
+		for (const WindowMessage& message : messages)
+			inOrder = inOrder && message.lParam == expected++;
+
+		// Everything was posted before the last look
+		if (done && count == 0)
+			break;
+		if (count == 0)
+			std::this_thread::yield();
+	}
+	producer.join();
+
+	CHECK(inOrder);
+	CHECK(expected == MessageCount);
+	CHECK(events.GetPostedCount() == (unsigned long long)MessageCount);
+	CHECK(sizesGrow);
+	CHECK(events.GetResizesPosted() == MessageCount / 16);
+	CHECK(events.GetResizesTaken() <= drains);
+
+	// The last size taken is the last one posted, and there's
+	// nothing newer
+	unsigned int width = 0;
+	unsigned int height = 0;
+	int lastPosted = (MessageCount / 16) * 16 - 1;
+	CHECK(lastWidth == 640u + lastPosted / 16 && lastHeight == 360u + lastPosted / 32);
+	CHECK(!events.TakeResize(width, height));
+}
+
+
+TEST(ZeroAndRepeatedSizesAreIgnored)
+{
+	// Minimizing sends a zero size, and restoring sends the
+	// size the window already had
+	WindowEvents events(16);
+	unsigned int width = 0;
+	unsigned int height = 0;
+	events.PostResize(1280, 720);
+	CHECK(events.TakeResize(width, height) && width == 1280 && height == 720);
+
+	events.PostResize(0, 0);
+	CHECK(!events.TakeResize(width, height));
+	events.PostResize(1280, 720);
+	CHECK(!events.TakeResize(width, height));
+	events.PostResize(1920, 1080);
+	events.PostResize(1280, 720);
+	CHECK(!events.TakeResize(width, height));
+	CHECK(events.GetResizesTaken() == 1);
+}
+
+
+TEST(FullQueueDropsMessages)
+{
+	WindowEvents events(16);
+	int accepted = 0;
+	for (int i = 0; i < 20; i++)
+		accepted += events.Post({ 0x0100, (unsigned long long)i, 0 }) ? 1 : 0;	// WM_KEYDOWN
+	CHECK(accepted == 16);
+	CHECK(events.GetDroppedCount() == 4);
+	CHECK(events.GetPostedCount() == 16);
+
+	std::vector<WindowMessage> messages;
+	CHECK(events.Drain(messages) == 16);
+	CHECK(messages.front().wParam == 0 && messages.back().wParam == 15);
+}